@@ -2,13 +2,20 @@ cl /std:c++20 /O2 /MT /DNDEBUG /D_UNICODE /DUNICODE /Fo"release\\" /Fd"release\\
 
 @echo off
 :: Check the error level (exit code) of the last command
-if %ERRORLEVEL% neq 0 (
-    :: Set text color to red
-    color 0C
-    echo :: BUILD FAILED! BUILD FAILED! BUILD FAILED! BUILD FAILED! BUILD FAILED! ::
-    pause
-    :: Reset color to default
-    color 07
-    exit /b 1
-)
+if %ERRORLEVEL% neq 0 goto build_failed
 
+:: Compile the shaders into release\shader_cache, next to the executable where the game looks for them
+cl /std:c++20 /O2 /EHsc /Fo"release\\" tools/shader_precompiler.cpp /link /LIBPATH:"./lib" D3DCompiler.lib /OUT:"release\shader_precompiler.exe"
+if %ERRORLEVEL% neq 0 goto build_failed
+release\shader_precompiler.exe -o release\shader_cache resources
+if %ERRORLEVEL% neq 0 goto build_failed
+exit /b 0
+
+:build_failed
+:: Set text color to red
+color 0C
+echo :: BUILD FAILED! BUILD FAILED! BUILD FAILED! BUILD FAILED! BUILD FAILED! ::
+pause
+:: Reset color to default
+color 07
+exit /b 1
@@ -0,0 +1,572 @@
+#pragma once
+
+// ----------
+// Includes
+
+#include <stdio.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include "types.h"
+#include "text_layout.h"
+#include "mipmap.h"
+#include "block_texture.h"
+#include "qoi_image.h"
+#include "vfs.h"
+#include "stb_image.h"
+#include "stb_truetype.h"
+
+// Startup asset loading on a worker pool. Workers read the files and do all CPU side work: image decoding and
+// mip chains, block texture validation, WAV parsing and font baking. Finished jobs go back to the thread that
+// calls AssetLoaderFinish in completion order, which creates the GPU and audio objects through an
+// AssetUploadSink while the workers keep decoding. Nothing here touches D3D11 or XAudio2.
+//
+// Paths are virtual paths resolved through the loader's Vfs. Without a Vfs they are native file paths.
+
+// ---------
+// Defines
+
+const i32 ASSET_PATH_MAX = 260;
+const i32 ASSET_ERROR_MAX = ASSET_PATH_MAX + 64; // A full path and the message around it
+const i32 ASSET_LOADER_MAX_WORKERS = 16;
+
+enum AssetKind : u32 {
+    ASSET_KIND_IMAGE = 0,
+    ASSET_KIND_BLOCK_TEXTURE = 1,
+    ASSET_KIND_SOUND = 2,
+    ASSET_KIND_FONT = 3,
+};
+
+// ---------
+// Structs
+
+/**
+ * @brief PCM sound parsed from a WAV file. 'data' holds 'data_size' bytes of samples.
+ */
+struct AssetSound {
+    u16 audio_format;
+    u16 channel_count;
+    u32 sample_rate;
+    u32 byte_rate;
+    u16 block_align;
+    u16 bits_per_sample;
+    byte* data;
+    u32 data_size;
+};
+
+/**
+ * @brief Baked ASCII font atlas, one R8 row of glyphs 'width' x 'height' pixels.
+ */
+struct AssetFontBitmap {
+    i32 font_size_px;
+    i32 width;
+    i32 height;
+    f32 ascent;
+    f32 descent;
+    f32 linegap;
+    FontGlyphInfo glyphs[FONT_GLYPH_COUNT];
+    byte* pixels;
+};
+
+struct AssetLoadJob {
+    AssetKind kind;
+    char path[ASSET_PATH_MAX];
+    f32 font_pixel_height;
+    void* target;
+
+    // File bytes between AssetReadJob and AssetDecodeJob. 'file_view' points into 'file_data' or into a pack
+    const byte* file_view;
+    byte* file_data;
+    size_t file_size;
+    bool is_qoi;
+
+    bool is_ok;
+    char error[ASSET_ERROR_MAX];
+    f64 read_ms;
+    f64 decode_ms;
+
+    MipChain image;
+    i32 image_channels;
+    BlockTexture block_texture;
+    AssetSound sound;
+    AssetFontBitmap font;
+};
+
+/**
+ * @brief Creates the final objects of finished jobs on the thread calling AssetLoaderFinish.
+ *
+ * The loader frees the CPU side data of a job after 'upload' returns. To keep a buffer, set its pointer in the job to nullptr.
+ */
+struct AssetUploadSink {
+    void* user_data;
+    void (*upload)(void* user_data, AssetLoadJob* job);
+};
+
+struct AssetLoaderStats {
+    i32 job_count;
+    i32 worker_count;
+    f64 wall_ms;
+    f64 decode_ms;
+    f64 upload_ms;
+};
+
+struct AssetLoader {
+    Vfs* vfs = nullptr;
+    AssetLoadJob* jobs = nullptr;
+    i32 job_count = 0;
+    i32 job_capacity = 0;
+
+    std::atomic<i32> next_job = 0;
+    std::thread workers[ASSET_LOADER_MAX_WORKERS];
+    i32 worker_count = 0;
+
+    std::mutex completed_mutex;
+    std::condition_variable completed_signal;
+    i32* completed = nullptr;
+    i32 completed_count = 0;
+
+    std::chrono::steady_clock::time_point start_time;
+    AssetLoaderStats stats = {};
+};
+
+// --------------------------
+// Function implementations
+
+/**
+ * @brief Last '/' or '\\' of 'path', whichever comes later. Returns nullptr for paths without one.
+ */
+const char* PathLastSeparator(const char* path) {
+    const char* result = nullptr;
+    for (const char* p = path; *p != 0; p++) {
+        if (*p == '/' || *p == '\\') {
+            result = p;
+        }
+    }
+    return result;
+}
+
+/**
+ * @brief Write 'path' with its file extension replaced by 'extension' (with the dot) to 'result'.
+ */
+void PathWithExtension(char* result, i32 result_size, const char* path, const char* extension) {
+    const char* old_extension = strrchr(path, '.');
+    const char* last_separator = PathLastSeparator(path);
+
+    bool has_extension = old_extension && (!last_separator || last_separator < old_extension);
+    i32 stem_length = has_extension ? (i32)(old_extension - path) : (i32)strlen(path);
+    snprintf(result, result_size, "%.*s%s", stem_length, path, extension);
+}
+
+bool AssetFileExists(Vfs* vfs, const char* path) {
+    if (vfs) {
+        return VfsExists(vfs, path);
+    }
+
+    FILE* file = fopen(path, "rb");
+    if (file) {
+        fclose(file);
+    }
+    return file != nullptr;
+}
+
+bool AssetFileModifiedTime(Vfs* vfs, const char* path, i64* time) {
+    return vfs ? VfsModifiedTime(vfs, path, time) : VfsNativeModifiedTime(path, time);
+}
+
+/**
+ * @brief True when 'derived_path', a file converted from 'source_path' offline, exists and is not older than the source.
+ *
+ * A derived file without its source is used as is. Pack and memory files have no times and are built together, so a
+ * packed derived file is current unless its source is a loose file, which is then an edit in progress.
+ */
+bool AssetDerivedFileIsCurrent(Vfs* vfs, const char* derived_path, const char* source_path) {
+    if (!AssetFileExists(vfs, derived_path)) {
+        return false;
+    }
+    if (!AssetFileExists(vfs, source_path)) {
+        return true;
+    }
+
+    i64 derived_time = 0;
+    i64 source_time = 0;
+    bool has_derived_time = AssetFileModifiedTime(vfs, derived_path, &derived_time);
+    bool has_source_time = AssetFileModifiedTime(vfs, source_path, &source_time);
+    if (has_derived_time && has_source_time) {
+        return source_time <= derived_time;
+    }
+    return !has_source_time;
+}
+
+/**
+ * @brief Read a whole file into a malloc'ed buffer. Returns nullptr if it can not be read.
+ */
+byte* AssetReadFile(Vfs* vfs, const char* path, size_t* file_size) {
+    return vfs ? VfsReadFile(vfs, path, file_size) : VfsReadNativeFile(path, file_size);
+}
+
+/**
+ * @brief Bytes of an image file, preferring a .qoi next to it unless the source is newer. Packed and in-memory files are returned in place, loose files are read into '*owned_data', which the caller frees.
+ */
+const byte* AssetOpenImageFile(Vfs* vfs, const char* path, size_t* file_size, byte** owned_data, bool* is_qoi, char* error) {
+    char qoi_path[ASSET_PATH_MAX];
+    PathWithExtension(qoi_path, ASSET_PATH_MAX, path, ".qoi");
+    *is_qoi = AssetDerivedFileIsCurrent(vfs, qoi_path, path);
+    *owned_data = nullptr;
+
+    VfsFile file = {};
+    const byte* source = nullptr;
+    if (vfs && VfsResolve(vfs, *is_qoi ? qoi_path : path, &file) && file.kind != VFS_MOUNT_DIRECTORY) {
+        source = file.data;
+        *file_size = file.size;
+    }
+    else {
+        *owned_data = AssetReadFile(vfs, *is_qoi ? qoi_path : path, file_size);
+        source = *owned_data;
+    }
+
+    if (!source) {
+        snprintf(error, ASSET_ERROR_MAX, "Failed to read %s", *is_qoi ? qoi_path : path);
+    }
+    return source;
+}
+
+/**
+ * @brief Decode PNG (or anything stb_image reads) or QOI file bytes and build the mip chain.
+ */
+bool AssetDecodeImageMemory(const byte* data, size_t data_size, bool is_qoi, const char* path, MipChain* mip_chain, i32* channels, char* error) {
+    i32 width = 0;
+    i32 height = 0;
+    byte* image = nullptr;
+    if (is_qoi) {
+        QoiImageInfo info = {};
+        image = QoiDecode(data, data_size, &info);
+        width = (i32)info.width;
+        height = (i32)info.height;
+        *channels = info.channels;
+    }
+    else {
+        image = stbi_load_from_memory(data, (int)data_size, &width, &height, channels, 4);
+    }
+
+    if (!image) {
+        snprintf(error, ASSET_ERROR_MAX, "Failed to decode %s", path);
+        return false;
+    }
+
+    bool is_ok = MipChainBuild(mip_chain, image, width, height);
+    if (!is_ok) {
+        snprintf(error, ASSET_ERROR_MAX, "Out of memory building mip chain of %s", path);
+    }
+
+    // stb_image allocates with malloc as well
+    free(image);
+    return is_ok;
+}
+
+/**
+ * @brief Decode an image and build its mip chain. A .qoi file next to the source is decoded instead when it is up to date.
+ */
+bool AssetDecodeImage(Vfs* vfs, const char* path, MipChain* mip_chain, i32* channels, char* error) {
+    size_t file_size = 0;
+    byte* owned_data = nullptr;
+    bool is_qoi = false;
+    const byte* source = AssetOpenImageFile(vfs, path, &file_size, &owned_data, &is_qoi, error);
+    if (!source) {
+        return false;
+    }
+
+    bool is_ok = AssetDecodeImageMemory(source, file_size, is_qoi, path, mip_chain, channels, error);
+    free(owned_data);
+    return is_ok;
+}
+
+/**
+ * @brief Parse a canonical 44 byte header PCM WAV file. On success 'sound->data' is a malloc'ed copy of the samples.
+ */
+bool AssetParseWav(const byte* data, size_t data_size, AssetSound* sound) {
+    const size_t header_size = 44;
+    if (data_size < header_size || memcmp(data, "RIFF", 4) != 0 || memcmp(data + 8, "WAVE", 4) != 0) {
+        return false;
+    }
+
+    *sound = {};
+    memcpy(&sound->audio_format, data + 20, 2);
+    memcpy(&sound->channel_count, data + 22, 2);
+    memcpy(&sound->sample_rate, data + 24, 4);
+    memcpy(&sound->byte_rate, data + 28, 4);
+    memcpy(&sound->block_align, data + 32, 2);
+    memcpy(&sound->bits_per_sample, data + 34, 2);
+    memcpy(&sound->data_size, data + 40, 4);
+
+    if (data_size - header_size < sound->data_size) {
+        return false;
+    }
+
+    sound->data = (byte*)malloc(sound->data_size ? sound->data_size : 1);
+    if (!sound->data) {
+        return false;
+    }
+    memcpy(sound->data, data + header_size, sound->data_size);
+    return true;
+}
+
+/**
+ * @brief Bake the printable ASCII glyphs of a TrueType font into a single row atlas.
+ */
+bool AssetBakeFont(const byte* font_data, f32 pixel_height, AssetFontBitmap* result) {
+    *result = {};
+
+    stbtt_fontinfo font;
+    if (!stbtt_InitFont(&font, font_data, stbtt_GetFontOffsetForIndex(font_data, 0))) {
+        return false;
+    }
+
+    i32 used_height = (i32)pixel_height;
+    f32 scale = stbtt_ScaleForPixelHeight(&font, (f32)used_height);
+    i32 ascent, descent, line_gap;
+    stbtt_GetFontVMetrics(&font, &ascent, &descent, &line_gap);
+
+    result->font_size_px = used_height;
+    result->ascent = ascent * scale;
+    result->descent = descent * scale;
+    result->linegap = line_gap * scale;
+
+    byte* bitmaps[FONT_GLYPH_COUNT] = {};
+    for (i32 c = 32; c < 128; c++) {
+        i32 width, height, x_offset, y_offset;
+        bitmaps[c - 32] = stbtt_GetCodepointBitmap(&font, 0, scale, c, &width, &height, &x_offset, &y_offset);
+
+        i32 advance_width, left_side_bearing;
+        stbtt_GetCodepointHMetrics(&font, c, &advance_width, &left_side_bearing);
+
+        FontGlyphInfo* glyph = &result->glyphs[c - 32];
+        glyph->advance = (f32)advance_width * scale;
+        glyph->bitmap_height = height;
+        glyph->bitmap_width = width;
+        glyph->character = (char)c;
+        glyph->x_offset = x_offset;
+        glyph->y_offset = -1 * y_offset;
+
+        result->width += width;
+        if (result->height < height) {
+            result->height = height;
+        }
+    }
+
+    result->pixels = (byte*)calloc((size_t)result->height * result->width, 1);
+    i32 atlas_x = 0;
+
+    for (i32 i = 0; i < FONT_GLYPH_COUNT; i++) {
+        FontGlyphInfo* glyph = &result->glyphs[i];
+        if (result->pixels) {
+            for (i32 row = 0; row < glyph->bitmap_height; row++) {
+                memcpy(&result->pixels[result->width * row + atlas_x], &bitmaps[i][glyph->bitmap_width * row], glyph->bitmap_width);
+            }
+        }
+
+        glyph->uv_x0 = (f32)atlas_x / (f32)result->width;
+        glyph->uv_y0 = 0.0f;
+        glyph->uv_x1 = glyph->uv_x0 + (f32)glyph->bitmap_width / (f32)result->width;
+        glyph->uv_y1 = (f32)glyph->bitmap_height / (f32)result->height;
+
+        atlas_x += glyph->bitmap_width;
+        stbtt_FreeBitmap(bitmaps[i], nullptr);
+    }
+
+    result->glyphs[32].advance = result->glyphs['M' - 32].bitmap_width / 2.0f; // Spacebar
+    return result->pixels != nullptr;
+}
+
+void AssetFreeJobData(AssetLoadJob* job) {
+    free(job->file_data);
+    job->file_data = nullptr;
+    job->file_view = nullptr;
+    MipChainDestroy(&job->image);
+    BlockTextureDestroy(&job->block_texture);
+    free(job->sound.data);
+    job->sound.data = nullptr;
+    free(job->font.pixels);
+    job->font.pixels = nullptr;
+}
+
+/**
+ * @brief I/O half of a job: get the file bytes into 'file_view'. Returns false with 'error' set if the file can not be read.
+ */
+bool AssetReadJob(Vfs* vfs, AssetLoadJob* job) {
+    auto start_time = std::chrono::steady_clock::now();
+
+    if (job->kind == ASSET_KIND_IMAGE) {
+        job->file_view = AssetOpenImageFile(vfs, job->path, &job->file_size, &job->file_data, &job->is_qoi, job->error);
+    }
+    else {
+        job->file_data = AssetReadFile(vfs, job->path, &job->file_size);
+        job->file_view = job->file_data;
+        if (!job->file_data) {
+            snprintf(job->error, ASSET_ERROR_MAX, "Failed to read %s", job->path);
+        }
+    }
+
+    job->read_ms = std::chrono::duration<f64, std::milli>(std::chrono::steady_clock::now() - start_time).count();
+    return job->file_view != nullptr;
+}
+
+/**
+ * @brief CPU half of a job, after AssetReadJob succeeded. Consumes the file bytes.
+ */
+void AssetDecodeJob(AssetLoadJob* job) {
+    auto start_time = std::chrono::steady_clock::now();
+
+    if (job->kind == ASSET_KIND_IMAGE) {
+        job->is_ok = AssetDecodeImageMemory(job->file_view, job->file_size, job->is_qoi, job->path, &job->image, &job->image_channels, job->error);
+    }
+    else if (job->kind == ASSET_KIND_BLOCK_TEXTURE) {
+        // The block texture takes ownership of the file data
+        job->is_ok = BlockTextureLoadFromMemory(&job->block_texture, job->file_data, job->file_size);
+        if (job->is_ok) {
+            job->file_data = nullptr;
+        }
+        else {
+            snprintf(job->error, ASSET_ERROR_MAX, "Invalid block compressed texture %s", job->path);
+        }
+    }
+    else if (job->kind == ASSET_KIND_SOUND) {
+        job->is_ok = AssetParseWav(job->file_view, job->file_size, &job->sound);
+        if (!job->is_ok) {
+            snprintf(job->error, ASSET_ERROR_MAX, "Invalid WAV file %s", job->path);
+        }
+    }
+    else if (job->kind == ASSET_KIND_FONT) {
+        job->is_ok = AssetBakeFont(job->file_view, job->font_pixel_height, &job->font);
+        if (!job->is_ok) {
+            snprintf(job->error, ASSET_ERROR_MAX, "Failed to bake font %s", job->path);
+        }
+    }
+
+    free(job->file_data);
+    job->file_data = nullptr;
+    job->file_view = nullptr;
+    job->decode_ms = std::chrono::duration<f64, std::milli>(std::chrono::steady_clock::now() - start_time).count();
+}
+
+/**
+ * @brief All CPU side work of one job. Runs on a worker thread.
+ */
+void AssetRunJob(Vfs* vfs, AssetLoadJob* job) {
+    if (AssetReadJob(vfs, job)) {
+        AssetDecodeJob(job);
+    }
+}
+
+void AssetLoaderWorker(AssetLoader* loader) {
+    for (;;) {
+        i32 job_index = loader->next_job.fetch_add(1);
+        if (loader->job_count <= job_index) {
+            return;
+        }
+
+        AssetRunJob(loader->vfs, &loader->jobs[job_index]);
+
+        std::lock_guard<std::mutex> lock(loader->completed_mutex);
+        loader->completed[loader->completed_count++] = job_index;
+        loader->completed_signal.notify_one();
+    }
+}
+
+/**
+ * @brief Create with room for 'job_capacity' jobs. 'vfs' resolves job paths, null for native paths.
+ */
+bool AssetLoaderCreate(AssetLoader* loader, i32 job_capacity, Vfs* vfs) {
+    loader->vfs = vfs;
+    loader->jobs = (AssetLoadJob*)calloc(job_capacity, sizeof(AssetLoadJob));
+    loader->completed = (i32*)malloc(sizeof(i32) * job_capacity);
+    loader->job_capacity = job_capacity;
+    return loader->jobs && loader->completed;
+}
+
+void AssetLoaderDestroy(AssetLoader* loader) {
+    for (i32 i = 0; i < loader->job_count; i++) {
+        AssetFreeJobData(&loader->jobs[i]);
+    }
+    free(loader->jobs);
+    free(loader->completed);
+    loader->jobs = nullptr;
+    loader->completed = nullptr;
+    loader->job_count = 0;
+    loader->job_capacity = 0;
+}
+
+/**
+ * @brief Queue a file before AssetLoaderStart. 'target' is handed to the upload sink untouched. Returns nullptr when full.
+ */
+AssetLoadJob* AssetLoaderAdd(AssetLoader* loader, AssetKind kind, const char* path, void* target) {
+    if (loader->job_capacity <= loader->job_count) {
+        return nullptr;
+    }
+
+    AssetLoadJob* job = &loader->jobs[loader->job_count++];
+    *job = {};
+    job->kind = kind;
+    job->target = target;
+    snprintf(job->path, ASSET_PATH_MAX, "%s", path);
+    return job;
+}
+
+/**
+ * @brief Start decoding every queued job on 'worker_count' threads.
+ */
+void AssetLoaderStart(AssetLoader* loader, i32 worker_count) {
+    worker_count = worker_count < 1 ? 1 : worker_count;
+    worker_count = ASSET_LOADER_MAX_WORKERS < worker_count ? ASSET_LOADER_MAX_WORKERS : worker_count;
+
+    loader->start_time = std::chrono::steady_clock::now();
+    loader->next_job = 0;
+    loader->completed_count = 0;
+    loader->worker_count = worker_count;
+
+    // The sRGB tables are filled lazily on first use, fill them before the workers race to do it
+    MipmapInitTables();
+
+    for (i32 i = 0; i < worker_count; i++) {
+        loader->workers[i] = std::thread(AssetLoaderWorker, loader);
+    }
+}
+
+/**
+ * @brief Hand every job to 'sink' as soon as it is decoded, then join the workers. Returns timing stats.
+ */
+AssetLoaderStats AssetLoaderFinish(AssetLoader* loader, AssetUploadSink* sink) {
+    f64 upload_ms = 0.0;
+
+    for (i32 uploaded = 0; uploaded < loader->job_count; uploaded++) {
+        i32 job_index;
+        {
+            std::unique_lock<std::mutex> lock(loader->completed_mutex);
+            loader->completed_signal.wait(lock, [&] { return uploaded < loader->completed_count; });
+            job_index = loader->completed[uploaded];
+        }
+
+        AssetLoadJob* job = &loader->jobs[job_index];
+        auto upload_start = std::chrono::steady_clock::now();
+        sink->upload(sink->user_data, job);
+        upload_ms += std::chrono::duration<f64, std::milli>(std::chrono::steady_clock::now() - upload_start).count();
+        AssetFreeJobData(job);
+    }
+
+    for (i32 i = 0; i < loader->worker_count; i++) {
+        loader->workers[i].join();
+    }
+
+    AssetLoaderStats stats = {};
+    stats.job_count = loader->job_count;
+    stats.worker_count = loader->worker_count;
+    stats.wall_ms = std::chrono::duration<f64, std::milli>(std::chrono::steady_clock::now() - loader->start_time).count();
+    stats.upload_ms = upload_ms;
+    for (i32 i = 0; i < loader->job_count; i++) {
+        stats.decode_ms += loader->jobs[i].read_ms + loader->jobs[i].decode_ms;
+    }
+    loader->stats = stats;
+    return stats;
+}
@@ -0,0 +1,295 @@
+#pragma once
+
+// ----------
+// Includes
+
+#include <string.h>
+
+#include "types.h"
+#include "hash.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Asset pack file written by tools/asset_packer.cpp. Everything is little-endian:
+//
+//   AssetPackHeader
+//   AssetPackEntry entries[entry_count]
+//   u32            slots[slot_count]      open addressing table of entry indices by path hash
+//   char           strings[string_bytes]  zero terminated entry paths
+//   byte           data[]                 file contents, each starting at a multiple of 'alignment'
+//
+// The pack is memory mapped and never copied: a lookup is one hash and a short probe, and the returned
+// pointer points straight into the mapping. Paths are matched case insensitively with '/' and '\' treated
+// as the same separator, so "images\Tiles_01.png" finds the entry "images/tiles_01.png".
+
+// ---------
+// Defines
+
+const u32 ASSET_PACK_MAGIC = 0x4B415046; // "FPAK"
+const u32 ASSET_PACK_VERSION = 1;
+const u32 ASSET_PACK_SLOT_EMPTY = 0xFFFFFFFFu;
+const u32 ASSET_PACK_DEFAULT_ALIGNMENT = 64;
+
+// ---------
+// Structs
+
+struct AssetPackHeader {
+    u32 magic;
+    u32 version;
+    u32 entry_count;
+    u32 slot_count;
+    u32 string_bytes;
+    u32 alignment;
+    u64 data_offset;
+};
+
+/**
+ * @brief One packed file. 'offset' is from the start of the pack, 'name_offset' points to its normalized path.
+ */
+struct AssetPackEntry {
+    u64 path_hash;
+    u64 offset;
+    u64 size;
+    u32 name_offset;
+    u32 reserved;
+};
+
+static_assert(sizeof(AssetPackHeader) == 32, "AssetPackHeader is not 32 bytes");
+static_assert(sizeof(AssetPackEntry) == 32, "AssetPackEntry is not 32 bytes");
+
+/**
+ * @brief Opened pack. All pointers point into 'data', which is a read-only mapping when 'is_mapped' is set.
+ */
+struct AssetPack {
+    const byte* data = nullptr;
+    size_t data_size = 0;
+    bool is_mapped = false;
+    const AssetPackHeader* header = nullptr;
+    const AssetPackEntry* entries = nullptr;
+    const u32* slots = nullptr;
+    const char* strings = nullptr;
+};
+
+// --------------------------
+// Function implementations
+
+/**
+ * @brief Pack path form of one character: lower case ASCII, '/' as the separator.
+ */
+char AssetPackNormalizeChar(char c) {
+    if (c == '\\') {
+        return '/';
+    }
+    if ('A' <= c && c <= 'Z') {
+        return c - 'A' + 'a';
+    }
+    return c;
+}
+
+/**
+ * @brief FNV-1a hash of a zero terminated path in its normalized form.
+ */
+u64 AssetPackHashPath(const char* path) {
+    u64 hash = HASH_FNV1A_SEED;
+    for (const char* p = path; *p != 0; p++) {
+        hash = HashFnv1aByte(hash, (byte)AssetPackNormalizeChar(*p));
+    }
+    return hash;
+}
+
+bool AssetPackPathEquals(const char* normalized, const char* path) {
+    for (; *normalized != 0 && *path != 0; normalized++, path++) {
+        if (*normalized != AssetPackNormalizeChar(*path)) {
+            return false;
+        }
+    }
+    return *normalized == *path;
+}
+
+size_t AssetPackTableSize(u32 entry_count, u32 slot_count, u32 string_bytes) {
+    return sizeof(AssetPackHeader)
+        + sizeof(AssetPackEntry) * (size_t)entry_count
+        + sizeof(u32) * (size_t)slot_count
+        + string_bytes;
+}
+
+/**
+ * @brief Open a pack already in memory. The pack does not own 'data', which must outlive it. Returns false if the data is not a valid pack.
+ *
+ * Slot tables without an empty slot are not valid.
+ */
+bool AssetPackOpenMemory(AssetPack* pack, const byte* data, size_t data_size) {
+    *pack = {};
+    if (data_size < sizeof(AssetPackHeader)) {
+        return false;
+    }
+
+    const AssetPackHeader* header = (const AssetPackHeader*)data;
+    bool is_slot_count_valid = header->slot_count != 0 && (header->slot_count & (header->slot_count - 1)) == 0 && header->entry_count < header->slot_count;
+    bool is_alignment_valid = header->alignment != 0 && (header->alignment & (header->alignment - 1)) == 0;
+    if (header->magic != ASSET_PACK_MAGIC || header->version != ASSET_PACK_VERSION || !is_slot_count_valid || !is_alignment_valid) {
+        return false;
+    }
+
+    size_t table_size = AssetPackTableSize(header->entry_count, header->slot_count, header->string_bytes);
+    if (data_size < table_size || header->data_offset < table_size || data_size < header->data_offset || header->string_bytes == 0) {
+        return false;
+    }
+
+    const byte* cursor = data + sizeof(AssetPackHeader);
+    const AssetPackEntry* entries = (const AssetPackEntry*)cursor;
+    cursor += sizeof(AssetPackEntry) * header->entry_count;
+    const u32* slots = (const u32*)cursor;
+    cursor += sizeof(u32) * header->slot_count;
+    const char* strings = (const char*)cursor;
+
+    // Offsets are trusted after this, the lookup does no further bounds checks
+    if (strings[header->string_bytes - 1] != '\0') {
+        return false;
+    }
+    for (u32 i = 0; i < header->entry_count; i++) {
+        const AssetPackEntry* entry = &entries[i];
+        bool is_in_data = header->data_offset <= entry->offset && entry->offset <= data_size && entry->size <= data_size - entry->offset;
+        if (!is_in_data || entry->offset % header->alignment != 0 || header->string_bytes <= entry->name_offset) {
+            return false;
+        }
+    }
+    // A probe stops at an empty slot, a table without one would never end a miss
+    u32 empty_slot_count = 0;
+    for (u32 i = 0; i < header->slot_count; i++) {
+        if (slots[i] == ASSET_PACK_SLOT_EMPTY) {
+            empty_slot_count++;
+        }
+        else if (header->entry_count <= slots[i]) {
+            return false;
+        }
+    }
+    if (empty_slot_count == 0) {
+        return false;
+    }
+
+    pack->data = data;
+    pack->data_size = data_size;
+    pack->header = header;
+    pack->entries = entries;
+    pack->slots = slots;
+    pack->strings = strings;
+    return true;
+}
+
+/**
+ * @brief Map a pack file read-only. Returns false if the file can not be mapped or is not a valid pack.
+ */
+bool AssetPackOpenFile(AssetPack* pack, const char* path) {
+    *pack = {};
+    const byte* data = nullptr;
+    size_t data_size = 0;
+
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+
+    LARGE_INTEGER file_size = {};
+    if (GetFileSizeEx(file, &file_size) && 0 < file_size.QuadPart) {
+        // The view keeps the mapping alive, both handles can be closed right away
+        HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (mapping) {
+            data = (const byte*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+            data_size = (size_t)file_size.QuadPart;
+            CloseHandle(mapping);
+        }
+    }
+    CloseHandle(file);
+#else
+    int file = open(path, O_RDONLY);
+    if (file < 0) {
+        return false;
+    }
+
+    struct stat file_stat = {};
+    if (fstat(file, &file_stat) == 0 && 0 < file_stat.st_size) {
+        // The mapping holds its own reference to the file
+        void* mapping = mmap(nullptr, (size_t)file_stat.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+        if (mapping != MAP_FAILED) {
+            data = (const byte*)mapping;
+            data_size = (size_t)file_stat.st_size;
+        }
+    }
+    close(file);
+#endif
+
+    if (!data) {
+        return false;
+    }
+
+    if (!AssetPackOpenMemory(pack, data, data_size)) {
+#ifdef _WIN32
+        UnmapViewOfFile(data);
+#else
+        munmap((void*)data, data_size);
+#endif
+        return false;
+    }
+
+    pack->is_mapped = true;
+    return true;
+}
+
+void AssetPackClose(AssetPack* pack) {
+    if (pack->is_mapped) {
+#ifdef _WIN32
+        UnmapViewOfFile(pack->data);
+#else
+        munmap((void*)pack->data, pack->data_size);
+#endif
+    }
+    *pack = {};
+}
+
+const char* AssetPackEntryName(AssetPack* pack, const AssetPackEntry* entry) {
+    return pack->strings + entry->name_offset;
+}
+
+/**
+ * @brief Find entry by path. Returns nullptr if the pack has no such file.
+ */
+const AssetPackEntry* AssetPackFind(AssetPack* pack, const char* path) {
+    if (!pack->header) {
+        return nullptr;
+    }
+
+    u64 hash = AssetPackHashPath(path);
+    u32 mask = pack->header->slot_count - 1;
+    u32 slot = (u32)hash & mask;
+
+    for (u32 probe = 0; probe < pack->header->slot_count && pack->slots[slot] != ASSET_PACK_SLOT_EMPTY; probe++) {
+        const AssetPackEntry* entry = &pack->entries[pack->slots[slot]];
+        if (entry->path_hash == hash && AssetPackPathEquals(pack->strings + entry->name_offset, path)) {
+            return entry;
+        }
+        slot = (slot + 1) & mask;
+    }
+    return nullptr;
+}
+
+/**
+ * @brief Contents of a packed file, pointing into the pack. Returns nullptr if the pack has no such file.
+ */
+const byte* AssetPackView(AssetPack* pack, const char* path, size_t* size) {
+    const AssetPackEntry* entry = AssetPackFind(pack, path);
+    if (!entry) {
+        return nullptr;
+    }
+
+    *size = (size_t)entry->size;
+    return pack->data + entry->offset;
+}
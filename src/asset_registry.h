@@ -0,0 +1,266 @@
+#pragma once
+
+// ----------
+// Includes
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "types.h"
+#include "asset_pack.h"
+#include "asset_loader.h"
+
+// Loaded assets by path. Acquiring a path that is already registered returns the same entry with one more
+// reference instead of loading the file again, paths are matched like the VFS matches them. Entries are
+// referenced with generational ids: releasing the last reference moves the generation on, so ids kept
+// around after that resolve to nothing instead of to whatever reuses the entry.
+//
+// The registry does not know what a resource is. The owner stores a pointer per entry, typically into a
+// pool indexed by 'id.index', and destroys it when AssetRegistryRelease reports the last reference gone.
+// Used from one thread only.
+
+// ---------
+// Defines
+
+const u32 ASSET_REGISTRY_SLOT_EMPTY = 0xFFFFFFFFu;
+
+// ---------
+// Structs
+
+/**
+ * @brief Reference to a registered asset. Generation 0 is never handed out, a zeroed id is always invalid.
+ */
+struct AssetId {
+    u32 index;
+    u32 generation;
+};
+
+struct AssetRegistryStats {
+    i32 acquires;
+    i32 dedup_hits;
+    i32 live_count;
+};
+
+/**
+ * @brief Entries are stored as parallel arrays, resolving an id reads 'generations' and 'resources' only.
+ */
+struct AssetRegistry {
+    u32* generations = nullptr;
+    void** resources = nullptr;
+    i32* ref_counts = nullptr;
+    AssetKind* kinds = nullptr;
+    u64* path_hashes = nullptr;
+    char (*paths)[ASSET_PATH_MAX] = nullptr;
+    u32 capacity = 0;
+
+    u32* free_entries = nullptr;
+    u32 free_count = 0;
+
+    // Open addressing table of entry indices by path hash
+    u32* slots = nullptr;
+    u32 slot_mask = 0;
+
+    AssetRegistryStats stats = {};
+};
+
+// --------------------------
+// Function implementations
+
+bool AssetRegistryCreate(AssetRegistry* registry, u32 capacity) {
+    u32 slot_count = 1;
+    while (slot_count < capacity * 2) {
+        slot_count *= 2;
+    }
+
+    registry->capacity = capacity;
+    registry->generations = (u32*)malloc(sizeof(u32) * capacity);
+    registry->resources = (void**)calloc(capacity, sizeof(void*));
+    registry->ref_counts = (i32*)calloc(capacity, sizeof(i32));
+    registry->kinds = (AssetKind*)calloc(capacity, sizeof(AssetKind));
+    registry->path_hashes = (u64*)calloc(capacity, sizeof(u64));
+    registry->paths = (char (*)[ASSET_PATH_MAX])calloc(capacity, ASSET_PATH_MAX);
+    registry->free_entries = (u32*)malloc(sizeof(u32) * capacity);
+    registry->slots = (u32*)malloc(sizeof(u32) * slot_count);
+    registry->slot_mask = slot_count - 1;
+    registry->stats = {};
+
+    bool is_ok = registry->generations && registry->resources && registry->ref_counts && registry->kinds
+        && registry->path_hashes && registry->paths && registry->free_entries && registry->slots;
+    if (!is_ok) {
+        return false;
+    }
+
+    // Hand out low indices first
+    for (u32 i = 0; i < capacity; i++) {
+        registry->generations[i] = 1;
+        registry->free_entries[i] = capacity - 1 - i;
+    }
+    registry->free_count = capacity;
+
+    for (u32 i = 0; i < slot_count; i++) {
+        registry->slots[i] = ASSET_REGISTRY_SLOT_EMPTY;
+    }
+    return true;
+}
+
+void AssetRegistryDestroy(AssetRegistry* registry) {
+    free(registry->generations);
+    free(registry->resources);
+    free(registry->ref_counts);
+    free(registry->kinds);
+    free(registry->path_hashes);
+    free(registry->paths);
+    free(registry->free_entries);
+    free(registry->slots);
+    *registry = {};
+}
+
+/**
+ * @brief Table slot holding the entry of 'path', or the empty slot where it would go.
+ */
+u32 AssetRegistryFindSlot(AssetRegistry* registry, AssetKind kind, const char* path, u64 hash) {
+    u32 slot = (u32)hash & registry->slot_mask;
+    for (;;) {
+        u32 index = registry->slots[slot];
+        if (index == ASSET_REGISTRY_SLOT_EMPTY) {
+            return slot;
+        }
+        if (registry->path_hashes[index] == hash && registry->kinds[index] == kind && AssetPackPathEquals(registry->paths[index], path)) {
+            return slot;
+        }
+        slot = (slot + 1) & registry->slot_mask;
+    }
+}
+
+AssetId AssetRegistryIdOf(AssetRegistry* registry, u32 index) {
+    AssetId id = {};
+    id.index = index;
+    id.generation = registry->generations[index];
+    return id;
+}
+
+/**
+ * @brief Reference to the asset at 'path', registering it if needed. '*is_new' tells the caller to load it and call AssetRegistrySetResource.
+ *
+ * Returns a zeroed id when the registry is full or 'path' does not fit in ASSET_PATH_MAX.
+ */
+AssetId AssetRegistryAcquire(AssetRegistry* registry, AssetKind kind, const char* path, bool* is_new) {
+    registry->stats.acquires++;
+    *is_new = false;
+
+    // A truncated path would be stored under the hash of the full one and never match it again
+    i32 path_length = 0;
+    while (path[path_length] != 0) {
+        path_length++;
+    }
+    if (ASSET_PATH_MAX <= path_length) {
+        return {};
+    }
+
+    u64 hash = AssetPackHashPath(path);
+    u32 slot = AssetRegistryFindSlot(registry, kind, path, hash);
+    u32 index = registry->slots[slot];
+    if (index != ASSET_REGISTRY_SLOT_EMPTY) {
+        registry->stats.dedup_hits++;
+        registry->ref_counts[index]++;
+        return AssetRegistryIdOf(registry, index);
+    }
+
+    if (registry->free_count == 0) {
+        return {};
+    }
+
+    index = registry->free_entries[--registry->free_count];
+    registry->slots[slot] = index;
+    registry->resources[index] = nullptr;
+    registry->ref_counts[index] = 1;
+    registry->kinds[index] = kind;
+    registry->path_hashes[index] = hash;
+
+    // Interned in normalized form, which is what lookups compare against
+    for (i32 i = 0; i <= path_length; i++) {
+        registry->paths[index][i] = AssetPackNormalizeChar(path[i]);
+    }
+
+    registry->stats.live_count++;
+    *is_new = true;
+    return AssetRegistryIdOf(registry, index);
+}
+
+bool AssetRegistryIsValid(AssetRegistry* registry, AssetId id) {
+    return id.index < registry->capacity && registry->generations[id.index] == id.generation;
+}
+
+/**
+ * @brief Resource of 'id', nullptr for stale ids and assets that are not loaded yet.
+ */
+void* AssetRegistryResolve(AssetRegistry* registry, AssetId id) {
+    if (registry->capacity <= id.index || registry->generations[id.index] != id.generation) {
+        return nullptr;
+    }
+    return registry->resources[id.index];
+}
+
+void AssetRegistrySetResource(AssetRegistry* registry, AssetId id, void* resource) {
+    if (AssetRegistryIsValid(registry, id)) {
+        registry->resources[id.index] = resource;
+    }
+}
+
+/**
+ * @brief Registered asset of 'path' without taking a reference. Returns a zeroed id if there is none.
+ */
+AssetId AssetRegistryFind(AssetRegistry* registry, AssetKind kind, const char* path) {
+    u32 index = registry->slots[AssetRegistryFindSlot(registry, kind, path, AssetPackHashPath(path))];
+    return index == ASSET_REGISTRY_SLOT_EMPTY ? AssetId{} : AssetRegistryIdOf(registry, index);
+}
+
+/**
+ * @brief Normalized path of 'id', empty for stale ids.
+ */
+const char* AssetRegistryPath(AssetRegistry* registry, AssetId id) {
+    return AssetRegistryIsValid(registry, id) ? registry->paths[id.index] : "";
+}
+
+void AssetRegistryAddRef(AssetRegistry* registry, AssetId id) {
+    if (AssetRegistryIsValid(registry, id)) {
+        registry->ref_counts[id.index]++;
+    }
+}
+
+/**
+ * @brief Drop a reference. Returns the resource when this was the last one, the caller destroys it, and the id goes stale.
+ */
+void* AssetRegistryRelease(AssetRegistry* registry, AssetId id) {
+    if (!AssetRegistryIsValid(registry, id) || 0 < --registry->ref_counts[id.index]) {
+        return nullptr;
+    }
+
+    u32 index = id.index;
+    void* resource = registry->resources[index];
+    registry->resources[index] = nullptr;
+    registry->generations[index] = registry->generations[index] + 1 == 0 ? 1 : registry->generations[index] + 1;
+    registry->free_entries[registry->free_count++] = index;
+    registry->stats.live_count--;
+
+    // Backward shift deletion, entries probed past the hole move into it so lookups never need tombstones
+    u32 hole = AssetRegistryFindSlot(registry, registry->kinds[index], registry->paths[index], registry->path_hashes[index]);
+    u32 slot = hole;
+    for (;;) {
+        slot = (slot + 1) & registry->slot_mask;
+        u32 moved = registry->slots[slot];
+        if (moved == ASSET_REGISTRY_SLOT_EMPTY) {
+            break;
+        }
+
+        // Move it unless its home slot lies cyclically in (hole, slot]
+        u32 home = (u32)registry->path_hashes[moved] & registry->slot_mask;
+        bool is_home_after_hole = ((slot - home) & registry->slot_mask) < ((slot - hole) & registry->slot_mask);
+        if (!is_home_after_hole) {
+            registry->slots[hole] = moved;
+            hole = slot;
+        }
+    }
+    registry->slots[hole] = ASSET_REGISTRY_SLOT_EMPTY;
+    return resource;
+}
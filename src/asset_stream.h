@@ -0,0 +1,462 @@
+#pragma once
+
+// ----------
+// Includes
+
+#include <stdio.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include "types.h"
+#include "asset_loader.h"
+
+// Asynchronous asset loading while the game runs. The frame thread requests a file and gets a handle back at
+// once, the handle stays pending until the asset has been read, decoded and uploaded:
+//
+//   frame thread  AssetStreamRequest  -> request queue    -> I/O thread      reads the file through the backend
+//                                        decode queue     -> decode workers  AssetDecodeJob
+//   frame thread  AssetStreamPoll     <- completion queue <-                 upload sink, handle becomes ready
+//
+// The queues are bounded lock-free rings of slot indices, so requesting, cancelling and polling never take a
+// lock or wait for the other threads. Slots and their free list belong to the frame thread. A job is owned by
+// whichever thread popped its index last, the queues publish it to the next stage.
+
+// ---------
+// Defines
+
+const i32 ASSET_STREAM_MAX_WORKERS = 8;
+
+enum AssetStreamState : u32 {
+    ASSET_STREAM_NONE = 0,
+    ASSET_STREAM_PENDING = 1,
+    ASSET_STREAM_READY = 2,
+    ASSET_STREAM_FAILED = 3,
+};
+
+// ---------
+// Structs
+
+/**
+ * @brief Reference to one request. Generation 0 is never handed out, a zeroed handle is always invalid.
+ */
+struct AssetHandle {
+    u32 index;
+    u32 generation;
+};
+
+/**
+ * @brief Reads the file of a job on the I/O thread, like AssetReadJob. Returns false with 'job->error' set on failure.
+ */
+struct AssetStreamBackend {
+    void* user_data;
+    bool (*read)(void* user_data, AssetLoadJob* job);
+};
+
+struct AssetStreamQueueCell {
+    std::atomic<u32> sequence;
+    u32 value;
+};
+
+/**
+ * @brief Bounded multi producer multi consumer ring of u32s. 'signal' counts pushes for consumers that sleep when it is empty.
+ */
+struct AssetStreamQueue {
+    AssetStreamQueueCell* cells = nullptr;
+    u32 mask = 0;
+    alignas(64) std::atomic<u32> head = 0;
+    alignas(64) std::atomic<u32> tail = 0;
+    alignas(64) std::atomic<u32> signal = 0;
+};
+
+struct AssetStreamSlot {
+    AssetLoadJob job;
+    u32 generation;
+    AssetStreamState state;
+    std::atomic<bool> is_cancelled;
+};
+
+struct AssetStreamStats {
+    i32 requested_count;
+    i32 ready_count;
+    i32 failed_count;
+    i32 cancelled_count;
+    i32 pending_count;
+    f64 read_ms;
+    f64 decode_ms;
+    f64 upload_ms;
+};
+
+struct AssetStream {
+    AssetStreamBackend backend = {};
+    AssetStreamSlot* slots = nullptr;
+    u32 slot_count = 0;
+    u32* free_slots = nullptr;
+    u32 free_count = 0;
+
+    AssetStreamQueue request_queue;
+    AssetStreamQueue decode_queue;
+    AssetStreamQueue completion_queue;
+
+    std::atomic<bool> is_stopping = false;
+    std::thread io_thread;
+    std::thread workers[ASSET_STREAM_MAX_WORKERS];
+    i32 worker_count = 0;
+
+    AssetStreamStats stats = {};
+};
+
+// --------------------------
+// Function implementations
+
+bool AssetStreamQueueCreate(AssetStreamQueue* queue, u32 min_capacity) {
+    u32 capacity = 1;
+    while (capacity < min_capacity) {
+        capacity *= 2;
+    }
+
+    queue->cells = (AssetStreamQueueCell*)calloc(capacity, sizeof(AssetStreamQueueCell));
+    if (!queue->cells) {
+        return false;
+    }
+
+    // A cell whose sequence equals the tail position is free to push to, one past a position is ready to pop
+    for (u32 i = 0; i < capacity; i++) {
+        queue->cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    queue->mask = capacity - 1;
+    queue->head.store(0, std::memory_order_relaxed);
+    queue->tail.store(0, std::memory_order_relaxed);
+    queue->signal.store(0, std::memory_order_relaxed);
+    return true;
+}
+
+void AssetStreamQueueDestroy(AssetStreamQueue* queue) {
+    free(queue->cells);
+    queue->cells = nullptr;
+    queue->mask = 0;
+}
+
+/**
+ * @brief Returns false when the queue is full.
+ */
+bool AssetStreamQueuePush(AssetStreamQueue* queue, u32 value) {
+    u32 position = queue->tail.load(std::memory_order_relaxed);
+    AssetStreamQueueCell* cell;
+    for (;;) {
+        cell = &queue->cells[position & queue->mask];
+        u32 sequence = cell->sequence.load(std::memory_order_acquire);
+        i32 difference = (i32)(sequence - position);
+        if (difference == 0) {
+            if (queue->tail.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                break;
+            }
+        }
+        else if (difference < 0) {
+            return false;
+        }
+        else {
+            position = queue->tail.load(std::memory_order_relaxed);
+        }
+    }
+
+    cell->value = value;
+    cell->sequence.store(position + 1, std::memory_order_release);
+    return true;
+}
+
+/**
+ * @brief Returns false when the queue is empty.
+ */
+bool AssetStreamQueuePop(AssetStreamQueue* queue, u32* value) {
+    u32 position = queue->head.load(std::memory_order_relaxed);
+    AssetStreamQueueCell* cell;
+    for (;;) {
+        cell = &queue->cells[position & queue->mask];
+        u32 sequence = cell->sequence.load(std::memory_order_acquire);
+        i32 difference = (i32)(sequence - (position + 1));
+        if (difference == 0) {
+            if (queue->head.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                break;
+            }
+        }
+        else if (difference < 0) {
+            return false;
+        }
+        else {
+            position = queue->head.load(std::memory_order_relaxed);
+        }
+    }
+
+    *value = cell->value;
+    cell->sequence.store(position + queue->mask + 1, std::memory_order_release);
+    return true;
+}
+
+/**
+ * @brief Push and wake a consumer sleeping in AssetStreamQueueWaitPop. Waking is a futex call, not a wait.
+ */
+void AssetStreamQueuePushAndSignal(AssetStreamQueue* queue, u32 value) {
+    // Every queue holds at least as many cells as there are slots, a push can not fail
+    AssetStreamQueuePush(queue, value);
+    queue->signal.fetch_add(1, std::memory_order_release);
+    queue->signal.notify_one();
+}
+
+/**
+ * @brief Pop, sleeping while the queue is empty. Returns false once 'is_stopping' is set.
+ */
+bool AssetStreamQueueWaitPop(AssetStreamQueue* queue, std::atomic<bool>* is_stopping, u32* value) {
+    for (;;) {
+        // Read the signal before trying, a push after a failed pop changes it and the wait returns at once
+        u32 signal = queue->signal.load(std::memory_order_acquire);
+        if (is_stopping->load(std::memory_order_acquire)) {
+            return false;
+        }
+        if (AssetStreamQueuePop(queue, value)) {
+            return true;
+        }
+        queue->signal.wait(signal, std::memory_order_acquire);
+    }
+}
+
+bool AssetStreamReadVfs(void* user_data, AssetLoadJob* job) {
+    return AssetReadJob((Vfs*)user_data, job);
+}
+
+/**
+ * @brief Backend reading through 'vfs' with AssetReadJob. A null 'vfs' reads native paths with stdio.
+ */
+AssetStreamBackend AssetStreamVfsBackend(Vfs* vfs) {
+    AssetStreamBackend backend = {};
+    backend.user_data = vfs;
+    backend.read = AssetStreamReadVfs;
+    return backend;
+}
+
+/**
+ * @brief Reads files one at a time in request order, so a slow disk sees sequential reads and never stalls a decode worker.
+ */
+void AssetStreamIoThread(AssetStream* stream) {
+    u32 index;
+    while (AssetStreamQueueWaitPop(&stream->request_queue, &stream->is_stopping, &index)) {
+        AssetStreamSlot* slot = &stream->slots[index];
+        if (slot->is_cancelled.load(std::memory_order_relaxed)) {
+            AssetStreamQueuePush(&stream->completion_queue, index);
+            continue;
+        }
+
+        if (stream->backend.read(stream->backend.user_data, &slot->job)) {
+            AssetStreamQueuePushAndSignal(&stream->decode_queue, index);
+        }
+        else {
+            slot->job.is_ok = false;
+            AssetStreamQueuePush(&stream->completion_queue, index);
+        }
+    }
+}
+
+void AssetStreamWorker(AssetStream* stream) {
+    u32 index;
+    while (AssetStreamQueueWaitPop(&stream->decode_queue, &stream->is_stopping, &index)) {
+        AssetStreamSlot* slot = &stream->slots[index];
+        if (!slot->is_cancelled.load(std::memory_order_relaxed)) {
+            AssetDecodeJob(&slot->job);
+        }
+        AssetStreamQueuePush(&stream->completion_queue, index);
+    }
+}
+
+/**
+ * @brief Create with room for 'capacity' requests in flight and start the I/O thread and 'worker_count' decode workers.
+ */
+bool AssetStreamCreate(AssetStream* stream, i32 capacity, i32 worker_count, AssetStreamBackend backend) {
+    worker_count = worker_count < 1 ? 1 : worker_count;
+    worker_count = ASSET_STREAM_MAX_WORKERS < worker_count ? ASSET_STREAM_MAX_WORKERS : worker_count;
+
+    stream->backend = backend;
+    stream->slot_count = (u32)capacity;
+    stream->slots = (AssetStreamSlot*)calloc(capacity, sizeof(AssetStreamSlot));
+    stream->free_slots = (u32*)malloc(sizeof(u32) * capacity);
+    bool is_ok = stream->slots && stream->free_slots
+        && AssetStreamQueueCreate(&stream->request_queue, (u32)capacity)
+        && AssetStreamQueueCreate(&stream->decode_queue, (u32)capacity)
+        && AssetStreamQueueCreate(&stream->completion_queue, (u32)capacity);
+    if (!is_ok) {
+        return false;
+    }
+
+    // Hand out low indices first
+    for (u32 i = 0; i < stream->slot_count; i++) {
+        stream->slots[i].generation = 1;
+        stream->free_slots[i] = stream->slot_count - 1 - i;
+    }
+    stream->free_count = stream->slot_count;
+    stream->stats = {};
+
+    // The sRGB tables are filled lazily on first use, fill them before the workers race to do it
+    MipmapInitTables();
+
+    stream->is_stopping = false;
+    stream->worker_count = worker_count;
+    stream->io_thread = std::thread(AssetStreamIoThread, stream);
+    for (i32 i = 0; i < worker_count; i++) {
+        stream->workers[i] = std::thread(AssetStreamWorker, stream);
+    }
+    return true;
+}
+
+/**
+ * @brief Stop and join the threads. Requests still in flight are dropped without reaching the sink.
+ */
+void AssetStreamDestroy(AssetStream* stream) {
+    stream->is_stopping.store(true, std::memory_order_release);
+    AssetStreamQueue* queues[] = { &stream->request_queue, &stream->decode_queue };
+    for (AssetStreamQueue* queue : queues) {
+        queue->signal.fetch_add(1, std::memory_order_release);
+        queue->signal.notify_all();
+    }
+
+    if (stream->io_thread.joinable()) {
+        stream->io_thread.join();
+    }
+    for (i32 i = 0; i < stream->worker_count; i++) {
+        stream->workers[i].join();
+    }
+
+    for (u32 i = 0; stream->slots && i < stream->slot_count; i++) {
+        AssetFreeJobData(&stream->slots[i].job);
+    }
+    free(stream->slots);
+    free(stream->free_slots);
+    AssetStreamQueueDestroy(&stream->request_queue);
+    AssetStreamQueueDestroy(&stream->decode_queue);
+    AssetStreamQueueDestroy(&stream->completion_queue);
+    stream->slots = nullptr;
+    stream->free_slots = nullptr;
+    stream->slot_count = 0;
+    stream->free_count = 0;
+    stream->worker_count = 0;
+}
+
+AssetStreamSlot* AssetStreamGetSlot(AssetStream* stream, AssetHandle handle) {
+    if (stream->slot_count <= handle.index || stream->slots[handle.index].generation != handle.generation) {
+        return nullptr;
+    }
+    return &stream->slots[handle.index];
+}
+
+void AssetStreamFreeSlot(AssetStream* stream, u32 index) {
+    AssetStreamSlot* slot = &stream->slots[index];
+    AssetFreeJobData(&slot->job);
+    slot->state = ASSET_STREAM_NONE;
+    slot->generation = slot->generation + 1 == 0 ? 1 : slot->generation + 1;
+    stream->free_slots[stream->free_count++] = index;
+}
+
+/**
+ * @brief Queue a file. 'target' is handed to the upload sink untouched. Returns a zeroed handle when every slot is in use.
+ */
+AssetHandle AssetStreamRequest(AssetStream* stream, AssetKind kind, const char* path, void* target, f32 font_pixel_height = 0.0f) {
+    if (stream->free_count == 0) {
+        return {};
+    }
+
+    u32 index = stream->free_slots[--stream->free_count];
+    AssetStreamSlot* slot = &stream->slots[index];
+    slot->job = {};
+    slot->job.kind = kind;
+    slot->job.target = target;
+    slot->job.font_pixel_height = font_pixel_height;
+    snprintf(slot->job.path, ASSET_PATH_MAX, "%s", path);
+    slot->state = ASSET_STREAM_PENDING;
+    slot->is_cancelled.store(false, std::memory_order_relaxed);
+
+    stream->stats.requested_count++;
+    stream->stats.pending_count++;
+    AssetStreamQueuePushAndSignal(&stream->request_queue, index);
+
+    AssetHandle handle = {};
+    handle.index = index;
+    handle.generation = slot->generation;
+    return handle;
+}
+
+/**
+ * @brief ASSET_STREAM_NONE for cancelled, released and invalid handles.
+ */
+AssetStreamState AssetStreamGetState(AssetStream* stream, AssetHandle handle) {
+    AssetStreamSlot* slot = AssetStreamGetSlot(stream, handle);
+    return slot ? slot->state : ASSET_STREAM_NONE;
+}
+
+/**
+ * @brief Why a failed request failed. Empty for other handles.
+ */
+const char* AssetStreamGetError(AssetStream* stream, AssetHandle handle) {
+    AssetStreamSlot* slot = AssetStreamGetSlot(stream, handle);
+    return slot && slot->state == ASSET_STREAM_FAILED ? slot->job.error : "";
+}
+
+/**
+ * @brief Cancel a pending request or release a finished one. The handle is invalid afterwards.
+ *
+ * A pending job is skipped by the next stage that sees it and never reaches the sink. Its slot is reused once the job drains.
+ */
+void AssetStreamCancel(AssetStream* stream, AssetHandle handle) {
+    AssetStreamSlot* slot = AssetStreamGetSlot(stream, handle);
+    if (!slot) {
+        return;
+    }
+
+    if (slot->state == ASSET_STREAM_PENDING) {
+        slot->is_cancelled.store(true, std::memory_order_relaxed);
+        slot->generation = slot->generation + 1 == 0 ? 1 : slot->generation + 1;
+        slot->state = ASSET_STREAM_NONE;
+    }
+    else {
+        AssetStreamFreeSlot(stream, handle.index);
+    }
+}
+
+/**
+ * @brief Drain finished jobs, once per frame. Hands at most 'max_uploads' of them to 'sink', 0 for no limit.
+ *
+ * Jobs that failed or were cancelled do not count against the limit and never reach the sink.
+ */
+void AssetStreamPoll(AssetStream* stream, AssetUploadSink* sink, i32 max_uploads) {
+    i32 upload_count = 0;
+    u32 index;
+    while ((max_uploads <= 0 || upload_count < max_uploads) && AssetStreamQueuePop(&stream->completion_queue, &index)) {
+        AssetStreamSlot* slot = &stream->slots[index];
+        AssetLoadJob* job = &slot->job;
+        stream->stats.pending_count--;
+
+        // Cancel already moved the generation on, the slot only has to go back to the free list
+        if (slot->is_cancelled.load(std::memory_order_relaxed)) {
+            stream->stats.cancelled_count++;
+            AssetFreeJobData(job);
+            slot->state = ASSET_STREAM_NONE;
+            stream->free_slots[stream->free_count++] = index;
+            continue;
+        }
+
+        stream->stats.read_ms += job->read_ms;
+        stream->stats.decode_ms += job->decode_ms;
+        if (!job->is_ok) {
+            stream->stats.failed_count++;
+            AssetFreeJobData(job);
+            slot->state = ASSET_STREAM_FAILED;
+            continue;
+        }
+
+        auto upload_start = std::chrono::steady_clock::now();
+        sink->upload(sink->user_data, job);
+        stream->stats.upload_ms += std::chrono::duration<f64, std::milli>(std::chrono::steady_clock::now() - upload_start).count();
+        AssetFreeJobData(job);
+
+        stream->stats.ready_count++;
+        slot->state = ASSET_STREAM_READY;
+        upload_count++;
+    }
+}
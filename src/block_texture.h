@@ -0,0 +1,127 @@
+#pragma once
+
+// ----------
+// Includes
+
+#include "types.h"
+#include "mipmap.h"
+
+// Block compressed texture container written by tools/texture_compressor.cpp. Little-endian:
+//
+//   BlockTextureHeader
+//   byte levels[]   mip levels from largest to smallest, each a row-major grid of 4x4 blocks
+//
+// The level data is in the exact layout D3D11 expects for BC1, BC3 and BC7, so the loader hands it to
+// CreateTexture2D as is. Level 0 width and height are multiples of 4, smaller levels round up to whole blocks.
+
+// ---------
+// Defines
+
+const u32 BLOCK_TEXTURE_MAGIC = 0x54434246; // "FBCT"
+const u32 BLOCK_TEXTURE_VERSION = 1;
+
+enum BlockTextureFormat : u32 {
+    BLOCK_TEXTURE_FORMAT_BC1 = 1,
+    BLOCK_TEXTURE_FORMAT_BC3 = 3,
+    BLOCK_TEXTURE_FORMAT_BC7 = 7,
+};
+
+// ---------
+// Structs
+
+struct BlockTextureHeader {
+    u32 magic;
+    u32 version;
+    u32 format;
+    u32 width;
+    u32 height;
+    u32 level_count;
+    u32 data_bytes;
+    u32 reserved;
+};
+
+static_assert(sizeof(BlockTextureHeader) == 32, "BlockTextureHeader is not 32 bytes");
+
+/**
+ * @brief Loaded container. Level pointers point into 'data', which the texture owns.
+ */
+struct BlockTexture {
+    byte* data = nullptr;
+    size_t data_size = 0;
+    BlockTextureHeader* header = nullptr;
+    byte* levels[MIPMAP_MAX_LEVELS] = {};
+    u32 level_sizes[MIPMAP_MAX_LEVELS] = {};
+    u32 level_row_pitches[MIPMAP_MAX_LEVELS] = {};
+};
+
+// --------------------------
+// Function implementations
+
+/**
+ * @brief Bytes per 4x4 block, 0 for an unknown format.
+ */
+u32 BlockTextureBlockBytes(u32 format) {
+    switch (format) {
+        case BLOCK_TEXTURE_FORMAT_BC1: return 8;
+        case BLOCK_TEXTURE_FORMAT_BC3: return 16;
+        case BLOCK_TEXTURE_FORMAT_BC7: return 16;
+        default: return 0;
+    }
+}
+
+u32 BlockTextureRowPitch(u32 format, u32 width) {
+    return ((width + 3) / 4) * BlockTextureBlockBytes(format);
+}
+
+u32 BlockTextureLevelSize(u32 format, u32 width, u32 height) {
+    return BlockTextureRowPitch(format, width) * ((height + 3) / 4);
+}
+
+/**
+ * @brief Take ownership of container bytes allocated with malloc. Returns false and frees nothing if the data is not a valid container.
+ */
+bool BlockTextureLoadFromMemory(BlockTexture* texture, byte* data, size_t data_size) {
+    *texture = {};
+    if (data_size < sizeof(BlockTextureHeader)) {
+        return false;
+    }
+
+    BlockTextureHeader* header = (BlockTextureHeader*)data;
+    if (header->magic != BLOCK_TEXTURE_MAGIC || header->version != BLOCK_TEXTURE_VERSION || BlockTextureBlockBytes(header->format) == 0) {
+        return false;
+    }
+
+    bool is_size_valid = header->width != 0 && header->height != 0 && header->width % 4 == 0 && header->height % 4 == 0 && header->width <= 16384 && header->height <= 16384;
+    if (!is_size_valid || header->level_count == 0 || (u32)MipLevelCount(header->width, header->height) < header->level_count) {
+        return false;
+    }
+
+    byte* cursor = data + sizeof(BlockTextureHeader);
+    size_t total_bytes = 0;
+    u32 width = header->width;
+    u32 height = header->height;
+
+    for (u32 level = 0; level < header->level_count; level++) {
+        texture->levels[level] = cursor + total_bytes;
+        texture->level_sizes[level] = BlockTextureLevelSize(header->format, width, height);
+        texture->level_row_pitches[level] = BlockTextureRowPitch(header->format, width);
+        total_bytes += texture->level_sizes[level];
+        width = 1 < width ? width / 2 : 1;
+        height = 1 < height ? height / 2 : 1;
+    }
+
+    if (header->data_bytes != total_bytes || data_size < sizeof(BlockTextureHeader) + total_bytes) {
+        *texture = {};
+        return false;
+    }
+
+    texture->data = data;
+    texture->data_size = data_size;
+    texture->header = header;
+    return true;
+}
+
+void BlockTextureDestroy(BlockTexture* texture) {
+    free(texture->data);
+    *texture = {};
+}
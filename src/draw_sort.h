@@ -0,0 +1,178 @@
+#pragma once
+
+// ----------
+// Includes
+
+#include "types.h"
+#include "sprite_instance.h"
+
+// ---------
+// Defines
+
+const i32 DRAW_SORT_RADIX_BITS = 8;
+const i32 DRAW_SORT_RADIX_BUCKETS = 1 << DRAW_SORT_RADIX_BITS;
+const i32 DRAW_SORT_RADIX_PASSES = 64 / DRAW_SORT_RADIX_BITS;
+
+enum DrawLayer : u32 {
+    DRAW_LAYER_GROUND = 0,
+    DRAW_LAYER_GROUND_OVERLAY = 1,
+    DRAW_LAYER_SPRITES = 2,
+    DRAW_LAYER_WORLD_OVERLAY = 3,
+};
+
+// ---------
+// Structs
+
+/**
+ * @brief Queued sprite, packed at queue time so drawing only copies the instance.
+ */
+struct QueuedQuad {
+    SpriteInstance instance;
+    u32 texture_id;
+};
+
+/**
+ * @brief Per frame list of quads drawn back to front after sorting by packed 64-bit keys.
+ *
+ * Key layout from most to least significant bits:
+ * layer (8) | inverted isometric depth (32) | texture id (16) | unused (8)
+ */
+struct QuadDrawQueue {
+    i32 count = 0;
+    i32 capacity = 0;
+    QueuedQuad* quads = nullptr;
+    u64* keys = nullptr;
+    u32* indices = nullptr;
+    u64* temp_keys = nullptr;
+    u32* temp_indices = nullptr;
+};
+
+// --------------------------
+// Function implementations
+
+/**
+ * @brief Map float to unsigned integer with the same ordering.
+ */
+u32 FloatToSortableU32(f32 value) {
+    u32 bits;
+    memcpy(&bits, &value, sizeof(bits));
+    u32 mask = (bits & 0x80000000u) ? 0xFFFFFFFFu : 0x80000000u;
+    return bits ^ mask;
+}
+
+/**
+ * @brief Pack draw sort key. Quads with larger isometric depth (screen y) sort first within a layer.
+ */
+u64 PackDrawSortKey(u32 layer, f32 isometric_depth, u32 texture_id) {
+    u64 depth_bits = (u64)(~FloatToSortableU32(isometric_depth));
+    u64 key = ((u64)(layer & 0xFF) << 56) | (depth_bits << 24) | ((u64)(texture_id & 0xFFFF) << 8);
+    return key;
+}
+
+u32 DrawSortKeyTextureId(u64 key) {
+    return (u32)((key >> 8) & 0xFFFF);
+}
+
+/**
+ * @brief Stable LSD radix sort of 'keys' carrying 'values' along.
+ *
+ * Byte histograms for all passes are built in one sweep, and passes where every
+ * key has the same byte are skipped. Result ends up in 'keys' and 'values'.
+ */
+void RadixSortKeys(u64* keys, u32* values, u64* temp_keys, u32* temp_values, i32 count) {
+    u32 histograms[DRAW_SORT_RADIX_PASSES][DRAW_SORT_RADIX_BUCKETS] = {};
+
+    for (i32 i = 0; i < count; i++) {
+        u64 key = keys[i];
+        for (i32 pass = 0; pass < DRAW_SORT_RADIX_PASSES; pass++) {
+            histograms[pass][(key >> (pass * DRAW_SORT_RADIX_BITS)) & (DRAW_SORT_RADIX_BUCKETS - 1)]++;
+        }
+    }
+
+    u64* src_keys = keys;
+    u32* src_values = values;
+    u64* dst_keys = temp_keys;
+    u32* dst_values = temp_values;
+
+    for (i32 pass = 0; pass < DRAW_SORT_RADIX_PASSES; pass++) {
+        u32* histogram = histograms[pass];
+        i32 shift = pass * DRAW_SORT_RADIX_BITS;
+
+        if (count == 0 || histogram[(src_keys[0] >> shift) & (DRAW_SORT_RADIX_BUCKETS - 1)] == (u32)count) {
+            continue;
+        }
+
+        u32 offset = 0;
+        for (i32 bucket = 0; bucket < DRAW_SORT_RADIX_BUCKETS; bucket++) {
+            u32 bucket_count = histogram[bucket];
+            histogram[bucket] = offset;
+            offset += bucket_count;
+        }
+
+        for (i32 i = 0; i < count; i++) {
+            u64 key = src_keys[i];
+            u32 destination = histogram[(key >> shift) & (DRAW_SORT_RADIX_BUCKETS - 1)]++;
+            dst_keys[destination] = key;
+            dst_values[destination] = src_values[i];
+        }
+
+        u64* swap_keys = src_keys;
+        src_keys = dst_keys;
+        dst_keys = swap_keys;
+        u32* swap_values = src_values;
+        src_values = dst_values;
+        dst_values = swap_values;
+    }
+
+    if (src_keys != keys) {
+        memcpy(keys, src_keys, sizeof(u64) * count);
+        memcpy(values, src_values, sizeof(u32) * count);
+    }
+}
+
+bool QuadDrawQueueCreate(QuadDrawQueue* queue, i32 capacity) {
+    queue->quads = (QueuedQuad*)malloc(sizeof(QueuedQuad) * capacity);
+    queue->keys = (u64*)malloc(sizeof(u64) * capacity);
+    queue->indices = (u32*)malloc(sizeof(u32) * capacity);
+    queue->temp_keys = (u64*)malloc(sizeof(u64) * capacity);
+    queue->temp_indices = (u32*)malloc(sizeof(u32) * capacity);
+    queue->count = 0;
+    queue->capacity = capacity;
+
+    return queue->quads && queue->keys && queue->indices && queue->temp_keys && queue->temp_indices;
+}
+
+void QuadDrawQueueDestroy(QuadDrawQueue* queue) {
+    free(queue->quads);
+    free(queue->keys);
+    free(queue->indices);
+    free(queue->temp_keys);
+    free(queue->temp_indices);
+    *queue = {};
+}
+
+/**
+ * @brief Add quad to the queue. Depth is the isometric screen y of the quad's ground contact point.
+ */
+bool QuadDrawQueuePush(QuadDrawQueue* queue, u32 layer, f32 isometric_depth, QueuedQuad quad) {
+    if (queue->capacity <= queue->count) {
+        return false;
+    }
+
+    i32 index = queue->count++;
+    queue->quads[index] = quad;
+    queue->keys[index] = PackDrawSortKey(layer, isometric_depth, quad.texture_id);
+    queue->indices[index] = (u32)index;
+    return true;
+}
+
+/**
+ * @brief Sort queued quads. Afterwards quads[indices[i]] is the i:th quad to draw.
+ */
+void QuadDrawQueueSort(QuadDrawQueue* queue) {
+    RadixSortKeys(queue->keys, queue->indices, queue->temp_keys, queue->temp_indices, queue->count);
+}
+
+void QuadDrawQueueClear(QuadDrawQueue* queue) {
+    queue->count = 0;
+}
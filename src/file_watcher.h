@@ -0,0 +1,415 @@
+#pragma once
+
+// ----------
+// Includes
+
+#include <stdio.h>
+#include <string.h>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <dirent.h>
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+#include "types.h"
+#include "asset_pack.h"
+#include "asset_loader.h"
+
+// Reports files that changed under a directory tree, for reloading assets while the game runs. A watcher
+// thread blocks on the OS (ReadDirectoryChangesW on Windows, inotify elsewhere) and records changed paths
+// relative to the watched directory. The frame thread polls them without waiting on anything but a short lock.
+//
+// Saving a file usually arrives as several events: truncate, a few writes, sometimes a rename over the old
+// file. A path is only reported once it has been quiet for the settle time, as one change, so the file is
+// read after the editor is done with it.
+
+// ---------
+// Defines
+
+const i32 FILE_WATCHER_MAX_PENDING = 256;
+const i32 FILE_WATCHER_MAX_DIRECTORIES = 128;
+const i32 FILE_WATCHER_EVENT_BUFFER_BYTES = 64 * 1024;
+
+// ---------
+// Structs
+
+/**
+ * @brief Changed file. 'is_structural' is set when it was created, removed or renamed rather than only written.
+ *
+ * An empty 'path' means events were lost and anything may have changed.
+ */
+struct FileWatcherChange {
+    char path[ASSET_PATH_MAX];
+    bool is_structural;
+    f64 first_event_ms;
+    f64 last_event_ms;
+};
+
+struct FileWatcherStats {
+    i64 event_count;
+    i32 change_count;
+    i32 dropped_count;
+    f64 last_latency_ms;
+    f64 max_latency_ms;
+};
+
+struct FileWatcherDirectory {
+    i32 watch;
+    char path[ASSET_PATH_MAX];
+};
+
+struct FileWatcher {
+    char directory[ASSET_PATH_MAX] = {};
+    f64 settle_ms = 0.0;
+    std::chrono::steady_clock::time_point start_time;
+
+    std::mutex pending_mutex;
+    FileWatcherChange* pending = nullptr;
+    i32 pending_count = 0;
+
+    std::atomic<bool> is_stopping = false;
+    std::thread thread;
+
+#ifdef _WIN32
+    HANDLE directory_handle = INVALID_HANDLE_VALUE;
+    HANDLE stop_event = nullptr;
+#else
+    int inotify_fd = -1;
+    int wake_pipe[2] = { -1, -1 };
+    FileWatcherDirectory* directories = nullptr;
+    i32 directory_count = 0;
+#endif
+
+    FileWatcherStats stats = {};
+};
+
+// --------------------------
+// Function implementations
+
+f64 FileWatcherNowMs(FileWatcher* watcher) {
+    return std::chrono::duration<f64, std::milli>(std::chrono::steady_clock::now() - watcher->start_time).count();
+}
+
+/**
+ * @brief Record an event for 'path', relative to the watched directory. Called on the watcher thread.
+ */
+void FileWatcherRecord(FileWatcher* watcher, const char* path, bool is_structural) {
+    f64 now_ms = FileWatcherNowMs(watcher);
+    std::lock_guard<std::mutex> lock(watcher->pending_mutex);
+    watcher->stats.event_count++;
+
+    // Later events of a path already waiting to settle push its report back
+    for (i32 i = 0; i < watcher->pending_count; i++) {
+        FileWatcherChange* change = &watcher->pending[i];
+        if (AssetPackPathEquals(change->path, path)) {
+            change->is_structural = change->is_structural || is_structural;
+            change->last_event_ms = now_ms;
+            return;
+        }
+    }
+
+    if (FILE_WATCHER_MAX_PENDING <= watcher->pending_count) {
+        watcher->stats.dropped_count++;
+        return;
+    }
+
+    FileWatcherChange* change = &watcher->pending[watcher->pending_count++];
+    snprintf(change->path, ASSET_PATH_MAX, "%s", path);
+    change->is_structural = is_structural;
+    change->first_event_ms = now_ms;
+    change->last_event_ms = now_ms;
+}
+
+#ifdef _WIN32
+
+void FileWatcherThread(FileWatcher* watcher) {
+    // DWORD aligned, as ReadDirectoryChangesW requires
+    DWORD* buffer = (DWORD*)malloc(FILE_WATCHER_EVENT_BUFFER_BYTES);
+    OVERLAPPED overlapped = {};
+    overlapped.hEvent = CreateEventA(nullptr, TRUE, FALSE, nullptr);
+    HANDLE wait_handles[] = { overlapped.hEvent, watcher->stop_event };
+    DWORD filter = FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_DIR_NAME | FILE_NOTIFY_CHANGE_SIZE | FILE_NOTIFY_CHANGE_LAST_WRITE;
+
+    while (buffer && overlapped.hEvent && !watcher->is_stopping.load(std::memory_order_acquire)) {
+        ResetEvent(overlapped.hEvent);
+        if (!ReadDirectoryChangesW(watcher->directory_handle, buffer, FILE_WATCHER_EVENT_BUFFER_BYTES, TRUE, filter, nullptr, &overlapped, nullptr)) {
+            break;
+        }
+
+        if (WaitForMultipleObjects(2, wait_handles, FALSE, INFINITE) != WAIT_OBJECT_0) {
+            CancelIoEx(watcher->directory_handle, &overlapped);
+            DWORD ignored = 0;
+            GetOverlappedResult(watcher->directory_handle, &overlapped, &ignored, TRUE);
+            break;
+        }
+
+        DWORD bytes = 0;
+        if (!GetOverlappedResult(watcher->directory_handle, &overlapped, &bytes, FALSE)) {
+            break;
+        }
+
+        // Zero bytes means the buffer overflowed and the events are gone
+        if (bytes == 0) {
+            FileWatcherRecord(watcher, "", true);
+            continue;
+        }
+
+        byte* event = (byte*)buffer;
+        for (;;) {
+            FILE_NOTIFY_INFORMATION* info = (FILE_NOTIFY_INFORMATION*)event;
+            char path[ASSET_PATH_MAX];
+            i32 length = WideCharToMultiByte(CP_UTF8, 0, info->FileName, (int)(info->FileNameLength / sizeof(WCHAR)), path, ASSET_PATH_MAX - 1, nullptr, nullptr);
+            path[0 < length ? length : 0] = '\0';
+
+            if (0 < length) {
+                FileWatcherRecord(watcher, path, info->Action != FILE_ACTION_MODIFIED);
+            }
+
+            if (info->NextEntryOffset == 0) {
+                break;
+            }
+            event += info->NextEntryOffset;
+        }
+    }
+
+    if (overlapped.hEvent) {
+        CloseHandle(overlapped.hEvent);
+    }
+    free(buffer);
+}
+
+#else
+
+/**
+ * @brief Watch 'relative_path' and every directory below it. inotify watches are not recursive.
+ */
+void FileWatcherAddDirectory(FileWatcher* watcher, const char* relative_path) {
+    if (FILE_WATCHER_MAX_DIRECTORIES <= watcher->directory_count) {
+        return;
+    }
+
+    // Paths that do not fit are not watched, a truncated one would name a different directory
+    char native_path[ASSET_PATH_MAX];
+    i32 length = snprintf(native_path, ASSET_PATH_MAX, "%s%s%s", watcher->directory, relative_path[0] ? "/" : "", relative_path);
+    if (length < 0 || ASSET_PATH_MAX <= length) {
+        return;
+    }
+
+    u32 mask = IN_CLOSE_WRITE | IN_MODIFY | IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO;
+    int watch = inotify_add_watch(watcher->inotify_fd, native_path, mask);
+    if (watch < 0) {
+        return;
+    }
+
+    FileWatcherDirectory* directory = &watcher->directories[watcher->directory_count++];
+    directory->watch = watch;
+    snprintf(directory->path, ASSET_PATH_MAX, "%s", relative_path);
+
+    DIR* dir = opendir(native_path);
+    if (!dir) {
+        return;
+    }
+    while (dirent* entry = readdir(dir)) {
+        if (entry->d_type != DT_DIR || strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0) {
+            continue;
+        }
+
+        char child_path[ASSET_PATH_MAX];
+        i32 child_length = snprintf(child_path, ASSET_PATH_MAX, "%s%s%s", relative_path, relative_path[0] ? "/" : "", entry->d_name);
+        if (0 <= child_length && child_length < ASSET_PATH_MAX) {
+            FileWatcherAddDirectory(watcher, child_path);
+        }
+    }
+    closedir(dir);
+}
+
+const char* FileWatcherDirectoryPath(FileWatcher* watcher, int watch) {
+    for (i32 i = 0; i < watcher->directory_count; i++) {
+        if (watcher->directories[i].watch == watch) {
+            return watcher->directories[i].path;
+        }
+    }
+    return nullptr;
+}
+
+void FileWatcherThread(FileWatcher* watcher) {
+    // malloc alignment suits the inotify_event structs read out of it
+    char* buffer = (char*)malloc(FILE_WATCHER_EVENT_BUFFER_BYTES);
+    pollfd fds[] = {
+        { watcher->inotify_fd, POLLIN, 0 },
+        { watcher->wake_pipe[0], POLLIN, 0 },
+    };
+
+    while (buffer && !watcher->is_stopping.load(std::memory_order_acquire)) {
+        if (poll(fds, 2, -1) < 0 || (fds[1].revents & POLLIN)) {
+            break;
+        }
+
+        ssize_t bytes = read(watcher->inotify_fd, buffer, FILE_WATCHER_EVENT_BUFFER_BYTES);
+        if (bytes <= 0) {
+            continue;
+        }
+
+        for (char* event = buffer; event < buffer + bytes;) {
+            inotify_event* info = (inotify_event*)event;
+            event += sizeof(inotify_event) + info->len;
+
+            if (info->mask & IN_Q_OVERFLOW) {
+                FileWatcherRecord(watcher, "", true);
+                continue;
+            }
+
+            const char* directory = FileWatcherDirectoryPath(watcher, info->wd);
+            if (!directory || info->len == 0) {
+                continue;
+            }
+
+            // A truncated path would reload a different file
+            char path[ASSET_PATH_MAX];
+            i32 length = snprintf(path, ASSET_PATH_MAX, "%s%s%s", directory, directory[0] ? "/" : "", info->name);
+            if (length < 0 || ASSET_PATH_MAX <= length) {
+                continue;
+            }
+
+            if (info->mask & IN_ISDIR) {
+                // A new directory is watched from now on, files written into it before that are missed
+                if (info->mask & (IN_CREATE | IN_MOVED_TO)) {
+                    FileWatcherAddDirectory(watcher, path);
+                }
+                continue;
+            }
+
+            bool is_structural = (info->mask & (IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO)) != 0;
+            FileWatcherRecord(watcher, path, is_structural);
+        }
+    }
+    free(buffer);
+}
+
+#endif
+
+/**
+ * @brief Start watching the tree under 'directory'. Changes are reported once no event arrived for 'settle_ms'.
+ */
+bool FileWatcherCreate(FileWatcher* watcher, const char* directory, f64 settle_ms) {
+    snprintf(watcher->directory, ASSET_PATH_MAX, "%s", directory);
+    watcher->settle_ms = settle_ms;
+    watcher->start_time = std::chrono::steady_clock::now();
+    watcher->pending = (FileWatcherChange*)calloc(FILE_WATCHER_MAX_PENDING, sizeof(FileWatcherChange));
+    watcher->pending_count = 0;
+    watcher->stats = {};
+    watcher->is_stopping = false;
+    if (!watcher->pending) {
+        return false;
+    }
+
+#ifdef _WIN32
+    watcher->directory_handle = CreateFileA(
+        directory, FILE_LIST_DIRECTORY, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+        nullptr, OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED, nullptr);
+    watcher->stop_event = CreateEventA(nullptr, TRUE, FALSE, nullptr);
+    if (watcher->directory_handle == INVALID_HANDLE_VALUE || !watcher->stop_event) {
+        return false;
+    }
+#else
+    watcher->inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    watcher->directories = (FileWatcherDirectory*)calloc(FILE_WATCHER_MAX_DIRECTORIES, sizeof(FileWatcherDirectory));
+    if (watcher->inotify_fd < 0 || !watcher->directories || pipe(watcher->wake_pipe) != 0) {
+        return false;
+    }
+
+    watcher->directory_count = 0;
+    FileWatcherAddDirectory(watcher, "");
+    if (watcher->directory_count == 0) {
+        return false;
+    }
+#endif
+
+    watcher->thread = std::thread(FileWatcherThread, watcher);
+    return true;
+}
+
+void FileWatcherDestroy(FileWatcher* watcher) {
+    watcher->is_stopping.store(true, std::memory_order_release);
+
+#ifdef _WIN32
+    if (watcher->stop_event) {
+        SetEvent(watcher->stop_event);
+    }
+#else
+    if (0 <= watcher->wake_pipe[1]) {
+        char wake = 0;
+        ssize_t ignored = write(watcher->wake_pipe[1], &wake, 1);
+        (void)ignored;
+    }
+#endif
+
+    if (watcher->thread.joinable()) {
+        watcher->thread.join();
+    }
+
+#ifdef _WIN32
+    if (watcher->directory_handle != INVALID_HANDLE_VALUE) {
+        CloseHandle(watcher->directory_handle);
+    }
+    if (watcher->stop_event) {
+        CloseHandle(watcher->stop_event);
+    }
+    watcher->directory_handle = INVALID_HANDLE_VALUE;
+    watcher->stop_event = nullptr;
+#else
+    if (0 <= watcher->inotify_fd) {
+        close(watcher->inotify_fd);
+    }
+    for (int fd : watcher->wake_pipe) {
+        if (0 <= fd) {
+            close(fd);
+        }
+    }
+    free(watcher->directories);
+    watcher->inotify_fd = -1;
+    watcher->wake_pipe[0] = -1;
+    watcher->wake_pipe[1] = -1;
+    watcher->directories = nullptr;
+    watcher->directory_count = 0;
+#endif
+
+    free(watcher->pending);
+    watcher->pending = nullptr;
+    watcher->pending_count = 0;
+}
+
+/**
+ * @brief Take up to 'max_changes' changes that have settled, oldest first. Call from one thread, typically once per frame.
+ */
+i32 FileWatcherPoll(FileWatcher* watcher, FileWatcherChange* changes, i32 max_changes) {
+    f64 now_ms = FileWatcherNowMs(watcher);
+    i32 change_count = 0;
+
+    std::lock_guard<std::mutex> lock(watcher->pending_mutex);
+    i32 kept_count = 0;
+    for (i32 i = 0; i < watcher->pending_count; i++) {
+        FileWatcherChange* change = &watcher->pending[i];
+        bool is_settled = watcher->settle_ms <= now_ms - change->last_event_ms;
+        if (!is_settled || max_changes <= change_count) {
+            watcher->pending[kept_count++] = *change;
+            continue;
+        }
+
+        changes[change_count++] = *change;
+        f64 latency_ms = now_ms - change->first_event_ms;
+        watcher->stats.change_count++;
+        watcher->stats.last_latency_ms = latency_ms;
+        watcher->stats.max_latency_ms = watcher->stats.max_latency_ms < latency_ms ? latency_ms : watcher->stats.max_latency_ms;
+    }
+    watcher->pending_count = kept_count;
+    return change_count;
+}
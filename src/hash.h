@@ -0,0 +1,43 @@
+#pragma once
+
+// ----------
+// Includes
+
+#include "types.h"
+
+// 64-bit FNV-1a, the hash of pack paths, atlas sprite names, text runs and shader cache keys. Pack and atlas
+// files store these hashes, so changing the function means rebuilding them.
+
+// ---------
+// Defines
+
+const u64 HASH_FNV1A_SEED = 0xcbf29ce484222325ULL;
+const u64 HASH_FNV1A_PRIME = 0x100000001b3ULL;
+
+// --------------------------
+// Function implementations
+
+u64 HashFnv1aByte(u64 hash, byte value) {
+    return (hash ^ value) * HASH_FNV1A_PRIME;
+}
+
+/**
+ * @brief FNV-1a hash of 'size' bytes, continuing from 'hash'.
+ */
+u64 HashFnv1a(const void* data, size_t size, u64 hash = HASH_FNV1A_SEED) {
+    const byte* bytes = (const byte*)data;
+    for (size_t i = 0; i < size; i++) {
+        hash = HashFnv1aByte(hash, bytes[i]);
+    }
+    return hash;
+}
+
+/**
+ * @brief FNV-1a hash of a zero terminated string, without the terminator.
+ */
+u64 HashFnv1aString(const char* text, u64 hash = HASH_FNV1A_SEED) {
+    for (const byte* p = (const byte*)text; *p != 0; p++) {
+        hash = HashFnv1aByte(hash, *p);
+    }
+    return hash;
+}
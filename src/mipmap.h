@@ -0,0 +1,357 @@
+#pragma once
+
+// ----------
+// Includes
+
+#include <math.h>
+
+#include "types.h"
+
+#if defined(_M_X64) || defined(__x86_64__)
+#define MIPMAP_X86_SIMD 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define MIPMAP_TARGET_AVX2
+#else
+#include <cpuid.h>
+#define MIPMAP_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+// Mip chain generation for RGBA8 textures holding sRGB encoded color.
+//
+// Level 0 is converted once to linear light float RGBA with premultiplied alpha. Every smaller level is a 2x2
+// box filter of the previous one in that space, so dark fringes from gamma space averaging and color bleeding
+// from fully transparent texels both go away. Each level is then unpremultiplied and encoded back to sRGB RGBA8.
+//
+// The SSE2 and AVX2 kernels do the same float operations in the same order as the scalar reference, so every
+// path produces identical bytes.
+
+// ---------
+// Defines
+
+const i32 MIPMAP_MAX_LEVELS = 16;
+const i32 MIPMAP_SRGB_ENCODE_TABLE_SIZE = 4096;
+
+enum MipmapKernel : u32 {
+    MIPMAP_KERNEL_AUTO = 0,
+    MIPMAP_KERNEL_SCALAR = 1,
+    MIPMAP_KERNEL_SSE2 = 2,
+    MIPMAP_KERNEL_AVX2 = 3,
+};
+
+// ---------
+// Structs
+
+/**
+ * @brief All levels of a texture as RGBA8, stored one after another in 'pixels'.
+ */
+struct MipChain {
+    byte* pixels = nullptr;
+    size_t byte_size = 0;
+    i32 level_count = 0;
+    i32 widths[MIPMAP_MAX_LEVELS] = {};
+    i32 heights[MIPMAP_MAX_LEVELS] = {};
+    size_t offsets[MIPMAP_MAX_LEVELS] = {};
+};
+
+struct MipmapTables {
+    bool is_initialized;
+    f32 srgb_to_linear[256];
+    byte linear_to_srgb[MIPMAP_SRGB_ENCODE_TABLE_SIZE];
+};
+
+MipmapTables mipmap_tables = {};
+
+// --------------------------
+// Function implementations
+
+/**
+ * @brief Fill the sRGB conversion tables. Not thread safe, MipChainBuild calls it on every use.
+ */
+void MipmapInitTables() {
+    if (mipmap_tables.is_initialized) {
+        return;
+    }
+
+    for (i32 i = 0; i < 256; i++) {
+        f32 c = (f32)i / 255.0f;
+        mipmap_tables.srgb_to_linear[i] = c <= 0.04045f ? c / 12.92f : powf((c + 0.055f) / 1.055f, 2.4f);
+    }
+
+    for (i32 i = 0; i < MIPMAP_SRGB_ENCODE_TABLE_SIZE; i++) {
+        f32 l = (f32)i / (f32)(MIPMAP_SRGB_ENCODE_TABLE_SIZE - 1);
+        f32 c = l <= 0.0031308f ? l * 12.92f : 1.055f * powf(l, 1.0f / 2.4f) - 0.055f;
+        mipmap_tables.linear_to_srgb[i] = (byte)(i32)(c * 255.0f + 0.5f);
+    }
+
+    mipmap_tables.is_initialized = true;
+}
+
+i32 MipLevelCount(i32 width, i32 height) {
+    i32 levels = 1;
+    while ((1 < width || 1 < height) && levels < MIPMAP_MAX_LEVELS) {
+        width = 1 < width ? width / 2 : 1;
+        height = 1 < height ? height / 2 : 1;
+        levels++;
+    }
+    return levels;
+}
+
+/**
+ * @brief RGBA8 sRGB to linear premultiplied float RGBA.
+ */
+void MipToLinear(byte* rgba, i32 pixel_count, f32* out) {
+    f32* table = mipmap_tables.srgb_to_linear;
+    for (i32 i = 0; i < pixel_count; i++) {
+        byte* p = &rgba[i * 4];
+        f32 a = (f32)p[3] * (1.0f / 255.0f);
+        out[i * 4 + 0] = table[p[0]] * a;
+        out[i * 4 + 1] = table[p[1]] * a;
+        out[i * 4 + 2] = table[p[2]] * a;
+        out[i * 4 + 3] = a;
+    }
+}
+
+/**
+ * @brief Linear premultiplied float RGBA back to RGBA8 sRGB.
+ */
+void MipToRGBA8(f32* linear, i32 pixel_count, byte* out) {
+    byte* table = mipmap_tables.linear_to_srgb;
+    const f32 scale = (f32)(MIPMAP_SRGB_ENCODE_TABLE_SIZE - 1);
+
+    for (i32 i = 0; i < pixel_count; i++) {
+        f32* p = &linear[i * 4];
+        f32 a = p[3];
+        f32 inverse_alpha = 0.0f < a ? 1.0f / a : 0.0f;
+
+        for (i32 c = 0; c < 3; c++) {
+            f32 value = p[c] * inverse_alpha;
+            value = value < 0.0f ? 0.0f : value;
+            value = 1.0f < value ? 1.0f : value;
+            out[i * 4 + c] = table[(i32)(value * scale + 0.5f)];
+        }
+
+        a = a < 0.0f ? 0.0f : a;
+        a = 1.0f < a ? 1.0f : a;
+        out[i * 4 + 3] = (byte)(i32)(a * 255.0f + 0.5f);
+    }
+}
+
+/**
+ * @brief 2x2 box filter of one float RGBA level. Odd last rows and columns are dropped, a size of 1 repeats itself.
+ */
+void MipDownsampleScalar(f32* src, i32 src_width, i32 src_height, f32* dst, i32 dst_width, i32 dst_height) {
+    for (i32 y = 0; y < dst_height; y++) {
+        f32* row0 = src + (size_t)(y * 2) * src_width * 4;
+        f32* row1 = src_height == 1 ? row0 : row0 + (size_t)src_width * 4;
+        f32* out = dst + (size_t)y * dst_width * 4;
+
+        for (i32 x = 0; x < dst_width; x++) {
+            i32 x0 = x * 2;
+            i32 x1 = src_width == 1 ? x0 : x0 + 1;
+            for (i32 c = 0; c < 4; c++) {
+                out[x * 4 + c] = ((row0[x0 * 4 + c] + row1[x0 * 4 + c]) + (row0[x1 * 4 + c] + row1[x1 * 4 + c])) * 0.25f;
+            }
+        }
+    }
+}
+
+#ifdef MIPMAP_X86_SIMD
+
+/**
+ * @brief SSE2 box filter, one destination pixel per 128-bit vector.
+ */
+void MipDownsampleSSE2(f32* src, i32 src_width, i32 src_height, f32* dst, i32 dst_width, i32 dst_height) {
+    if (src_width == 1) {
+        MipDownsampleScalar(src, src_width, src_height, dst, dst_width, dst_height);
+        return;
+    }
+
+    __m128 quarter = _mm_set1_ps(0.25f);
+    for (i32 y = 0; y < dst_height; y++) {
+        f32* row0 = src + (size_t)(y * 2) * src_width * 4;
+        f32* row1 = src_height == 1 ? row0 : row0 + (size_t)src_width * 4;
+        f32* out = dst + (size_t)y * dst_width * 4;
+
+        for (i32 x = 0; x < dst_width; x++) {
+            __m128 left = _mm_add_ps(_mm_loadu_ps(row0 + x * 8), _mm_loadu_ps(row1 + x * 8));
+            __m128 right = _mm_add_ps(_mm_loadu_ps(row0 + x * 8 + 4), _mm_loadu_ps(row1 + x * 8 + 4));
+            _mm_storeu_ps(out + x * 4, _mm_mul_ps(_mm_add_ps(left, right), quarter));
+        }
+    }
+}
+
+/**
+ * @brief AVX2 box filter, two destination pixels per 256-bit vector.
+ */
+MIPMAP_TARGET_AVX2 void MipDownsampleAVX2(f32* src, i32 src_width, i32 src_height, f32* dst, i32 dst_width, i32 dst_height) {
+    if (src_width == 1) {
+        MipDownsampleScalar(src, src_width, src_height, dst, dst_width, dst_height);
+        return;
+    }
+
+    __m256 quarter = _mm256_set1_ps(0.25f);
+    for (i32 y = 0; y < dst_height; y++) {
+        f32* row0 = src + (size_t)(y * 2) * src_width * 4;
+        f32* row1 = src_height == 1 ? row0 : row0 + (size_t)src_width * 4;
+        f32* out = dst + (size_t)y * dst_width * 4;
+
+        i32 x = 0;
+        for (; x + 2 <= dst_width; x += 2) {
+            // Column sums of source pixels 0-1 and 2-3, then pair them up across the 128-bit lanes
+            __m256 a = _mm256_add_ps(_mm256_loadu_ps(row0 + x * 8), _mm256_loadu_ps(row1 + x * 8));
+            __m256 b = _mm256_add_ps(_mm256_loadu_ps(row0 + x * 8 + 8), _mm256_loadu_ps(row1 + x * 8 + 8));
+            __m256 left = _mm256_permute2f128_ps(a, b, 0x20);
+            __m256 right = _mm256_permute2f128_ps(a, b, 0x31);
+            _mm256_storeu_ps(out + x * 4, _mm256_mul_ps(_mm256_add_ps(left, right), quarter));
+        }
+
+        for (; x < dst_width; x++) {
+            __m128 left = _mm_add_ps(_mm_loadu_ps(row0 + x * 8), _mm_loadu_ps(row1 + x * 8));
+            __m128 right = _mm_add_ps(_mm_loadu_ps(row0 + x * 8 + 4), _mm_loadu_ps(row1 + x * 8 + 4));
+            _mm_storeu_ps(out + x * 4, _mm_mul_ps(_mm_add_ps(left, right), _mm_set1_ps(0.25f)));
+        }
+    }
+}
+
+/**
+ * @brief SSE2 version of MipToRGBA8. The table lookups stay scalar, the unpremultiply and index math is vectorized.
+ */
+void MipToRGBA8SSE2(f32* linear, i32 pixel_count, byte* out) {
+    byte* table = mipmap_tables.linear_to_srgb;
+    __m128 zero = _mm_setzero_ps();
+    __m128 one = _mm_set1_ps(1.0f);
+    __m128 half = _mm_set1_ps(0.5f);
+    __m128 scale = _mm_setr_ps((f32)(MIPMAP_SRGB_ENCODE_TABLE_SIZE - 1), (f32)(MIPMAP_SRGB_ENCODE_TABLE_SIZE - 1), (f32)(MIPMAP_SRGB_ENCODE_TABLE_SIZE - 1), 255.0f);
+    __m128 color_mask = _mm_castsi128_ps(_mm_setr_epi32(-1, -1, -1, 0));
+    alignas(16) i32 indices[4];
+
+    for (i32 i = 0; i < pixel_count; i++) {
+        __m128 p = _mm_loadu_ps(linear + i * 4);
+        __m128 a = _mm_shuffle_ps(p, p, _MM_SHUFFLE(3, 3, 3, 3));
+        __m128 inverse_alpha = _mm_and_ps(_mm_div_ps(one, a), _mm_cmplt_ps(zero, a));
+
+        // Unpremultiply the color lanes, alpha is multiplied by one
+        __m128 multiplier = _mm_or_ps(_mm_and_ps(color_mask, inverse_alpha), _mm_andnot_ps(color_mask, one));
+        __m128 value = _mm_mul_ps(p, multiplier);
+
+        value = _mm_max_ps(value, zero);
+        value = _mm_min_ps(value, one);
+        _mm_store_si128((__m128i*)indices, _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(value, scale), half)));
+
+        out[i * 4 + 0] = table[indices[0]];
+        out[i * 4 + 1] = table[indices[1]];
+        out[i * 4 + 2] = table[indices[2]];
+        out[i * 4 + 3] = (byte)indices[3];
+    }
+}
+
+bool MipmapCpuHasAVX2() {
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 1);
+    bool has_osxsave = (info[2] & (1 << 27)) != 0;
+    bool has_avx = (info[2] & (1 << 28)) != 0;
+    if (!has_osxsave || !has_avx || (_xgetbv(0) & 0x6) != 0x6) {
+        return false;
+    }
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+
+#endif
+
+MipmapKernel MipmapResolveKernel(MipmapKernel kernel) {
+#ifdef MIPMAP_X86_SIMD
+    if (kernel == MIPMAP_KERNEL_AUTO) {
+        return MipmapCpuHasAVX2() ? MIPMAP_KERNEL_AVX2 : MIPMAP_KERNEL_SSE2;
+    }
+    if (kernel == MIPMAP_KERNEL_AVX2 && !MipmapCpuHasAVX2()) {
+        return MIPMAP_KERNEL_SSE2;
+    }
+    return kernel;
+#else
+    return MIPMAP_KERNEL_SCALAR;
+#endif
+}
+
+void MipChainDestroy(MipChain* chain) {
+    free(chain->pixels);
+    *chain = {};
+}
+
+/**
+ * @brief Build the full mip chain of an RGBA8 image, level 0 included. Returns false when out of memory.
+ */
+bool MipChainBuild(MipChain* chain, byte* rgba, i32 width, i32 height, MipmapKernel kernel = MIPMAP_KERNEL_AUTO) {
+    MipmapInitTables();
+    kernel = MipmapResolveKernel(kernel);
+    *chain = {};
+
+    chain->level_count = MipLevelCount(width, height);
+    size_t total_bytes = 0;
+    for (i32 level = 0; level < chain->level_count; level++) {
+        chain->widths[level] = width;
+        chain->heights[level] = height;
+        chain->offsets[level] = total_bytes;
+        total_bytes += (size_t)width * height * 4;
+        width = 1 < width ? width / 2 : 1;
+        height = 1 < height ? height / 2 : 1;
+    }
+
+    // Float levels ping-pong between two buffers, the second one only ever holds level 1 or smaller
+    size_t level0_pixels = (size_t)chain->widths[0] * chain->heights[0];
+    size_t level1_pixels = (size_t)chain->widths[1 < chain->level_count ? 1 : 0] * chain->heights[1 < chain->level_count ? 1 : 0];
+    chain->pixels = (byte*)malloc(total_bytes);
+    f32* linear = (f32*)malloc(sizeof(f32) * 4 * level0_pixels);
+    f32* linear_next = (f32*)malloc(sizeof(f32) * 4 * level1_pixels);
+    if (!chain->pixels || !linear || !linear_next) {
+        free(linear);
+        free(linear_next);
+        MipChainDestroy(chain);
+        return false;
+    }
+
+    chain->byte_size = total_bytes;
+    memcpy(chain->pixels, rgba, level0_pixels * 4);
+    MipToLinear(rgba, (i32)level0_pixels, linear);
+
+    for (i32 level = 1; level < chain->level_count; level++) {
+        i32 src_width = chain->widths[level - 1];
+        i32 src_height = chain->heights[level - 1];
+        i32 dst_width = chain->widths[level];
+        i32 dst_height = chain->heights[level];
+        i32 dst_pixels = dst_width * dst_height;
+        byte* out = chain->pixels + chain->offsets[level];
+
+        switch (kernel) {
+#ifdef MIPMAP_X86_SIMD
+            case MIPMAP_KERNEL_AVX2:
+                MipDownsampleAVX2(linear, src_width, src_height, linear_next, dst_width, dst_height);
+                MipToRGBA8SSE2(linear_next, dst_pixels, out);
+                break;
+            case MIPMAP_KERNEL_SSE2:
+                MipDownsampleSSE2(linear, src_width, src_height, linear_next, dst_width, dst_height);
+                MipToRGBA8SSE2(linear_next, dst_pixels, out);
+                break;
+#endif
+            default:
+                MipDownsampleScalar(linear, src_width, src_height, linear_next, dst_width, dst_height);
+                MipToRGBA8(linear_next, dst_pixels, out);
+                break;
+        }
+
+        f32* swap = linear;
+        linear = linear_next;
+        linear_next = swap;
+    }
+
+    free(linear);
+    free(linear_next);
+    return true;
+}
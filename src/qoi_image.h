@@ -0,0 +1,184 @@
+#pragma once
+
+// ----------
+// Includes
+
+#include "types.h"
+
+#if defined(_M_X64) || defined(__x86_64__)
+#define QOI_X86_SIMD 1
+#include <emmintrin.h>
+#endif
+
+// Decoder for the QOI image format (https://qoiformat.org), written by tools/qoi_converter.cpp.
+//
+//   14 byte header: "qoif", width and height as big-endian u32, channels (3 or 4), colorspace
+//   chunks: byte aligned ops coding each pixel as a run, an index into the 64 most recently seen
+//           colors, a small delta from the previous pixel, or a literal
+//   8 byte end marker: seven 0x00 and one 0x01
+//
+// Every op is a few bytes and decodes without any bit level entropy coding, so decoding is several times
+// faster than inflating a PNG while the files stay within a similar size for sprite and tile art.
+
+// ---------
+// Defines
+
+const u32 QOI_MAGIC = 0x716f6966; // "qoif", big-endian
+const i32 QOI_HEADER_SIZE = 14;
+const i32 QOI_END_MARKER_SIZE = 8;
+const u32 QOI_MAX_PIXELS = 400000000;
+
+const byte QOI_OP_INDEX = 0x00;
+const byte QOI_OP_DIFF = 0x40;
+const byte QOI_OP_LUMA = 0x80;
+const byte QOI_OP_RUN = 0xc0;
+const byte QOI_OP_RGB = 0xfe;
+const byte QOI_OP_RGBA = 0xff;
+const byte QOI_MASK_2 = 0xc0;
+
+// ---------
+// Structs
+
+struct QoiImageInfo {
+    u32 width;
+    u32 height;
+    byte channels;
+    byte colorspace;
+};
+
+// --------------------------
+// Function implementations
+
+u32 QoiReadU32(const byte* p) {
+    return ((u32)p[0] << 24) | ((u32)p[1] << 16) | ((u32)p[2] << 8) | (u32)p[3];
+}
+
+/**
+ * @brief Index slot of a pixel packed as R | G << 8 | B << 16 | A << 24.
+ */
+u32 QoiColorHash(u32 pixel) {
+    u32 r = pixel & 0xff;
+    u32 g = (pixel >> 8) & 0xff;
+    u32 b = (pixel >> 16) & 0xff;
+    u32 a = pixel >> 24;
+    return (r * 3 + g * 5 + b * 7 + a * 11) & 63;
+}
+
+bool QoiReadHeader(const byte* data, size_t data_size, QoiImageInfo* info) {
+    if (data_size < (size_t)(QOI_HEADER_SIZE + QOI_END_MARKER_SIZE) || QoiReadU32(data) != QOI_MAGIC) {
+        return false;
+    }
+
+    info->width = QoiReadU32(data + 4);
+    info->height = QoiReadU32(data + 8);
+    info->channels = data[12];
+    info->colorspace = data[13];
+
+    return info->width != 0 && info->height != 0
+        && info->height <= QOI_MAX_PIXELS / info->width
+        && (info->channels == 3 || info->channels == 4)
+        && info->colorspace <= 1;
+}
+
+/**
+ * @brief Fill 'count' pixels with one color. Runs are the only op that writes more than one pixel.
+ */
+void QoiFillRun(u32* out, u32 pixel, i32 count) {
+    i32 i = 0;
+#ifdef QOI_X86_SIMD
+    __m128i pixels = _mm_set1_epi32((i32)pixel);
+    for (; i + 4 <= count; i += 4) {
+        _mm_storeu_si128((__m128i*)(out + i), pixels);
+    }
+#endif
+    for (; i < count; i++) {
+        out[i] = pixel;
+    }
+}
+
+/**
+ * @brief Decode a QOI file to RGBA8, whatever the channel count of the file. Returns a malloc'ed image or nullptr if the data is invalid.
+ */
+byte* QoiDecode(const byte* data, size_t data_size, QoiImageInfo* info) {
+    if (!QoiReadHeader(data, data_size, info)) {
+        return nullptr;
+    }
+
+    size_t pixel_count = (size_t)info->width * info->height;
+    u32* pixels = (u32*)malloc(pixel_count * 4);
+    if (!pixels) {
+        return nullptr;
+    }
+
+    u32 index[64] = {};
+    u32 pixel = 0xff000000;
+    const byte* p = data + QOI_HEADER_SIZE;
+    const byte* chunks_end = data + data_size - QOI_END_MARKER_SIZE;
+    size_t position = 0;
+
+    // Ops never read into the end marker, a stream that runs out before the last pixel fails to decode
+    while (position < pixel_count) {
+        if (chunks_end <= p) {
+            free(pixels);
+            return nullptr;
+        }
+
+        byte op = *p++;
+        if (op == QOI_OP_RGB) {
+            if (chunks_end < p + 3) {
+                break;
+            }
+            pixel = (pixel & 0xff000000) | (u32)p[0] | ((u32)p[1] << 8) | ((u32)p[2] << 16);
+            p += 3;
+        }
+        else if (op == QOI_OP_RGBA) {
+            if (chunks_end < p + 4) {
+                break;
+            }
+            pixel = (u32)p[0] | ((u32)p[1] << 8) | ((u32)p[2] << 16) | ((u32)p[3] << 24);
+            p += 4;
+        }
+        else if ((op & QOI_MASK_2) == QOI_OP_INDEX) {
+            pixels[position++] = pixel = index[op];
+            continue;
+        }
+        else if ((op & QOI_MASK_2) == QOI_OP_DIFF) {
+            u32 r = (pixel + ((op >> 4) & 3) - 2) & 0xff;
+            u32 g = ((pixel >> 8) + ((op >> 2) & 3) - 2) & 0xff;
+            u32 b = ((pixel >> 16) + (op & 3) - 2) & 0xff;
+            pixel = (pixel & 0xff000000) | r | (g << 8) | (b << 16);
+        }
+        else if ((op & QOI_MASK_2) == QOI_OP_LUMA) {
+            if (chunks_end < p + 1) {
+                break;
+            }
+            i32 dg = (op & 0x3f) - 32;
+            i32 dr = dg - 8 + ((*p >> 4) & 0x0f);
+            i32 db = dg - 8 + (*p & 0x0f);
+            p++;
+            u32 r = (pixel + dr) & 0xff;
+            u32 g = ((pixel >> 8) + dg) & 0xff;
+            u32 b = ((pixel >> 16) + db) & 0xff;
+            pixel = (pixel & 0xff000000) | r | (g << 8) | (b << 16);
+        }
+        else {
+            // QOI_OP_RUN, the previous pixel repeats and the index is left as is
+            i32 run = (op & 0x3f) + 1;
+            if (pixel_count - position < (size_t)run) {
+                break;
+            }
+            QoiFillRun(pixels + position, pixel, run);
+            position += run;
+            continue;
+        }
+
+        index[QoiColorHash(pixel)] = pixel;
+        pixels[position++] = pixel;
+    }
+
+    if (position < pixel_count) {
+        free(pixels);
+        return nullptr;
+    }
+    return (byte*)pixels;
+}
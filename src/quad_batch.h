@@ -0,0 +1,152 @@
+#pragma once
+
+// ----------
+// Includes
+
+#include "types.h"
+
+// ---------
+// Defines
+
+// Quads are four vertices in order top-left, top-right, bottom-left, bottom-right,
+// drawn as two clockwise triangles through a shared static index buffer.
+const i32 QUAD_VERTEX_COUNT = 4;
+const i32 QUAD_INDEX_COUNT = 6;
+
+// ---------
+// Structs
+
+// Compact vertex layouts. Positions are 2D floats expanded to (x, y, 0, 1) by the input assembler,
+// colors are R8G8B8A8_UNORM and UVs are R16G16_UNORM, which keeps full texel precision on large atlases.
+
+struct TilemapTileVertex {
+    Vec2f position;
+    u32 color;
+    u16 uv[2];
+};
+
+struct RectangleVertex {
+    Vec2f position;
+    u32 color;
+};
+
+struct TextUiVertex {
+    Vec2f position;
+    u16 uv[2];
+};
+
+static_assert(sizeof(TilemapTileVertex) == 16, "TilemapTileVertex is not 16 bytes");
+static_assert(sizeof(RectangleVertex) == 12, "RectangleVertex is not 12 bytes");
+static_assert(sizeof(TextUiVertex) == 12, "TextUiVertex is not 12 bytes");
+
+// --------------------------
+// Function implementations
+
+/**
+ * @brief Convert pixel position, origin at the top-left corner, to normalized device coordinates.
+ */
+Vec2f ScreenPxToNDC(Vec2i px, Vec2i viewport_size) {
+    f32 ndcX = (2.0f * px.x) / (viewport_size.x - 1) - 1.0f;
+    f32 ndcY = 1.0f - (2.0f * px.y) / (viewport_size.y - 1);
+    Vec2f result = {
+        .x = ndcX,
+        .y = ndcY
+    };
+    return result;
+}
+
+/**
+ * @brief Convert normalized device coordinates to pixels. Unlike ScreenPxToNDC, y grows upwards.
+ */
+Vec2i NDCToScreenPx(Vec2f ndc, Vec2i viewport_size) {
+    int x = (viewport_size.x * (ndc.x + 1.0f)) * 0.5f;
+    int y = (viewport_size.y * (ndc.y + 1.0f)) * 0.5f;
+    Vec2i result = {
+        .x = x,
+        .y = y
+    };
+    return result;
+}
+
+u32 PackUnorm8(f32 value) {
+    value = value < 0.0f ? 0.0f : (1.0f < value ? 1.0f : value);
+    return (u32)(value * 255.0f + 0.5f);
+}
+
+u16 PackUnorm16(f32 value) {
+    value = value < 0.0f ? 0.0f : (1.0f < value ? 1.0f : value);
+    return (u16)(value * 65535.0f + 0.5f);
+}
+
+/**
+ * @brief Pack color into R8G8B8A8_UNORM layout, red in the lowest byte.
+ */
+u32 PackColorRGBA8(Vec4f color) {
+    return PackUnorm8(color.x) | (PackUnorm8(color.y) << 8) | (PackUnorm8(color.z) << 16) | (PackUnorm8(color.w) << 24);
+}
+
+/**
+ * @brief Fill index list for 'quad_count' quads: 0, 1, 2, 2, 1, 3 offset by four per quad.
+ */
+void FillQuadIndices(u32* indices, i32 quad_count) {
+    for (i32 i = 0; i < quad_count; i++) {
+        u32 base = (u32)(i * QUAD_VERTEX_COUNT);
+        u32* quad = &indices[i * QUAD_INDEX_COUNT];
+        quad[0] = base + 0;
+        quad[1] = base + 1;
+        quad[2] = base + 2;
+        quad[3] = base + 2;
+        quad[4] = base + 1;
+        quad[5] = base + 3;
+    }
+}
+
+/**
+ * @brief Write a textured quad centered on 'center'. Returns written vertex count.
+ */
+i32 BuildQuadVertices(TilemapTileVertex* out, Vec2f center, Vec2f size, Vec4f uv_rect, Vec4f color) {
+    f32 x0 = center.x - size.x * 0.5f;
+    f32 x1 = center.x + size.x * 0.5f;
+    f32 y0 = center.y - size.y * 0.5f;
+    f32 y1 = center.y + size.y * 0.5f;
+
+    u32 packed_color = PackColorRGBA8(color);
+    u16 u0 = PackUnorm16(uv_rect.x);
+    u16 v0 = PackUnorm16(uv_rect.y);
+    u16 u1 = PackUnorm16(uv_rect.z);
+    u16 v1 = PackUnorm16(uv_rect.w);
+
+    out[0] = { {x0, y1}, packed_color, {u0, v0} }; // Top-left
+    out[1] = { {x1, y1}, packed_color, {u1, v0} }; // Top-right
+    out[2] = { {x0, y0}, packed_color, {u0, v1} }; // Bottom-left
+    out[3] = { {x1, y0}, packed_color, {u1, v1} }; // Bottom-right
+    return QUAD_VERTEX_COUNT;
+}
+
+/**
+ * @brief Write a solid color quad from four NDC corners. Returns written vertex count.
+ */
+i32 BuildRectangleQuadVertices(RectangleVertex* out, Vec2f top_left, Vec2f top_right, Vec2f bot_left, Vec2f bot_right, Vec4f color) {
+    u32 packed_color = PackColorRGBA8(color);
+    out[0] = { top_left, packed_color };
+    out[1] = { top_right, packed_color };
+    out[2] = { bot_left, packed_color };
+    out[3] = { bot_right, packed_color };
+    return QUAD_VERTEX_COUNT;
+}
+
+/**
+ * @brief Write a text glyph quad from four NDC corners and atlas UV rectangle (u0, v0, u1, v1). Returns written vertex count.
+ */
+i32 BuildTextUiQuadVertices(TextUiVertex* out, Vec2f top_left, Vec2f top_right, Vec2f bot_left, Vec2f bot_right, Vec4f uv_rect) {
+    u16 u0 = PackUnorm16(uv_rect.x);
+    u16 v0 = PackUnorm16(uv_rect.y);
+    u16 u1 = PackUnorm16(uv_rect.z);
+    u16 v1 = PackUnorm16(uv_rect.w);
+
+    out[0] = { top_left, {u0, v0} };
+    out[1] = { top_right, {u1, v0} };
+    out[2] = { bot_left, {u0, v1} };
+    out[3] = { bot_right, {u1, v1} };
+    return QUAD_VERTEX_COUNT;
+}
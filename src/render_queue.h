@@ -0,0 +1,404 @@
+#pragma once
+
+// ----------
+// Includes
+
+#include "types.h"
+#include "quad_batch.h"
+#include "draw_sort.h"
+
+// ---------
+// Defines
+
+const u32 RENDER_TEXTURE_NONE = 0xFFFF;
+const u32 RENDER_STATIC_BUFFER_NONE = 0xFFFFFFFFu;
+const u32 RENDER_ORDER_MAX = 0xFFFFFF;
+
+// ---------
+// Structs
+
+/**
+ * @brief Deferred quad draw. Vertices either live in the queue's frame vertex data or in a static GPU buffer.
+ *
+ * Instanced commands store one 'vertex_stride' sized instance record per quad instead of four vertices.
+ */
+struct RenderCommand {
+    u32 pipeline;
+    u32 texture;
+    u32 vertex_stride;
+    u32 vertex_offset;
+    u32 quad_count;
+    u32 static_buffer;
+    bool is_instanced;
+};
+
+/**
+ * @brief Graphics API side of the render queue. Binds are only called when the state actually changes.
+ */
+struct RenderBackend {
+    void* user_data = nullptr;
+    void (*bind_pipeline)(void* user_data, u32 pipeline) = nullptr;
+    void (*bind_texture)(void* user_data, u32 texture) = nullptr;
+    void (*draw_quads)(void* user_data, void* vertices, u32 vertex_stride, u32 quad_count) = nullptr;
+    void (*draw_static_quads)(void* user_data, u32 static_buffer, u32 vertex_stride, u32 quad_count) = nullptr;
+    void (*draw_instances)(void* user_data, void* instances, u32 instance_stride, u32 instance_count) = nullptr;
+};
+
+struct RenderQueueStats {
+    i32 commands;
+    i32 merged_commands;
+    i32 draws;
+    i32 pipeline_binds;
+    i32 texture_binds;
+    i32 skipped_binds;
+};
+
+/**
+ * @brief Per frame list of draw commands sorted at submit to minimize state changes.
+ *
+ * Key layout from most to least significant bits:
+ * layer (8) | order (24) | pipeline (8) | texture (16) | unused (8)
+ *
+ * Commands with equal keys keep their recording order. 'order' lets a caller keep a sequence of
+ * commands with different textures, such as depth sorted sprite runs, from being regrouped. Orders
+ * above RENDER_ORDER_MAX are refused instead of wrapping around.
+ */
+struct RenderQueue {
+    i32 count = 0;
+    i32 capacity = 0;
+    RenderCommand* commands = nullptr;
+    u64* keys = nullptr;
+    u32* indices = nullptr;
+    u64* temp_keys = nullptr;
+    u32* temp_indices = nullptr;
+
+    byte* vertex_data = nullptr;
+    u32 vertex_bytes = 0;
+    u32 vertex_capacity = 0;
+
+    byte* merge_scratch = nullptr;
+    u32 merge_scratch_capacity = 0;
+
+    u32 max_quads_per_draw = 0;
+    RenderQueueStats stats = {};
+};
+
+/**
+ * @brief Backend that only counts calls, for measuring state changes without a GPU.
+ */
+struct RenderNullBackendCounters {
+    i32 pipeline_binds;
+    i32 texture_binds;
+    i32 draws;
+    i32 static_draws;
+    i32 instanced_draws;
+    i64 quads;
+};
+
+// --------------------------
+// Function implementations
+
+u64 PackRenderSortKey(u32 layer, u32 order, u32 pipeline, u32 texture) {
+    return ((u64)(layer & 0xFF) << 56) | ((u64)(order & RENDER_ORDER_MAX) << 32) | ((u64)(pipeline & 0xFF) << 24) | ((u64)(texture & 0xFFFF) << 8);
+}
+
+u32 RenderCommandQuadBytes(RenderCommand* command) {
+    return command->is_instanced ? command->vertex_stride : command->vertex_stride * QUAD_VERTEX_COUNT;
+}
+
+bool RenderQueueCreate(RenderQueue* queue, i32 capacity, u32 vertex_capacity, u32 max_quads_per_draw) {
+    queue->commands = (RenderCommand*)malloc(sizeof(RenderCommand) * capacity);
+    queue->keys = (u64*)malloc(sizeof(u64) * capacity);
+    queue->indices = (u32*)malloc(sizeof(u32) * capacity);
+    queue->temp_keys = (u64*)malloc(sizeof(u64) * capacity);
+    queue->temp_indices = (u32*)malloc(sizeof(u32) * capacity);
+    queue->vertex_data = (byte*)malloc(vertex_capacity);
+    queue->count = 0;
+    queue->capacity = capacity;
+    queue->vertex_bytes = 0;
+    queue->vertex_capacity = vertex_capacity;
+    queue->merge_scratch = nullptr;
+    queue->merge_scratch_capacity = 0;
+    queue->max_quads_per_draw = max_quads_per_draw;
+    queue->stats = {};
+
+    return queue->commands && queue->keys && queue->indices && queue->temp_keys && queue->temp_indices && queue->vertex_data;
+}
+
+void RenderQueueDestroy(RenderQueue* queue) {
+    free(queue->commands);
+    free(queue->keys);
+    free(queue->indices);
+    free(queue->temp_keys);
+    free(queue->temp_indices);
+    free(queue->vertex_data);
+    free(queue->merge_scratch);
+    *queue = {};
+}
+
+/**
+ * @brief Grow a byte buffer by doubling until it holds 'size' bytes.
+ */
+bool RenderQueueReserveBytes(byte** buffer, u32* capacity, u32 size) {
+    if (size <= *capacity) {
+        return true;
+    }
+
+    u32 new_capacity = *capacity < 1024 ? 1024 : *capacity;
+    while (new_capacity < size) {
+        new_capacity *= 2;
+    }
+
+    byte* grown = (byte*)realloc(*buffer, new_capacity);
+    if (!grown) {
+        return false;
+    }
+    *buffer = grown;
+    *capacity = new_capacity;
+    return true;
+}
+
+/**
+ * @brief Record quads and return space for their vertex or instance data, valid until the next push.
+ *
+ * When the previous command has the same key and state the quads are appended to it. Returns nullptr if the queue
+ * is full or 'order' is above RENDER_ORDER_MAX.
+ */
+void* RenderQueuePushData(RenderQueue* queue, u32 layer, u32 order, u32 pipeline, u32 texture, u32 vertex_stride, u32 quad_count, bool is_instanced) {
+    if (RENDER_ORDER_MAX < order) {
+        return nullptr;
+    }
+
+    u32 quad_bytes = is_instanced ? vertex_stride : vertex_stride * QUAD_VERTEX_COUNT;
+    u32 byte_size = quad_bytes * quad_count;
+    if (!RenderQueueReserveBytes(&queue->vertex_data, &queue->vertex_capacity, queue->vertex_bytes + byte_size)) {
+        return nullptr;
+    }
+
+    u64 key = PackRenderSortKey(layer, order, pipeline, texture);
+
+    RenderCommand* last = 0 < queue->count ? &queue->commands[queue->count - 1] : nullptr;
+    bool extends_last = last
+        && queue->keys[queue->count - 1] == key
+        && last->static_buffer == RENDER_STATIC_BUFFER_NONE
+        && last->vertex_stride == vertex_stride
+        && last->is_instanced == is_instanced
+        && last->vertex_offset + quad_bytes * last->quad_count == queue->vertex_bytes;
+
+    if (extends_last) {
+        last->quad_count += quad_count;
+    }
+    else {
+        if (queue->capacity <= queue->count) {
+            return nullptr;
+        }
+
+        i32 index = queue->count++;
+        queue->commands[index] = RenderCommand{ pipeline, texture, vertex_stride, queue->vertex_bytes, quad_count, RENDER_STATIC_BUFFER_NONE, is_instanced };
+        queue->keys[index] = key;
+        queue->indices[index] = (u32)index;
+    }
+
+    void* result = queue->vertex_data + queue->vertex_bytes;
+    queue->vertex_bytes += byte_size;
+    return result;
+}
+
+void* RenderQueuePushQuads(RenderQueue* queue, u32 layer, u32 order, u32 pipeline, u32 texture, u32 vertex_stride, u32 quad_count) {
+    return RenderQueuePushData(queue, layer, order, pipeline, texture, vertex_stride, quad_count, false);
+}
+
+/**
+ * @brief Record 'instance_count' instanced quads and return space for their 'instance_stride' sized records.
+ */
+void* RenderQueuePushInstances(RenderQueue* queue, u32 layer, u32 order, u32 pipeline, u32 texture, u32 instance_stride, u32 instance_count) {
+    return RenderQueuePushData(queue, layer, order, pipeline, texture, instance_stride, instance_count, true);
+}
+
+/**
+ * @brief Record a draw of quads from a static GPU buffer identified by 'static_buffer'.
+ */
+bool RenderQueuePushStatic(RenderQueue* queue, u32 layer, u32 order, u32 pipeline, u32 texture, u32 static_buffer, u32 vertex_stride, u32 quad_count) {
+    if (queue->capacity <= queue->count || RENDER_ORDER_MAX < order) {
+        return false;
+    }
+
+    i32 index = queue->count++;
+    queue->commands[index] = RenderCommand{ pipeline, texture, vertex_stride, 0, quad_count, static_buffer, false };
+    queue->keys[index] = PackRenderSortKey(layer, order, pipeline, texture);
+    queue->indices[index] = (u32)index;
+    return true;
+}
+
+bool RenderCommandsCanMerge(RenderCommand* a, RenderCommand* b) {
+    return a->pipeline == b->pipeline
+        && a->texture == b->texture
+        && a->vertex_stride == b->vertex_stride
+        && a->is_instanced == b->is_instanced
+        && a->static_buffer == RENDER_STATIC_BUFFER_NONE
+        && b->static_buffer == RENDER_STATIC_BUFFER_NONE;
+}
+
+/**
+ * @brief Issue draws for 'quad_count' quads at 'vertices', split by the per draw quad limit.
+ *
+ * Instanced quads only read the first quad of the index buffer, so they are drawn with one call.
+ */
+void RenderQueueDrawQuads(RenderQueue* queue, RenderBackend* backend, byte* vertices, u32 vertex_stride, u32 quad_count, bool is_instanced) {
+    if (is_instanced) {
+        backend->draw_instances(backend->user_data, vertices, vertex_stride, quad_count);
+        queue->stats.draws++;
+        return;
+    }
+
+    u32 quad_bytes = vertex_stride * QUAD_VERTEX_COUNT;
+    u32 max_quads = queue->max_quads_per_draw == 0 ? quad_count : queue->max_quads_per_draw;
+
+    for (u32 first = 0; first < quad_count; first += max_quads) {
+        u32 count = quad_count - first < max_quads ? quad_count - first : max_quads;
+        backend->draw_quads(backend->user_data, vertices + first * quad_bytes, vertex_stride, count);
+        queue->stats.draws++;
+    }
+}
+
+/**
+ * @brief Sort commands, merge neighbours with the same state and draw them through 'backend'. Clears the queue.
+ */
+void RenderQueueSubmit(RenderQueue* queue, RenderBackend* backend) {
+    RadixSortKeys(queue->keys, queue->indices, queue->temp_keys, queue->temp_indices, queue->count);
+
+    RenderQueueStats stats = {};
+    stats.commands = queue->count;
+    queue->stats = stats;
+
+    bool has_state = false;
+    u32 bound_pipeline = 0;
+    u32 bound_texture = 0;
+
+    i32 i = 0;
+    while (i < queue->count) {
+        RenderCommand* first = &queue->commands[queue->indices[i]];
+
+        if (!has_state || bound_pipeline != first->pipeline) {
+            backend->bind_pipeline(backend->user_data, first->pipeline);
+            bound_pipeline = first->pipeline;
+            queue->stats.pipeline_binds++;
+        }
+        else {
+            queue->stats.skipped_binds++;
+        }
+
+        if (!has_state || bound_texture != first->texture) {
+            backend->bind_texture(backend->user_data, first->texture);
+            bound_texture = first->texture;
+            queue->stats.texture_binds++;
+        }
+        else {
+            queue->stats.skipped_binds++;
+        }
+        has_state = true;
+
+        if (first->static_buffer != RENDER_STATIC_BUFFER_NONE) {
+            backend->draw_static_quads(backend->user_data, first->static_buffer, first->vertex_stride, first->quad_count);
+            queue->stats.draws++;
+            i++;
+            continue;
+        }
+
+        // Collect the run of mergeable commands, noting whether their vertices are already back to back
+        i32 run_end = i + 1;
+        u32 run_quads = first->quad_count;
+        bool is_contiguous = true;
+        u32 next_offset = first->vertex_offset + RenderCommandQuadBytes(first) * first->quad_count;
+
+        while (run_end < queue->count) {
+            RenderCommand* next = &queue->commands[queue->indices[run_end]];
+            if (!RenderCommandsCanMerge(first, next)) {
+                break;
+            }
+            is_contiguous = is_contiguous && next->vertex_offset == next_offset;
+            next_offset = next->vertex_offset + RenderCommandQuadBytes(next) * next->quad_count;
+            run_quads += next->quad_count;
+            run_end++;
+        }
+        queue->stats.merged_commands += run_end - i - 1;
+
+        byte* vertices = queue->vertex_data + first->vertex_offset;
+        if (!is_contiguous) {
+            u32 run_bytes = RenderCommandQuadBytes(first) * run_quads;
+            if (!RenderQueueReserveBytes(&queue->merge_scratch, &queue->merge_scratch_capacity, run_bytes)) {
+                // Out of memory, draw the commands one by one
+                for (; i < run_end; i++) {
+                    RenderCommand* command = &queue->commands[queue->indices[i]];
+                    RenderQueueDrawQuads(queue, backend, queue->vertex_data + command->vertex_offset, command->vertex_stride, command->quad_count, command->is_instanced);
+                }
+                continue;
+            }
+
+            u32 written = 0;
+            for (i32 j = i; j < run_end; j++) {
+                RenderCommand* command = &queue->commands[queue->indices[j]];
+                u32 command_bytes = RenderCommandQuadBytes(command) * command->quad_count;
+                memcpy(queue->merge_scratch + written, queue->vertex_data + command->vertex_offset, command_bytes);
+                written += command_bytes;
+            }
+            vertices = queue->merge_scratch;
+        }
+
+        RenderQueueDrawQuads(queue, backend, vertices, first->vertex_stride, run_quads, first->is_instanced);
+        i = run_end;
+    }
+
+    queue->count = 0;
+    queue->vertex_bytes = 0;
+}
+
+// --------------
+// Null backend
+
+void RenderNullBindPipeline(void* user_data, u32 pipeline) {
+    (void)pipeline;
+    ((RenderNullBackendCounters*)user_data)->pipeline_binds++;
+}
+
+void RenderNullBindTexture(void* user_data, u32 texture) {
+    (void)texture;
+    ((RenderNullBackendCounters*)user_data)->texture_binds++;
+}
+
+void RenderNullDrawQuads(void* user_data, void* vertices, u32 vertex_stride, u32 quad_count) {
+    (void)vertices;
+    (void)vertex_stride;
+    RenderNullBackendCounters* counters = (RenderNullBackendCounters*)user_data;
+    counters->draws++;
+    counters->quads += quad_count;
+}
+
+void RenderNullDrawStaticQuads(void* user_data, u32 static_buffer, u32 vertex_stride, u32 quad_count) {
+    (void)static_buffer;
+    (void)vertex_stride;
+    RenderNullBackendCounters* counters = (RenderNullBackendCounters*)user_data;
+    counters->static_draws++;
+    counters->quads += quad_count;
+}
+
+void RenderNullDrawInstances(void* user_data, void* instances, u32 instance_stride, u32 instance_count) {
+    (void)instances;
+    (void)instance_stride;
+    RenderNullBackendCounters* counters = (RenderNullBackendCounters*)user_data;
+    counters->instanced_draws++;
+    counters->quads += instance_count;
+}
+
+RenderBackend RenderNullBackendCreate(RenderNullBackendCounters* counters) {
+    *counters = {};
+    RenderBackend result = {
+        .user_data = counters,
+        .bind_pipeline = RenderNullBindPipeline,
+        .bind_texture = RenderNullBindTexture,
+        .draw_quads = RenderNullDrawQuads,
+        .draw_static_quads = RenderNullDrawStaticQuads,
+        .draw_instances = RenderNullDrawInstances
+    };
+    return result;
+}
@@ -0,0 +1,394 @@
+#pragma once
+
+// ----------
+// Includes
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <atomic>
+
+#include "types.h"
+#include "hash.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <dirent.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Compiled shader bytecode on disk, one file per compile named after its key:
+//
+//   ShaderCacheFileHeader
+//   ShaderCacheDependency dependencies[dependency_count]  files pulled in with #include
+//   byte                  bytecode[bytecode_size]
+//
+// The key hashes everything the compiler sees on the command line: the source, the defines, the entry point,
+// the profile, the flags and the compiler version. Included files are not known before compiling, so they
+// are recorded with a hash of their contents and checked again on every load, an entry whose includes
+// changed is stale and compiled again. Files are written under a temporary name and renamed over the
+// entry, readers never see half a file, and a file that is damaged anyway fails its bytecode hash.
+//
+// Editing a source gives it a new key, the entry of the old one stays behind until ShaderCachePrune.
+//
+// Nothing here knows about a shader compiler, see src/shader_compiler.h. Safe to use from several threads.
+
+// ---------
+// Defines
+
+const u32 SHADER_CACHE_MAGIC = 0x43485346; // "FSHC"
+const u32 SHADER_CACHE_VERSION = 1;
+const i32 SHADER_CACHE_MAX_DEPENDENCIES = 16;
+const i32 SHADER_CACHE_PATH_MAX = 260;
+const char* SHADER_CACHE_EXTENSION = ".fsc";
+
+// ---------
+// Structs
+
+struct ShaderCacheFileHeader {
+    u32 magic;
+    u32 version;
+    u64 key;
+    u64 bytecode_hash;
+    u32 bytecode_size;
+    u32 dependency_count;
+};
+
+struct ShaderCacheDependency {
+    u64 content_hash;
+    char path[SHADER_CACHE_PATH_MAX];
+};
+
+/**
+ * @brief Reads a source file by the path it was compiled or included with. Returns a malloc'ed buffer, nullptr if there is no such file.
+ */
+struct ShaderCacheSourceReader {
+    void* user_data;
+    byte* (*read)(void* user_data, const char* path, size_t* size);
+};
+
+struct ShaderCacheStats {
+    std::atomic<i32> hits;
+    std::atomic<i32> misses;
+    std::atomic<i32> stale;
+    std::atomic<i32> corrupt;
+    std::atomic<i32> writes;
+    std::atomic<i32> write_failures;
+};
+
+struct ShaderCache {
+    char directory[SHADER_CACHE_PATH_MAX] = {};
+    std::atomic<u32> next_temp_id = 0;
+    ShaderCacheStats stats = {};
+};
+
+// --------------------------
+// Function implementations
+
+/**
+ * @brief Hash a zero terminated string together with its length, so neighbouring fields can not run into each other.
+ */
+u64 ShaderCacheHashString(const char* text, u64 hash) {
+    u64 length = text ? strlen(text) : 0;
+    hash = HashFnv1a(&length, sizeof(length), hash);
+    return HashFnv1a(text, length, hash);
+}
+
+/**
+ * @brief Key of one compile. 'defines' is every macro of the compile in order, written as "NAME=VALUE;" pairs.
+ */
+u64 ShaderCacheKeyOf(const byte* source, size_t source_size, const char* defines, const char* entry_point, const char* profile, u32 flags, u32 compiler_version) {
+    u64 size = source_size;
+    u64 hash = HashFnv1a(&SHADER_CACHE_VERSION, sizeof(SHADER_CACHE_VERSION));
+    hash = HashFnv1a(&compiler_version, sizeof(compiler_version), hash);
+    hash = HashFnv1a(&flags, sizeof(flags), hash);
+    hash = ShaderCacheHashString(entry_point, hash);
+    hash = ShaderCacheHashString(profile, hash);
+    hash = ShaderCacheHashString(defines, hash);
+    hash = HashFnv1a(&size, sizeof(size), hash);
+    return HashFnv1a(source, source_size, hash);
+}
+
+/**
+ * @brief Use 'directory' for cache files, creating it if needed. Returns false if it can not be created or its path is too long.
+ */
+bool ShaderCacheCreate(ShaderCache* cache, const char* directory) {
+    i32 length = snprintf(cache->directory, SHADER_CACHE_PATH_MAX, "%s", directory);
+    cache->next_temp_id = 0;
+    if (length < 0 || SHADER_CACHE_PATH_MAX <= length) {
+        cache->directory[0] = '\0';
+        return false;
+    }
+
+#ifdef _WIN32
+    return CreateDirectoryA(directory, nullptr) || GetLastError() == ERROR_ALREADY_EXISTS;
+#else
+    struct stat info;
+    return mkdir(directory, 0755) == 0 || (stat(directory, &info) == 0 && S_ISDIR(info.st_mode));
+#endif
+}
+
+/**
+ * @brief Path of the entry of 'key'. Returns false if it does not fit in SHADER_CACHE_PATH_MAX, a truncated path would name another file.
+ */
+bool ShaderCacheFilePath(ShaderCache* cache, u64 key, char* result) {
+    i32 length = snprintf(result, SHADER_CACHE_PATH_MAX, "%s/%016llx%s", cache->directory, (unsigned long long)key, SHADER_CACHE_EXTENSION);
+    return 0 <= length && length < SHADER_CACHE_PATH_MAX;
+}
+
+byte* ShaderCacheReadFile(const char* path, size_t* size) {
+    FILE* file = fopen(path, "rb");
+    if (!file) {
+        return nullptr;
+    }
+
+    fseek(file, 0, SEEK_END);
+    long file_size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+
+    // Empty files are valid includes, they still get a buffer to hash
+    byte* buffer = 0 <= file_size ? (byte*)malloc(file_size + 1) : nullptr;
+    bool is_ok = buffer && fread(buffer, 1, file_size, file) == (size_t)file_size;
+    fclose(file);
+
+    if (!is_ok) {
+        free(buffer);
+        return nullptr;
+    }
+    *size = (size_t)file_size;
+    return buffer;
+}
+
+/**
+ * @brief Bytecode cached under 'key' as a malloc'ed buffer, nullptr on a miss.
+ *
+ * Included files are read through 'reader' and compared with the hashes they were compiled with, any
+ * difference makes the entry stale. Damaged entries count as corrupt, both are misses to the caller.
+ */
+byte* ShaderCacheLoad(ShaderCache* cache, u64 key, ShaderCacheSourceReader* reader, size_t* bytecode_size) {
+    char path[SHADER_CACHE_PATH_MAX];
+    if (!ShaderCacheFilePath(cache, key, path)) {
+        cache->stats.misses++;
+        return nullptr;
+    }
+
+    size_t file_size = 0;
+    byte* file = ShaderCacheReadFile(path, &file_size);
+    if (!file) {
+        cache->stats.misses++;
+        return nullptr;
+    }
+
+    ShaderCacheFileHeader header = {};
+    bool is_valid = sizeof(header) <= file_size;
+    if (is_valid) {
+        memcpy(&header, file, sizeof(header));
+        u64 expected_size = sizeof(header) + (u64)header.dependency_count * sizeof(ShaderCacheDependency) + header.bytecode_size;
+        is_valid = header.magic == SHADER_CACHE_MAGIC
+            && header.version == SHADER_CACHE_VERSION
+            && header.key == key
+            && header.dependency_count <= (u32)SHADER_CACHE_MAX_DEPENDENCIES
+            && 0 < header.bytecode_size
+            && expected_size == file_size;
+    }
+
+    byte* bytecode = is_valid ? file + file_size - header.bytecode_size : nullptr;
+    if (is_valid && HashFnv1a(bytecode, header.bytecode_size) != header.bytecode_hash) {
+        is_valid = false;
+    }
+    if (!is_valid) {
+        free(file);
+        cache->stats.corrupt++;
+        return nullptr;
+    }
+
+    ShaderCacheDependency* dependencies = (ShaderCacheDependency*)(file + sizeof(header));
+    for (u32 i = 0; i < header.dependency_count; i++) {
+        ShaderCacheDependency dependency = {};
+        memcpy(&dependency, &dependencies[i], sizeof(dependency));
+        dependency.path[SHADER_CACHE_PATH_MAX - 1] = '\0';
+
+        size_t size = 0;
+        byte* content = reader->read(reader->user_data, dependency.path, &size);
+        bool is_same = content && HashFnv1a(content, size) == dependency.content_hash;
+        free(content);
+
+        if (!is_same) {
+            free(file);
+            cache->stats.stale++;
+            return nullptr;
+        }
+    }
+
+    byte* result = (byte*)malloc(header.bytecode_size);
+    if (result) {
+        memcpy(result, bytecode, header.bytecode_size);
+        *bytecode_size = header.bytecode_size;
+        cache->stats.hits++;
+    }
+    free(file);
+    return result;
+}
+
+/**
+ * @brief Store bytecode under 'key', replacing what was there. Returns false if the file could not be written, the cache then stays as it was.
+ */
+bool ShaderCacheStore(ShaderCache* cache, u64 key, const byte* bytecode, size_t bytecode_size, const ShaderCacheDependency* dependencies, i32 dependency_count) {
+    if (bytecode_size == 0 || 0xFFFFFFFFu < bytecode_size || dependency_count < 0 || SHADER_CACHE_MAX_DEPENDENCIES < dependency_count) {
+        cache->stats.write_failures++;
+        return false;
+    }
+
+    ShaderCacheFileHeader header = {};
+    header.magic = SHADER_CACHE_MAGIC;
+    header.version = SHADER_CACHE_VERSION;
+    header.key = key;
+    header.bytecode_hash = HashFnv1a(bytecode, bytecode_size);
+    header.bytecode_size = (u32)bytecode_size;
+    header.dependency_count = (u32)dependency_count;
+
+    char path[SHADER_CACHE_PATH_MAX];
+    char temp_path[SHADER_CACHE_PATH_MAX + 32];
+    if (!ShaderCacheFilePath(cache, key, path)) {
+        cache->stats.write_failures++;
+        return false;
+    }
+
+    // Unique per process and per call, so writers racing on the same key each rename a complete file of their own
+#ifdef _WIN32
+    u32 process_id = (u32)GetCurrentProcessId();
+#else
+    u32 process_id = (u32)getpid();
+#endif
+    snprintf(temp_path, sizeof(temp_path), "%s.%u-%u.tmp", path, process_id, cache->next_temp_id++);
+
+    FILE* file = fopen(temp_path, "wb");
+    if (!file) {
+        cache->stats.write_failures++;
+        return false;
+    }
+
+    bool is_ok = fwrite(&header, sizeof(header), 1, file) == 1
+        && (dependency_count == 0 || fwrite(dependencies, sizeof(ShaderCacheDependency), dependency_count, file) == (size_t)dependency_count)
+        && fwrite(bytecode, 1, bytecode_size, file) == bytecode_size;
+    is_ok = fclose(file) == 0 && is_ok;
+
+#ifdef _WIN32
+    is_ok = is_ok && MoveFileExA(temp_path, path, MOVEFILE_REPLACE_EXISTING);
+#else
+    is_ok = is_ok && rename(temp_path, path) == 0;
+#endif
+
+    if (!is_ok) {
+        remove(temp_path);
+        cache->stats.write_failures++;
+        return false;
+    }
+    cache->stats.writes++;
+    return true;
+}
+
+/**
+ * @brief Key of a cache file name, "<16 hex digits>.fsc". Returns false for any other name.
+ */
+bool ShaderCacheKeyOfFileName(const char* name, u64* key) {
+    u64 result = 0;
+    for (i32 i = 0; i < 16; i++) {
+        char c = name[i];
+        u64 digit = 0;
+        if ('0' <= c && c <= '9') {
+            digit = (u64)(c - '0');
+        }
+        else if ('a' <= c && c <= 'f') {
+            digit = (u64)(c - 'a' + 10);
+        }
+        else {
+            return false;
+        }
+        result = (result << 4) | digit;
+    }
+    if (strcmp(name + 16, SHADER_CACHE_EXTENSION) != 0) {
+        return false;
+    }
+    *key = result;
+    return true;
+}
+
+/**
+ * @brief True if 'name' is a cache file whose key is not one of 'keys'. Its key is written to 'key'.
+ */
+bool ShaderCacheIsSuperseded(const char* name, const u64* keys, i32 key_count, u64* key) {
+    if (!ShaderCacheKeyOfFileName(name, key)) {
+        return false;
+    }
+    for (i32 i = 0; i < key_count; i++) {
+        if (keys[i] == *key) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Collect the keys of up to 'max_count' superseded entries. Returns how many were collected.
+ */
+i32 ShaderCacheListSuperseded(ShaderCache* cache, const u64* keys, i32 key_count, u64* superseded, i32 max_count) {
+    i32 count = 0;
+    u64 key = 0;
+#ifdef _WIN32
+    char pattern[SHADER_CACHE_PATH_MAX + 8];
+    snprintf(pattern, sizeof(pattern), "%s/*%s", cache->directory, SHADER_CACHE_EXTENSION);
+    WIN32_FIND_DATAA find_data;
+    HANDLE find = FindFirstFileA(pattern, &find_data);
+    if (find == INVALID_HANDLE_VALUE) {
+        return 0;
+    }
+    do {
+        if (count < max_count && ShaderCacheIsSuperseded(find_data.cFileName, keys, key_count, &key)) {
+            superseded[count++] = key;
+        }
+    } while (FindNextFileA(find, &find_data));
+    FindClose(find);
+#else
+    DIR* dir = opendir(cache->directory);
+    if (!dir) {
+        return 0;
+    }
+    while (dirent* entry = readdir(dir)) {
+        if (count < max_count && ShaderCacheIsSuperseded(entry->d_name, keys, key_count, &key)) {
+            superseded[count++] = key;
+        }
+    }
+    closedir(dir);
+#endif
+    return count;
+}
+
+/**
+ * @brief Remove every entry whose key is not one of 'keys', typically the keys of the current sources. Returns the number removed.
+ *
+ * Only names written by ShaderCacheStore are touched, temporary files of writers still running are left alone.
+ */
+i32 ShaderCachePrune(ShaderCache* cache, const u64* keys, i32 key_count) {
+    // Removing while listing is not safe everywhere, entries are collected in batches and removed after
+    const i32 batch_size = 64;
+    u64 superseded[batch_size];
+    i32 removed_count = 0;
+    for (;;) {
+        i32 count = ShaderCacheListSuperseded(cache, keys, key_count, superseded, batch_size);
+        i32 batch_removed_count = 0;
+        for (i32 i = 0; i < count; i++) {
+            char path[SHADER_CACHE_PATH_MAX];
+            if (ShaderCacheFilePath(cache, superseded[i], path) && remove(path) == 0) {
+                batch_removed_count++;
+            }
+        }
+
+        removed_count += batch_removed_count;
+        if (count < batch_size || batch_removed_count == 0) {
+            return removed_count;
+        }
+    }
+}
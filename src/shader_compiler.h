@@ -0,0 +1,196 @@
+#pragma once
+
+// ----------
+// Includes
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <d3dcompiler.h>
+
+#include "types.h"
+#include "shader_cache.h"
+
+// HLSL compiles through the shader cache, used by the game and by tools/shader_precompiler.cpp so both
+// produce the same keys. Sources and includes are read with a ShaderCacheSourceReader by virtual path,
+// "#include" resolves relative to the including file the same way D3D_COMPILE_STANDARD_FILE_INCLUDE does.
+
+// ---------
+// Defines
+
+const i32 SHADER_DEFINES_MAX = 1024;
+const i32 SHADER_INCLUDE_DEPTH_MAX = 16;
+
+// ---------
+// Structs
+
+/**
+ * @brief Include handler that reads through the source reader and records every included file for the cache.
+ */
+struct ShaderIncludeHandler : ID3DInclude {
+    ShaderCacheSourceReader* reader = nullptr;
+    char root_directory[SHADER_CACHE_PATH_MAX] = {};
+
+    // Open includes, to resolve nested includes relative to the file that contains them
+    const void* open_data[SHADER_INCLUDE_DEPTH_MAX] = {};
+    char open_directories[SHADER_INCLUDE_DEPTH_MAX][SHADER_CACHE_PATH_MAX] = {};
+    i32 open_count = 0;
+
+    ShaderCacheDependency dependencies[SHADER_CACHE_MAX_DEPENDENCIES] = {};
+    i32 dependency_count = 0;
+    bool is_dependency_overflow = false;
+
+    HRESULT __stdcall Open(D3D_INCLUDE_TYPE include_type, LPCSTR file_name, LPCVOID parent_data, LPCVOID* data, UINT* size) override;
+    HRESULT __stdcall Close(LPCVOID data) override;
+};
+
+// --------------------------
+// Function implementations
+
+/**
+ * @brief Directory part of 'path' including the trailing separator, empty for paths without one.
+ */
+void ShaderDirectoryOf(const char* path, char* result) {
+    const char* end = path;
+    for (const char* p = path; *p != 0; p++) {
+        if (*p == '/' || *p == '\\') {
+            end = p + 1;
+        }
+    }
+    snprintf(result, SHADER_CACHE_PATH_MAX, "%.*s", (int)(end - path), path);
+}
+
+HRESULT __stdcall ShaderIncludeHandler::Open(D3D_INCLUDE_TYPE include_type, LPCSTR file_name, LPCVOID parent_data, LPCVOID* data, UINT* size) {
+    (void)include_type;
+    if (SHADER_INCLUDE_DEPTH_MAX <= open_count) {
+        return E_FAIL;
+    }
+
+    const char* directory = root_directory;
+    for (i32 i = 0; i < open_count; i++) {
+        if (open_data[i] == parent_data) {
+            directory = open_directories[i];
+        }
+    }
+
+    char path[SHADER_CACHE_PATH_MAX];
+    snprintf(path, SHADER_CACHE_PATH_MAX, "%s%s", directory, file_name);
+
+    size_t file_size = 0;
+    byte* file = reader->read(reader->user_data, path, &file_size);
+    if (!file) {
+        return E_FAIL;
+    }
+
+    // An include used twice is recorded once
+    u64 content_hash = HashFnv1a(file, file_size);
+    bool is_recorded = false;
+    for (i32 i = 0; i < dependency_count; i++) {
+        is_recorded = is_recorded || strcmp(dependencies[i].path, path) == 0;
+    }
+    if (!is_recorded && dependency_count < SHADER_CACHE_MAX_DEPENDENCIES) {
+        ShaderCacheDependency* dependency = &dependencies[dependency_count++];
+        dependency->content_hash = content_hash;
+        snprintf(dependency->path, SHADER_CACHE_PATH_MAX, "%s", path);
+    }
+    else if (!is_recorded) {
+        is_dependency_overflow = true;
+    }
+
+    open_data[open_count] = file;
+    ShaderDirectoryOf(path, open_directories[open_count]);
+    open_count++;
+
+    *data = file;
+    *size = (UINT)file_size;
+    return S_OK;
+}
+
+HRESULT __stdcall ShaderIncludeHandler::Close(LPCVOID data) {
+    for (i32 i = 0; i < open_count; i++) {
+        if (open_data[i] == data) {
+            open_count--;
+            open_data[i] = open_data[open_count];
+            memcpy(open_directories[i], open_directories[open_count], SHADER_CACHE_PATH_MAX);
+            break;
+        }
+    }
+    free((void*)data);
+    return S_OK;
+}
+
+/**
+ * @brief Cache key of compiling 'source' with 'macros'. Returns false if the macros are too long to key, such compiles bypass the cache.
+ */
+bool ShaderCompileKey(const byte* source, size_t source_size, const D3D_SHADER_MACRO* macros, const char* entry_point, const char* profile, u32 flags, u64* key) {
+    char defines[SHADER_DEFINES_MAX] = {};
+    i32 defines_length = 0;
+    for (const D3D_SHADER_MACRO* macro = macros; macro && macro->Name; macro++) {
+        defines_length += snprintf(defines + defines_length, SHADER_DEFINES_MAX - defines_length, "%s=%s;", macro->Name, macro->Definition ? macro->Definition : "");
+        if (SHADER_DEFINES_MAX <= defines_length) {
+            return false;
+        }
+    }
+
+    *key = ShaderCacheKeyOf(source, source_size, defines, entry_point, profile, flags, D3D_COMPILER_VERSION);
+    return true;
+}
+
+/**
+ * @brief Compile one entry point of the HLSL file at 'path', loading the bytecode from 'cache' when it has it.
+ *
+ * 'cache' may be nullptr to always compile. Returns nullptr with the compiler output in 'error' on failure.
+ */
+ID3DBlob* ShaderCompileCached(ShaderCache* cache, ShaderCacheSourceReader* reader, const char* path, const D3D_SHADER_MACRO* macros, const char* entry_point, const char* profile, u32 flags, char* error, i32 error_size) {
+    size_t source_size = 0;
+    byte* source = reader->read(reader->user_data, path, &source_size);
+    if (!source) {
+        snprintf(error, error_size, "Failed to load shader source: %s", path);
+        return nullptr;
+    }
+
+    // Defines too long to key reliably compile without the cache
+    u64 key = 0;
+    if (!ShaderCompileKey(source, source_size, macros, entry_point, profile, flags, &key)) {
+        cache = nullptr;
+    }
+
+    ID3DBlob* blob = nullptr;
+    size_t bytecode_size = 0;
+    byte* bytecode = cache ? ShaderCacheLoad(cache, key, reader, &bytecode_size) : nullptr;
+    if (bytecode) {
+        if (SUCCEEDED(D3DCreateBlob(bytecode_size, &blob))) {
+            memcpy(blob->GetBufferPointer(), bytecode, bytecode_size);
+        }
+        free(bytecode);
+        if (blob) {
+            free(source);
+            return blob;
+        }
+    }
+
+    ShaderIncludeHandler includes;
+    includes.reader = reader;
+    ShaderDirectoryOf(path, includes.root_directory);
+
+    ID3DBlob* error_blob = nullptr;
+    HRESULT hr = D3DCompile(
+        source, source_size, path,
+        macros, &includes,
+        entry_point, profile, flags, 0, &blob, &error_blob);
+    free(source);
+
+    if (FAILED(hr)) {
+        snprintf(error, error_size, "%s", error_blob ? (char*)error_blob->GetBufferPointer() : "Shader compilation failed");
+        blob = nullptr;
+    }
+    else if (cache && !includes.is_dependency_overflow) {
+        // A failed store only costs a compile next time
+        ShaderCacheStore(cache, key, (byte*)blob->GetBufferPointer(), blob->GetBufferSize(), includes.dependencies, includes.dependency_count);
+    }
+
+    if (error_blob) {
+        error_blob->Release();
+    }
+    return blob;
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+// ----------
+// Includes
+
+#include <math.h>
+
+#include "types.h"
+#include "quad_batch.h"
+
+// Solid color screen space shapes. Every shape is one RectangleVertex quad, so rectangles, lines
+// and dots drawn in any order can share one vertex stream and one draw call.
+
+// --------------------------
+// Function implementations
+
+/**
+ * @brief Write a line quad 'size_px' pixels thick on both sides of the line. Returns written vertex count.
+ */
+i32 BuildLineQuadVertices(RectangleVertex* out, Vec2f ndc_start, Vec2f ndc_end, f32 size_px, Vec2i viewport_size, Vec4f color) {
+    Vec2i start_px = NDCToScreenPx(ndc_start, viewport_size);
+    Vec2i end_px = NDCToScreenPx(ndc_end, viewport_size);
+
+    Vec2i line_vec = {start_px.x - end_px.x, start_px.y - end_px.y};
+    f32 perp_x = (f32)-line_vec.y;
+    f32 perp_y = (f32)line_vec.x;
+
+    f32 length = sqrtf(perp_x * perp_x + perp_y * perp_y);
+    if (0.0f < length) {
+        perp_x = perp_x / length * size_px;
+        perp_y = perp_y / length * size_px;
+    }
+
+    Vec2i perp_vec = {(i32)perp_x, (i32)perp_y};
+
+    Vec2i line_start_1 = {start_px.x - perp_vec.x, start_px.y - perp_vec.y};
+    Vec2i line_start_2 = {start_px.x + perp_vec.x, start_px.y + perp_vec.y};
+    Vec2i line_end_1 = {end_px.x - perp_vec.x, end_px.y - perp_vec.y};
+    Vec2i line_end_2 = {end_px.x + perp_vec.x, end_px.y + perp_vec.y};
+
+    Vec2f s1 = ScreenPxToNDC(line_start_1, viewport_size);
+    Vec2f s2 = ScreenPxToNDC(line_start_2, viewport_size);
+    Vec2f e1 = ScreenPxToNDC(line_end_1, viewport_size);
+    Vec2f e2 = ScreenPxToNDC(line_end_2, viewport_size);
+
+    return BuildRectangleQuadVertices(out, s1, s2, e1, e2, color);
+}
+
+/**
+ * @brief Write a square dot centered on 'ndc'. Returns written vertex count.
+ */
+i32 BuildDotQuadVertices(RectangleVertex* out, Vec2f ndc, f32 size_px, Vec2i viewport_size, Vec4f color) {
+    f32 dot_w = (size_px / 2) / (f32)viewport_size.x;
+    f32 dot_h = (size_px / 2) / (f32)viewport_size.y;
+
+    Vec2f top_left = {ndc.x - dot_w, ndc.y + dot_h};
+    Vec2f top_right = {ndc.x + dot_w, ndc.y + dot_h};
+    Vec2f bot_left = {ndc.x - dot_w, ndc.y - dot_h};
+    Vec2f bot_right = {ndc.x + dot_w, ndc.y - dot_h};
+    return BuildRectangleQuadVertices(out, top_left, top_right, bot_left, bot_right, color);
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+// ----------
+// Includes
+
+#include "types.h"
+#include "quad_batch.h"
+
+// Instanced sprites. Each sprite is one SpriteInstance record in a structured buffer and the vertex
+// shader expands it to the four corners of the shared quad index buffer, so the CPU writes 32 bytes
+// per sprite instead of four TilemapTileVertex vertices.
+
+// ---------
+// Structs
+
+/**
+ * @brief Per sprite instance data, mirrored by the SpriteInstance struct of the instanced sprite shader.
+ *
+ * 'uv' is the atlas rectangle as R16 UNORM pairs: uv[0] = u0 | v0 << 16, uv[1] = u1 | v1 << 16.
+ * 'color' is R8G8B8A8_UNORM with red in the lowest byte. 'depth' is the isometric sort depth.
+ */
+struct SpriteInstance {
+    Vec2f center;
+    Vec2f size;
+    u32 uv[2];
+    u32 color;
+    f32 depth;
+};
+
+static_assert(sizeof(SpriteInstance) == 32, "SpriteInstance is not 32 bytes");
+
+/**
+ * @brief Visible world rectangle. Sprites entirely outside of it are not drawn.
+ */
+struct SpriteCullRect {
+    Vec2f min;
+    Vec2f max;
+};
+
+// --------------------------
+// Function implementations
+
+SpriteInstance PackSpriteInstance(Vec2f center, Vec2f size, Vec4f uv_rect, Vec4f color, f32 depth) {
+    SpriteInstance result = {
+        .center = center,
+        .size = size,
+        .uv = {
+            (u32)PackUnorm16(uv_rect.x) | ((u32)PackUnorm16(uv_rect.y) << 16),
+            (u32)PackUnorm16(uv_rect.z) | ((u32)PackUnorm16(uv_rect.w) << 16)
+        },
+        .color = PackColorRGBA8(color),
+        .depth = depth
+    };
+    return result;
+}
+
+/**
+ * @brief Cull rectangle of an orthographic view of 'view_size' world units centered on 'view_center'.
+ */
+SpriteCullRect SpriteCullRectFromView(Vec2f view_center, Vec2f view_size) {
+    SpriteCullRect result = {
+        .min = { view_center.x - view_size.x * 0.5f, view_center.y - view_size.y * 0.5f },
+        .max = { view_center.x + view_size.x * 0.5f, view_center.y + view_size.y * 0.5f }
+    };
+    return result;
+}
+
+/**
+ * @brief True when any part of the sprite overlaps 'cull_rect'. Sprites are tested once as they are queued,
+ * so culled sprites never reach the depth sort.
+ */
+bool SpriteIsVisible(SpriteCullRect* cull_rect, Vec2f center, Vec2f size) {
+    f32 half_w = size.x * 0.5f;
+    f32 half_h = size.y * 0.5f;
+    return cull_rect->min.x <= center.x + half_w
+        && center.x - half_w <= cull_rect->max.x
+        && cull_rect->min.y <= center.y + half_h
+        && center.y - half_h <= cull_rect->max.y;
+}
@@ -0,0 +1,108 @@
+#pragma once
+
+// ----------
+// Includes
+
+#include "types.h"
+#include "quad_batch.h"
+
+// ---------
+// Defines
+
+const i32 FONT_FIRST_GLYPH = 32;
+const i32 FONT_GLYPH_COUNT = 96;
+
+// ---------
+// Structs
+
+struct FontGlyphInfo {
+    i32 bitmap_width = 0;
+    i32 bitmap_height = 0;
+    i32 x_offset = 0;
+    i32 y_offset = 0;
+    f32 advance = 0.0f;
+    f32 uv_x0 = 0.0f;
+    f32 uv_y0 = 0.0f;
+    f32 uv_x1 = 0.0f;
+    f32 uv_y1 = 0.0f;
+    char character;
+};
+
+/**
+ * @brief Pen position of a text run being laid out, in screen pixels from the top-left corner.
+ */
+struct TextLayoutCursor {
+    Vec2f position;
+    Vec2f origin;
+};
+
+// --------------------------
+// Function implementations
+
+TextLayoutCursor TextLayoutBegin(Vec2f screen_pos) {
+    TextLayoutCursor result = {
+        .position = screen_pos,
+        .origin = screen_pos
+    };
+    return result;
+}
+
+/**
+ * @brief Advance the cursor over one character and write its glyph quad into 'out'.
+ *
+ * Returns false when the character produces no visible quad (newline, unsupported or empty glyph).
+ */
+bool TextLayoutGlyph(TextLayoutCursor* cursor, char c, FontGlyphInfo* glyphs, i32 font_size_px, Vec2i viewport_size, TextUiVertex* out) {
+    if (c == '\n') {
+        cursor->position.x = cursor->origin.x;
+        cursor->position.y += font_size_px;
+        return false;
+    }
+
+    i32 glyph_index = (i32)(unsigned char)c - FONT_FIRST_GLYPH;
+    if (glyph_index < 0 || FONT_GLYPH_COUNT <= glyph_index) {
+        return false;
+    }
+
+    FontGlyphInfo* glyph = &glyphs[glyph_index];
+
+    i32 px_x0 = cursor->position.x + glyph->x_offset;
+    i32 px_x1 = px_x0 + glyph->bitmap_width;
+    i32 px_y0 = cursor->position.y - glyph->y_offset;
+    i32 px_y1 = px_y0 + glyph->bitmap_height;
+
+    cursor->position.x += glyph->advance;
+
+    if (glyph->bitmap_width == 0 || glyph->bitmap_height == 0) {
+        return false;
+    }
+
+    Vec2f top_left = ScreenPxToNDC({px_x0, px_y0}, viewport_size);
+    Vec2f top_right = ScreenPxToNDC({px_x1, px_y0}, viewport_size);
+    Vec2f bot_left = ScreenPxToNDC({px_x0, px_y1}, viewport_size);
+    Vec2f bot_right = ScreenPxToNDC({px_x1, px_y1}, viewport_size);
+
+    BuildTextUiQuadVertices(out, top_left, top_right, bot_left, bot_right, Vec4f{glyph->uv_x0, glyph->uv_y0, glyph->uv_x1, glyph->uv_y1});
+    return true;
+}
+
+/**
+ * @brief Lay out a whole string into 'out', which must hold QUAD_VERTEX_COUNT vertices per character.
+ *
+ * Returns the number of quads written. 'end_cursor' receives the final pen position.
+ */
+i32 TextLayoutString(char* text, Vec2f screen_pos, FontGlyphInfo* glyphs, i32 font_size_px, Vec2i viewport_size, TextUiVertex* out, Vec2f* end_cursor) {
+    TextLayoutCursor cursor = TextLayoutBegin(screen_pos);
+    i32 quad_count = 0;
+
+    for (char* p = text; *p != '\0'; p++) {
+        if (TextLayoutGlyph(&cursor, *p, glyphs, font_size_px, viewport_size, &out[quad_count * QUAD_VERTEX_COUNT])) {
+            quad_count++;
+        }
+    }
+
+    if (end_cursor) {
+        *end_cursor = cursor.position;
+    }
+    return quad_count;
+}
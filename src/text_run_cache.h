@@ -0,0 +1,313 @@
+#pragma once
+
+// ----------
+// Includes
+
+#include "types.h"
+#include "hash.h"
+#include "quad_batch.h"
+#include "text_layout.h"
+
+// ---------
+// Defines
+
+const i32 TEXT_RUN_SLOT_EMPTY = -1;
+
+// ---------
+// Structs
+
+/**
+ * @brief Everything that affects the generated vertices of a text run.
+ */
+struct TextRunKey {
+    u64 text_hash;
+    u64 font_id;
+    Vec2f position;
+    Vec2i viewport_size;
+    i32 text_length;
+};
+
+/**
+ * @brief Laid out glyph quads of one string. 'text' is a copy of the string used to reject hash collisions.
+ */
+struct TextRun {
+    TextRunKey key;
+    u64 last_used_tick;
+    bool is_used;
+    i32 quad_count;
+    Vec2f end_cursor;
+    TextUiVertex* vertices;
+    char* text;
+    size_t byte_size;
+};
+
+/**
+ * @brief Cache of laid out text runs, evicting least recently used runs to stay under 'byte_budget'.
+ */
+struct TextRunCache {
+    i32 run_capacity = 0;
+    i32 run_count = 0;
+    TextRun* runs = nullptr;
+    i32* run_index = nullptr;
+    u32 run_index_mask = 0;
+    size_t byte_budget = 0;
+    size_t bytes_used = 0;
+    u64 tick = 0;
+    u64 hits = 0;
+    u64 misses = 0;
+};
+
+/**
+ * @brief Glyph quads to draw for a string, either owned by the cache or pointing into caller scratch memory.
+ */
+struct TextRunView {
+    TextUiVertex* vertices;
+    i32 quad_count;
+    Vec2f end_cursor;
+};
+
+// --------------------------
+// Function implementations
+
+u32 TextRunKeyHash(TextRunKey* key) {
+    u64 hash = HashFnv1a(&key->font_id, sizeof(key->font_id), key->text_hash);
+    hash = HashFnv1a(&key->position, sizeof(key->position), hash);
+    hash = HashFnv1a(&key->viewport_size, sizeof(key->viewport_size), hash);
+    return (u32)(hash ^ (hash >> 32));
+}
+
+TextRunKey TextRunMakeKey(char* text, u64 font_id, Vec2f position, Vec2i viewport_size) {
+    size_t length = strlen(text);
+
+    // The key is hashed and matched by its bytes, adding zero turns -0 into 0 so both find the same run
+    TextRunKey result = {
+        .text_hash = HashFnv1a(text, length),
+        .font_id = font_id,
+        .position = { position.x + 0.0f, position.y + 0.0f },
+        .viewport_size = viewport_size,
+        .text_length = (i32)length
+    };
+    return result;
+}
+
+/**
+ * @brief True if 'run' was laid out for 'key' and 'text'. Positions compare by bits like TextRunKeyHash, so a NaN matches itself.
+ */
+bool TextRunMatches(TextRun* run, TextRunKey* key, char* text) {
+    TextRunKey* k = &run->key;
+    return k->text_hash == key->text_hash
+        && k->text_length == key->text_length
+        && k->font_id == key->font_id
+        && memcmp(&k->position, &key->position, sizeof(k->position)) == 0
+        && k->viewport_size.x == key->viewport_size.x
+        && k->viewport_size.y == key->viewport_size.y
+        && memcmp(run->text, text, key->text_length) == 0;
+}
+
+bool TextRunCacheCreate(TextRunCache* cache, i32 run_capacity, size_t byte_budget) {
+    if (run_capacity <= 0) {
+        return false;
+    }
+
+    u32 index_size = 16;
+    while (index_size < (u32)run_capacity * 2) {
+        index_size *= 2;
+    }
+
+    cache->runs = (TextRun*)calloc(run_capacity, sizeof(TextRun));
+    cache->run_index = (i32*)malloc(sizeof(i32) * index_size);
+    if (!cache->runs || !cache->run_index) {
+        free(cache->runs);
+        free(cache->run_index);
+        cache->runs = nullptr;
+        cache->run_index = nullptr;
+        return false;
+    }
+
+    for (u32 i = 0; i < index_size; i++) {
+        cache->run_index[i] = TEXT_RUN_SLOT_EMPTY;
+    }
+
+    cache->run_capacity = run_capacity;
+    cache->run_count = 0;
+    cache->run_index_mask = index_size - 1;
+    cache->byte_budget = byte_budget;
+    cache->bytes_used = 0;
+    cache->tick = 0;
+    cache->hits = 0;
+    cache->misses = 0;
+    return true;
+}
+
+/**
+ * @brief Find index slot holding a matching run, or the empty slot where it would be inserted.
+ */
+u32 TextRunCacheFindIndexSlot(TextRunCache* cache, TextRunKey* key, char* text) {
+    u32 slot = TextRunKeyHash(key) & cache->run_index_mask;
+    while (true) {
+        i32 run_id = cache->run_index[slot];
+        if (run_id == TEXT_RUN_SLOT_EMPTY || TextRunMatches(&cache->runs[run_id], key, text)) {
+            return slot;
+        }
+        slot = (slot + 1) & cache->run_index_mask;
+    }
+}
+
+void TextRunCacheRemoveIndexSlot(TextRunCache* cache, u32 slot) {
+    // Same backward shift deletion as the tilemap chunk index
+    u32 mask = cache->run_index_mask;
+    u32 hole = slot;
+    u32 next = (slot + 1) & mask;
+
+    while (cache->run_index[next] != TEXT_RUN_SLOT_EMPTY) {
+        TextRun* run = &cache->runs[cache->run_index[next]];
+        u32 home = TextRunKeyHash(&run->key) & mask;
+        u32 distance_to_hole = (hole - home) & mask;
+        u32 distance_to_next = (next - home) & mask;
+
+        if (distance_to_hole < distance_to_next) {
+            cache->run_index[hole] = cache->run_index[next];
+            hole = next;
+        }
+        next = (next + 1) & mask;
+    }
+
+    cache->run_index[hole] = TEXT_RUN_SLOT_EMPTY;
+}
+
+void TextRunCacheEvict(TextRunCache* cache, i32 run_id) {
+    TextRun* run = &cache->runs[run_id];
+    u32 slot = TextRunCacheFindIndexSlot(cache, &run->key, run->text);
+    TextRunCacheRemoveIndexSlot(cache, slot);
+
+    free(run->vertices);
+    cache->bytes_used -= run->byte_size;
+    cache->run_count--;
+    *run = {};
+}
+
+/**
+ * @brief Evict the least recently used run. Returns its freed run id, or -1 if the cache is empty.
+ */
+i32 TextRunCacheEvictOldest(TextRunCache* cache) {
+    i32 oldest = -1;
+    for (i32 i = 0; i < cache->run_capacity; i++) {
+        TextRun* run = &cache->runs[i];
+        if (run->is_used && (oldest < 0 || run->last_used_tick < cache->runs[oldest].last_used_tick)) {
+            oldest = i;
+        }
+    }
+
+    if (0 <= oldest) {
+        TextRunCacheEvict(cache, oldest);
+    }
+    return oldest;
+}
+
+void TextRunCacheClear(TextRunCache* cache) {
+    for (i32 i = 0; i < cache->run_capacity; i++) {
+        if (cache->runs[i].is_used) {
+            TextRunCacheEvict(cache, i);
+        }
+    }
+}
+
+void TextRunCacheDestroy(TextRunCache* cache) {
+    if (cache->runs) {
+        TextRunCacheClear(cache);
+    }
+    free(cache->runs);
+    free(cache->run_index);
+    *cache = {};
+}
+
+/**
+ * @brief Look up a run, counting the result towards the hit rate. Returns nullptr on a miss.
+ */
+TextRun* TextRunCacheFind(TextRunCache* cache, TextRunKey* key, char* text) {
+    u32 slot = TextRunCacheFindIndexSlot(cache, key, text);
+    i32 run_id = cache->run_index[slot];
+    if (run_id == TEXT_RUN_SLOT_EMPTY) {
+        cache->misses++;
+        return nullptr;
+    }
+
+    TextRun* run = &cache->runs[run_id];
+    run->last_used_tick = ++cache->tick;
+    cache->hits++;
+    return run;
+}
+
+/**
+ * @brief Store a copy of laid out quads. Returns nullptr if the run alone exceeds the byte budget or allocation fails.
+ */
+TextRun* TextRunCacheInsert(TextRunCache* cache, TextRunKey* key, char* text, TextUiVertex* vertices, i32 quad_count, Vec2f end_cursor) {
+    size_t vertex_bytes = sizeof(TextUiVertex) * QUAD_VERTEX_COUNT * (size_t)quad_count;
+    size_t byte_size = vertex_bytes + (size_t)key->text_length;
+    if (cache->byte_budget < byte_size) {
+        return nullptr;
+    }
+
+    while (cache->byte_budget < cache->bytes_used + byte_size || cache->run_capacity <= cache->run_count) {
+        TextRunCacheEvictOldest(cache);
+    }
+
+    i32 run_id = 0;
+    while (cache->runs[run_id].is_used) {
+        run_id++;
+    }
+
+    // Vertices and the string copy share one allocation
+    byte* memory = (byte*)malloc(byte_size == 0 ? 1 : byte_size);
+    if (!memory) {
+        return nullptr;
+    }
+
+    TextRun* run = &cache->runs[run_id];
+    run->key = *key;
+    run->last_used_tick = ++cache->tick;
+    run->is_used = true;
+    run->quad_count = quad_count;
+    run->end_cursor = end_cursor;
+    run->vertices = (TextUiVertex*)memory;
+    run->text = (char*)(memory + vertex_bytes);
+    run->byte_size = byte_size;
+    memcpy(run->vertices, vertices, vertex_bytes);
+    memcpy(run->text, text, key->text_length);
+
+    u32 slot = TextRunCacheFindIndexSlot(cache, key, text);
+    cache->run_index[slot] = run_id;
+    cache->run_count++;
+    cache->bytes_used += byte_size;
+    return run;
+}
+
+/**
+ * @brief Get glyph quads for 'text', laying it out into 'scratch' and caching the result on a miss.
+ *
+ * 'scratch' must hold QUAD_VERTEX_COUNT vertices per character of 'text'.
+ */
+TextRunView TextRunCacheLayout(TextRunCache* cache, char* text, Vec2f screen_pos, u64 font_id, FontGlyphInfo* glyphs, i32 font_size_px, Vec2i viewport_size, TextUiVertex* scratch) {
+    TextRunKey key = TextRunMakeKey(text, font_id, screen_pos, viewport_size);
+
+    TextRun* run = TextRunCacheFind(cache, &key, text);
+    if (run) {
+        return TextRunView{ run->vertices, run->quad_count, run->end_cursor };
+    }
+
+    TextRunView result = {};
+    result.vertices = scratch;
+    result.quad_count = TextLayoutString(text, screen_pos, glyphs, font_size_px, viewport_size, scratch, &result.end_cursor);
+    TextRunCacheInsert(cache, &key, text, scratch, result.quad_count, result.end_cursor);
+    return result;
+}
+
+f32 TextRunCacheHitRate(TextRunCache* cache) {
+    u64 lookups = cache->hits + cache->misses;
+    return lookups == 0 ? 0.0f : (f32)cache->hits / (f32)lookups;
+}
+
+void TextRunCacheResetStats(TextRunCache* cache) {
+    cache->hits = 0;
+    cache->misses = 0;
+}
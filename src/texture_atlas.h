@@ -0,0 +1,218 @@
+#pragma once
+
+// ----------
+// Includes
+
+#include "types.h"
+#include "hash.h"
+
+// Binary atlas manifest written by tools/atlas_packer.cpp. Everything is little-endian and 4 byte aligned:
+//
+//   TextureAtlasHeader
+//   TextureAtlasPage   pages[page_count]
+//   TextureAtlasRegion regions[region_count]
+//   u32                slots[slot_count]      open addressing table of region indices by name hash
+//   char               strings[string_bytes]  zero terminated page file names and region names
+//
+// The slot table is built offline, so resolving a sprite name at runtime is one hash and a short probe.
+
+// ---------
+// Defines
+
+const u32 TEXTURE_ATLAS_MAGIC = 0x4C544146; // "FATL"
+const u32 TEXTURE_ATLAS_VERSION = 1;
+const u32 TEXTURE_ATLAS_SLOT_EMPTY = 0xFFFFFFFFu;
+
+// ---------
+// Structs
+
+struct TextureAtlasHeader {
+    u32 magic;
+    u32 version;
+    u32 page_count;
+    u32 region_count;
+    u32 slot_count;
+    u32 string_bytes;
+    u32 reserved[2];
+};
+
+/**
+ * @brief One atlas page image. 'name_offset' points to its file name, relative to the manifest.
+ */
+struct TextureAtlasPage {
+    u32 name_offset;
+    u16 width;
+    u16 height;
+};
+
+/**
+ * @brief Named sub-rectangle of a page in pixels, origin at the page's top-left corner.
+ */
+struct TextureAtlasRegion {
+    u64 name_hash;
+    u32 name_offset;
+    u16 page;
+    u16 reserved;
+    u16 x;
+    u16 y;
+    u16 width;
+    u16 height;
+};
+
+static_assert(sizeof(TextureAtlasHeader) == 32, "TextureAtlasHeader is not 32 bytes");
+static_assert(sizeof(TextureAtlasPage) == 8, "TextureAtlasPage is not 8 bytes");
+static_assert(sizeof(TextureAtlasRegion) == 24, "TextureAtlasRegion is not 24 bytes");
+
+/**
+ * @brief Loaded manifest. All pointers point into 'data', which the atlas owns.
+ */
+struct TextureAtlas {
+    byte* data = nullptr;
+    size_t data_size = 0;
+    TextureAtlasHeader* header = nullptr;
+    TextureAtlasPage* pages = nullptr;
+    TextureAtlasRegion* regions = nullptr;
+    u32* slots = nullptr;
+    char* strings = nullptr;
+};
+
+// --------------------------
+// Function implementations
+
+/**
+ * @brief FNV-1a hash of a zero terminated name.
+ */
+u64 TextureAtlasHashName(const char* name) {
+    return HashFnv1aString(name);
+}
+
+size_t TextureAtlasManifestSize(u32 page_count, u32 region_count, u32 slot_count, u32 string_bytes) {
+    return sizeof(TextureAtlasHeader)
+        + sizeof(TextureAtlasPage) * (size_t)page_count
+        + sizeof(TextureAtlasRegion) * (size_t)region_count
+        + sizeof(u32) * (size_t)slot_count
+        + string_bytes;
+}
+
+/**
+ * @brief Take ownership of manifest bytes allocated with malloc. Returns false and frees nothing if the data is not a valid manifest.
+ *
+ * Pages of zero width or height and slot tables without an empty slot are not valid.
+ */
+bool TextureAtlasLoadFromMemory(TextureAtlas* atlas, byte* data, size_t data_size) {
+    *atlas = {};
+    if (data_size < sizeof(TextureAtlasHeader)) {
+        return false;
+    }
+
+    TextureAtlasHeader* header = (TextureAtlasHeader*)data;
+    bool is_slot_count_valid = header->slot_count != 0 && (header->slot_count & (header->slot_count - 1)) == 0 && header->region_count < header->slot_count;
+    if (header->magic != TEXTURE_ATLAS_MAGIC || header->version != TEXTURE_ATLAS_VERSION || !is_slot_count_valid) {
+        return false;
+    }
+
+    size_t expected_size = TextureAtlasManifestSize(header->page_count, header->region_count, header->slot_count, header->string_bytes);
+    if (data_size < expected_size || header->string_bytes == 0) {
+        return false;
+    }
+
+    byte* cursor = data + sizeof(TextureAtlasHeader);
+    TextureAtlasPage* pages = (TextureAtlasPage*)cursor;
+    cursor += sizeof(TextureAtlasPage) * header->page_count;
+    TextureAtlasRegion* regions = (TextureAtlasRegion*)cursor;
+    cursor += sizeof(TextureAtlasRegion) * header->region_count;
+    u32* slots = (u32*)cursor;
+    cursor += sizeof(u32) * header->slot_count;
+    char* strings = (char*)cursor;
+
+    // Offsets are trusted after this, the lookup does no further bounds checks
+    if (strings[header->string_bytes - 1] != '\0') {
+        return false;
+    }
+    for (u32 i = 0; i < header->page_count; i++) {
+        if (header->string_bytes <= pages[i].name_offset || pages[i].width == 0 || pages[i].height == 0) {
+            return false;
+        }
+    }
+    for (u32 i = 0; i < header->region_count; i++) {
+        TextureAtlasRegion* region = &regions[i];
+        if (header->string_bytes <= region->name_offset || header->page_count <= region->page) {
+            return false;
+        }
+        TextureAtlasPage* page = &pages[region->page];
+        if (page->width < region->x + region->width || page->height < region->y + region->height) {
+            return false;
+        }
+    }
+    // A probe stops at an empty slot, a table without one would never end a miss
+    u32 empty_slot_count = 0;
+    for (u32 i = 0; i < header->slot_count; i++) {
+        if (slots[i] == TEXTURE_ATLAS_SLOT_EMPTY) {
+            empty_slot_count++;
+        }
+        else if (header->region_count <= slots[i]) {
+            return false;
+        }
+    }
+    if (empty_slot_count == 0) {
+        return false;
+    }
+
+    atlas->data = data;
+    atlas->data_size = data_size;
+    atlas->header = header;
+    atlas->pages = pages;
+    atlas->regions = regions;
+    atlas->slots = slots;
+    atlas->strings = strings;
+    return true;
+}
+
+void TextureAtlasDestroy(TextureAtlas* atlas) {
+    free(atlas->data);
+    *atlas = {};
+}
+
+char* TextureAtlasPageName(TextureAtlas* atlas, u32 page) {
+    return atlas->strings + atlas->pages[page].name_offset;
+}
+
+char* TextureAtlasRegionName(TextureAtlas* atlas, TextureAtlasRegion* region) {
+    return atlas->strings + region->name_offset;
+}
+
+/**
+ * @brief Find region by sprite name. Returns nullptr if there is no such region.
+ */
+TextureAtlasRegion* TextureAtlasFind(TextureAtlas* atlas, const char* name) {
+    if (!atlas->header) {
+        return nullptr;
+    }
+
+    u64 hash = TextureAtlasHashName(name);
+    u32 mask = atlas->header->slot_count - 1;
+    u32 slot = (u32)hash & mask;
+
+    for (u32 probe = 0; probe < atlas->header->slot_count && atlas->slots[slot] != TEXTURE_ATLAS_SLOT_EMPTY; probe++) {
+        TextureAtlasRegion* region = &atlas->regions[atlas->slots[slot]];
+        if (region->name_hash == hash && strcmp(atlas->strings + region->name_offset, name) == 0) {
+            return region;
+        }
+        slot = (slot + 1) & mask;
+    }
+    return nullptr;
+}
+
+/**
+ * @brief UV rectangle (u0, v0, u1, v1) of a region on its page.
+ */
+Vec4f TextureAtlasRegionUVRect(TextureAtlas* atlas, TextureAtlasRegion* region) {
+    TextureAtlasPage* page = &atlas->pages[region->page];
+    Vec4f result = {
+        .x = (f32)region->x / (f32)page->width,
+        .y = (f32)region->y / (f32)page->height,
+        .z = (f32)(region->x + region->width) / (f32)page->width,
+        .w = (f32)(region->y + region->height) / (f32)page->height
+    };
+    return result;
+}
@@ -0,0 +1,308 @@
+#pragma once
+
+// ----------
+// Includes
+
+#include <stdlib.h>
+
+#include "types.h"
+#include "mipmap.h"
+
+// Decides which mip levels of which textures stay in video memory under a byte budget. Textures are numbered
+// by the caller, the draw paths stamp the ones they use each frame and TextureResidencyUpdate runs once per
+// frame after drawing:
+//
+//   - Textures drawn this frame gain at least one more detailed level per update, the ones missing the most
+//     detail first, so everything on screen gets its small levels before anything gets its large ones.
+//   - A load reads and decodes the whole file, so budget still free once every promoted texture has its
+//     level, minus what the ones left for a later update need for theirs, extends the loads further in the
+//     same order. A texture that fits is promoted to level 0 with one load instead of one load per level.
+//   - When a level does not fit, the textures unused for the longest drop everything above their mip tail.
+//     Textures drawn this frame are never evicted.
+//
+// The mip tail, the smallest levels up to TEXTURE_RESIDENCY_TAIL_BYTES, always stays resident so there is
+// something to draw. Nothing here touches a graphics API, a TextureResidencyBackend does the loading.
+
+// ---------
+// Defines
+
+const u64 TEXTURE_RESIDENCY_TAIL_BYTES = 64 * 1024;
+const u64 TEXTURE_RESIDENCY_INDEX_MASK = 0xFFFFFFFFull;
+
+// ---------
+// Structs
+
+struct TextureResidencyEntry {
+    bool is_tracked;
+    i32 level_count;
+    u64 level_bytes[MIPMAP_MAX_LEVELS];
+    i32 tail_level;
+    i32 resident_level;
+    i32 loading_level;
+    u64 last_used_frame;
+};
+
+/**
+ * @brief Graphics side of residency. Levels [top_level, level_count) are resident after either call.
+ *
+ * 'load' may finish later, the backend reports it with TextureResidencyLoaded. 'evict' drops levels right away
+ * and returns false if the texture can not start at 'top_level', which keeps it as it is.
+ */
+struct TextureResidencyBackend {
+    void* user_data;
+    void (*load)(void* user_data, u32 texture, i32 top_level);
+    bool (*evict)(void* user_data, u32 texture, i32 top_level);
+};
+
+struct TextureResidencyStats {
+    u64 resident_bytes;
+    u64 committed_bytes;
+    i32 tracked_count;
+    i32 loads;
+    i32 evictions;
+    i32 over_budget_updates;
+};
+
+struct TextureResidency {
+    TextureResidencyEntry* entries = nullptr;
+    u32 capacity = 0;
+    u64 budget_bytes = 0;
+    i32 max_loads_per_update = 0;
+    u64 frame = 0;
+
+    // Sort keys rebuilt every update
+    u64* promotions = nullptr;
+    u64* victims = nullptr;
+
+    TextureResidencyStats stats = {};
+};
+
+// --------------------------
+// Function implementations
+
+/**
+ * @brief Track up to 'capacity' textures numbered 0..capacity-1. At most 'max_loads_per_update' loads start per update.
+ */
+bool TextureResidencyCreate(TextureResidency* residency, u32 capacity, u64 budget_bytes, i32 max_loads_per_update) {
+    residency->entries = (TextureResidencyEntry*)calloc(capacity, sizeof(TextureResidencyEntry));
+    residency->promotions = (u64*)malloc(sizeof(u64) * capacity);
+    residency->victims = (u64*)malloc(sizeof(u64) * capacity);
+    residency->capacity = capacity;
+    residency->budget_bytes = budget_bytes;
+    residency->max_loads_per_update = max_loads_per_update;
+    residency->frame = 0;
+    residency->stats = {};
+    return residency->entries && residency->promotions && residency->victims;
+}
+
+void TextureResidencyDestroy(TextureResidency* residency) {
+    free(residency->entries);
+    free(residency->promotions);
+    free(residency->victims);
+    *residency = {};
+}
+
+/**
+ * @brief Bytes of levels [top_level, level_count).
+ */
+u64 TextureResidencyBytesFrom(TextureResidencyEntry* entry, i32 top_level) {
+    u64 bytes = 0;
+    for (i32 level = top_level; level < entry->level_count; level++) {
+        bytes += entry->level_bytes[level];
+    }
+    return bytes;
+}
+
+/**
+ * @brief Start tracking a texture whose levels [resident_level, level_count) are resident.
+ */
+void TextureResidencyTrack(TextureResidency* residency, u32 texture, const u64* level_bytes, i32 level_count, i32 resident_level) {
+    if (residency->capacity <= texture || level_count < 1 || MIPMAP_MAX_LEVELS < level_count) {
+        return;
+    }
+
+    TextureResidencyEntry* entry = &residency->entries[texture];
+    *entry = {};
+    entry->is_tracked = true;
+    entry->level_count = level_count;
+    for (i32 level = 0; level < level_count; level++) {
+        entry->level_bytes[level] = level_bytes[level];
+    }
+
+    // The tail is the most detailed level that still fits the tail size together with everything below it
+    entry->tail_level = level_count - 1;
+    while (0 < entry->tail_level && TextureResidencyBytesFrom(entry, entry->tail_level - 1) <= TEXTURE_RESIDENCY_TAIL_BYTES) {
+        entry->tail_level--;
+    }
+
+    entry->resident_level = resident_level;
+    entry->loading_level = resident_level;
+    entry->last_used_frame = residency->frame;
+}
+
+void TextureResidencyUntrack(TextureResidency* residency, u32 texture) {
+    if (texture < residency->capacity) {
+        residency->entries[texture] = {};
+    }
+}
+
+/**
+ * @brief Mark a texture as drawn this frame. Untracked textures are ignored.
+ */
+void TextureResidencyTouch(TextureResidency* residency, u32 texture) {
+    if (texture < residency->capacity) {
+        residency->entries[texture].last_used_frame = residency->frame;
+    }
+}
+
+/**
+ * @brief A load started by the backend finished with levels [top_level, level_count) resident.
+ */
+void TextureResidencyLoaded(TextureResidency* residency, u32 texture, i32 top_level) {
+    if (texture < residency->capacity && residency->entries[texture].is_tracked) {
+        residency->entries[texture].resident_level = top_level;
+        residency->entries[texture].loading_level = top_level;
+    }
+}
+
+/**
+ * @brief A load started by the backend failed, the texture keeps its resident levels.
+ */
+void TextureResidencyLoadFailed(TextureResidency* residency, u32 texture) {
+    if (texture < residency->capacity && residency->entries[texture].is_tracked) {
+        residency->entries[texture].loading_level = residency->entries[texture].resident_level;
+    }
+}
+
+/**
+ * @brief Top level of the smallest promotion of a texture. One at or past its tail gets the whole tail at once.
+ */
+i32 TextureResidencyNextLevel(TextureResidencyEntry* entry) {
+    return entry->tail_level < entry->resident_level ? entry->tail_level : entry->resident_level - 1;
+}
+
+int TextureResidencyCompareKeys(const void* a, const void* b) {
+    u64 key_a = *(const u64*)a;
+    u64 key_b = *(const u64*)b;
+    return key_a < key_b ? -1 : (key_b < key_a ? 1 : 0);
+}
+
+/**
+ * @brief Evict the least recently used victims until 'needed_bytes' more fit in the budget. Returns false if they do not.
+ */
+bool TextureResidencyMakeRoom(TextureResidency* residency, TextureResidencyBackend* backend, u64 needed_bytes, i32 victim_count, i32* next_victim) {
+    while (residency->budget_bytes < residency->stats.committed_bytes + needed_bytes) {
+        if (victim_count <= *next_victim) {
+            return false;
+        }
+
+        u32 texture = (u32)(residency->victims[(*next_victim)++] & TEXTURE_RESIDENCY_INDEX_MASK);
+        TextureResidencyEntry* entry = &residency->entries[texture];
+        if (!backend->evict(backend->user_data, texture, entry->tail_level)) {
+            continue;
+        }
+
+        residency->stats.committed_bytes -= TextureResidencyBytesFrom(entry, entry->resident_level) - TextureResidencyBytesFrom(entry, entry->tail_level);
+        entry->resident_level = entry->tail_level;
+        entry->loading_level = entry->tail_level;
+        residency->stats.evictions++;
+    }
+    return true;
+}
+
+/**
+ * @brief Start loads and evictions for this frame, then advance to the next frame. Call after everything was drawn.
+ */
+void TextureResidencyUpdate(TextureResidency* residency, TextureResidencyBackend* backend) {
+    u64 frame = residency->frame;
+    i32 promotion_count = 0;
+    i32 victim_count = 0;
+    residency->stats.committed_bytes = 0;
+    residency->stats.tracked_count = 0;
+
+    for (u32 texture = 0; texture < residency->capacity; texture++) {
+        TextureResidencyEntry* entry = &residency->entries[texture];
+        if (!entry->is_tracked) {
+            continue;
+        }
+
+        // Loads in flight already count against the budget
+        residency->stats.tracked_count++;
+        residency->stats.committed_bytes += TextureResidencyBytesFrom(entry, entry->loading_level);
+
+        bool is_idle = entry->loading_level == entry->resident_level;
+        if (!is_idle) {
+            continue;
+        }
+
+        if (entry->last_used_frame == frame) {
+            if (0 < entry->resident_level) {
+                // Most missing detail first, the level index is inverted so that sorting ascending puts it in front
+                u64 missing = (u64)(MIPMAP_MAX_LEVELS - entry->resident_level);
+                residency->promotions[promotion_count++] = (missing << 32) | texture;
+            }
+        }
+        else if (entry->resident_level < entry->tail_level) {
+            // Oldest first. Frame numbers fit the upper 32 bits for over two years at 60 frames per second
+            residency->victims[victim_count++] = (entry->last_used_frame << 32) | texture;
+        }
+    }
+
+    qsort(residency->promotions, promotion_count, sizeof(u64), TextureResidencyCompareKeys);
+    qsort(residency->victims, victim_count, sizeof(u64), TextureResidencyCompareKeys);
+
+    // A lowered budget is enforced even when nothing wants to load
+    i32 next_victim = 0;
+    TextureResidencyMakeRoom(residency, backend, 0, victim_count, &next_victim);
+
+    // The accepted loads are written over the front of 'promotions', which is never ahead of the read
+    i32 load_count = 0;
+    i32 next_promotion = 0;
+    for (; next_promotion < promotion_count && load_count < residency->max_loads_per_update; next_promotion++) {
+        u32 texture = (u32)(residency->promotions[next_promotion] & TEXTURE_RESIDENCY_INDEX_MASK);
+        TextureResidencyEntry* entry = &residency->entries[texture];
+
+        i32 top_level = TextureResidencyNextLevel(entry);
+        u64 needed_bytes = TextureResidencyBytesFrom(entry, top_level) - TextureResidencyBytesFrom(entry, entry->resident_level);
+        if (!TextureResidencyMakeRoom(residency, backend, needed_bytes, victim_count, &next_victim)) {
+            continue;
+        }
+
+        entry->loading_level = top_level;
+        residency->stats.committed_bytes += needed_bytes;
+        residency->promotions[load_count++] = texture;
+    }
+
+    // Textures past the load limit keep room for their next level
+    u64 reserved_bytes = 0;
+    for (i32 i = next_promotion; i < promotion_count; i++) {
+        TextureResidencyEntry* entry = &residency->entries[residency->promotions[i] & TEXTURE_RESIDENCY_INDEX_MASK];
+        reserved_bytes += TextureResidencyBytesFrom(entry, TextureResidencyNextLevel(entry)) - TextureResidencyBytesFrom(entry, entry->resident_level);
+    }
+
+    // Free budget extends the loads without evicting anything more
+    for (i32 i = 0; i < load_count; i++) {
+        u32 texture = (u32)residency->promotions[i];
+        TextureResidencyEntry* entry = &residency->entries[texture];
+        while (0 < entry->loading_level && residency->stats.committed_bytes + reserved_bytes + entry->level_bytes[entry->loading_level - 1] <= residency->budget_bytes) {
+            entry->loading_level--;
+            residency->stats.committed_bytes += entry->level_bytes[entry->loading_level];
+        }
+
+        residency->stats.loads++;
+        backend->load(backend->user_data, texture, entry->loading_level);
+    }
+
+    residency->stats.resident_bytes = 0;
+    for (u32 texture = 0; texture < residency->capacity; texture++) {
+        TextureResidencyEntry* entry = &residency->entries[texture];
+        if (entry->is_tracked) {
+            residency->stats.resident_bytes += TextureResidencyBytesFrom(entry, entry->resident_level);
+        }
+    }
+    if (residency->budget_bytes < residency->stats.committed_bytes) {
+        residency->stats.over_budget_updates++;
+    }
+
+    residency->frame++;
+}
@@ -0,0 +1,675 @@
+#pragma once
+
+// ----------
+// Includes
+
+#include <math.h>
+
+#include "types.h"
+
+// ---------
+// Defines
+
+const i32 TILEMAP_CHUNK_SIZE = 32;
+const i32 TILEMAP_CHUNK_TILE_COUNT = TILEMAP_CHUNK_SIZE * TILEMAP_CHUNK_SIZE;
+
+const i32 TILEMAP_CHUNK_SLOT_EMPTY = -1;
+
+// ---------
+// Structs
+
+struct Tile {
+    i32 type;
+};
+
+struct TilemapChunk {
+    Vec2i coord;
+    u64 last_used_frame = 0;
+    bool is_loaded = false;
+    bool is_modified = false;
+    bool is_mesh_dirty = false;
+    Tile tiles[TILEMAP_CHUNK_TILE_COUNT];
+};
+
+/**
+ * @brief Fill tiles of a chunk that is being brought into memory.
+ */
+typedef void (*TilemapChunkLoadFn)(void* user_data, Vec2i chunk_coord, Tile* tiles);
+
+/**
+ * @brief Receive tiles of a modified chunk that is being evicted from memory.
+ */
+typedef void (*TilemapChunkStoreFn)(void* user_data, Vec2i chunk_coord, Tile* tiles);
+
+/**
+ * @brief World tilemap split into fixed size chunks.
+ *
+ * Only 'chunk_capacity' chunks are resident at a time. Resident chunks are found
+ * through an open addressing hash index keyed by chunk coordinate, and the least
+ * recently used chunk is evicted when a new one is needed.
+ */
+struct Tilemap {
+    i32 width = 0;
+    i32 height = 0;
+    i32 chunk_capacity = 0;
+    i32 loaded_chunk_count = 0;
+    TilemapChunk* chunks = nullptr;
+    i32* chunk_index = nullptr;
+    u32 chunk_index_mask = 0;
+    u64 frame = 0;
+    TilemapChunkLoadFn load_chunk = nullptr;
+    TilemapChunkStoreFn store_chunk = nullptr;
+    void* user_data = nullptr;
+};
+
+/**
+ * @brief Tiles of chunks that were modified and then evicted, kept in memory until their chunk is loaded again.
+ *
+ * Used as the tilemap backing store so edits survive eviction. Open addressing hash keyed by chunk coordinate.
+ * At most 'max_count' chunks are held, so edits fit a fixed budget like resident chunks do. When a new chunk
+ * would go over it, the least recently used one is handed to 'spill_chunk' and dropped, without a spill
+ * callback the new chunk is refused.
+ */
+struct TilemapChunkStore {
+    Vec2i* coords = nullptr;
+    Tile** tiles = nullptr;
+    u64* used_ticks = nullptr;
+    u32 capacity = 0;
+    u32 count = 0;
+    u32 max_count = 0;
+    u32 spilled_count = 0;
+    u64 tick = 0;
+    TilemapChunkStoreFn spill_chunk = nullptr;
+    void* user_data = nullptr;
+};
+
+// --------------------------
+// Function implementations
+
+Vec2f ScreenSpaceToTilemapCoords(Vec2f screen_coord) {
+    float x_tile = (screen_coord.x + 2.0f * screen_coord.y) / 2.0f;
+    float y_tile = (2.0f * screen_coord.y - screen_coord.x) / 2.0f;
+    Vec2f result = {x_tile, y_tile};
+    return result;
+}
+
+Vec2f TilemapCoordsToIsometricScreenSpace(Vec2f tilemap_coord) {
+    const float y_offset = 0.5f; // So that 0,0 coord is the bottom corner of tile
+    float x = (tilemap_coord.y * (-1.0f)) + (tilemap_coord.x * (1.0f));
+    float y = (tilemap_coord.y * (0.5f))  + (tilemap_coord.x * (0.5f)) + y_offset;
+    Vec2f result = {x, y};
+    return result;
+}
+
+u32 TilemapChunkHash(Vec2i chunk_coord) {
+    u64 key = ((u64)(u32)chunk_coord.x << 32) | (u64)(u32)chunk_coord.y;
+    key ^= key >> 33;
+    key *= 0xff51afd7ed558ccdULL;
+    key ^= key >> 33;
+    return (u32)key;
+}
+
+/**
+ * @brief Allocate a tilemap of 'width' x 'height' tiles that keeps at most 'chunk_capacity' chunks in memory.
+ */
+bool TilemapCreate(Tilemap* tilemap, i32 width, i32 height, i32 chunk_capacity) {
+    if (width <= 0 || height <= 0 || chunk_capacity <= 0) {
+        return false;
+    }
+
+    u32 index_size = 16;
+    while (index_size < (u32)chunk_capacity * 2) {
+        index_size *= 2;
+    }
+
+    tilemap->chunks = (TilemapChunk*)calloc(chunk_capacity, sizeof(TilemapChunk));
+    tilemap->chunk_index = (i32*)malloc(sizeof(i32) * index_size);
+    if (!tilemap->chunks || !tilemap->chunk_index) {
+        free(tilemap->chunks);
+        free(tilemap->chunk_index);
+        tilemap->chunks = nullptr;
+        tilemap->chunk_index = nullptr;
+        return false;
+    }
+
+    for (u32 i = 0; i < index_size; i++) {
+        tilemap->chunk_index[i] = TILEMAP_CHUNK_SLOT_EMPTY;
+    }
+
+    tilemap->width = width;
+    tilemap->height = height;
+    tilemap->chunk_capacity = chunk_capacity;
+    tilemap->chunk_index_mask = index_size - 1;
+    tilemap->loaded_chunk_count = 0;
+    tilemap->frame = 0;
+    return true;
+}
+
+void TilemapDestroy(Tilemap* tilemap) {
+    free(tilemap->chunks);
+    free(tilemap->chunk_index);
+    tilemap->chunks = nullptr;
+    tilemap->chunk_index = nullptr;
+    tilemap->chunk_capacity = 0;
+    tilemap->loaded_chunk_count = 0;
+}
+
+bool TilemapContains(Tilemap* tilemap, i32 x, i32 y) {
+    return 0 <= x && 0 <= y && x < tilemap->width && y < tilemap->height;
+}
+
+Vec2i TilemapChunkCount(Tilemap* tilemap) {
+    Vec2i result = {
+        .x = (tilemap->width + TILEMAP_CHUNK_SIZE - 1) / TILEMAP_CHUNK_SIZE,
+        .y = (tilemap->height + TILEMAP_CHUNK_SIZE - 1) / TILEMAP_CHUNK_SIZE
+    };
+    return result;
+}
+
+/**
+ * @brief Return index slot holding 'chunk_coord', or the empty slot where it would be inserted.
+ */
+u32 TilemapFindIndexSlot(Tilemap* tilemap, Vec2i chunk_coord) {
+    u32 slot = TilemapChunkHash(chunk_coord) & tilemap->chunk_index_mask;
+    while (true) {
+        i32 chunk_id = tilemap->chunk_index[slot];
+        if (chunk_id == TILEMAP_CHUNK_SLOT_EMPTY) {
+            return slot;
+        }
+
+        TilemapChunk* chunk = &tilemap->chunks[chunk_id];
+        if (chunk->coord.x == chunk_coord.x && chunk->coord.y == chunk_coord.y) {
+            return slot;
+        }
+
+        slot = (slot + 1) & tilemap->chunk_index_mask;
+    }
+}
+
+void TilemapRemoveIndexSlot(Tilemap* tilemap, u32 slot) {
+    // Backward shift deletion keeps linear probing chains intact without tombstones
+    u32 mask = tilemap->chunk_index_mask;
+    u32 hole = slot;
+    u32 next = (slot + 1) & mask;
+
+    while (tilemap->chunk_index[next] != TILEMAP_CHUNK_SLOT_EMPTY) {
+        TilemapChunk* chunk = &tilemap->chunks[tilemap->chunk_index[next]];
+        u32 home = TilemapChunkHash(chunk->coord) & mask;
+        u32 distance_to_hole = (hole - home) & mask;
+        u32 distance_to_next = (next - home) & mask;
+
+        if (distance_to_hole < distance_to_next) {
+            tilemap->chunk_index[hole] = tilemap->chunk_index[next];
+            hole = next;
+        }
+        next = (next + 1) & mask;
+    }
+
+    tilemap->chunk_index[hole] = TILEMAP_CHUNK_SLOT_EMPTY;
+}
+
+/**
+ * @brief Find a resident chunk. Returns nullptr if the chunk is not loaded.
+ */
+TilemapChunk* TilemapFindChunk(Tilemap* tilemap, Vec2i chunk_coord) {
+    u32 slot = TilemapFindIndexSlot(tilemap, chunk_coord);
+    i32 chunk_id = tilemap->chunk_index[slot];
+    if (chunk_id == TILEMAP_CHUNK_SLOT_EMPTY) {
+        return nullptr;
+    }
+    return &tilemap->chunks[chunk_id];
+}
+
+void TilemapEvictChunk(Tilemap* tilemap, i32 chunk_id) {
+    TilemapChunk* chunk = &tilemap->chunks[chunk_id];
+    if (chunk->is_modified && tilemap->store_chunk) {
+        tilemap->store_chunk(tilemap->user_data, chunk->coord, chunk->tiles);
+    }
+
+    u32 slot = TilemapFindIndexSlot(tilemap, chunk->coord);
+    TilemapRemoveIndexSlot(tilemap, slot);
+
+    chunk->is_loaded = false;
+    chunk->is_modified = false;
+    tilemap->loaded_chunk_count--;
+}
+
+/**
+ * @brief Returns true if a chunk can be loaded without evicting a chunk used in the current frame.
+ *
+ * Callers that keep per chunk resources for the rest of the frame, like the chunk vertex buffers, check this
+ * before loading so a chunk they already used is not replaced under them.
+ */
+bool TilemapCanLoadChunk(Tilemap* tilemap) {
+    if (tilemap->loaded_chunk_count < tilemap->chunk_capacity) {
+        return true;
+    }
+    for (i32 i = 0; i < tilemap->chunk_capacity; i++) {
+        if (tilemap->chunks[i].last_used_frame < tilemap->frame) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Get a resident chunk, loading it and evicting the least recently used chunk if needed.
+ */
+TilemapChunk* TilemapLoadChunk(Tilemap* tilemap, Vec2i chunk_coord) {
+    TilemapChunk* found = TilemapFindChunk(tilemap, chunk_coord);
+    if (found) {
+        found->last_used_frame = tilemap->frame;
+        return found;
+    }
+
+    i32 chunk_id = -1;
+    if (tilemap->loaded_chunk_count < tilemap->chunk_capacity) {
+        for (i32 i = 0; i < tilemap->chunk_capacity; i++) {
+            if (!tilemap->chunks[i].is_loaded) {
+                chunk_id = i;
+                break;
+            }
+        }
+    }
+    else {
+        chunk_id = 0;
+        for (i32 i = 1; i < tilemap->chunk_capacity; i++) {
+            if (tilemap->chunks[i].last_used_frame < tilemap->chunks[chunk_id].last_used_frame) {
+                chunk_id = i;
+            }
+        }
+        TilemapEvictChunk(tilemap, chunk_id);
+    }
+
+    TilemapChunk* chunk = &tilemap->chunks[chunk_id];
+    chunk->coord = chunk_coord;
+    chunk->last_used_frame = tilemap->frame;
+    chunk->is_loaded = true;
+    chunk->is_modified = false;
+    chunk->is_mesh_dirty = true;
+
+    if (tilemap->load_chunk) {
+        tilemap->load_chunk(tilemap->user_data, chunk_coord, chunk->tiles);
+    }
+    else {
+        memset(chunk->tiles, 0, sizeof(chunk->tiles));
+    }
+
+    u32 slot = TilemapFindIndexSlot(tilemap, chunk_coord);
+    tilemap->chunk_index[slot] = chunk_id;
+    tilemap->loaded_chunk_count++;
+    return chunk;
+}
+
+/**
+ * @brief Get tile at tilemap coordinate, loading its chunk on demand. Returns nullptr outside the tilemap.
+ */
+Tile* TilemapGetTile(Tilemap* tilemap, i32 x, i32 y) {
+    if (!TilemapContains(tilemap, x, y)) {
+        return nullptr;
+    }
+
+    Vec2i chunk_coord = { x / TILEMAP_CHUNK_SIZE, y / TILEMAP_CHUNK_SIZE };
+    TilemapChunk* chunk = TilemapLoadChunk(tilemap, chunk_coord);
+
+    i32 local_x = x - chunk_coord.x * TILEMAP_CHUNK_SIZE;
+    i32 local_y = y - chunk_coord.y * TILEMAP_CHUNK_SIZE;
+    return &chunk->tiles[local_x + local_y * TILEMAP_CHUNK_SIZE];
+}
+
+/**
+ * @brief Set tile type and mark its chunk as modified and its mesh as dirty.
+ */
+void TilemapSetTile(Tilemap* tilemap, i32 x, i32 y, i32 type) {
+    Tile* tile = TilemapGetTile(tilemap, x, y);
+    if (!tile) {
+        return;
+    }
+
+    Vec2i chunk_coord = { x / TILEMAP_CHUNK_SIZE, y / TILEMAP_CHUNK_SIZE };
+    TilemapChunk* chunk = TilemapFindChunk(tilemap, chunk_coord);
+    if (tile->type != type) {
+        chunk->is_modified = true;
+        chunk->is_mesh_dirty = true;
+    }
+    tile->type = type;
+}
+
+/**
+ * @brief Advance the tilemap frame and keep chunks within 'radius_chunks' of 'center_tile' resident.
+ *
+ * The radius is clamped so the streamed square always fits inside the chunk budget.
+ */
+void TilemapStreamAround(Tilemap* tilemap, Vec2f center_tile, i32 radius_chunks) {
+    tilemap->frame++;
+
+    i32 max_radius = ((i32)sqrtf((f32)tilemap->chunk_capacity) - 1) / 2;
+    if (radius_chunks > max_radius) {
+        radius_chunks = max_radius;
+    }
+    if (radius_chunks < 0) {
+        radius_chunks = 0;
+    }
+
+    Vec2i chunk_count = TilemapChunkCount(tilemap);
+    i32 center_x = (i32)floorf(center_tile.x / (f32)TILEMAP_CHUNK_SIZE);
+    i32 center_y = (i32)floorf(center_tile.y / (f32)TILEMAP_CHUNK_SIZE);
+
+    for (i32 y = center_y - radius_chunks; y <= center_y + radius_chunks; y++) {
+        if (y < 0 || chunk_count.y <= y) {
+            continue;
+        }
+        for (i32 x = center_x - radius_chunks; x <= center_x + radius_chunks; x++) {
+            if (x < 0 || chunk_count.x <= x) {
+                continue;
+            }
+            TilemapLoadChunk(tilemap, Vec2i{x, y});
+        }
+    }
+}
+
+// ---------------------
+// Chunk store
+
+/**
+ * @brief Allocate an empty chunk store that holds at most 'max_count' chunks.
+ */
+bool TilemapChunkStoreCreate(TilemapChunkStore* store, u32 max_count) {
+    if (max_count == 0) {
+        return false;
+    }
+
+    // Never more than half full, the table does not grow
+    u32 size = 16;
+    while (size < max_count * 2) {
+        size *= 2;
+    }
+
+    store->coords = (Vec2i*)malloc(sizeof(Vec2i) * size);
+    store->tiles = (Tile**)calloc(size, sizeof(Tile*));
+    store->used_ticks = (u64*)malloc(sizeof(u64) * size);
+    if (!store->coords || !store->tiles || !store->used_ticks) {
+        free(store->coords);
+        free(store->tiles);
+        free(store->used_ticks);
+        store->coords = nullptr;
+        store->tiles = nullptr;
+        store->used_ticks = nullptr;
+        return false;
+    }
+
+    store->capacity = size;
+    store->count = 0;
+    store->max_count = max_count;
+    store->spilled_count = 0;
+    store->tick = 0;
+    return true;
+}
+
+void TilemapChunkStoreDestroy(TilemapChunkStore* store) {
+    for (u32 i = 0; i < store->capacity; i++) {
+        free(store->tiles[i]);
+    }
+    free(store->coords);
+    free(store->tiles);
+    free(store->used_ticks);
+    store->coords = nullptr;
+    store->tiles = nullptr;
+    store->used_ticks = nullptr;
+    store->capacity = 0;
+    store->count = 0;
+    store->max_count = 0;
+}
+
+/**
+ * @brief Return the slot holding 'chunk_coord', or the empty slot where it would be inserted.
+ */
+u32 TilemapChunkStoreFindSlot(TilemapChunkStore* store, Vec2i chunk_coord) {
+    u32 mask = store->capacity - 1;
+    u32 slot = TilemapChunkHash(chunk_coord) & mask;
+    while (store->tiles[slot] && (store->coords[slot].x != chunk_coord.x || store->coords[slot].y != chunk_coord.y)) {
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
+
+/**
+ * @brief Empty a slot without freeing its tiles, with the same backward shift deletion as the tilemap index.
+ */
+void TilemapChunkStoreRemoveSlot(TilemapChunkStore* store, u32 slot) {
+    u32 mask = store->capacity - 1;
+    u32 hole = slot;
+    u32 next = (slot + 1) & mask;
+
+    while (store->tiles[next]) {
+        u32 home = TilemapChunkHash(store->coords[next]) & mask;
+        u32 distance_to_hole = (hole - home) & mask;
+        u32 distance_to_next = (next - home) & mask;
+
+        if (distance_to_hole < distance_to_next) {
+            store->coords[hole] = store->coords[next];
+            store->tiles[hole] = store->tiles[next];
+            store->used_ticks[hole] = store->used_ticks[next];
+            hole = next;
+        }
+        next = (next + 1) & mask;
+    }
+
+    store->tiles[hole] = nullptr;
+}
+
+/**
+ * @brief Hand the least recently used chunk to the spill callback and drop it. Returns its tiles for reuse.
+ */
+Tile* TilemapChunkStoreSpillOldest(TilemapChunkStore* store) {
+    u32 oldest = store->capacity;
+    for (u32 i = 0; i < store->capacity; i++) {
+        if (store->tiles[i] && (oldest == store->capacity || store->used_ticks[i] < store->used_ticks[oldest])) {
+            oldest = i;
+        }
+    }
+
+    Tile* tiles = store->tiles[oldest];
+    store->spill_chunk(store->user_data, store->coords[oldest], tiles);
+    TilemapChunkStoreRemoveSlot(store, oldest);
+    store->count--;
+    store->spilled_count++;
+    return tiles;
+}
+
+/**
+ * @brief Keep a copy of the tiles of a chunk, replacing an earlier copy.
+ *
+ * Returns false if out of memory, or if the store is full and has no spill callback.
+ */
+bool TilemapChunkStorePut(TilemapChunkStore* store, Vec2i chunk_coord, Tile* tiles) {
+    u32 slot = TilemapChunkStoreFindSlot(store, chunk_coord);
+    if (!store->tiles[slot]) {
+        Tile* stored_tiles = nullptr;
+        if (store->max_count <= store->count) {
+            if (!store->spill_chunk) {
+                return false;
+            }
+            stored_tiles = TilemapChunkStoreSpillOldest(store);
+            slot = TilemapChunkStoreFindSlot(store, chunk_coord);
+        }
+        else {
+            stored_tiles = (Tile*)malloc(sizeof(Tile) * TILEMAP_CHUNK_TILE_COUNT);
+            if (!stored_tiles) {
+                return false;
+            }
+        }
+        store->tiles[slot] = stored_tiles;
+        store->coords[slot] = chunk_coord;
+        store->count++;
+    }
+
+    store->used_ticks[slot] = ++store->tick;
+    memcpy(store->tiles[slot], tiles, sizeof(Tile) * TILEMAP_CHUNK_TILE_COUNT);
+    return true;
+}
+
+/**
+ * @brief Copy the stored tiles of a chunk into 'tiles'. Returns false if the chunk is not in the store.
+ */
+bool TilemapChunkStoreGet(TilemapChunkStore* store, Vec2i chunk_coord, Tile* tiles) {
+    u32 slot = TilemapChunkStoreFindSlot(store, chunk_coord);
+    if (!store->tiles[slot]) {
+        return false;
+    }
+
+    store->used_ticks[slot] = ++store->tick;
+    memcpy(tiles, store->tiles[slot], sizeof(Tile) * TILEMAP_CHUNK_TILE_COUNT);
+    return true;
+}
+
+// ---------------------
+// Visible tile range
+
+const i32 TILEMAP_VISIBLE_MARGIN_TILES = 2;
+
+/**
+ * @brief Screen rectangle mapped into tilemap coordinates.
+ *
+ * Isometric projection turns the screen rectangle into a diamond shaped
+ * quadrilateral in tilemap space, so visible tiles are walked row by row
+ * using TilemapVisibleRowSpan().
+ */
+struct TilemapVisibleRange {
+    Vec2f corners[4];
+    i32 min_y = 0;
+    i32 max_y = -1;
+    i32 tilemap_width = 0;
+};
+
+/**
+ * @brief Compute visible tile rows from the four screen corners given in world (screen space) coordinates.
+ */
+TilemapVisibleRange TilemapComputeVisibleRange(Tilemap* tilemap, Vec2f world_corners[4]) {
+    TilemapVisibleRange result = {};
+    result.tilemap_width = tilemap->width;
+
+    f32 min_y = 0.0f;
+    f32 max_y = 0.0f;
+    for (i32 i = 0; i < 4; i++) {
+        result.corners[i] = ScreenSpaceToTilemapCoords(world_corners[i]);
+        if (i == 0 || result.corners[i].y < min_y) {
+            min_y = result.corners[i].y;
+        }
+        if (i == 0 || max_y < result.corners[i].y) {
+            max_y = result.corners[i].y;
+        }
+    }
+
+    i32 first_row = (i32)floorf(min_y) - TILEMAP_VISIBLE_MARGIN_TILES;
+    i32 last_row = (i32)ceilf(max_y) + TILEMAP_VISIBLE_MARGIN_TILES;
+    result.min_y = first_row < 0 ? 0 : first_row;
+    result.max_y = tilemap->height - 1 < last_row ? tilemap->height - 1 : last_row;
+    return result;
+}
+
+/**
+ * @brief Get inclusive tile x span visible on row 'y'. Returns false if no tile of the row is on screen.
+ */
+bool TilemapVisibleRowSpan(TilemapVisibleRange* range, i32 y, i32* x_start, i32* x_end) {
+    if (y < range->min_y || range->max_y < y) {
+        return false;
+    }
+
+    // Clip every edge of the quadrilateral to the horizontal band around the row
+    f32 band_min = (f32)(y - TILEMAP_VISIBLE_MARGIN_TILES);
+    f32 band_max = (f32)(y + 1 + TILEMAP_VISIBLE_MARGIN_TILES);
+    f32 min_x = 0.0f;
+    f32 max_x = 0.0f;
+    bool found = false;
+
+    for (i32 i = 0; i < 4; i++) {
+        Vec2f a = range->corners[i];
+        Vec2f b = range->corners[(i + 1) % 4];
+        if (b.y < a.y) {
+            Vec2f temp = a;
+            a = b;
+            b = temp;
+        }
+
+        if (b.y < band_min || band_max < a.y) {
+            continue;
+        }
+
+        f32 t0 = 0.0f;
+        f32 t1 = 1.0f;
+        f32 dy = b.y - a.y;
+        if (0.0f < dy) {
+            if (a.y < band_min) {
+                t0 = (band_min - a.y) / dy;
+            }
+            if (band_max < b.y) {
+                t1 = (band_max - a.y) / dy;
+            }
+        }
+
+        f32 x0 = a.x + (b.x - a.x) * t0;
+        f32 x1 = a.x + (b.x - a.x) * t1;
+        f32 edge_min = x0 < x1 ? x0 : x1;
+        f32 edge_max = x0 < x1 ? x1 : x0;
+
+        if (!found || edge_min < min_x) {
+            min_x = edge_min;
+        }
+        if (!found || max_x < edge_max) {
+            max_x = edge_max;
+        }
+        found = true;
+    }
+
+    if (!found) {
+        return false;
+    }
+
+    i32 first = (i32)floorf(min_x) - TILEMAP_VISIBLE_MARGIN_TILES;
+    i32 last = (i32)ceilf(max_x) + TILEMAP_VISIBLE_MARGIN_TILES;
+    if (first < 0) {
+        first = 0;
+    }
+    if (range->tilemap_width - 1 < last) {
+        last = range->tilemap_width - 1;
+    }
+    if (last < first) {
+        return false;
+    }
+
+    *x_start = first;
+    *x_end = last;
+    return true;
+}
+
+/**
+ * @brief Get inclusive chunk x span visible on chunk row 'chunk_y'. Returns false if no chunk of the row is on screen.
+ */
+bool TilemapVisibleChunkSpan(TilemapVisibleRange* range, i32 chunk_y, i32* chunk_x_start, i32* chunk_x_end) {
+    bool found = false;
+    i32 min_x = 0;
+    i32 max_x = 0;
+
+    for (i32 y = chunk_y * TILEMAP_CHUNK_SIZE; y < (chunk_y + 1) * TILEMAP_CHUNK_SIZE; y++) {
+        i32 x_start, x_end;
+        if (!TilemapVisibleRowSpan(range, y, &x_start, &x_end)) {
+            continue;
+        }
+        if (!found || x_start < min_x) {
+            min_x = x_start;
+        }
+        if (!found || max_x < x_end) {
+            max_x = x_end;
+        }
+        found = true;
+    }
+
+    if (!found) {
+        return false;
+    }
+
+    *chunk_x_start = min_x / TILEMAP_CHUNK_SIZE;
+    *chunk_x_end = max_x / TILEMAP_CHUNK_SIZE;
+    return true;
+}
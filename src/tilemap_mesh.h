@@ -0,0 +1,80 @@
+#pragma once
+
+// ----------
+// Includes
+
+#include "types.h"
+#include "tilemap.h"
+#include "quad_batch.h"
+
+// ---------
+// Defines
+
+const i32 TILEMAP_CHUNK_MESH_MAX_VERTEX_COUNT = TILEMAP_CHUNK_TILE_COUNT * QUAD_VERTEX_COUNT;
+
+// Isometric tile quad spans two world units horizontally and one vertically
+const f32 TILE_QUAD_WIDTH = 2.0f;
+const f32 TILE_QUAD_HEIGHT = 1.0f;
+
+// ---------
+// Structs
+
+/**
+ * @brief Grid layout of tile images inside a tile atlas texture. Tile type N is the Nth cell in row-major order.
+ */
+struct TileAtlasLayout {
+    i32 columns = 1;
+    i32 rows = 1;
+};
+
+// --------------------------
+// Function implementations
+
+/**
+ * @brief Get atlas UV rectangle for a tile type as (u0, v0, u1, v1).
+ */
+Vec4f TileAtlasUvRect(TileAtlasLayout layout, i32 tile_type) {
+    i32 cell_count = layout.columns * layout.rows;
+    i32 cell = (0 <= tile_type && tile_type < cell_count) ? tile_type : 0;
+    f32 cell_w = 1.0f / (f32)layout.columns;
+    f32 cell_h = 1.0f / (f32)layout.rows;
+    f32 u0 = (f32)(cell % layout.columns) * cell_w;
+    f32 v0 = (f32)(cell / layout.columns) * cell_h;
+    Vec4f result = { u0, v0, u0 + cell_w, v0 + cell_h };
+    return result;
+}
+
+/**
+ * @brief Build vertices for every tile of a chunk, ordered back to front.
+ *
+ * 'out' must hold TILEMAP_CHUNK_MESH_MAX_VERTEX_COUNT vertices. Returns written vertex count.
+ */
+i32 TilemapBuildChunkMesh(Tilemap* tilemap, TilemapChunk* chunk, TileAtlasLayout atlas, TilemapTileVertex* out) {
+    i32 vertex_count = 0;
+    i32 base_x = chunk->coord.x * TILEMAP_CHUNK_SIZE;
+    i32 base_y = chunk->coord.y * TILEMAP_CHUNK_SIZE;
+    Vec4f color = { 1.0f, 1.0f, 1.0f, 1.0f };
+    Vec2f size = { TILE_QUAD_WIDTH, TILE_QUAD_HEIGHT };
+
+    // Tiles further away have larger x + y, walk diagonals from the back
+    for (i32 diagonal = (TILEMAP_CHUNK_SIZE - 1) * 2; 0 <= diagonal; diagonal--) {
+        for (i32 local_y = 0; local_y < TILEMAP_CHUNK_SIZE; local_y++) {
+            i32 local_x = diagonal - local_y;
+            if (local_x < 0 || TILEMAP_CHUNK_SIZE <= local_x) {
+                continue;
+            }
+
+            i32 x = base_x + local_x;
+            i32 y = base_y + local_y;
+            if (!TilemapContains(tilemap, x, y)) {
+                continue;
+            }
+
+            Tile tile = chunk->tiles[local_x + local_y * TILEMAP_CHUNK_SIZE];
+            Vec2f center = TilemapCoordsToIsometricScreenSpace(Vec2f{(f32)x, (f32)y});
+            vertex_count += BuildQuadVertices(&out[vertex_count], center, size, TileAtlasUvRect(atlas, tile.type), color);
+        }
+    }
+
+    return vertex_count;
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+// ----------
+// Includes
+
+#include <limits.h>
+#include <string.h>
+#include <stdlib.h>
+
+// ---------
+// Types
+
+typedef unsigned char byte;
+
+static_assert(sizeof(unsigned char) * CHAR_BIT == 8, "unsigned char is not 8 bits");
+
+typedef int i32;
+typedef long long i64;
+
+static_assert(sizeof(int) * CHAR_BIT == 32, "int is not 32 bits");
+static_assert(sizeof(long long) * CHAR_BIT == 64, "long is not 64 bits");
+
+typedef unsigned short u16;
+typedef unsigned int u32;
+typedef unsigned long long u64;
+
+static_assert(sizeof(unsigned short) * CHAR_BIT == 16, "short is not 16 bits");
+static_assert(sizeof(unsigned int) * CHAR_BIT == 32, "int is not 32 bits");
+static_assert(sizeof(unsigned long long) * CHAR_BIT == 64, "long is not 64 bits");
+
+typedef float f32;
+typedef double f64;
+
+static_assert(sizeof(float) * CHAR_BIT == 32, "float is not 32 bits");
+static_assert(sizeof(double) * CHAR_BIT == 64, "double is not 64 bits");
+
+// ---------
+// Structs
+
+struct Vec2i {
+    i32 x;
+    i32 y;
+};
+
+struct Vec2f {
+    f32 x;
+    f32 y;
+};
+
+struct Vec3i {
+    i32 x;
+    i32 y;
+    i32 z;
+};
+
+struct Vec3f {
+    f32 x;
+    f32 y;
+    f32 z;
+};
+
+struct Vec4f {
+    f32 x;
+    f32 y;
+    f32 z;
+    f32 w;
+};
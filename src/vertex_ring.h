@@ -0,0 +1,193 @@
+#pragma once
+
+// ----------
+// Includes
+
+#include "types.h"
+
+// ---------
+// Defines
+
+const i32 VERTEX_RING_MAX_FRAMES_IN_FLIGHT = 4;
+
+// ---------
+// Structs
+
+/**
+ * @brief Graphics API side of a vertex ring: one dynamic buffer and a fence per frame slot.
+ *
+ * 'map' returns the CPU address of the whole buffer. With 'discard' the previous contents may be
+ * thrown away (D3D11 WRITE_DISCARD), otherwise the mapping promises not to touch bytes in use by the GPU
+ * (D3D11 WRITE_NO_OVERWRITE).
+ */
+struct VertexRingBackend {
+    void* user_data = nullptr;
+    byte* (*map)(void* user_data, bool discard) = nullptr;
+    void (*unmap)(void* user_data) = nullptr;
+    void (*signal_fence)(void* user_data, i32 fence_slot) = nullptr;
+    bool (*is_fence_complete)(void* user_data, i32 fence_slot) = nullptr;
+};
+
+struct VertexRingFrame {
+    u32 byte_size;
+    i32 fence_slot;
+};
+
+/**
+ * @brief Frame level sub-allocator over one dynamic vertex buffer.
+ *
+ * Bytes between the oldest in-flight frame and 'head' are in use by the GPU. Allocations that do not
+ * fit before the buffer end wrap to offset zero, and when the GPU still uses that space the buffer is
+ * discarded instead of waiting, so the CPU never stalls on a fence.
+ */
+struct VertexRing {
+    VertexRingBackend backend = {};
+    u32 capacity = 0;
+    u32 head = 0;
+    u32 used = 0;
+    u32 frame_used = 0;
+    byte* mapped = nullptr;
+    bool needs_discard = true;
+
+    VertexRingFrame frames[VERTEX_RING_MAX_FRAMES_IN_FLIGHT] = {};
+    i32 frame_first = 0;
+    i32 frame_count = 0;
+
+    u32 stat_allocations = 0;
+    u32 stat_wraps = 0;
+    u32 stat_discards = 0;
+    u32 stat_overflows = 0;
+};
+
+struct VertexRingAllocation {
+    byte* data;
+    u32 offset;
+};
+
+// --------------------------
+// Function implementations
+
+u32 VertexRingAlignUp(u32 value, u32 alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+void VertexRingCreate(VertexRing* ring, VertexRingBackend backend, u32 capacity) {
+    *ring = {};
+    ring->backend = backend;
+    ring->capacity = capacity;
+}
+
+void VertexRingUnmap(VertexRing* ring) {
+    if (ring->mapped) {
+        ring->backend.unmap(ring->backend.user_data);
+        ring->mapped = nullptr;
+    }
+}
+
+void VertexRingDiscard(VertexRing* ring) {
+    VertexRingUnmap(ring);
+    ring->mapped = ring->backend.map(ring->backend.user_data, true);
+    ring->needs_discard = false;
+
+    // Old contents were renamed away by the driver, in-flight frames no longer hold any bytes
+    for (i32 i = 0; i < ring->frame_count; i++) {
+        ring->frames[(ring->frame_first + i) % VERTEX_RING_MAX_FRAMES_IN_FLIGHT].byte_size = 0;
+    }
+    ring->head = 0;
+    ring->used = 0;
+    ring->frame_used = 0;
+    ring->stat_discards++;
+}
+
+/**
+ * @brief Release the space of frames the GPU has finished with. Call at frame start.
+ */
+void VertexRingBeginFrame(VertexRing* ring) {
+    while (0 < ring->frame_count) {
+        VertexRingFrame* frame = &ring->frames[ring->frame_first];
+        if (!ring->backend.is_fence_complete(ring->backend.user_data, frame->fence_slot)) {
+            break;
+        }
+
+        ring->used -= frame->byte_size;
+        ring->frame_first = (ring->frame_first + 1) % VERTEX_RING_MAX_FRAMES_IN_FLIGHT;
+        ring->frame_count--;
+    }
+
+    ring->stat_allocations = 0;
+    ring->stat_wraps = 0;
+    ring->stat_discards = 0;
+    ring->stat_overflows = 0;
+}
+
+/**
+ * @brief Unmap and fence this frame's allocations. Call after the last draw of the frame.
+ */
+void VertexRingEndFrame(VertexRing* ring) {
+    VertexRingUnmap(ring);
+
+    if (ring->frame_count == VERTEX_RING_MAX_FRAMES_IN_FLIGHT) {
+        // Too many frames queued to track, start over from a discarded buffer on the next allocation
+        ring->needs_discard = true;
+        ring->frame_used = 0;
+        return;
+    }
+
+    i32 slot = (ring->frame_first + ring->frame_count) % VERTEX_RING_MAX_FRAMES_IN_FLIGHT;
+    ring->frames[slot].byte_size = ring->frame_used;
+    ring->frames[slot].fence_slot = slot;
+    ring->frame_count++;
+    ring->frame_used = 0;
+    ring->backend.signal_fence(ring->backend.user_data, slot);
+}
+
+/**
+ * @brief Reserve 'size' bytes at an offset aligned to 'alignment', mapping the buffer if needed.
+ *
+ * Returns data == nullptr if 'size' is larger than the whole ring. Call VertexRingUnmap before drawing from the buffer.
+ */
+VertexRingAllocation VertexRingAllocate(VertexRing* ring, u32 size, u32 alignment) {
+    VertexRingAllocation result = {};
+    if (ring->capacity < size) {
+        ring->stat_overflows++;
+        return result;
+    }
+
+    u32 offset = VertexRingAlignUp(ring->head, alignment);
+    u32 consumed = 0;
+    bool fits = false;
+
+    if (!ring->needs_discard) {
+        if (offset <= ring->capacity && size <= ring->capacity - offset) {
+            consumed = offset - ring->head + size;
+            fits = ring->used + consumed <= ring->capacity;
+        }
+        else {
+            // Wrap to the start, the skipped tail end counts as used until this frame retires
+            offset = 0;
+            consumed = ring->capacity - ring->head + size;
+            fits = ring->used + consumed <= ring->capacity;
+            if (fits) {
+                ring->stat_wraps++;
+            }
+        }
+    }
+
+    if (!fits) {
+        VertexRingDiscard(ring);
+        offset = 0;
+        consumed = size;
+    }
+    else if (!ring->mapped) {
+        ring->mapped = ring->backend.map(ring->backend.user_data, false);
+    }
+
+    ring->head = offset + size;
+    ring->used += consumed;
+    ring->frame_used += consumed;
+    ring->stat_allocations++;
+
+    result.data = ring->mapped + offset;
+    result.offset = offset;
+    return result;
+}
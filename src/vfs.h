@@ -0,0 +1,506 @@
+#pragma once
+
+// ----------
+// Includes
+
+#include <stdio.h>
+#include <sys/stat.h>
+#include <mutex>
+
+#include "types.h"
+#include "asset_pack.h"
+
+// Virtual filesystem. Resource paths like "images/tiles_01.png" are resolved against mount points instead of
+// absolute paths on the developer's machine. A mount maps a virtual prefix ("" for the root) to one of:
+//
+//   a loose directory   read through the OS, for iterating on assets
+//   an asset pack       views into the mapping, see asset_pack.h
+//   an in-memory table  files compiled into the exe or generated at runtime
+//
+// Mounts are searched from the highest priority down, the first one that has the file wins. Virtual paths
+// follow the pack rules: case insensitive, '/' and '\' are the same separator.
+//
+// Every resolve is remembered in a hash table keyed by the normalized path, so asking for the same file again
+// (a .qoi next to a .png, a font reload) costs a hash and a probe instead of touching the disk. Misses are
+// remembered too, most of them are optional files like a .qoi that was never converted. A remembered miss
+// hides a file created later until VfsInvalidate, which the file watcher calls when files appear or
+// disappear; without a watcher, call it after writing files the game should see. Misses take at most a
+// quarter of the table, so probing many missing paths never pushes out the files that exist. Mounting
+// clears the table.
+// Resolving is thread safe, mounting is not and must not run while files are being resolved.
+
+// ---------
+// Defines
+
+const i32 VFS_PATH_MAX = 260;
+const i32 VFS_MAX_MOUNTS = 8;
+const i32 VFS_NOT_FOUND = -1;
+const u32 VFS_CACHE_EMPTY = 0xFFFFFFFFu;
+const u32 VFS_CACHE_MISS_SHARE = 4; // Remembered misses take at most 1 / VFS_CACHE_MISS_SHARE of the table
+
+enum VfsMountKind : u32 {
+    VFS_MOUNT_DIRECTORY = 0,
+    VFS_MOUNT_PACK = 1,
+    VFS_MOUNT_MEMORY = 2,
+};
+
+// ---------
+// Structs
+
+/**
+ * @brief File of an in-memory mount. The mount does not copy 'path' or 'data', they must outlive it.
+ */
+struct VfsMemoryFile {
+    const char* path;
+    const byte* data;
+    size_t size;
+};
+
+struct VfsMount {
+    VfsMountKind kind;
+    i32 priority;
+    char mount_point[VFS_PATH_MAX];
+    i32 mount_point_length;
+
+    char directory[VFS_PATH_MAX];
+    AssetPack pack;
+    const VfsMemoryFile* files;
+    i32 file_count;
+};
+
+/**
+ * @brief Remembered resolve. 'mount_index' is VFS_NOT_FOUND for paths no mount has.
+ */
+struct VfsCacheEntry {
+    u64 path_hash;
+    u32 name_offset;
+    i32 mount_index;
+    const byte* data;
+    size_t size;
+};
+
+/**
+ * @brief Resolved file. Pack and memory files have their contents in 'data', directory files have a 'native_path' to read.
+ */
+struct VfsFile {
+    i32 mount_index;
+    VfsMountKind kind;
+    const byte* data;
+    size_t size;
+    char native_path[VFS_PATH_MAX];
+};
+
+struct VfsStats {
+    i64 resolves;
+    i64 cache_hits;
+    i64 uncached_misses;
+};
+
+struct Vfs {
+    VfsMount mounts[VFS_MAX_MOUNTS] = {};
+    i32 mount_count = 0;
+
+    std::mutex cache_mutex;
+    VfsCacheEntry* cache = nullptr;
+    u32 cache_mask = 0;
+    u32 cache_count = 0;
+    u32 cache_miss_count = 0;
+    char* names = nullptr;
+    u32 names_used = 0;
+    u32 names_capacity = 0;
+    VfsStats stats = {};
+};
+
+// --------------------------
+// Function implementations
+
+/**
+ * @brief 'path' starts with the normalized 'prefix'.
+ */
+bool VfsPathHasPrefix(const char* path, const char* prefix, i32 prefix_length) {
+    for (i32 i = 0; i < prefix_length; i++) {
+        if (path[i] == 0 || AssetPackNormalizeChar(path[i]) != prefix[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool VfsPathEquals(const char* a, const char* b) {
+    for (; *a != 0 && *b != 0; a++, b++) {
+        if (AssetPackNormalizeChar(*a) != AssetPackNormalizeChar(*b)) {
+            return false;
+        }
+    }
+    return *a == *b;
+}
+
+/**
+ * @brief Create with room for 'cache_capacity' remembered paths, rounded up to a power of two.
+ */
+bool VfsCreate(Vfs* vfs, i32 cache_capacity) {
+    u32 slot_count = 16;
+    while (slot_count < (u32)cache_capacity) {
+        slot_count *= 2;
+    }
+
+    vfs->cache = (VfsCacheEntry*)malloc(sizeof(VfsCacheEntry) * slot_count);
+    vfs->names_capacity = slot_count * 32;
+    vfs->names = (char*)malloc(vfs->names_capacity);
+    if (!vfs->cache || !vfs->names) {
+        return false;
+    }
+
+    vfs->cache_mask = slot_count - 1;
+    for (u32 i = 0; i < slot_count; i++) {
+        vfs->cache[i].name_offset = VFS_CACHE_EMPTY;
+    }
+    return true;
+}
+
+void VfsInvalidate(Vfs* vfs) {
+    std::lock_guard<std::mutex> lock(vfs->cache_mutex);
+    for (u32 i = 0; i <= vfs->cache_mask; i++) {
+        vfs->cache[i].name_offset = VFS_CACHE_EMPTY;
+    }
+    vfs->cache_count = 0;
+    vfs->cache_miss_count = 0;
+    vfs->names_used = 0;
+}
+
+void VfsDestroy(Vfs* vfs) {
+    for (i32 i = 0; i < vfs->mount_count; i++) {
+        AssetPackClose(&vfs->mounts[i].pack);
+    }
+    free(vfs->cache);
+    free(vfs->names);
+    vfs->cache = nullptr;
+    vfs->names = nullptr;
+    vfs->cache_mask = 0;
+    vfs->cache_count = 0;
+    vfs->cache_miss_count = 0;
+    vfs->names_used = 0;
+    vfs->names_capacity = 0;
+    vfs->mount_count = 0;
+}
+
+/**
+ * @brief Add a mount, keeping the mount array sorted from the highest priority down. Equal priorities keep mount order.
+ */
+VfsMount* VfsAddMount(Vfs* vfs, VfsMountKind kind, const char* mount_point, i32 priority) {
+    i32 length = (i32)strlen(mount_point);
+    if (VFS_MAX_MOUNTS <= vfs->mount_count || VFS_PATH_MAX - 2 <= length) {
+        return nullptr;
+    }
+
+    i32 index = vfs->mount_count;
+    while (0 < index && vfs->mounts[index - 1].priority < priority) {
+        vfs->mounts[index] = vfs->mounts[index - 1];
+        index--;
+    }
+    vfs->mount_count++;
+
+    VfsMount* mount = &vfs->mounts[index];
+    *mount = {};
+    mount->kind = kind;
+    mount->priority = priority;
+
+    // Stored normalized with a trailing separator, so "shaders" does not match "shaders_old/x.hlsl"
+    for (i32 i = 0; i < length; i++) {
+        mount->mount_point[i] = AssetPackNormalizeChar(mount_point[i]);
+    }
+    if (0 < length && mount->mount_point[length - 1] != '/') {
+        mount->mount_point[length++] = '/';
+    }
+    mount->mount_point_length = length;
+
+    VfsInvalidate(vfs);
+    return mount;
+}
+
+/**
+ * @brief Mount a loose directory. The directory is not checked, files that are not there just do not resolve.
+ */
+bool VfsMountDirectory(Vfs* vfs, const char* mount_point, const char* directory, i32 priority) {
+    if (VFS_PATH_MAX - 2 <= (i32)strlen(directory)) {
+        return false;
+    }
+
+    VfsMount* mount = VfsAddMount(vfs, VFS_MOUNT_DIRECTORY, mount_point, priority);
+    if (!mount) {
+        return false;
+    }
+    snprintf(mount->directory, VFS_PATH_MAX, "%s", directory);
+    return true;
+}
+
+/**
+ * @brief Map and mount an asset pack. Returns false if the pack can not be opened.
+ */
+bool VfsMountPack(Vfs* vfs, const char* mount_point, const char* pack_path, i32 priority) {
+    AssetPack pack = {};
+    if (!AssetPackOpenFile(&pack, pack_path)) {
+        return false;
+    }
+
+    VfsMount* mount = VfsAddMount(vfs, VFS_MOUNT_PACK, mount_point, priority);
+    if (!mount) {
+        AssetPackClose(&pack);
+        return false;
+    }
+    mount->pack = pack;
+    return true;
+}
+
+bool VfsMountMemory(Vfs* vfs, const char* mount_point, const VfsMemoryFile* files, i32 file_count, i32 priority) {
+    VfsMount* mount = VfsAddMount(vfs, VFS_MOUNT_MEMORY, mount_point, priority);
+    if (!mount) {
+        return false;
+    }
+    mount->files = files;
+    mount->file_count = file_count;
+    return true;
+}
+
+/**
+ * @brief Native path of 'relative_path' in a directory mount, with the platform's separator.
+ */
+void VfsNativePath(VfsMount* mount, const char* relative_path, char* result) {
+#ifdef _WIN32
+    const char separator = '\\';
+#else
+    const char separator = '/';
+#endif
+
+    i32 length = snprintf(result, VFS_PATH_MAX, "%s%c%s", mount->directory, separator, relative_path);
+    for (i32 i = 0; i < length && i < VFS_PATH_MAX; i++) {
+        if (result[i] == '/' || result[i] == '\\') {
+            result[i] = separator;
+        }
+    }
+}
+
+/**
+ * @brief Look for 'path' in one mount, without the cache.
+ */
+bool VfsFindInMount(VfsMount* mount, const char* path, VfsFile* file) {
+    if (!VfsPathHasPrefix(path, mount->mount_point, mount->mount_point_length)) {
+        return false;
+    }
+    const char* relative_path = path + mount->mount_point_length;
+
+    if (mount->kind == VFS_MOUNT_DIRECTORY) {
+        VfsNativePath(mount, relative_path, file->native_path);
+        FILE* native_file = fopen(file->native_path, "rb");
+        if (!native_file) {
+            return false;
+        }
+        fclose(native_file);
+        return true;
+    }
+
+    if (mount->kind == VFS_MOUNT_PACK) {
+        file->data = AssetPackView(&mount->pack, relative_path, &file->size);
+        return file->data != nullptr;
+    }
+
+    for (i32 i = 0; i < mount->file_count; i++) {
+        if (VfsPathEquals(mount->files[i].path, relative_path)) {
+            file->data = mount->files[i].data;
+            file->size = mount->files[i].size;
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Remember a resolve. When the table or its names are full everything is forgotten and the table starts over.
+ *
+ * Misses beyond their share of the table are not remembered, they are resolved again every time.
+ */
+void VfsCacheInsert(Vfs* vfs, u64 hash, const char* path, i32 mount_index, const byte* data, size_t size) {
+    bool is_miss = mount_index == VFS_NOT_FOUND;
+    if (is_miss && (vfs->cache_mask + 1) < (vfs->cache_miss_count + 1) * VFS_CACHE_MISS_SHARE) {
+        vfs->stats.uncached_misses++;
+        return;
+    }
+
+    u32 name_bytes = 0;
+    while (path[name_bytes] != 0) {
+        name_bytes++;
+    }
+    name_bytes++;
+
+    bool is_table_full = (vfs->cache_mask + 1) * 3 < (vfs->cache_count + 1) * 4;
+    if (is_table_full || vfs->names_capacity < vfs->names_used + name_bytes) {
+        for (u32 i = 0; i <= vfs->cache_mask; i++) {
+            vfs->cache[i].name_offset = VFS_CACHE_EMPTY;
+        }
+        vfs->cache_count = 0;
+        vfs->cache_miss_count = 0;
+        vfs->names_used = 0;
+        if (vfs->names_capacity < name_bytes) {
+            return;
+        }
+    }
+
+    u32 slot = (u32)hash & vfs->cache_mask;
+    while (vfs->cache[slot].name_offset != VFS_CACHE_EMPTY) {
+        VfsCacheEntry* entry = &vfs->cache[slot];
+        if (entry->path_hash == hash && AssetPackPathEquals(vfs->names + entry->name_offset, path)) {
+            return;
+        }
+        slot = (slot + 1) & vfs->cache_mask;
+    }
+
+    VfsCacheEntry* entry = &vfs->cache[slot];
+    entry->path_hash = hash;
+    entry->name_offset = vfs->names_used;
+    entry->mount_index = mount_index;
+    entry->data = data;
+    entry->size = size;
+
+    for (u32 i = 0; i < name_bytes; i++) {
+        vfs->names[vfs->names_used + i] = AssetPackNormalizeChar(path[i]);
+    }
+    vfs->names_used += name_bytes;
+    vfs->cache_count++;
+    vfs->cache_miss_count += is_miss ? 1 : 0;
+}
+
+/**
+ * @brief Find the mount that has 'path'. Returns false if no mount has it.
+ */
+bool VfsResolve(Vfs* vfs, const char* path, VfsFile* file) {
+    *file = {};
+    file->mount_index = VFS_NOT_FOUND;
+    u64 hash = AssetPackHashPath(path);
+
+    bool is_cached = false;
+    {
+        std::lock_guard<std::mutex> lock(vfs->cache_mutex);
+        vfs->stats.resolves++;
+
+        u32 slot = (u32)hash & vfs->cache_mask;
+        while (vfs->cache[slot].name_offset != VFS_CACHE_EMPTY) {
+            VfsCacheEntry* entry = &vfs->cache[slot];
+            if (entry->path_hash == hash && AssetPackPathEquals(vfs->names + entry->name_offset, path)) {
+                file->mount_index = entry->mount_index;
+                file->data = entry->data;
+                file->size = entry->size;
+                is_cached = true;
+                vfs->stats.cache_hits++;
+                break;
+            }
+            slot = (slot + 1) & vfs->cache_mask;
+        }
+    }
+
+    if (is_cached) {
+        if (file->mount_index == VFS_NOT_FOUND) {
+            return false;
+        }
+
+        VfsMount* mount = &vfs->mounts[file->mount_index];
+        file->kind = mount->kind;
+        if (mount->kind == VFS_MOUNT_DIRECTORY) {
+            VfsNativePath(mount, path + mount->mount_point_length, file->native_path);
+        }
+        return true;
+    }
+
+    // Probing mounts can touch the disk, so it runs outside the lock
+    for (i32 i = 0; i < vfs->mount_count; i++) {
+        if (VfsFindInMount(&vfs->mounts[i], path, file)) {
+            file->mount_index = i;
+            file->kind = vfs->mounts[i].kind;
+            break;
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(vfs->cache_mutex);
+    VfsCacheInsert(vfs, hash, path, file->mount_index, file->data, file->size);
+    return file->mount_index != VFS_NOT_FOUND;
+}
+
+/**
+ * @brief Last modification time of a native file in seconds. Returns false if it can not be read.
+ */
+bool VfsNativeModifiedTime(const char* native_path, i64* time) {
+#ifdef _WIN32
+    struct _stat64 info;
+    if (_stat64(native_path, &info) != 0) {
+        return false;
+    }
+#else
+    struct stat info;
+    if (stat(native_path, &info) != 0) {
+        return false;
+    }
+#endif
+    *time = (i64)info.st_mtime;
+    return true;
+}
+
+/**
+ * @brief Last modification time of 'path' in seconds. Returns false for missing files and for pack and memory files, which have none.
+ */
+bool VfsModifiedTime(Vfs* vfs, const char* path, i64* time) {
+    VfsFile file;
+    if (!VfsResolve(vfs, path, &file) || file.kind != VFS_MOUNT_DIRECTORY) {
+        return false;
+    }
+    return VfsNativeModifiedTime(file.native_path, time);
+}
+
+bool VfsExists(Vfs* vfs, const char* path) {
+    VfsFile file;
+    return VfsResolve(vfs, path, &file);
+}
+
+/**
+ * @brief Read a whole native file into a malloc'ed buffer. Returns nullptr if it can not be read.
+ */
+byte* VfsReadNativeFile(const char* native_path, size_t* file_size) {
+    FILE* native_file = fopen(native_path, "rb");
+    if (!native_file) {
+        return nullptr;
+    }
+
+    byte* data = nullptr;
+    if (fseek(native_file, 0, SEEK_END) == 0) {
+        long size = ftell(native_file);
+        if (0 <= size && fseek(native_file, 0, SEEK_SET) == 0) {
+            data = (byte*)malloc(size ? (size_t)size : 1);
+            if (data && fread(data, 1, (size_t)size, native_file) != (size_t)size) {
+                free(data);
+                data = nullptr;
+            }
+            *file_size = (size_t)size;
+        }
+    }
+
+    fclose(native_file);
+    return data;
+}
+
+/**
+ * @brief Read a whole file into a malloc'ed buffer. Returns nullptr if no mount has it or it can not be read.
+ */
+byte* VfsReadFile(Vfs* vfs, const char* path, size_t* file_size) {
+    VfsFile file;
+    if (!VfsResolve(vfs, path, &file)) {
+        return nullptr;
+    }
+
+    if (file.kind != VFS_MOUNT_DIRECTORY) {
+        byte* data = (byte*)malloc(file.size ? file.size : 1);
+        if (data) {
+            memcpy(data, file.data, file.size);
+            *file_size = file.size;
+        }
+        return data;
+    }
+    return VfsReadNativeFile(file.native_path, file_size);
+}
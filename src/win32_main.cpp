@@ -3,7 +3,6 @@
 
 #include <windows.h>
 #include <commdlg.h>
-#include <limits.h>
 
 #include <combaseapi.h>
 #include <xaudio2.h>
@@ -11,6 +10,32 @@
 #include <d3dcompiler.h>
 #include <DirectXMath.h>
 
+#include "types.h"
+#include "hash.h"
+#include "tilemap.h"
+#include "quad_batch.h"
+#include "tilemap_mesh.h"
+#include "draw_sort.h"
+#include "text_layout.h"
+#include "text_run_cache.h"
+#include "shape_batch.h"
+#include "vertex_ring.h"
+#include "render_queue.h"
+#include "sprite_instance.h"
+#include "texture_atlas.h"
+#include "mipmap.h"
+#include "block_texture.h"
+#include "qoi_image.h"
+#include "asset_pack.h"
+#include "vfs.h"
+#include "asset_loader.h"
+#include "asset_stream.h"
+#include "asset_registry.h"
+#include "texture_residency.h"
+#include "file_watcher.h"
+#include "shader_cache.h"
+#include "shader_compiler.h"
+
 // ---------
 // Defines
 
@@ -21,57 +46,138 @@
 #define STB_TRUETYPE_IMPLEMENTATION
 #include "stb_truetype.h"
 
-const int MAX_TEXT_UI_VERTEX_COUNT = 500 * 6;
 const int STR_BUFFER_COUNT = 256;
 const int WINDOW_DEFAULT_WIDTH = 1600;
 const int WINDOW_DEFAULT_HEIGHT = 1200;
 
-typedef unsigned char byte;
+const int WORLD_TILEMAP_WIDTH = 4096;
+const int WORLD_TILEMAP_HEIGHT = 4096;
+const int WORLD_TILEMAP_CHUNK_BUDGET = 256;
+// Edited chunks kept in memory after eviction, 4 KB each. Older edits spill to a temporary file
+const int WORLD_TILEMAP_EDIT_BUDGET = 1024;
+const int WORLD_TILEMAP_CHUNKS_X = WORLD_TILEMAP_WIDTH / TILEMAP_CHUNK_SIZE;
+const int WORLD_TILEMAP_CHUNKS_Y = WORLD_TILEMAP_HEIGHT / TILEMAP_CHUNK_SIZE;
+
+const int MAX_QUEUED_QUADS = 131072;
+const int MAX_INDEXED_QUADS = 16384;
+const int TEXT_LAYOUT_MAX_QUADS = 4096;
+// Every queued sprite can start a run of its own, on top of text, shapes and tilemap chunks
+const int MAX_RENDER_COMMANDS = MAX_QUEUED_QUADS + 16384;
+static_assert(MAX_QUEUED_QUADS <= RENDER_ORDER_MAX, "Sprite runs of a frame do not fit in the render order");
+const u32 RENDER_QUEUE_INITIAL_VERTEX_BYTES = 1024 * 1024;
+const u32 DYNAMIC_VERTEX_RING_BYTES = 16 * 1024 * 1024;
+const u32 SPRITE_INSTANCE_RING_BYTES = MAX_QUEUED_QUADS * sizeof(SpriteInstance) * 2;
+const int TEXT_RUN_CACHE_MAX_RUNS = 256;
+const size_t TEXT_RUN_CACHE_BYTE_BUDGET = 512 * 1024;
+const int MAX_DRAW_TEXTURES = 64;
+const int MAX_ATLAS_PAGES = 8;
+const int MAX_STARTUP_ASSETS = 32;
+const int MAX_STREAMED_ASSETS = 64;
+const int MAX_REGISTERED_ASSETS = 256;
+const int STREAMED_UPLOADS_PER_FRAME = 4;
+const int VFS_CACHE_CAPACITY = 1024;
+
+// Resources are mounted from a loose directory, overriding a pack when both have the same file. The
+// directory defaults to 'resources' in the working directory, FINITE_ENGINE_RESOURCES points it elsewhere.
+const char* RESOURCES_DIRECTORY = "resources";
+const char* RESOURCES_DIRECTORY_VARIABLE = "FINITE_ENGINE_RESOURCES";
+const char* RESOURCES_PACK_PATH = "resources.fpak";
+const i32 RESOURCES_PACK_PRIORITY = 0;
+const i32 RESOURCES_DIRECTORY_PRIORITY = 1;
+
+const char* DEBUG_FONT_PATH = "fonts/Roboto-Light.ttf";
+const char* SPRITE_ATLAS_PATH = "atlas/sprites.fatl";
+
+// Registered textures share a video memory budget, FINITE_ENGINE_TEXTURE_BUDGET_MB overrides the default
+const char* TEXTURE_BUDGET_VARIABLE = "FINITE_ENGINE_TEXTURE_BUDGET_MB";
+const u64 TEXTURE_BUDGET_DEFAULT_MB = 512;
+const i32 TEXTURE_LOADS_PER_FRAME = 2;
+
+// Loose resource files reload when they change. A change is applied once the file has been quiet for the settle time
+const f64 HOT_RELOAD_SETTLE_MS = 100.0;
+const i32 HOT_RELOAD_MAX_CHANGES_PER_FRAME = 16;
+const i32 MAX_RETIRED_SOUNDS = 8;
+const i32 SHADER_ERROR_MAX = 1024;
+
+// Compiled shaders are cached in 'shader_cache' next to the executable, FINITE_ENGINE_SHADER_CACHE points it
+// elsewhere. build_release.bat fills release\shader_cache with tools/shader_precompiler.cpp
+const char* SHADER_CACHE_DIRECTORY = "shader_cache";
+const char* SHADER_CACHE_VARIABLE = "FINITE_ENGINE_SHADER_CACHE";
+
+enum ShaderProgramId : u32 {
+    SHADER_PROGRAM_RECTANGLE = 0,
+    SHADER_PROGRAM_RECTANGLE_2D = 1,
+    SHADER_PROGRAM_TEXT_UI = 2,
+    SHADER_PROGRAM_COUNT = 3,
+};
 
-static_assert(sizeof(unsigned char) * CHAR_BIT == 8, "unsigned char is not 8 bits");
+// Render queue layers are drawn in order. Within a layer commands are grouped by pipeline, then texture.
+enum RenderLayer : u32 {
+    RENDER_LAYER_BACKGROUND = 0,
+    RENDER_LAYER_WORLD = 1,
+    RENDER_LAYER_WORLD_OVERLAY = 2,
+    RENDER_LAYER_UI = 3,
+};
 
-typedef int i32;
-typedef long long i64;
+enum RenderPipeline : u32 {
+    RENDER_PIPELINE_QUAD_2D = 0,
+    RENDER_PIPELINE_SHAPES = 1,
+    RENDER_PIPELINE_TEXT = 2,
+    RENDER_PIPELINE_SPRITE_INSTANCED = 3,
+};
 
-static_assert(sizeof(int) * CHAR_BIT == 32, "int is not 32 bits");
-static_assert(sizeof(long long) * CHAR_BIT == 64, "long is not 64 bits");
+// Vertex shader reads sprite instances from a structured buffer and expands them to the corners
+// of the shared quad index buffer: SV_VertexID 0 top-left, 1 top-right, 2 bottom-left, 3 bottom-right.
+const char* SPRITE_INSTANCED_SHADER_SOURCE = R"(
+cbuffer ViewProjection : register(b0) {
+    float4x4 view_projection;
+};
 
-typedef unsigned int u32;
-typedef unsigned long long u64;
+cbuffer SpriteInstanceDraw : register(b3) {
+    uint first_instance;
+    uint3 padding;
+};
 
-static_assert(sizeof(unsigned int) * CHAR_BIT == 32, "int is not 32 bits");
-static_assert(sizeof(unsigned long long) * CHAR_BIT == 64, "long is not 64 bits");
+struct SpriteInstance {
+    float2 center;
+    float2 size;
+    uint2 uv;
+    uint color;
+    float depth;
+};
 
-typedef float f32;
-typedef double f64;
+StructuredBuffer<SpriteInstance> instances : register(t1);
+Texture2D sprite_texture : register(t0);
+SamplerState sprite_sampler : register(s0);
 
-static_assert(sizeof(float) * CHAR_BIT == 32, "float is not 32 bits");
-static_assert(sizeof(double) * CHAR_BIT == 64, "double is not 64 bits");
+struct PSInput {
+    float4 position : SV_POSITION;
+    float4 color : COLOR;
+    float2 uv : TEXCOORD;
+};
 
-// ---------
-// Structs
+PSInput VSMain(uint vertex_id : SV_VertexID, uint instance_id : SV_InstanceID) {
+    SpriteInstance instance = instances[first_instance + instance_id];
+    float2 corner = float2(vertex_id & 1, vertex_id >> 1);
 
-struct Vec2i {
-    i32 x;
-    i32 y;
-};
+    float2 position = instance.center + float2(corner.x - 0.5f, 0.5f - corner.y) * instance.size;
+    float2 uv0 = float2(instance.uv.x & 0xFFFF, instance.uv.x >> 16) / 65535.0f;
+    float2 uv1 = float2(instance.uv.y & 0xFFFF, instance.uv.y >> 16) / 65535.0f;
 
-struct Vec2f {
-    f32 x;
-    f32 y;
-};
+    PSInput result;
+    result.position = mul(float4(position, 0.0f, 1.0f), view_projection);
+    result.color = float4(instance.color & 0xFF, (instance.color >> 8) & 0xFF, (instance.color >> 16) & 0xFF, instance.color >> 24) / 255.0f;
+    result.uv = lerp(uv0, uv1, corner);
+    return result;
+}
 
-struct Vec3i {
-    i32 x;
-    i32 y;
-    i32 z;
-};
+float4 PSMain(PSInput input) : SV_TARGET {
+    return sprite_texture.Sample(sprite_sampler, input.uv) * input.color;
+}
+)";
 
-struct Vec3f {
-    f32 x;
-    f32 y;
-    f32 z;
-};
+// ---------
+// Structs
 
 struct Buffer {
     i32 size_bytes;
@@ -93,23 +199,11 @@ struct Window {
     bool is_resizing;
 
     Vec2f ScreenPxToNDC(Vec2i px) {
-        f32 ndcX = (2.0f * px.x) / (size_px.x - 1) - 1.0f;
-        f32 ndcY = 1.0f - (2.0f * px.y) / (size_px.y - 1);
-        Vec2f result = {
-            .x = ndcX,
-            .y = ndcY
-        };
-        return result;
+        return ::ScreenPxToNDC(px, size_px);
     }
 
     Vec2i NDCToScreenPx(Vec2f ndc) {
-        int x = (size_px.x * (ndc.x + 1.0f)) * 0.5f;
-        int y = (size_px.y * (ndc.y + 1.0f)) * 0.5f;
-        Vec2i result = {
-            .x = x,
-            .y = y
-        };
-        return result;
+        return ::NDCToScreenPx(ndc, size_px);
     }
 
     Vec2f GetWindowMousePosition() {
@@ -180,67 +274,77 @@ struct ViewProjectionMatrixBufferType {
     DirectX::XMMATRIX view_projection_matrix;
 };
 
-enum class ImageFileType {
-    png
+struct SpriteInstanceDrawBufferType {
+    u32 first_instance;
+    u32 padding[3];
 };
 
+/**
+ * @brief Dynamic GPU buffer sub-allocated by a VertexRing, with one event query per frame slot.
+ *
+ * Without 'can_map_no_overwrite' every map discards, for shader resource buffers on drivers that
+ * do not allow WRITE_NO_OVERWRITE on them.
+ */
+struct D3D11RingBuffer {
+    ID3D11Buffer* buffer;
+    ID3D11Query* fences[VERTEX_RING_MAX_FRAMES_IN_FLIGHT];
+    bool can_map_no_overwrite;
+};
+
+/**
+ * @brief GPU texture. 'x' and 'y' are the full size, the view holds levels from 'top_level' down when residency dropped the larger ones.
+ */
 struct Texture {
-    char filename[128];
     i32 x;
     i32 y;
     i32 channels;
-    ImageFileType filetype;
+    u32 draw_id;
+    i32 top_level;
+    AssetId asset;
     ID3D11ShaderResourceView* resource_view;
 };
 
-struct TilemapTileVertex {
-    DirectX::XMFLOAT4 position;
-    DirectX::XMFLOAT4 color;
-    DirectX::XMFLOAT2 uv;
-};
-
-struct TextUiVertex {
-    DirectX::XMFLOAT4 Pos;
-    DirectX::XMFLOAT2 TexCoord;
+/**
+ * @brief Vertex and pixel shader of an HLSL file with VSMain and PSMain entry points. The pointers are the globals the pipelines bind.
+ */
+struct ShaderProgram {
+    const char* path;
+    const D3D11_INPUT_ELEMENT_DESC* layout;
+    u32 layout_count;
+    ID3D11VertexShader** vertex_shader;
+    ID3D11PixelShader** pixel_shader;
+    ID3D11InputLayout** input_layout;
 };
 
-struct RectangleVertex {
-    DirectX::XMFLOAT4 position;
-    DirectX::XMFLOAT4 color;
+/**
+ * @brief Recompile of a shader program running on its own thread. The frame thread owns it while 'is_done' is set.
+ */
+struct ShaderReload {
+    std::thread thread;
+    std::atomic<bool> is_done;
+    bool is_pending;
+    bool is_requested_again;
+    ID3DBlob* vertex_blob;
+    ID3DBlob* pixel_blob;
+    char error[SHADER_ERROR_MAX];
 };
 
-struct FontGlyphInfo {
-    i32 bitmap_width = 0;
-    i32 bitmap_height = 0;
-    i32 x_offset = 0;
-    i32 y_offset = 0;
-    f32 advance = 0.0f;
-    f32 uv_x0 = 0.0f;
-    f32 uv_y0 = 0.0f;
-    f32 uv_x1 = 0.0f;
-    f32 uv_y1 = 0.0f;
-    char character;
+struct SoundFile {
+    const char* path;
+    Buffer* buffer;
+    AssetHandle reload_request;
 };
 
 struct FontAtlasInfo {
     ID3D11ShaderResourceView* texture = nullptr;
+    u32 draw_id = RENDER_TEXTURE_NONE;
     i32 font_size_px = 0;
     i32 font_atlas_width = 0;
     i32 font_atlas_height = 0;
     f32 font_ascent = 0.0f;
     f32 font_descent = 0.0f;
     f32 font_linegap = 0.0f;
-    FontGlyphInfo glyphs[96] = {};
-};
-
-struct Tile {
-    i32 type;
-};
-
-struct Tilemap {
-    i32 width = 0;
-    i32 height = 0;
-    Tile* tiles = nullptr;
+    FontGlyphInfo glyphs[FONT_GLYPH_COUNT] = {};
 };
 
 struct CStrBuffer {
@@ -271,24 +375,6 @@ struct WStrBuffer {
     }
 };
 
-#pragma pack(1)
-typedef struct {
-    char riffHeader[4];        // "RIFF"
-    DWORD fileSize;            // Size of the entire file minus 8 bytes
-    char waveHeader[4];        // "WAVE"
-    char fmtHeader[4];         // "fmt "
-    DWORD fmtChunkSize;        // Size of the fmt chunk
-    WORD audioFormat;          // Audio format (1 for PCM)
-    WORD numChannels;          // Number of channels
-    DWORD sampleRate;          // Sampling frequency
-    DWORD byteRate;            // (Sample Rate * BitsPerSample * Channels) / 8
-    WORD blockAlign;           // Block align (Channels * BitsPerSample) / 8
-    WORD bitsPerSample;        // Bits per sample
-    char dataHeader[4];        // "data"
-    DWORD dataSize;            // Size of the data section
-} WAVHeader;
-#pragma pack()
-
 // -----------------------
 // Function declarations
 
@@ -309,31 +395,180 @@ void WindowResizeEvent();
 
 bool CursorOverTilemap();
 
-void BufferRectangle2d(Vec2f offset);
-void DrawBufferedRectangle2ds(ID3D11ShaderResourceView* texture);
+/**
+ * @brief Tilemap chunk callbacks backed by g_tilemap_edits, so modified chunks keep their tiles across eviction.
+ */
+void LoadTilemapChunk(void* user_data, Vec2i chunk_coord, Tile* tiles);
+void StoreTilemapChunk(void* user_data, Vec2i chunk_coord, Tile* tiles);
+
+/**
+ * @brief g_tilemap_edits spill callback, writes the least recently used edited chunk to the spill file.
+ */
+void SpillTilemapChunk(void* user_data, Vec2i chunk_coord, Tile* tiles);
+
+/**
+ * @brief Queue a textured quad for depth sorted drawing. The quad's bottom edge is used as its isometric depth.
+ */
+void QueueSprite(Texture* texture, Vec2f center, Vec2f size, Vec4f uv_rect, u32 layer);
+
+/**
+ * @brief Queue an already packed sprite instance, sorted by its 'depth'. Cheapest way to draw sprites whose data rarely changes.
+ */
+void QueueSpriteInstance(u32 texture_id, SpriteInstance* instance, u32 layer);
+
+/**
+ * @brief Queue a sprite from a region of the sprite atlas.
+ */
+void QueueAtlasSprite(TextureAtlasRegion* region, Vec2f center, Vec2f size, u32 layer);
+
+/**
+ * @brief Sort queued sprites back to front and record them as instanced sprite runs, one per texture change.
+ */
+void DrawQueuedSprites();
+
+/**
+ * @brief Draw a tilemap chunk from its GPU vertex buffer, rebuilding the buffer first if the chunk mesh is dirty.
+ */
+void DrawTilemapChunk(TilemapChunk* chunk, u32 texture_id);
 
 void StrToWideStr(char* str, wchar_t* wresult, int str_count);
 
-Vec2f TilemapCoordsToIsometricScreenSpace(Vec2f tilemap_coord);
+/**
+ * @brief Read a whole resource file through g_vfs into a malloc'ed buffer. Breaks if the file can not be read.
+ */
+unsigned char* LoadFileToPtr(char* path, size_t* get_file_size);
+
+/**
+ * @brief Compile one entry point of an HLSL file read through g_vfs. Breaks on compile errors.
+ */
+ID3DBlob* CompileShaderFromVfs(char* path, const char* entry_point, const char* target);
+
+/**
+ * @brief CompileShaderFromVfs that returns nullptr with the compiler output in 'error' instead of breaking. Safe to call from any thread.
+ */
+ID3DBlob* TryCompileShaderFromVfs(const char* path, const char* entry_point, const char* target, char* error);
+
+/**
+ * @brief ShaderCacheSourceReader callback reading shader sources and includes through g_vfs.
+ */
+byte* ReadShaderSource(void* user_data, const char* path, size_t* size);
 
-unsigned char* LoadFileToPtr(wchar_t* filename, size_t* get_file_size);
+/**
+ * @brief Create the shaders and input layout of 'program' from compiled blobs. The old ones are released only if all of them were created.
+ */
+bool CreateShaderProgram(ShaderProgram* program, ID3DBlob* vertex_blob, ID3DBlob* pixel_blob);
 
 FontAtlasInfo LoadFontAtlas(char* filepath, float pixel_height);
+FontAtlasInfo CreateFontAtlas(AssetFontBitmap* bitmap);
 
 f32 GetTextWidthPx(char* text, FontAtlasInfo* font_info);
 
+/**
+ * @brief Load an image file as a mipmapped texture. A .qoi file next to the source, written by tools/qoi_converter, is decoded instead unless the source is newer.
+ */
 void LoadTextureFromFilepath(Texture* texture, char* filepath);
+void CreateTextureFromMipChain(Texture* texture, MipChain* mip_chain, i32 channels);
 
-Vec2f ScreenSpaceToTilemapCoords(Vec2f tilemap_coord);
+/**
+ * @brief Load a block compressed texture written by tools/texture_compressor. The levels are uploaded as stored, without decoding.
+ */
+void LoadBlockTextureFromFilepath(Texture* texture, char* filepath);
+void CreateTextureFromBlockTexture(Texture* texture, BlockTexture* block_texture);
 
-void LoadGlobalFonts();
+/**
+ * @brief Load an atlas manifest written by tools/atlas_packer and queue its page textures on 'loader'. Returns false if the manifest is missing or invalid.
+ */
+bool LoadTextureAtlas(TextureAtlas* atlas, AssetId* pages, i32 max_pages, char* manifest_path, AssetLoader* loader);
 
-Tile* GetCursorTilePtr();
+/**
+ * @brief Load an edited atlas manifest in place of 'atlas'. Pages both versions use keep their textures, the old atlas stays if the new one is invalid.
+ */
+void ReloadTextureAtlas(TextureAtlas* atlas, AssetId* pages, char* manifest_path);
+
+/**
+ * @brief Release the page textures of an atlas loaded with LoadTextureAtlas and free the manifest.
+ */
+void ReleaseTextureAtlas(TextureAtlas* atlas, AssetId* pages);
+
+/**
+ * @brief True if 'path' is the .png or the .fbct file of an atlas page, whichever of the two the page is loaded from.
+ */
+bool IsTextureAtlasPageFile(TextureAtlas* atlas, AssetId* pages, const char* path);
+
+/**
+ * @brief AssetUploadSink callback of the startup loader and the asset stream. 'user_data' is the WAVEFORMATEX the sound voices are created with, or null.
+ */
+void UploadLoadedAsset(void* user_data, AssetLoadJob* job);
+
+/**
+ * @brief Reference to the texture of an image or block texture file, loading it only the first time the path is acquired. With a 'loader' the load is queued on it, otherwise it happens right away.
+ */
+AssetId AcquireTexture(char* filepath, AssetKind kind, AssetLoader* loader);
+
+/**
+ * @brief Texture of 'id', nullptr once every reference was released.
+ */
+Texture* ResolveTexture(AssetId id);
+
+/**
+ * @brief Drop a reference taken with AcquireTexture. The GPU texture is destroyed with the last one.
+ */
+void ReleaseTexture(AssetId id);
+
+u32 RegisterDrawTexture(ID3D11ShaderResourceView* resource_view);
+
+/**
+ * @brief Give a texture its new view. The first view registers a draw texture, later ones replace the old view in the same slot.
+ */
+void SetTextureResourceView(Texture* texture, ID3D11ShaderResourceView* resource_view);
+
+/**
+ * @brief Put a created registered texture under residency management, or report its finished residency load.
+ */
+void UpdateTextureResidency(Texture* texture, const u64* level_bytes, i32 level_count);
+
+void D3D11ResidencyLoad(void* user_data, u32 texture_id, i32 top_level);
+bool D3D11ResidencyEvict(void* user_data, u32 texture_id, i32 top_level);
+
+/**
+ * @brief Reload whatever was loaded from the changed file. Textures and sounds are decoded by the asset stream and shaders compile on a thread, all of them are swapped in at the start of a later frame.
+ */
+void ApplyFileChange(FileWatcherChange* change);
+void ReloadTexture(AssetId id);
+void StartShaderReload(ShaderProgramId program_id);
+
+/**
+ * @brief Swap in shader programs whose recompile finished. A program that failed to compile keeps its old shaders.
+ */
+void FinishShaderReloads();
+
+/**
+ * @brief Stop every voice and keep the samples of a replaced sound until the voices let go of them. Returns false if too many are waiting already.
+ */
+bool RetireSoundData(byte* data);
+void ReleaseRetiredSounds();
+
+void LoadGlobalFonts();
+void SetDebugFont(FontAtlasInfo font);
 
 void SetDefaultViewportDimensions();
 
 void DrawDotOnScreen(Vec2f ndc, f32 size_px, Vec3f color);
 Vec2f DrawTextToScreen(char* text, Vec2f screen_pos, FontAtlasInfo* font_info);
+void UploadDynamicVertices(void* vertices, u32 byte_size, UINT stride);
+
+void D3D11RenderBindPipeline(void* user_data, u32 pipeline);
+void D3D11RenderBindTexture(void* user_data, u32 texture);
+void D3D11RenderDrawQuads(void* user_data, void* vertices, u32 vertex_stride, u32 quad_count);
+void D3D11RenderDrawStaticQuads(void* user_data, u32 static_buffer, u32 vertex_stride, u32 quad_count);
+void D3D11RenderDrawInstances(void* user_data, void* instances, u32 instance_stride, u32 instance_count);
+
+void CreateD3D11RingBuffer(D3D11RingBuffer* ring_buffer, VertexRing* ring, D3D11_BUFFER_DESC* buffer_desc);
+
+byte* D3D11VertexRingMap(void* user_data, bool discard);
+void D3D11VertexRingUnmap(void* user_data);
+void D3D11VertexRingSignalFence(void* user_data, i32 fence_slot);
+bool D3D11VertexRingIsFenceComplete(void* user_data, i32 fence_slot);
 void DrawRectangleToScreen(Vec2f top_left, Vec2f top_right, Vec2f bot_left, Vec2f bot_right, Vec3f color);
 // void DrawTilemapTile(ID3D11ShaderResourceView* texture, Vec2f coordinate);
 void DrawLineOnScreen(Vec2f ndc_start, Vec2f ndc_end, f32 size_px, Vec3f color);
@@ -341,28 +576,49 @@ void DrawLineOnScreen(Vec2f ndc_start, Vec2f ndc_end, f32 size_px, Vec3f color);
 DirectX::XMMATRIX GetViewportProjectionMatrix();
 DirectX::XMMATRIX GetViewportViewMatrix();
 
-BYTE* LoadWAWFile(wchar_t* filePath, WAVHeader* wavHeader);
-
 void PlayMonoSound(Buffer audio_buffer);
 
 // ---------
 // Globals
 
-const int tilemap_width = 40;
-const int tilemap_height = 40;
-
-Tile tilemap_data[tilemap_width * tilemap_height] = {0};
-
-Tilemap g_tilemap = {
-    .width = tilemap_width,
-    .height = tilemap_height,
-    .tiles = tilemap_data
-};
+Tilemap g_tilemap = {};
+TilemapChunkStore g_tilemap_edits = {};
+// Temporary file of spilled edits. Each chunk has a fixed place in it once spilled, 1 + its slot, 0 for never
+FILE* g_tilemap_spill_file = nullptr;
+u32 g_tilemap_spill_slots[WORLD_TILEMAP_CHUNKS_X * WORLD_TILEMAP_CHUNKS_Y] = {};
+u32 g_tilemap_spill_slot_count = 0;
+TilemapVisibleRange visible_tilemap_range = {};
+i32 frame_visible_chunk_count = 0;
+i32 frame_skipped_chunk_count = 0;
+i32 frame_culled_sprite_count = 0;
+
+const TileAtlasLayout tile_atlas_01_layout = { .columns = 3, .rows = 1 };
+ID3D11Buffer* tilemap_chunk_vertex_buffers[WORLD_TILEMAP_CHUNK_BUDGET] = {};
+i32 tilemap_chunk_vertex_counts[WORLD_TILEMAP_CHUNK_BUDGET] = {};
+TilemapTileVertex* tilemap_chunk_mesh_scratch = nullptr;
+
+QuadDrawQueue sprite_draw_queue = {};
+SpriteCullRect sprite_cull_rect = {};
+ID3D11ShaderResourceView* draw_textures[MAX_DRAW_TEXTURES] = {};
+i32 draw_texture_count = 0;
+
+RenderQueue render_queue = {};
+RenderBackend d3d11_render_backend = {};
+u32 render_layer = RENDER_LAYER_WORLD;
+u32 sprite_run_order = 0;
 
 Buffer sound_buffer_1 = {};
 Buffer sound_buffer_2 = {};
 Buffer sound_buffer_3 = {};
 
+SoundFile sound_files[] = {
+    { "sounds/Jump.wav", &sound_buffer_1, {} },
+    { "sounds/Laser_Shoot.wav", &sound_buffer_2, {} },
+    { "sounds/Pickup_Coin.wav", &sound_buffer_3, {} },
+};
+byte* retired_sound_data[MAX_RETIRED_SOUNDS] = {};
+i32 retired_sound_count = 0;
+
 const int MAX_VOICES = 20;
 IXAudio2SourceVoice* mono_source_voice_pool[MAX_VOICES] = { nullptr };
 IXAudio2* pXAudio2 = NULL;
@@ -371,16 +627,25 @@ IXAudio2MasteringVoice* pMasterVoice = NULL;
 const f32 debug_font_vh_size = 1.5f;
 FontAtlasInfo g_debug_font;
 
+Vfs g_vfs;
+AssetStream g_asset_stream;
+AssetHandle debug_font_request = {};
+
+f32 startup_time_ms = 0.0f;
+AssetLoaderStats startup_asset_stats = {};
+
 Window g_window = {};
 FrameInput frame_input = {};
 
 const int BUFFER_SLOT_VIEW_PROJECTION = 0;
 const int BUFFER_SLOT_MODEL = 1;
 const int BUFFER_SLOT_VIEW = 2;
+const int BUFFER_SLOT_SPRITE_INSTANCE_DRAW = 3;
 
 ID3D11Buffer* cbuffer_view_projection = nullptr;
 ID3D11Buffer* cbuffer_model = nullptr;
 ID3D11Buffer* cbuffer_view = nullptr;
+ID3D11Buffer* cbuffer_sprite_instance_draw = nullptr;
 
 IDXGISwapChain *swapChain;
 ID3D11Device* id3d11_device;
@@ -389,25 +654,75 @@ ID3D11RenderTargetView *renderTargetView;
 D3D11_VIEWPORT render_viewport;
 
 ID3D11SamplerState* g_sampler;
-Texture tile_atlas_01 = {};
-Texture dude_01 = {};
+AssetRegistry g_assets;
+Texture registered_textures[MAX_REGISTERED_ASSETS] = {};
+AssetId tile_atlas_01 = {};
+AssetId dude_01 = {};
+
+// Residency is tracked by draw texture id
+TextureResidency texture_residency = {};
+TextureResidencyBackend d3d11_residency_backend = {};
+Texture* resident_textures[MAX_DRAW_TEXTURES] = {};
+AssetHandle residency_requests[MAX_DRAW_TEXTURES] = {};
+
+FileWatcher g_file_watcher;
+i32 hot_reload_count = 0;
+
+ShaderCache g_shader_cache;
+ShaderCacheSourceReader vfs_shader_reader = { &g_vfs, ReadShaderSource };
+
+TextureAtlas sprite_atlas = {};
+AssetId sprite_atlas_pages[MAX_ATLAS_PAGES] = {};
 FLOAT clear_color[] = { 1.0f, 0.0f, 1.0f, 1.0f };
 
 ID3D11VertexShader* text_ui_vertex_shader = nullptr;
 ID3D11PixelShader* text_ui_pixel_shader = nullptr;
-ID3D11Buffer* text_ui_vertex_buffer = nullptr;
 ID3D11InputLayout* text_ui_input_layout = nullptr;
+TextRunCache text_run_cache = {};
+TextUiVertex* text_layout_scratch = nullptr;
 
 ID3D11VertexShader* rectangle_vertex_shader = nullptr;
 ID3D11PixelShader* rectangle_pixel_shader = nullptr;
-ID3D11Buffer* rectangle_vertex_buffer = nullptr;
 ID3D11InputLayout* rectangle_input_layout = nullptr;
 
 ID3D11VertexShader* rectangle_2d_vertex_shader = nullptr;
 ID3D11PixelShader* rectangle_2d_pixel_shader = nullptr;
-ID3D11Buffer* rectangle_2d_vertex_buffer = nullptr;
 ID3D11InputLayout* rectangle_2d_input_layout = nullptr;
-u64 buffered_rectangle_2d_vertex_count = 0;
+
+const D3D11_INPUT_ELEMENT_DESC rectangle_input_elements[] = {
+    { "POSITION", 0, DXGI_FORMAT_R32G32_FLOAT, 0, 0, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+    { "COLOR", 0,    DXGI_FORMAT_R8G8B8A8_UNORM, 0, 8, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+};
+
+const D3D11_INPUT_ELEMENT_DESC rectangle_2d_input_elements[] = {
+    { "POSITION", 0, DXGI_FORMAT_R32G32_FLOAT, 0, 0, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+    { "COLOR",    0, DXGI_FORMAT_R8G8B8A8_UNORM, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+    { "TEXCOORD", 0, DXGI_FORMAT_R16G16_UNORM, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+};
+
+const D3D11_INPUT_ELEMENT_DESC text_ui_input_elements[] = {
+    { "POSITION", 0, DXGI_FORMAT_R32G32_FLOAT, 0, 0, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+    { "TEXCOORD", 0, DXGI_FORMAT_R16G16_UNORM, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+};
+
+// Indexed by ShaderProgramId
+ShaderProgram shader_programs[SHADER_PROGRAM_COUNT] = {
+    { "shaders/rectangle.hlsl", rectangle_input_elements, ARRAYSIZE(rectangle_input_elements), &rectangle_vertex_shader, &rectangle_pixel_shader, &rectangle_input_layout },
+    { "shaders/rectangle_2d.hlsl", rectangle_2d_input_elements, ARRAYSIZE(rectangle_2d_input_elements), &rectangle_2d_vertex_shader, &rectangle_2d_pixel_shader, &rectangle_2d_input_layout },
+    { "shaders/text_ui.hlsl", text_ui_input_elements, ARRAYSIZE(text_ui_input_elements), &text_ui_vertex_shader, &text_ui_pixel_shader, &text_ui_input_layout },
+};
+ShaderReload shader_reloads[SHADER_PROGRAM_COUNT];
+
+ID3D11Buffer* quad_index_buffer = nullptr;
+
+D3D11RingBuffer dynamic_vertex_buffer = {};
+VertexRing dynamic_vertex_ring = {};
+
+ID3D11VertexShader* sprite_instanced_vertex_shader = nullptr;
+ID3D11PixelShader* sprite_instanced_pixel_shader = nullptr;
+D3D11RingBuffer sprite_instance_buffer = {};
+ID3D11ShaderResourceView* sprite_instance_view = nullptr;
+VertexRing sprite_instance_ring = {};
 
 char cstr_buffer_256[STR_BUFFER_COUNT] = {};
 CStrBuffer temp_cstr = {
@@ -435,26 +750,422 @@ Camera2D viewport_camera = {
 
 void LoadGlobalFonts() {
     float debug_font_size = g_window.GetVHInPx(debug_font_vh_size);
-    g_debug_font = LoadFontAtlas((char*)"G:\\projects\\game\\finite-engine-dev\\resources\\fonts\\Roboto-Light.ttf", debug_font_size);
+    if (!g_asset_stream.slots) {
+        SetDebugFont(LoadFontAtlas((char*)DEBUG_FONT_PATH, debug_font_size));
+        return;
+    }
+
+    // The old font stays in use until the new size is baked. A resize before that makes the pending one stale
+    AssetStreamCancel(&g_asset_stream, debug_font_request);
+    debug_font_request = AssetStreamRequest(&g_asset_stream, ASSET_KIND_FONT, DEBUG_FONT_PATH, nullptr, debug_font_size);
+}
+
+void SetDebugFont(FontAtlasInfo font) {
+    // Glyph metrics change with the font size, cached runs are stale
+    if (text_run_cache.runs) {
+        TextRunCacheClear(&text_run_cache);
+    }
+
+    // Reloaded fonts keep their draw texture slot. The context keeps its own reference while the old view is bound
+    u32 debug_font_draw_id = g_debug_font.draw_id;
+    ID3D11ShaderResourceView* old_texture = g_debug_font.texture;
+    g_debug_font = font;
+    if (old_texture && old_texture != g_debug_font.texture) {
+        old_texture->Release();
+    }
+
+    if (debug_font_draw_id == RENDER_TEXTURE_NONE) {
+        g_debug_font.draw_id = RegisterDrawTexture(g_debug_font.texture);
+    }
+    else {
+        g_debug_font.draw_id = debug_font_draw_id;
+        draw_textures[debug_font_draw_id] = g_debug_font.texture;
+    }
+}
+
+u32 RegisterDrawTexture(ID3D11ShaderResourceView* resource_view) {
+    // Slots of released textures are reused first
+    for (i32 i = 0; i < draw_texture_count; i++) {
+        if (!draw_textures[i]) {
+            draw_textures[i] = resource_view;
+            return (u32)i;
+        }
+    }
+
+    if (MAX_DRAW_TEXTURES <= draw_texture_count) {
+        ErrorMessageAndBreak((char*)"Too many draw textures");
+    }
+    u32 draw_id = (u32)draw_texture_count;
+    draw_textures[draw_texture_count++] = resource_view;
+    return draw_id;
+}
+
+void SetTextureResourceView(Texture* texture, ID3D11ShaderResourceView* resource_view) {
+    // A reloaded texture keeps its draw texture slot
+    if (texture->resource_view) {
+        texture->resource_view->Release();
+        texture->resource_view = resource_view;
+        draw_textures[texture->draw_id] = resource_view;
+    }
+    else {
+        texture->resource_view = resource_view;
+        texture->draw_id = RegisterDrawTexture(resource_view);
+    }
+}
+
+AssetId AcquireTexture(char* filepath, AssetKind kind, AssetLoader* loader) {
+    bool is_new = false;
+    AssetId id = AssetRegistryAcquire(&g_assets, kind, filepath, &is_new);
+    if (id.generation == 0) {
+        ErrorMessageAndBreak((char*)"Asset not registered, too many registered assets or the path is too long");
+    }
+    if (!is_new) {
+        return id;
+    }
+
+    // Entries and textures share indices
+    Texture* texture = &registered_textures[id.index];
+    *texture = {};
+    texture->asset = id;
+    AssetRegistrySetResource(&g_assets, id, texture);
+
+    if (loader) {
+        if (!AssetLoaderAdd(loader, kind, filepath, texture)) {
+            ErrorMessageAndBreak((char*)"Too many startup assets");
+        }
+    }
+    else if (kind == ASSET_KIND_BLOCK_TEXTURE) {
+        LoadBlockTextureFromFilepath(texture, filepath);
+    }
+    else {
+        LoadTextureFromFilepath(texture, filepath);
+    }
+    return id;
+}
+
+Texture* ResolveTexture(AssetId id) {
+    return (Texture*)AssetRegistryResolve(&g_assets, id);
+}
+
+void ReleaseTexture(AssetId id) {
+    Texture* texture = (Texture*)AssetRegistryRelease(&g_assets, id);
+    if (!texture || !texture->resource_view) {
+        return;
+    }
+
+    u32 draw_id = texture->draw_id;
+    AssetStreamCancel(&g_asset_stream, residency_requests[draw_id]);
+    residency_requests[draw_id] = {};
+    TextureResidencyUntrack(&texture_residency, draw_id);
+    resident_textures[draw_id] = nullptr;
+
+    draw_textures[draw_id] = nullptr;
+    texture->resource_view->Release();
+    *texture = {};
+}
+
+void UpdateTextureResidency(Texture* texture, const u64* level_bytes, i32 level_count) {
+    if (texture->asset.generation == 0) {
+        return;
+    }
+
+    // A reloaded file can have a different size, which starts tracking over
+    resident_textures[texture->draw_id] = texture;
+    TextureResidencyEntry* entry = &texture_residency.entries[texture->draw_id];
+    if (entry->is_tracked && entry->level_count == level_count && entry->level_bytes[0] == level_bytes[0]) {
+        TextureResidencyLoaded(&texture_residency, texture->draw_id, texture->top_level);
+    }
+    else {
+        TextureResidencyTrack(&texture_residency, texture->draw_id, level_bytes, level_count, texture->top_level);
+    }
+}
+
+void D3D11ResidencyLoad(void* user_data, u32 texture_id, i32 top_level) {
+    // A reloading texture keeps its levels until the reload is uploaded
+    if (AssetStreamGetState(&g_asset_stream, residency_requests[texture_id]) != ASSET_STREAM_NONE) {
+        TextureResidencyLoadFailed(&texture_residency, texture_id);
+        return;
+    }
+
+    // The current view stays in use until the upload replaces it
+    Texture* texture = resident_textures[texture_id];
+    texture->top_level = top_level;
+
+    AssetKind kind = g_assets.kinds[texture->asset.index];
+    residency_requests[texture_id] = AssetStreamRequest(&g_asset_stream, kind, AssetRegistryPath(&g_assets, texture->asset), texture);
+    if (residency_requests[texture_id].generation == 0) {
+        texture->top_level = texture_residency.entries[texture_id].resident_level;
+        TextureResidencyLoadFailed(&texture_residency, texture_id);
+    }
+}
+
+bool D3D11ResidencyEvict(void* user_data, u32 texture_id, i32 top_level) {
+    Texture* texture = resident_textures[texture_id];
+    i32 dropped_levels = top_level - texture->top_level;
+
+    ID3D11Resource* old_resource = nullptr;
+    texture->resource_view->GetResource(&old_resource);
+    ID3D11Texture2D* old_texture = (ID3D11Texture2D*)old_resource;
+
+    D3D11_TEXTURE2D_DESC textureDesc = {};
+    old_texture->GetDesc(&textureDesc);
+    textureDesc.Width = 1u < (textureDesc.Width >> dropped_levels) ? textureDesc.Width >> dropped_levels : 1u;
+    textureDesc.Height = 1u < (textureDesc.Height >> dropped_levels) ? textureDesc.Height >> dropped_levels : 1u;
+    textureDesc.MipLevels -= dropped_levels;
+    textureDesc.Usage = D3D11_USAGE_DEFAULT;
+
+    // Block compressed textures need a top level of whole blocks
+    bool is_block_compressed = textureDesc.Format == DXGI_FORMAT_BC1_UNORM || textureDesc.Format == DXGI_FORMAT_BC3_UNORM || textureDesc.Format == DXGI_FORMAT_BC7_UNORM;
+    ID3D11Texture2D* new_texture = nullptr;
+    bool is_ok = !(is_block_compressed && (textureDesc.Width % 4 != 0 || textureDesc.Height % 4 != 0))
+        && SUCCEEDED(id3d11_device->CreateTexture2D(&textureDesc, nullptr, &new_texture));
+
+    ID3D11ShaderResourceView* resource_view = nullptr;
+    if (is_ok) {
+        // Copied on the GPU, evicting never goes back to the file
+        for (UINT level = 0; level < textureDesc.MipLevels; level++) {
+            deviceContext->CopySubresourceRegion(new_texture, level, 0, 0, 0, old_texture, level + dropped_levels, nullptr);
+        }
+
+        D3D11_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
+        srvDesc.Format = textureDesc.Format;
+        srvDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
+        srvDesc.Texture2D.MostDetailedMip = 0;
+        srvDesc.Texture2D.MipLevels = textureDesc.MipLevels;
+        is_ok = SUCCEEDED(id3d11_device->CreateShaderResourceView(new_texture, &srvDesc, &resource_view));
+        new_texture->Release();
+    }
+    old_resource->Release();
+
+    if (!is_ok) {
+        return false;
+    }
+
+    texture->resource_view->Release();
+    texture->resource_view = resource_view;
+    texture->top_level = top_level;
+    draw_textures[texture_id] = resource_view;
+    return true;
+}
+
+void ApplyFileChange(FileWatcherChange* change) {
+    // Created, removed and renamed files change what paths resolve to
+    if (change->is_structural) {
+        VfsInvalidate(&g_vfs);
+    }
+    if (change->path[0] == 0) {
+        DebugMessage((char*)"File change events were lost, save the file again to reload it\n");
+        return;
+    }
+
+    AssetId texture_id = AssetRegistryFind(&g_assets, ASSET_KIND_IMAGE, change->path);
+    if (texture_id.generation == 0) {
+        texture_id = AssetRegistryFind(&g_assets, ASSET_KIND_BLOCK_TEXTURE, change->path);
+    }
+    if (texture_id.generation == 0) {
+        // Images are decoded from a .qoi next to the source when there is one, the sources here are .png files
+        char source_path[ASSET_PATH_MAX];
+        PathWithExtension(source_path, ASSET_PATH_MAX, change->path, ".qoi");
+        bool is_qoi = AssetPackPathEquals(source_path, change->path);
+        PathWithExtension(source_path, ASSET_PATH_MAX, change->path, ".png");
+        texture_id = is_qoi ? AssetRegistryFind(&g_assets, ASSET_KIND_IMAGE, source_path) : AssetId{};
+    }
+    if (texture_id.generation != 0) {
+        ReloadTexture(texture_id);
+        return;
+    }
+
+    // An atlas page is loaded from its .fbct while that is current. Editing the .png, or compressing it again,
+    // switches the page to the other file, which loading the atlas again picks up
+    if (IsTextureAtlasPageFile(&sprite_atlas, sprite_atlas_pages, change->path)) {
+        ReloadTextureAtlas(&sprite_atlas, sprite_atlas_pages, (char*)SPRITE_ATLAS_PATH);
+        return;
+    }
+
+    for (u32 i = 0; i < SHADER_PROGRAM_COUNT; i++) {
+        if (VfsPathEquals(shader_programs[i].path, change->path)) {
+            StartShaderReload((ShaderProgramId)i);
+            return;
+        }
+    }
+
+    // Any other shader file may be included by a program. Programs that do not include it load from the cache
+    char include_path[ASSET_PATH_MAX];
+    PathWithExtension(include_path, ASSET_PATH_MAX, change->path, ".hlsli");
+    bool is_include = VfsPathEquals(include_path, change->path);
+    PathWithExtension(include_path, ASSET_PATH_MAX, change->path, ".hlsl");
+    if (is_include || VfsPathEquals(include_path, change->path)) {
+        for (u32 i = 0; i < SHADER_PROGRAM_COUNT; i++) {
+            StartShaderReload((ShaderProgramId)i);
+        }
+        return;
+    }
+
+    for (SoundFile& sound_file : sound_files) {
+        if (VfsPathEquals(sound_file.path, change->path)) {
+            AssetStreamCancel(&g_asset_stream, sound_file.reload_request);
+            sound_file.reload_request = AssetStreamRequest(&g_asset_stream, ASSET_KIND_SOUND, sound_file.path, sound_file.buffer);
+            hot_reload_count++;
+            return;
+        }
+    }
+
+    if (VfsPathEquals(SPRITE_ATLAS_PATH, change->path)) {
+        ReloadTextureAtlas(&sprite_atlas, sprite_atlas_pages, (char*)SPRITE_ATLAS_PATH);
+        return;
+    }
+
+    if (VfsPathEquals(DEBUG_FONT_PATH, change->path)) {
+        LoadGlobalFonts();
+        hot_reload_count++;
+    }
+}
+
+void ReloadTexture(AssetId id) {
+    Texture* texture = ResolveTexture(id);
+    if (!texture || !texture->resource_view) {
+        return;
+    }
+
+    // A residency load in flight would upload the old file, the reload takes its place at the resident levels
+    u32 draw_id = texture->draw_id;
+    AssetStreamCancel(&g_asset_stream, residency_requests[draw_id]);
+    if (texture_residency.entries[draw_id].is_tracked) {
+        texture->top_level = texture_residency.entries[draw_id].resident_level;
+        TextureResidencyLoadFailed(&texture_residency, draw_id);
+    }
+
+    residency_requests[draw_id] = AssetStreamRequest(&g_asset_stream, g_assets.kinds[id.index], AssetRegistryPath(&g_assets, id), texture);
+    if (residency_requests[draw_id].generation == 0) {
+        DebugMessage((char*)"Texture reload skipped, the asset stream is full\n");
+        return;
+    }
+    hot_reload_count++;
+}
+
+void CompileShaderReload(ShaderProgram* program, ShaderReload* reload) {
+    reload->vertex_blob = TryCompileShaderFromVfs(program->path, "VSMain", "vs_5_0", reload->error);
+    if (reload->vertex_blob) {
+        reload->pixel_blob = TryCompileShaderFromVfs(program->path, "PSMain", "ps_5_0", reload->error);
+    }
+    reload->is_done.store(true, std::memory_order_release);
+}
+
+void StartShaderReload(ShaderProgramId program_id) {
+    // A save during a recompile compiles again once it is done
+    ShaderReload* reload = &shader_reloads[program_id];
+    if (reload->is_pending) {
+        reload->is_requested_again = true;
+        return;
+    }
+
+    reload->is_pending = true;
+    reload->is_requested_again = false;
+    reload->vertex_blob = nullptr;
+    reload->pixel_blob = nullptr;
+    reload->error[0] = '\0';
+    reload->is_done.store(false, std::memory_order_relaxed);
+    reload->thread = std::thread(CompileShaderReload, &shader_programs[program_id], reload);
+}
+
+void FinishShaderReloads() {
+    for (u32 i = 0; i < SHADER_PROGRAM_COUNT; i++) {
+        ShaderReload* reload = &shader_reloads[i];
+        if (!reload->is_pending || !reload->is_done.load(std::memory_order_acquire)) {
+            continue;
+        }
+
+        reload->thread.join();
+        reload->is_pending = false;
+
+        if (!reload->vertex_blob || !reload->pixel_blob) {
+            OutputDebugStringA(reload->error);
+        }
+        else if (!CreateShaderProgram(&shader_programs[i], reload->vertex_blob, reload->pixel_blob)) {
+            DebugMessage((char*)"Reloaded shaders could not be created, keeping the old ones\n");
+        }
+        else {
+            hot_reload_count++;
+        }
+
+        if (reload->vertex_blob) {
+            reload->vertex_blob->Release();
+        }
+        if (reload->pixel_blob) {
+            reload->pixel_blob->Release();
+        }
+        reload->vertex_blob = nullptr;
+        reload->pixel_blob = nullptr;
+
+        if (reload->is_requested_again) {
+            StartShaderReload((ShaderProgramId)i);
+        }
+    }
+}
+
+bool RetireSoundData(byte* data) {
+    if (MAX_RETIRED_SOUNDS <= retired_sound_count) {
+        return false;
+    }
+
+    // Voices do not say which samples they play, so all of them stop
+    for (IXAudio2SourceVoice* voice : mono_source_voice_pool) {
+        if (voice) {
+            voice->Stop(0);
+            voice->FlushSourceBuffers();
+        }
+    }
+    retired_sound_data[retired_sound_count++] = data;
+    return true;
+}
+
+void ReleaseRetiredSounds() {
+    if (retired_sound_count == 0) {
+        return;
+    }
+
+    // Voices that failed to be created play nothing
+    for (IXAudio2SourceVoice* voice : mono_source_voice_pool) {
+        if (!voice) {
+            continue;
+        }
+        XAUDIO2_VOICE_STATE state;
+        voice->GetState(&state);
+        if (0 < state.BuffersQueued) {
+            return;
+        }
+    }
+
+    for (i32 i = 0; i < retired_sound_count; i++) {
+        free(retired_sound_data[i]);
+    }
+    retired_sound_count = 0;
 }
 
 void LoadTextureFromFilepath(Texture* texture, char* filepath) {
+    MipChain mip_chain = {};
+    i32 channels = 0;
+    char error[ASSET_ERROR_MAX];
+
+    if (!AssetDecodeImage(&g_vfs, filepath, &mip_chain, &channels, error)) {
+        ErrorMessageAndBreak(error);
+    }
+
+    CreateTextureFromMipChain(texture, &mip_chain, channels);
+    MipChainDestroy(&mip_chain);
+}
+
+void CreateTextureFromMipChain(Texture* texture, MipChain* mip_chain, i32 channels) {
     HRESULT hr;
-    int image_x = 0;
-    int image_y = 0;
-    int image_channels = 0;
     int bytes_per_pixel = 4;
 
-    auto image = stbi_load(filepath, &image_x, &image_y, &image_channels, bytes_per_pixel);
-
-    if (!image) {
-       ErrorMessageAndBreak((wchar_t*)L"stbi_load failed");
-    }
+    i32 top_level = texture->top_level < mip_chain->level_count ? texture->top_level : mip_chain->level_count - 1;
+    i32 level_count = mip_chain->level_count - top_level;
 
     D3D11_TEXTURE2D_DESC textureDesc = {};
-    textureDesc.Width = image_x;
-    textureDesc.Height = image_y;
-    textureDesc.MipLevels = 1;
+    textureDesc.Width = mip_chain->widths[top_level];
+    textureDesc.Height = mip_chain->heights[top_level];
+    textureDesc.MipLevels = level_count;
     textureDesc.ArraySize = 1;
     textureDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
     textureDesc.SampleDesc.Count = 1;
@@ -463,12 +1174,18 @@ void LoadTextureFromFilepath(Texture* texture, char* filepath) {
     textureDesc.CPUAccessFlags = 0;
     textureDesc.MiscFlags = 0;
 
-    D3D11_SUBRESOURCE_DATA img_subresource_data = {};
-    img_subresource_data.pSysMem = image;
-    img_subresource_data.SysMemPitch = static_cast<UINT>(bytes_per_pixel * image_x);
+    D3D11_SUBRESOURCE_DATA img_subresource_data[MIPMAP_MAX_LEVELS] = {};
+    u64 level_bytes[MIPMAP_MAX_LEVELS] = {};
+    for (i32 level = 0; level < mip_chain->level_count; level++) {
+        level_bytes[level] = (u64)bytes_per_pixel * mip_chain->widths[level] * mip_chain->heights[level];
+    }
+    for (i32 level = 0; level < level_count; level++) {
+        img_subresource_data[level].pSysMem = mip_chain->pixels + mip_chain->offsets[top_level + level];
+        img_subresource_data[level].SysMemPitch = static_cast<UINT>(bytes_per_pixel * mip_chain->widths[top_level + level]);
+    }
 
     ID3D11Texture2D* texture_2d;
-    hr = id3d11_device->CreateTexture2D(&textureDesc, &img_subresource_data, &texture_2d);
+    hr = id3d11_device->CreateTexture2D(&textureDesc, img_subresource_data, &texture_2d);
 
     if (FAILED(hr)) {
         ErrorMessageAndBreak((wchar_t*)L"Failed to create texture");
@@ -478,19 +1195,237 @@ void LoadTextureFromFilepath(Texture* texture, char* filepath) {
     srvDesc.Format = textureDesc.Format;
     srvDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
     srvDesc.Texture2D.MostDetailedMip = 0;
-    srvDesc.Texture2D.MipLevels = 1;
+    srvDesc.Texture2D.MipLevels = level_count;
 
-    hr = id3d11_device->CreateShaderResourceView(texture_2d, &srvDesc, &texture->resource_view);
+    ID3D11ShaderResourceView* resource_view = nullptr;
+    hr = id3d11_device->CreateShaderResourceView(texture_2d, &srvDesc, &resource_view);
 
     if (FAILED(hr)) {
         ErrorMessageAndBreak((char*)"Failed to create shader resource view");
     }
 
-    texture->x = image_x;
-    texture->y = image_y;
-    texture->channels = image_channels;
+    // The view keeps the texture alive, releasing the view releases both
+    texture_2d->Release();
+
+    texture->x = mip_chain->widths[0];
+    texture->y = mip_chain->heights[0];
+    texture->channels = channels;
+    texture->top_level = top_level;
+
+    SetTextureResourceView(texture, resource_view);
+    UpdateTextureResidency(texture, level_bytes, mip_chain->level_count);
+}
+
+void LoadBlockTextureFromFilepath(Texture* texture, char* filepath) {
+    size_t file_size = 0;
+    byte* data = LoadFileToPtr(filepath, &file_size);
+
+    BlockTexture block_texture = {};
+    if (!BlockTextureLoadFromMemory(&block_texture, data, file_size)) {
+        ErrorMessageAndBreak((char*)"Invalid block compressed texture");
+    }
+
+    CreateTextureFromBlockTexture(texture, &block_texture);
+    BlockTextureDestroy(&block_texture);
+}
+
+void CreateTextureFromBlockTexture(Texture* texture, BlockTexture* block_texture) {
+    HRESULT hr;
+
+    DXGI_FORMAT format = DXGI_FORMAT_BC7_UNORM;
+    switch (block_texture->header->format) {
+        case BLOCK_TEXTURE_FORMAT_BC1: format = DXGI_FORMAT_BC1_UNORM; break;
+        case BLOCK_TEXTURE_FORMAT_BC3: format = DXGI_FORMAT_BC3_UNORM; break;
+        case BLOCK_TEXTURE_FORMAT_BC7: format = DXGI_FORMAT_BC7_UNORM; break;
+    }
+
+    // The top level has to be whole blocks, the levels below it do not
+    i32 top_level = texture->top_level < (i32)block_texture->header->level_count ? texture->top_level : 0;
+    u32 top_width = 1u < (block_texture->header->width >> top_level) ? block_texture->header->width >> top_level : 1u;
+    u32 top_height = 1u < (block_texture->header->height >> top_level) ? block_texture->header->height >> top_level : 1u;
+    if (top_width % 4 != 0 || top_height % 4 != 0) {
+        top_level = 0;
+        top_width = block_texture->header->width;
+        top_height = block_texture->header->height;
+    }
+    i32 level_count = (i32)block_texture->header->level_count - top_level;
+
+    D3D11_TEXTURE2D_DESC textureDesc = {};
+    textureDesc.Width = top_width;
+    textureDesc.Height = top_height;
+    textureDesc.MipLevels = level_count;
+    textureDesc.ArraySize = 1;
+    textureDesc.Format = format;
+    textureDesc.SampleDesc.Count = 1;
+    textureDesc.Usage = D3D11_USAGE_IMMUTABLE;
+    textureDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+
+    D3D11_SUBRESOURCE_DATA level_data[MIPMAP_MAX_LEVELS] = {};
+    u64 level_bytes[MIPMAP_MAX_LEVELS] = {};
+    for (u32 level = 0; level < block_texture->header->level_count; level++) {
+        level_bytes[level] = block_texture->level_sizes[level];
+    }
+    for (i32 level = 0; level < level_count; level++) {
+        level_data[level].pSysMem = block_texture->levels[top_level + level];
+        level_data[level].SysMemPitch = block_texture->level_row_pitches[top_level + level];
+    }
+
+    ID3D11Texture2D* texture_2d;
+    hr = id3d11_device->CreateTexture2D(&textureDesc, level_data, &texture_2d);
+
+    if (FAILED(hr)) {
+        ErrorMessageAndBreak((char*)"Failed to create block compressed texture");
+    }
+
+    D3D11_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
+    srvDesc.Format = format;
+    srvDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
+    srvDesc.Texture2D.MostDetailedMip = 0;
+    srvDesc.Texture2D.MipLevels = level_count;
+
+    ID3D11ShaderResourceView* resource_view = nullptr;
+    hr = id3d11_device->CreateShaderResourceView(texture_2d, &srvDesc, &resource_view);
+
+    if (FAILED(hr)) {
+        ErrorMessageAndBreak((char*)"Failed to create shader resource view");
+    }
+
+    // The view keeps the texture alive, releasing the view releases both
+    texture_2d->Release();
+
+    texture->x = (i32)block_texture->header->width;
+    texture->y = (i32)block_texture->header->height;
+    texture->channels = 4;
+    texture->top_level = top_level;
+
+    SetTextureResourceView(texture, resource_view);
+    UpdateTextureResidency(texture, level_bytes, (i32)block_texture->header->level_count);
+}
+
+bool LoadTextureAtlas(TextureAtlas* atlas, AssetId* pages, i32 max_pages, char* manifest_path, AssetLoader* loader) {
+    if (!VfsExists(&g_vfs, manifest_path)) {
+        return false;
+    }
+
+    size_t file_size = 0;
+    byte* data = LoadFileToPtr(manifest_path, &file_size);
+
+    if (!TextureAtlasLoadFromMemory(atlas, data, file_size)) {
+        free(data);
+        DebugMessage((char*)"Invalid texture atlas manifest\n");
+        return false;
+    }
+
+    if (max_pages < (i32)atlas->header->page_count) {
+        ErrorMessageAndBreak((char*)"Texture atlas has too many pages");
+    }
+
+    // Page file names are relative to the manifest directory
+    char page_path[MAX_PATH];
+    const char* directory_end = PathLastSeparator(manifest_path);
+    i32 directory_length = directory_end ? (i32)(directory_end - manifest_path) + 1 : 0;
+
+    for (u32 i = 0; i < atlas->header->page_count; i++) {
+        snprintf(page_path, MAX_PATH, "%.*s%s", directory_length, manifest_path, TextureAtlasPageName(atlas, i));
+
+        // A page run through tools/texture_compressor has a .fbct next to it, which is used instead until the page is edited
+        char compressed_path[MAX_PATH];
+        PathWithExtension(compressed_path, MAX_PATH, page_path, ".fbct");
+
+        if (AssetDerivedFileIsCurrent(&g_vfs, compressed_path, page_path)) {
+            pages[i] = AcquireTexture(compressed_path, ASSET_KIND_BLOCK_TEXTURE, loader);
+        }
+        else {
+            pages[i] = AcquireTexture(page_path, ASSET_KIND_IMAGE, loader);
+        }
+    }
+    return true;
+}
+
+void ReloadTextureAtlas(TextureAtlas* atlas, AssetId* pages, char* manifest_path) {
+    // The new pages are acquired before the old ones are released, so a page in both keeps its texture
+    TextureAtlas new_atlas = {};
+    AssetId new_pages[MAX_ATLAS_PAGES] = {};
+    if (!LoadTextureAtlas(&new_atlas, new_pages, MAX_ATLAS_PAGES, manifest_path, nullptr)) {
+        DebugMessage((char*)"Texture atlas reload skipped, the previous atlas stays in use\n");
+        return;
+    }
+
+    ReleaseTextureAtlas(atlas, pages);
+    *atlas = new_atlas;
+    memcpy(pages, new_pages, sizeof(new_pages));
+    hot_reload_count++;
+}
+
+void ReleaseTextureAtlas(TextureAtlas* atlas, AssetId* pages) {
+    u32 page_count = atlas->header ? atlas->header->page_count : 0;
+    for (u32 i = 0; i < page_count; i++) {
+        ReleaseTexture(pages[i]);
+        pages[i] = {};
+    }
+    TextureAtlasDestroy(atlas);
+}
+
+bool IsTextureAtlasPageFile(TextureAtlas* atlas, AssetId* pages, const char* path) {
+    char image_path[ASSET_PATH_MAX];
+    char compressed_path[ASSET_PATH_MAX];
+    PathWithExtension(image_path, ASSET_PATH_MAX, path, ".png");
+    PathWithExtension(compressed_path, ASSET_PATH_MAX, path, ".fbct");
+    bool is_page_file = AssetPackPathEquals(image_path, path) || AssetPackPathEquals(compressed_path, path);
+    u32 page_count = atlas->header && is_page_file ? atlas->header->page_count : 0;
+
+    for (u32 i = 0; i < page_count; i++) {
+        const char* page_path = AssetRegistryPath(&g_assets, pages[i]);
+        if (AssetPackPathEquals(page_path, image_path) || AssetPackPathEquals(page_path, compressed_path)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void UploadLoadedAsset(void* user_data, AssetLoadJob* job) {
+    if (!job->is_ok) {
+        ErrorMessageAndBreak(job->error);
+    }
+
+    switch (job->kind) {
+        case ASSET_KIND_IMAGE: {
+            CreateTextureFromMipChain((Texture*)job->target, &job->image, job->image_channels);
+            break;
+        }
+        case ASSET_KIND_BLOCK_TEXTURE: {
+            CreateTextureFromBlockTexture((Texture*)job->target, &job->block_texture);
+            break;
+        }
+        case ASSET_KIND_SOUND: {
+            // The sound buffer keeps the samples, voices are created with the format of the last sound
+            Buffer* sound_buffer = (Buffer*)job->target;
+            if (sound_buffer->data && !RetireSoundData(sound_buffer->data)) {
+                DebugMessage((char*)"Sound reload skipped, too many replaced sounds are still playing\n");
+                break;
+            }
+            sound_buffer->data = job->sound.data;
+            sound_buffer->size_bytes = (i32)job->sound.data_size;
+            job->sound.data = nullptr;
 
-    stbi_image_free(image); // Free filedata
+            WAVEFORMATEX* sound_format = (WAVEFORMATEX*)user_data;
+            if (!sound_format) {
+                break;
+            }
+            sound_format->wFormatTag = job->sound.audio_format;
+            sound_format->nChannels = job->sound.channel_count;
+            sound_format->nSamplesPerSec = job->sound.sample_rate;
+            sound_format->nAvgBytesPerSec = job->sound.byte_rate;
+            sound_format->nBlockAlign = job->sound.block_align;
+            sound_format->wBitsPerSample = job->sound.bits_per_sample;
+            sound_format->cbSize = 0;
+            break;
+        }
+        case ASSET_KIND_FONT: {
+            SetDebugFont(CreateFontAtlas(&job->font));
+            break;
+        }
+    }
 }
 
 void _ErrorMessageAndBreak(wchar_t* message) {
@@ -675,6 +1610,9 @@ bool isFullscreen = false;
  * @brief Program main entry.
  */
 int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine, int nCmdShow) {
+    LARGE_INTEGER startup_begin_time;
+    QueryPerformanceCounter(&startup_begin_time);
+
     // ---------------------------------
     // Register and create window class
     {
@@ -731,6 +1669,93 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine
         }
     }
 
+    // ------------------------
+    // Mount resource files
+    {
+        if (!VfsCreate(&g_vfs, VFS_CACHE_CAPACITY)) {
+            ErrorMessageAndBreak((char*)"Virtual filesystem allocation failed!");
+        }
+
+        if (!AssetRegistryCreate(&g_assets, MAX_REGISTERED_ASSETS)) {
+            ErrorMessageAndBreak((char*)"Asset registry allocation failed!");
+        }
+
+        u64 texture_budget_mb = TEXTURE_BUDGET_DEFAULT_MB;
+        char budget_value[32];
+        DWORD budget_length = GetEnvironmentVariableA(TEXTURE_BUDGET_VARIABLE, budget_value, sizeof(budget_value));
+        if (0 < budget_length && budget_length < sizeof(budget_value) && 0 < atoi(budget_value)) {
+            texture_budget_mb = (u64)atoi(budget_value);
+        }
+
+        if (!TextureResidencyCreate(&texture_residency, MAX_DRAW_TEXTURES, texture_budget_mb * 1024 * 1024, TEXTURE_LOADS_PER_FRAME)) {
+            ErrorMessageAndBreak((char*)"Texture residency allocation failed!");
+        }
+        d3d11_residency_backend = {
+            .user_data = nullptr,
+            .load = D3D11ResidencyLoad,
+            .evict = D3D11ResidencyEvict,
+        };
+
+        char resources_directory[MAX_PATH];
+        DWORD length = GetEnvironmentVariableA(RESOURCES_DIRECTORY_VARIABLE, resources_directory, MAX_PATH);
+        if (length == 0 || MAX_PATH <= length) {
+            snprintf(resources_directory, MAX_PATH, "%s", RESOURCES_DIRECTORY);
+        }
+
+        if (!VfsMountPack(&g_vfs, "", RESOURCES_PACK_PATH, RESOURCES_PACK_PRIORITY)) {
+            DebugMessage((char*)"No resource pack, loading resources from the directory only\n");
+        }
+        if (!VfsMountDirectory(&g_vfs, "", resources_directory, RESOURCES_DIRECTORY_PRIORITY)) {
+            ErrorMessageAndBreak((char*)"Failed to mount the resources directory");
+        }
+
+        if (!FileWatcherCreate(&g_file_watcher, resources_directory, HOT_RELOAD_SETTLE_MS)) {
+            DebugMessage((char*)"Failed to watch the resources directory, hot reload is off\n");
+        }
+
+        // Without the directory every load misses and shaders compile as before
+        char shader_cache_directory[MAX_PATH];
+        length = GetEnvironmentVariableA(SHADER_CACHE_VARIABLE, shader_cache_directory, MAX_PATH);
+        if (length == 0 || MAX_PATH <= length) {
+            // A truncated executable path falls back to the working directory
+            char executable_path[MAX_PATH];
+            DWORD executable_length = GetModuleFileNameA(nullptr, executable_path, MAX_PATH);
+            const char* directory_end = 0 < executable_length && executable_length < MAX_PATH ? PathLastSeparator(executable_path) : nullptr;
+            i32 directory_length = directory_end ? (i32)(directory_end - executable_path) + 1 : 0;
+            snprintf(shader_cache_directory, MAX_PATH, "%.*s%s", directory_length, executable_path, SHADER_CACHE_DIRECTORY);
+        }
+        if (!ShaderCacheCreate(&g_shader_cache, shader_cache_directory)) {
+            DebugMessage((char*)"Failed to create the shader cache directory, shaders compile on every launch\n");
+        }
+    }
+
+    // ------------------------------------------------------------------
+    // Start decoding startup assets, workers run during device creation
+    AssetLoader startup_loader = {};
+    {
+        if (!AssetLoaderCreate(&startup_loader, MAX_STARTUP_ASSETS, &g_vfs)) {
+            ErrorMessageAndBreak((char*)"Startup asset loader allocation failed!");
+        }
+
+        tile_atlas_01 = AcquireTexture((char*)"images/tiles_01.png", ASSET_KIND_IMAGE, &startup_loader);
+        dude_01 = AcquireTexture((char*)"images/dude_01.png", ASSET_KIND_IMAGE, &startup_loader);
+
+        for (SoundFile& sound_file : sound_files) {
+            AssetLoaderAdd(&startup_loader, ASSET_KIND_SOUND, sound_file.path, sound_file.buffer);
+        }
+
+        AssetLoadJob* font_job = AssetLoaderAdd(&startup_loader, ASSET_KIND_FONT, DEBUG_FONT_PATH, nullptr);
+        font_job->font_pixel_height = g_window.GetVHInPx(debug_font_vh_size);
+
+        if (!LoadTextureAtlas(&sprite_atlas, sprite_atlas_pages, MAX_ATLAS_PAGES, (char*)SPRITE_ATLAS_PATH, &startup_loader)) {
+            DebugMessage((char*)"Sprite atlas not loaded, atlas sprites are not drawn\n");
+        }
+
+        // The main thread keeps working on device and shader setup meanwhile
+        i32 worker_count = (i32)std::thread::hardware_concurrency() - 1;
+        AssetLoaderStart(&startup_loader, worker_count);
+    }
+
     // -------------
     // Init XAudio
     {
@@ -849,182 +1874,172 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine
         if (FAILED(hresult)) {
             ErrorMessageAndBreak((char*)"CreateBuffer ViewProjectionMatrixBufferType failed!");
         }
+
+        // Sprite instance draw b3
+        D3D11_BUFFER_DESC spriteInstanceDrawBufferDesc = {};
+        spriteInstanceDrawBufferDesc.Usage = D3D11_USAGE_DYNAMIC;
+        spriteInstanceDrawBufferDesc.ByteWidth = sizeof(SpriteInstanceDrawBufferType);
+        spriteInstanceDrawBufferDesc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+        spriteInstanceDrawBufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+        hresult = id3d11_device->CreateBuffer(&spriteInstanceDrawBufferDesc, nullptr, &cbuffer_sprite_instance_draw);
+        if (FAILED(hresult)) {
+            ErrorMessageAndBreak((char*)"CreateBuffer SpriteInstanceDrawBufferType failed!");
+        }
     }
 
-    // --------------------------
-    // Create rectangle shader
+    // ---------------------------------
+    // Create shared quad index buffer
     {
-        HRESULT hr;
-        ID3DBlob* vsBlob = nullptr;
-        ID3DBlob* psBlob = nullptr;
-        ID3DBlob* error_blob = nullptr;
+        u32* indices = (u32*)malloc(sizeof(u32) * QUAD_INDEX_COUNT * MAX_INDEXED_QUADS);
+        if (!indices) {
+            ErrorMessageAndBreak((char*)"Quad index allocation failed!");
+        }
+        FillQuadIndices(indices, MAX_INDEXED_QUADS);
 
-        hr = D3DCompileFromFile(
-            L"G:\\projects\\game\\finite-engine-dev\\resources\\shaders\\rectangle.hlsl",
-            nullptr, D3D_COMPILE_STANDARD_FILE_INCLUDE,
-            "VSMain", "vs_5_0", 0, 0, &vsBlob, &error_blob);
-        CheckShaderCompileError(hr, error_blob);
+        D3D11_BUFFER_DESC indexBufferDesc = {};
+        indexBufferDesc.Usage = D3D11_USAGE_IMMUTABLE;
+        indexBufferDesc.ByteWidth = sizeof(u32) * QUAD_INDEX_COUNT * MAX_INDEXED_QUADS;
+        indexBufferDesc.BindFlags = D3D11_BIND_INDEX_BUFFER;
+        indexBufferDesc.CPUAccessFlags = 0;
 
-        hr = D3DCompileFromFile(
-            L"G:\\projects\\game\\finite-engine-dev\\resources\\shaders\\rectangle.hlsl",
-            nullptr, D3D_COMPILE_STANDARD_FILE_INCLUDE,
-            "PSMain", "ps_5_0", 0, 0, &psBlob, &error_blob);
-        CheckShaderCompileError(hr, error_blob);
+        D3D11_SUBRESOURCE_DATA index_data = {};
+        index_data.pSysMem = indices;
 
-        hr = id3d11_device->CreateVertexShader(vsBlob->GetBufferPointer(), vsBlob->GetBufferSize(), nullptr, &rectangle_vertex_shader);
+        HRESULT hr = id3d11_device->CreateBuffer(&indexBufferDesc, &index_data, &quad_index_buffer);
         if (FAILED(hr)) {
-            ErrorMessageAndBreak((char*)"CreateVertexShader failed!");
+            ErrorMessageAndBreak((char*)"CreateBuffer for quad_index_buffer failed!");
         }
 
-        hr = id3d11_device->CreatePixelShader(psBlob->GetBufferPointer(), psBlob->GetBufferSize(), nullptr, &rectangle_pixel_shader);
+        free(indices);
+    }
+
+    // ------------------------------------------
+    // Create dynamic vertex ring buffer and fences
+    {
+        D3D11_BUFFER_DESC vertexBufferDesc = {};
+        vertexBufferDesc.Usage = D3D11_USAGE_DYNAMIC;
+        vertexBufferDesc.ByteWidth = DYNAMIC_VERTEX_RING_BYTES;
+        vertexBufferDesc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
+        vertexBufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+
+        dynamic_vertex_buffer.can_map_no_overwrite = true;
+        CreateD3D11RingBuffer(&dynamic_vertex_buffer, &dynamic_vertex_ring, &vertexBufferDesc);
+    }
+
+    // ---------------------------------------------------
+    // Create sprite instance ring buffer and its view
+    {
+        D3D11_BUFFER_DESC instanceBufferDesc = {};
+        instanceBufferDesc.Usage = D3D11_USAGE_DYNAMIC;
+        instanceBufferDesc.ByteWidth = SPRITE_INSTANCE_RING_BYTES;
+        instanceBufferDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+        instanceBufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+        instanceBufferDesc.MiscFlags = D3D11_RESOURCE_MISC_BUFFER_STRUCTURED;
+        instanceBufferDesc.StructureByteStride = sizeof(SpriteInstance);
+
+        // WRITE_NO_OVERWRITE on shader resource buffers needs D3D11.1 driver support
+        D3D11_FEATURE_DATA_D3D11_OPTIONS options = {};
+        HRESULT hr = id3d11_device->CheckFeatureSupport(D3D11_FEATURE_D3D11_OPTIONS, &options, sizeof(options));
+        sprite_instance_buffer.can_map_no_overwrite = SUCCEEDED(hr) && options.MapNoOverwriteOnDynamicBufferSRV;
+        CreateD3D11RingBuffer(&sprite_instance_buffer, &sprite_instance_ring, &instanceBufferDesc);
+
+        D3D11_SHADER_RESOURCE_VIEW_DESC viewDesc = {};
+        viewDesc.Format = DXGI_FORMAT_UNKNOWN;
+        viewDesc.ViewDimension = D3D11_SRV_DIMENSION_BUFFER;
+        viewDesc.Buffer.FirstElement = 0;
+        viewDesc.Buffer.NumElements = SPRITE_INSTANCE_RING_BYTES / sizeof(SpriteInstance);
+
+        hr = id3d11_device->CreateShaderResourceView(sprite_instance_buffer.buffer, &viewDesc, &sprite_instance_view);
         if (FAILED(hr)) {
-            ErrorMessageAndBreak((char*)"CreatePixelShader failed!");
+            ErrorMessageAndBreak((char*)"CreateShaderResourceView for sprite instances failed!");
         }
+    }
 
-        D3D11_INPUT_ELEMENT_DESC layout[] = {
-            { "POSITION", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, 0, 0, D3D11_INPUT_PER_VERTEX_DATA, 0 },
-            { "COLOR", 0,    DXGI_FORMAT_R32G32B32A32_FLOAT, 0, 16, D3D11_INPUT_PER_VERTEX_DATA, 0 },
-        };
+    // --------------------------
+    // Create rectangle shader
+    {
+        ShaderProgram* program = &shader_programs[SHADER_PROGRAM_RECTANGLE];
+        ID3DBlob* vsBlob = CompileShaderFromVfs((char*)program->path, "VSMain", "vs_5_0");
+        ID3DBlob* psBlob = CompileShaderFromVfs((char*)program->path, "PSMain", "ps_5_0");
 
-        hr = id3d11_device->CreateInputLayout(layout, ARRAYSIZE(layout), vsBlob->GetBufferPointer(), vsBlob->GetBufferSize(), &rectangle_input_layout);
-        if (FAILED(hr)) {
-            ErrorMessageAndBreak((char*)"CreateInputLayout failed!");
+        if (!CreateShaderProgram(program, vsBlob, psBlob)) {
+            ErrorMessageAndBreak((char*)"Failed to create rectangle shaders!");
         }
 
         vsBlob->Release();
         psBlob->Release();
-
-        // -----------------------
-        // Create dynamic buffer
-        {
-            D3D11_BUFFER_DESC vertexBufferDesc = {};
-            vertexBufferDesc.Usage = D3D11_USAGE_DYNAMIC;
-            vertexBufferDesc.ByteWidth = sizeof(RectangleVertex) * MAX_TEXT_UI_VERTEX_COUNT;
-            vertexBufferDesc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
-            vertexBufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
-
-            hr = id3d11_device->CreateBuffer(&vertexBufferDesc, nullptr, &rectangle_vertex_buffer);
-            if (FAILED(hr)) {
-                ErrorMessageAndBreak((char*)"CreateBuffer for rectangle_vertex_buffer dynamic vertex buffer failed!");
-            }
-        }
     }
 
     // -----------------------------------------
     // Create rectangle 2D shader (with batch)
     {
-        HRESULT hr;
-        ID3DBlob* vsBlob = nullptr;
-        ID3DBlob* psBlob = nullptr;
-        ID3DBlob* error_blob = nullptr;
+        ShaderProgram* program = &shader_programs[SHADER_PROGRAM_RECTANGLE_2D];
+        ID3DBlob* vsBlob = CompileShaderFromVfs((char*)program->path, "VSMain", "vs_5_0");
+        ID3DBlob* psBlob = CompileShaderFromVfs((char*)program->path, "PSMain", "ps_5_0");
 
-        hr = D3DCompileFromFile(
-            L"G:\\projects\\game\\finite-engine-dev\\resources\\shaders\\rectangle_2d.hlsl",
-            nullptr, D3D_COMPILE_STANDARD_FILE_INCLUDE,
-            "VSMain", "vs_5_0", 0, 0, &vsBlob, &error_blob);
-        CheckShaderCompileError(hr, error_blob);
-
-        hr = D3DCompileFromFile(
-            L"G:\\projects\\game\\finite-engine-dev\\resources\\shaders\\rectangle_2d.hlsl",
-            nullptr, D3D_COMPILE_STANDARD_FILE_INCLUDE,
-            "PSMain", "ps_5_0", 0, 0, &psBlob, &error_blob);
-        CheckShaderCompileError(hr, error_blob);
-
-        hr = id3d11_device->CreateVertexShader(vsBlob->GetBufferPointer(), vsBlob->GetBufferSize(), nullptr, &rectangle_2d_vertex_shader);
-        if (FAILED(hr)) {
-            ErrorMessageAndBreak((char*)"CreateVertexShader failed!");
-        }
-
-        hr = id3d11_device->CreatePixelShader(psBlob->GetBufferPointer(), psBlob->GetBufferSize(), nullptr, &rectangle_2d_pixel_shader);
-        if (FAILED(hr)) {
-            ErrorMessageAndBreak((char*)"CreatePixelShader failed!");
-        }
-
-        D3D11_INPUT_ELEMENT_DESC layout[] = {
-            { "POSITION", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, 0, 0, D3D11_INPUT_PER_VERTEX_DATA, 0 },
-            { "COLOR",    0, DXGI_FORMAT_R32G32B32A32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 },
-            { "TEXCOORD", 0, DXGI_FORMAT_R32G32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 },
-        };
-
-        hr = id3d11_device->CreateInputLayout(layout, ARRAYSIZE(layout), vsBlob->GetBufferPointer(), vsBlob->GetBufferSize(), &rectangle_2d_input_layout);
-        if (FAILED(hr)) {
-            ErrorMessageAndBreak((char*)"CreateInputLayout failed!");
+        if (!CreateShaderProgram(program, vsBlob, psBlob)) {
+            ErrorMessageAndBreak((char*)"Failed to create rectangle 2D shaders!");
         }
 
         vsBlob->Release();
         psBlob->Release();
-
-        // -----------------------
-        // Create dynamic buffer
-        {
-            D3D11_BUFFER_DESC vertexBufferDesc = {};
-            vertexBufferDesc.Usage = D3D11_USAGE_DYNAMIC;
-            vertexBufferDesc.ByteWidth = sizeof(RectangleVertex) * MAX_TEXT_UI_VERTEX_COUNT;
-            vertexBufferDesc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
-            vertexBufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
-
-            hr = id3d11_device->CreateBuffer(&vertexBufferDesc, nullptr, &rectangle_2d_vertex_buffer);
-            if (FAILED(hr)) {
-                ErrorMessageAndBreak((char*)"CreateBuffer for rectangle_vertex_buffer dynamic vertex buffer failed!");
-            }
-        }
     }
 
-    // -----------------------
-    // Create font_ui shader
+    // --------------------------------
+    // Create instanced sprite shader
     {
         HRESULT hr;
+        ID3DBlob* vsBlob = nullptr;
+        ID3DBlob* psBlob = nullptr;
         ID3DBlob* error_blob = nullptr;
-        ID3DBlob* pVSBlob = nullptr;
-        ID3DBlob* pPSBlob = nullptr;
+        size_t source_length = strlen(SPRITE_INSTANCED_SHADER_SOURCE);
 
-        hr = D3DCompileFromFile(
-            L"G:\\projects\\game\\finite-engine-dev\\resources\\shaders\\text_ui.hlsl",
-            nullptr, D3D_COMPILE_STANDARD_FILE_INCLUDE, "VSMain", "vs_5_0", 0, 0, &pVSBlob, &error_blob);
+        hr = D3DCompile(
+            SPRITE_INSTANCED_SHADER_SOURCE, source_length, "sprite_instanced",
+            nullptr, nullptr,
+            "VSMain", "vs_5_0", 0, 0, &vsBlob, &error_blob);
         CheckShaderCompileError(hr, error_blob);
 
-        hr = D3DCompileFromFile(
-            L"G:\\projects\\game\\finite-engine-dev\\resources\\shaders\\text_ui.hlsl",
-            nullptr, D3D_COMPILE_STANDARD_FILE_INCLUDE, "PSMain", "ps_5_0", 0, 0, &pPSBlob, &error_blob);
+        hr = D3DCompile(
+            SPRITE_INSTANCED_SHADER_SOURCE, source_length, "sprite_instanced",
+            nullptr, nullptr,
+            "PSMain", "ps_5_0", 0, 0, &psBlob, &error_blob);
         CheckShaderCompileError(hr, error_blob);
 
-        hr = id3d11_device->CreateVertexShader(pVSBlob->GetBufferPointer(), pVSBlob->GetBufferSize(), nullptr, &text_ui_vertex_shader);
+        hr = id3d11_device->CreateVertexShader(vsBlob->GetBufferPointer(), vsBlob->GetBufferSize(), nullptr, &sprite_instanced_vertex_shader);
         if (FAILED(hr)) {
-            ErrorMessageAndBreak((char*)"CreateVertexShader font_ui failed!");
+            ErrorMessageAndBreak((char*)"CreateVertexShader failed!");
         }
 
-        hr = id3d11_device->CreatePixelShader(pPSBlob->GetBufferPointer(), pPSBlob->GetBufferSize(), nullptr, &text_ui_pixel_shader);
+        hr = id3d11_device->CreatePixelShader(psBlob->GetBufferPointer(), psBlob->GetBufferSize(), nullptr, &sprite_instanced_pixel_shader);
         if (FAILED(hr)) {
-            ErrorMessageAndBreak((char*)"CreatePixelShader font_ui failed!");
+            ErrorMessageAndBreak((char*)"CreatePixelShader failed!");
         }
 
-        // Define the input layout
-        D3D11_INPUT_ELEMENT_DESC layout[] = {
-            { "POSITION", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, 0, 0, D3D11_INPUT_PER_VERTEX_DATA, 0 },
-            { "TEXCOORD", 0, DXGI_FORMAT_R32G32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 },
-        };
+        vsBlob->Release();
+        psBlob->Release();
+    }
 
-        // Create the input layout
-        hr = id3d11_device->CreateInputLayout(layout, ARRAYSIZE(layout), pVSBlob->GetBufferPointer(), pVSBlob->GetBufferSize(), &text_ui_input_layout);
-        if (FAILED(hr)) {
-            ErrorMessageAndBreak((char*)"CreateInputLayout font_ui failed!");
+    // -----------------------
+    // Create font_ui shader
+    {
+        ShaderProgram* program = &shader_programs[SHADER_PROGRAM_TEXT_UI];
+        ID3DBlob* pVSBlob = CompileShaderFromVfs((char*)program->path, "VSMain", "vs_5_0");
+        ID3DBlob* pPSBlob = CompileShaderFromVfs((char*)program->path, "PSMain", "ps_5_0");
+
+        if (!CreateShaderProgram(program, pVSBlob, pPSBlob)) {
+            ErrorMessageAndBreak((char*)"Failed to create font_ui shaders!");
         }
 
         pVSBlob->Release();
         pPSBlob->Release();
 
         // -----------------------
-        // Create dynamix text_ui buffer
+        // Create text layout cache
         {
-            D3D11_BUFFER_DESC vertexBufferDesc = {};
-            vertexBufferDesc.Usage = D3D11_USAGE_DYNAMIC;
-            vertexBufferDesc.ByteWidth = sizeof(TextUiVertex) * MAX_TEXT_UI_VERTEX_COUNT;
-            vertexBufferDesc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
-            vertexBufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
-
-            hr = id3d11_device->CreateBuffer(&vertexBufferDesc, nullptr, &text_ui_vertex_buffer);
-            if (FAILED(hr)) {
-                ErrorMessageAndBreak((char*)"CreateBuffer for text_ui dynamic vertex buffer failed!");
+            text_layout_scratch = (TextUiVertex*)malloc(sizeof(TextUiVertex) * QUAD_VERTEX_COUNT * TEXT_LAYOUT_MAX_QUADS);
+            if (!text_layout_scratch || !TextRunCacheCreate(&text_run_cache, TEXT_RUN_CACHE_MAX_RUNS, TEXT_RUN_CACHE_BYTE_BUDGET)) {
+                ErrorMessageAndBreak((char*)"Text run cache allocation failed!");
             }
         }
     }
@@ -1032,27 +2047,11 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine
     // -------------------------------
     // Audio source voice (channels)
     {
-        WAVHeader wav_sound_header = {};
-        BYTE* wav_audio_data1 = LoadWAWFile((LPWSTR)L"G:\\projects\\game\\finite-engine-dev\\resources\\sounds\\Jump.wav", &wav_sound_header);
-        sound_buffer_1.data = wav_audio_data1;
-        sound_buffer_1.size_bytes = wav_sound_header.dataSize;
-
-        BYTE* wav_audio_data2 = LoadWAWFile((LPWSTR)L"G:\\projects\\game\\finite-engine-dev\\resources\\sounds\\Laser_Shoot.wav", &wav_sound_header);
-        sound_buffer_2.data = wav_audio_data2;
-        sound_buffer_2.size_bytes = wav_sound_header.dataSize;
-
-        BYTE* wav_audio_data3 = LoadWAWFile((LPWSTR)L"G:\\projects\\game\\finite-engine-dev\\resources\\sounds\\Pickup_Coin.wav", &wav_sound_header);
-        sound_buffer_3.data = wav_audio_data3;
-        sound_buffer_3.size_bytes = wav_sound_header.dataSize;
-
+        // Textures, sounds and the debug font are created here as their decode jobs complete
         WAVEFORMATEX wfx = { 0 };
-        wfx.wFormatTag = wav_sound_header.audioFormat;
-        wfx.nChannels = wav_sound_header.numChannels;
-        wfx.nSamplesPerSec = wav_sound_header.sampleRate;
-        wfx.nAvgBytesPerSec = wav_sound_header.byteRate;
-        wfx.nBlockAlign = wav_sound_header.blockAlign;
-        wfx.wBitsPerSample = wav_sound_header.bitsPerSample;
-        wfx.cbSize = 0;
+        AssetUploadSink startup_sink = { &wfx, UploadLoadedAsset };
+        startup_asset_stats = AssetLoaderFinish(&startup_loader, &startup_sink);
+        AssetLoaderDestroy(&startup_loader);
 
         for (int i = 0; i < MAX_VOICES; ++i) {
             HRESULT hr = pXAudio2->CreateSourceVoice(&mono_source_voice_pool[i], &wfx);
@@ -1062,13 +2061,57 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine
         }
     }
 
-    LoadTextureFromFilepath(&tile_atlas_01, (char*)"G:\\projects\\game\\finite-engine-dev\\resources\\images\\tiles_01.png");
-    LoadTextureFromFilepath(&dude_01, (char*)"G:\\projects\\game\\finite-engine-dev\\resources\\images\\dude_01.png");
+    if (!TilemapCreate(&g_tilemap, WORLD_TILEMAP_WIDTH, WORLD_TILEMAP_HEIGHT, WORLD_TILEMAP_CHUNK_BUDGET)) {
+        ErrorMessageAndBreak((char*)"TilemapCreate failed!");
+    }
+    if (!TilemapChunkStoreCreate(&g_tilemap_edits, WORLD_TILEMAP_EDIT_BUDGET)) {
+        ErrorMessageAndBreak((char*)"Tilemap chunk store allocation failed!");
+    }
+    g_tilemap_spill_file = tmpfile();
+    if (!g_tilemap_spill_file) {
+        ErrorMessageAndBreak((char*)"Failed to create the tilemap spill file!");
+    }
+    g_tilemap_edits.spill_chunk = SpillTilemapChunk;
+    g_tilemap.load_chunk = LoadTilemapChunk;
+    g_tilemap.store_chunk = StoreTilemapChunk;
+    g_tilemap.user_data = &g_tilemap_edits;
+
+    if (!QuadDrawQueueCreate(&sprite_draw_queue, MAX_QUEUED_QUADS)) {
+        ErrorMessageAndBreak((char*)"Sprite draw queue allocation failed!");
+    }
+
+    if (!RenderQueueCreate(&render_queue, MAX_RENDER_COMMANDS, RENDER_QUEUE_INITIAL_VERTEX_BYTES, MAX_INDEXED_QUADS)) {
+        ErrorMessageAndBreak((char*)"Render queue allocation failed!");
+    }
+
+    d3d11_render_backend = {
+        .user_data = nullptr,
+        .bind_pipeline = D3D11RenderBindPipeline,
+        .bind_texture = D3D11RenderBindTexture,
+        .draw_quads = D3D11RenderDrawQuads,
+        .draw_static_quads = D3D11RenderDrawStaticQuads,
+        .draw_instances = D3D11RenderDrawInstances
+    };
+
+    tilemap_chunk_mesh_scratch = (TilemapTileVertex*)malloc(sizeof(TilemapTileVertex) * TILEMAP_CHUNK_MESH_MAX_VERTEX_COUNT);
+    if (!tilemap_chunk_mesh_scratch) {
+        ErrorMessageAndBreak((char*)"Tilemap chunk mesh allocation failed!");
+    }
+
+    // Anything loaded after startup goes through the stream, the startup workers have exited by now
+    {
+        i32 worker_count = (i32)std::thread::hardware_concurrency() - 1;
+        if (!AssetStreamCreate(&g_asset_stream, MAX_STREAMED_ASSETS, worker_count, AssetStreamVfsBackend(&g_vfs))) {
+            ErrorMessageAndBreak((char*)"Asset stream allocation failed!");
+        }
+    }
 
     ShowWindow(g_window.handle, nCmdShow);
     UpdateWindow(g_window.handle);
 
-    LoadGlobalFonts();
+    LARGE_INTEGER startup_end_time;
+    QueryPerformanceCounter(&startup_end_time);
+    startup_time_ms = (f32)(startup_end_time.QuadPart - startup_begin_time.QuadPart) * 1000.0f / (f32)g_window.frequency.QuadPart;
 
     // -----------
     // Game loop
@@ -1123,6 +2166,60 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine
             }
         }
 
+        // --------------------------------------------
+        // Upload assets the stream finished loading
+        {
+            AssetUploadSink stream_sink = { nullptr, UploadLoadedAsset };
+            AssetStreamPoll(&g_asset_stream, &stream_sink, STREAMED_UPLOADS_PER_FRAME);
+
+            AssetStreamState font_state = AssetStreamGetState(&g_asset_stream, debug_font_request);
+            if (font_state == ASSET_STREAM_FAILED) {
+                DebugMessage((char*)AssetStreamGetError(&g_asset_stream, debug_font_request));
+            }
+            if (font_state == ASSET_STREAM_READY || font_state == ASSET_STREAM_FAILED) {
+                AssetStreamCancel(&g_asset_stream, debug_font_request);
+                debug_font_request = {};
+            }
+
+            // Finished residency loads were reported by the texture upload, failed ones keep their levels
+            for (u32 draw_id = 0; draw_id < (u32)draw_texture_count; draw_id++) {
+                AssetStreamState residency_state = AssetStreamGetState(&g_asset_stream, residency_requests[draw_id]);
+                if (residency_state == ASSET_STREAM_FAILED) {
+                    DebugMessage((char*)AssetStreamGetError(&g_asset_stream, residency_requests[draw_id]));
+                    resident_textures[draw_id]->top_level = texture_residency.entries[draw_id].resident_level;
+                    TextureResidencyLoadFailed(&texture_residency, draw_id);
+                }
+                if (residency_state == ASSET_STREAM_READY || residency_state == ASSET_STREAM_FAILED) {
+                    AssetStreamCancel(&g_asset_stream, residency_requests[draw_id]);
+                    residency_requests[draw_id] = {};
+                }
+            }
+
+            for (SoundFile& sound_file : sound_files) {
+                AssetStreamState sound_state = AssetStreamGetState(&g_asset_stream, sound_file.reload_request);
+                if (sound_state == ASSET_STREAM_FAILED) {
+                    DebugMessage((char*)AssetStreamGetError(&g_asset_stream, sound_file.reload_request));
+                }
+                if (sound_state == ASSET_STREAM_READY || sound_state == ASSET_STREAM_FAILED) {
+                    AssetStreamCancel(&g_asset_stream, sound_file.reload_request);
+                    sound_file.reload_request = {};
+                }
+            }
+        }
+
+        // ------------------------------------------
+        // Reload resource files changed on disk
+        {
+            FinishShaderReloads();
+            ReleaseRetiredSounds();
+
+            FileWatcherChange changes[HOT_RELOAD_MAX_CHANGES_PER_FRAME];
+            i32 change_count = FileWatcherPoll(&g_file_watcher, changes, HOT_RELOAD_MAX_CHANGES_PER_FRAME);
+            for (i32 i = 0; i < change_count; i++) {
+                ApplyFileChange(&changes[i]);
+            }
+        }
+
         // -------------
         // Query timer
         {
@@ -1162,27 +2259,33 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine
                 viewport_camera.position.x += camera_speed * g_window.frame_delta;
             }
 
+            // ------------------------------------
+            // Stream tilemap chunks around camera
+            {
+                Vec2f camera_tile = ScreenSpaceToTilemapCoords(Vec2f{viewport_camera.position.x, viewport_camera.position.y});
+                f32 view_radius_tiles = 2.0f * viewport_camera.zoom;
+                i32 radius_chunks = (i32)ceilf(view_radius_tiles / (f32)TILEMAP_CHUNK_SIZE) + 1;
+                TilemapStreamAround(&g_tilemap, camera_tile, radius_chunks);
+            }
+
             if (frame_input.keys._1.is_down) {
                 if (CursorOverTilemap()) {
-                    Tile* cursor_tile = GetCursorTilePtr();
-                    cursor_tile->type = 0;
+                    TilemapSetTile(&g_tilemap, frame_input.mouse_tilemap_x, frame_input.mouse_tilemap_y, 0);
                 }
             }
             if (frame_input.keys._2.is_down) {
                 if (CursorOverTilemap()) {
-                    Tile* cursor_tile = GetCursorTilePtr();
-                    cursor_tile->type = 1;
+                    TilemapSetTile(&g_tilemap, frame_input.mouse_tilemap_x, frame_input.mouse_tilemap_y, 1);
                 }
             }
             if (frame_input.keys._3.is_down) {
                 if (CursorOverTilemap()) {
-                    Tile* cursor_tile = GetCursorTilePtr();
-                    cursor_tile->type = 2;
+                    TilemapSetTile(&g_tilemap, frame_input.mouse_tilemap_x, frame_input.mouse_tilemap_y, 2);
                 }
             }
 
-            // ----------------------------
-            // Get mouse in tilemap coords
+            // --------------------------------------------------
+            // Get mouse in tilemap coords and visible tile range
             {
                 DirectX::XMMATRIX viewMatrix = GetViewportViewMatrix();
                 DirectX::XMMATRIX projection = GetViewportProjectionMatrix();
@@ -1200,6 +2303,16 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine
                 Vec2f tileCoord = ScreenSpaceToTilemapCoords(Vec2f{mx, my});
                 frame_input.mouse_tilemap_x = (int)tileCoord.x;
                 frame_input.mouse_tilemap_y = (int)tileCoord.y;
+
+                Vec2f ndc_corners[4] = { {-1.0f, -1.0f}, {1.0f, -1.0f}, {1.0f, 1.0f}, {-1.0f, 1.0f} };
+                Vec2f world_corners[4];
+                for (int i = 0; i < 4; i++) {
+                    DirectX::XMVECTOR cornerNDC = DirectX::XMVectorSet(ndc_corners[i].x, ndc_corners[i].y, 1.0f, 1.0f);
+                    DirectX::XMVECTOR cornerWorld = XMVector3TransformCoord(cornerNDC, viewProjInverse);
+                    world_corners[i] = Vec2f{DirectX::XMVectorGetX(cornerWorld), DirectX::XMVectorGetY(cornerWorld)};
+                }
+
+                visible_tilemap_range = TilemapComputeVisibleRange(&g_tilemap, world_corners);
             }
         }
 
@@ -1216,10 +2329,14 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine
         // -----------------------
         // Render viewport frame
         {
+            VertexRingBeginFrame(&dynamic_vertex_ring);
+            VertexRingBeginFrame(&sprite_instance_ring);
             deviceContext->ClearRenderTargetView(renderTargetView, clear_color);
             SetDefaultViewportDimensions();
             deviceContext->OMSetRenderTargets(1, &renderTargetView, nullptr);
 
+            Texture* tiles_texture = ResolveTexture(tile_atlas_01);
+
             // -----------------
             // Update cbuffers
             {
@@ -1231,6 +2348,11 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine
                     .view_projection_matrix = DirectX::XMMatrixTranspose(view_projection_matrix),
                 };
 
+                // Same view extents as GetViewportProjectionMatrix
+                f32 view_width = 2.0f * viewport_camera.zoom;
+                f32 view_height = view_width * (f32)g_window.size_px.y / (f32)g_window.size_px.x;
+                sprite_cull_rect = SpriteCullRectFromView(Vec2f{viewport_camera.position.x, viewport_camera.position.y}, Vec2f{view_width, view_height});
+
                 // -------------------------------
                 // Update view projection matrix
                 {
@@ -1249,16 +2371,38 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine
 
             // -----------------
             // Draw background
+            render_layer = RENDER_LAYER_BACKGROUND;
             DrawRectangleToScreen({-1.0f, 1.0f}, {1.0f, 1.0f}, {-1.0f, -1.0f}, {1.0f, -1.0f}, {0.0f, 0.0f, 0.0f});
 
             // ---------------
             // Draw tilemaps
+            render_layer = RENDER_LAYER_WORLD;
             {
-                for (int y = 0; y < g_tilemap.height; y++) {
-                    for (int x = 0; x < g_tilemap.width; x++) {
-                        // Vec2f coordinate = {(f32)x, f32(y)};
-                        // Tile tile = tilemap_data[x + (y * g_tilemap.width)];
-                        // DrawTilemapTile(texture.resource_view, coordinate);
+                frame_visible_chunk_count = 0;
+                frame_skipped_chunk_count = 0;
+
+                // Far chunks first so that nearer chunks are drawn on top
+                i32 chunk_y_start = visible_tilemap_range.min_y / TILEMAP_CHUNK_SIZE;
+                i32 chunk_y_end = visible_tilemap_range.max_y / TILEMAP_CHUNK_SIZE;
+
+                for (int chunk_y = chunk_y_end; chunk_y_start <= chunk_y; chunk_y--) {
+                    int chunk_x_start, chunk_x_end;
+                    if (!TilemapVisibleChunkSpan(&visible_tilemap_range, chunk_y, &chunk_x_start, &chunk_x_end)) {
+                        continue;
+                    }
+
+                    for (int chunk_x = chunk_x_end; chunk_x_start <= chunk_x; chunk_x--) {
+                        // Zoomed out past the chunk budget, loading would evict a chunk whose vertex buffer
+                        // is still to be drawn this frame. Skip chunks that are not resident instead.
+                        Vec2i chunk_coord = {chunk_x, chunk_y};
+                        if (!TilemapFindChunk(&g_tilemap, chunk_coord) && !TilemapCanLoadChunk(&g_tilemap)) {
+                            frame_skipped_chunk_count++;
+                            continue;
+                        }
+
+                        TilemapChunk* chunk = TilemapLoadChunk(&g_tilemap, chunk_coord);
+                        DrawTilemapChunk(chunk, tiles_texture->draw_id);
+                        frame_visible_chunk_count++;
                     }
                 }
             }
@@ -1267,15 +2411,22 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine
                 // DrawTilemapTile(selector_tile.resource_view, {(f32)frame_input.mouse_tilemap_x, (f32)frame_input.mouse_tilemap_y});
             }
 
-            BufferRectangle2d({0.5f, 0.5f});
-            BufferRectangle2d({0.25f, -0.25f});
-            DrawBufferedRectangle2ds(tile_atlas_01.resource_view);
+            QueueSprite(tiles_texture, {0.5f, 0.5f}, {1.0f, 1.0f}, {0.0f, 0.0f, 1.0f, 1.0f}, DRAW_LAYER_SPRITES);
+            QueueSprite(tiles_texture, {0.25f, -0.25f}, {1.0f, 1.0f}, {0.0f, 0.0f, 1.0f, 1.0f}, DRAW_LAYER_SPRITES);
+
+            TextureAtlasRegion* dude_region = TextureAtlasFind(&sprite_atlas, "dude_01");
+            if (dude_region) {
+                QueueAtlasSprite(dude_region, {-0.5f, 0.25f}, {1.0f, 1.0f}, DRAW_LAYER_SPRITES);
+            }
+            DrawQueuedSprites();
 
+            render_layer = RENDER_LAYER_WORLD_OVERLAY;
             DrawLineOnScreen({-0.025f, 0.0f}, {0.025f, 0.0f}, 1.0f, {1.0f, 1.0f, 1.0f});
             DrawLineOnScreen({0.0f, -0.025f}, {0.0f, 0.025f}, 1.0f, {1.0f, 1.0f, 1.0f});
 
             // ---------------
             // Display debug
+            render_layer = RENDER_LAYER_UI;
             {
                 SetDefaultViewportDimensions();
 
@@ -1306,102 +2457,110 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine
                 temp_cstr.MemsetBuffer(0);
                 sprintf(d_str, "Draw calls: %d\n", g_window.frame_draw_calls);
                 cursor01 = DrawTextToScreen((char*)d_str, cursor01, &g_debug_font);
-            }
 
-            swapChain->Present(1, 0);
-        }
+                temp_cstr.MemsetBuffer(0);
+                sprintf(d_str, "Tilemap chunks loaded: %d / %d, edited: %u / %u, spilled: %u\n", g_tilemap.loaded_chunk_count, g_tilemap.chunk_capacity, g_tilemap_edits.count, g_tilemap_edits.max_count, g_tilemap_edits.spilled_count);
+                cursor01 = DrawTextToScreen((char*)d_str, cursor01, &g_debug_font);
 
-        g_window.frame_counter++;
-        g_window.frame_draw_calls = 0;
-    }
+                temp_cstr.MemsetBuffer(0);
+                sprintf(d_str, "Visible chunks: %d, skipped over budget: %d\n", frame_visible_chunk_count, frame_skipped_chunk_count);
+                cursor01 = DrawTextToScreen((char*)d_str, cursor01, &g_debug_font);
 
-    return window_message.wParam;
-}
+                temp_cstr.MemsetBuffer(0);
+                sprintf(d_str, "Culled sprites: %d\n", frame_culled_sprite_count);
+                cursor01 = DrawTextToScreen((char*)d_str, cursor01, &g_debug_font);
 
-FontAtlasInfo LoadFontAtlas(char* filepath, float pixel_height) {
-    FontAtlasInfo result = {};
+                temp_cstr.MemsetBuffer(0);
+                sprintf(d_str, "Text cache hit rate: %.1f%%, runs: %d, KB: %d\n", TextRunCacheHitRate(&text_run_cache) * 100.0f, text_run_cache.run_count, (int)(text_run_cache.bytes_used / 1024));
+                cursor01 = DrawTextToScreen((char*)d_str, cursor01, &g_debug_font);
 
-    stbtt_fontinfo font;
-    size_t file_size;
-    auto wide_buffer = temp_wstr.GetWStrBuffer();
-    StrToWideStr(filepath, wide_buffer, STR_BUFFER_COUNT);
-    unsigned char *fontBuffer = LoadFileToPtr(wide_buffer, &file_size);
+                temp_cstr.MemsetBuffer(0);
+                sprintf(d_str, "Render commands: %d, merged: %d, binds: %d, skipped binds: %d\n", render_queue.stats.commands, render_queue.stats.merged_commands, render_queue.stats.pipeline_binds + render_queue.stats.texture_binds, render_queue.stats.skipped_binds);
+                cursor01 = DrawTextToScreen((char*)d_str, cursor01, &g_debug_font);
 
-    stbtt_InitFont(&font, fontBuffer, stbtt_GetFontOffsetForIndex(fontBuffer, 0));
+                temp_cstr.MemsetBuffer(0);
+                sprintf(d_str, "Startup: %.0f ms, assets: %d on %d threads in %.0f ms (decode %.0f ms, upload %.0f ms)\n", startup_time_ms, startup_asset_stats.job_count, startup_asset_stats.worker_count, startup_asset_stats.wall_ms, startup_asset_stats.decode_ms, startup_asset_stats.upload_ms);
+                cursor01 = DrawTextToScreen((char*)d_str, cursor01, &g_debug_font);
 
-    int used_height = (int)pixel_height;
-    float scale = stbtt_ScaleForPixelHeight(&font, (float)used_height);
-    int ascent, descent, lineGap;
-    stbtt_GetFontVMetrics(&font, &ascent, &descent, &lineGap);
-        
-    result.font_size_px = used_height;
-    result.font_ascent = ascent * scale;
-    result.font_descent = descent * scale;
-    result.font_linegap = lineGap * scale;
+                temp_cstr.MemsetBuffer(0);
+                AssetStreamStats* stream_stats = &g_asset_stream.stats;
+                sprintf(d_str, "Registered assets: %d, acquires: %d, deduplicated: %d\n", g_assets.stats.live_count, g_assets.stats.acquires, g_assets.stats.dedup_hits);
+                cursor01 = DrawTextToScreen((char*)d_str, cursor01, &g_debug_font);
 
-    int fontAtlasWidth = 0;
-    int fontAtlasHeight = 0;
+                temp_cstr.MemsetBuffer(0);
+                sprintf(d_str, "Streamed assets: %d pending, %d ready, %d failed, %d cancelled\n", stream_stats->pending_count, stream_stats->ready_count, stream_stats->failed_count, stream_stats->cancelled_count);
+                cursor01 = DrawTextToScreen((char*)d_str, cursor01, &g_debug_font);
 
-    for (int c = 32; c < 128; c++) {
-        int codepoint = c;
-        int width, height, xoffset, yoffset;
-        unsigned char *bitmap = stbtt_GetCodepointBitmap(&font, 0, scale, codepoint, &width, &height, &xoffset, &yoffset);
+                temp_cstr.MemsetBuffer(0);
+                TextureResidencyStats* residency_stats = &texture_residency.stats;
+                sprintf(d_str, "Textures: %.1f / %.1f MB resident, %d tracked, %d loads, %d evictions\n", (f64)residency_stats->resident_bytes / (1024.0 * 1024.0), (f64)texture_residency.budget_bytes / (1024.0 * 1024.0), residency_stats->tracked_count, residency_stats->loads, residency_stats->evictions);
+                cursor01 = DrawTextToScreen((char*)d_str, cursor01, &g_debug_font);
 
-        int advanceWidth, leftSideBearing;
-        stbtt_GetCodepointHMetrics(&font, codepoint, &advanceWidth, &leftSideBearing);
-        float advanceScaled = ((f32)advanceWidth * scale);      
+                temp_cstr.MemsetBuffer(0);
+                sprintf(d_str, "Hot reload: %d files changed, %d reloaded, last %.0f ms after the first event\n", g_file_watcher.stats.change_count, hot_reload_count, g_file_watcher.stats.last_latency_ms);
+                cursor01 = DrawTextToScreen((char*)d_str, cursor01, &g_debug_font);
 
-        int glyph_index = c - 32;
-        result.glyphs[glyph_index].advance = advanceScaled;
-        result.glyphs[glyph_index].bitmap_height = height;
-        result.glyphs[glyph_index].bitmap_width = width;
-        result.glyphs[glyph_index].character = c;
-        result.glyphs[glyph_index].x_offset = xoffset;
-        result.glyphs[glyph_index].y_offset = -1 * yoffset;
+                temp_cstr.MemsetBuffer(0);
+                ShaderCacheStats* shader_stats = &g_shader_cache.stats;
+                sprintf(d_str, "Shader cache: %d hits, %d misses, %d stale, %d written\n", shader_stats->hits.load(), shader_stats->misses.load() + shader_stats->corrupt.load(), shader_stats->stale.load(), shader_stats->writes.load());
+                cursor01 = DrawTextToScreen((char*)d_str, cursor01, &g_debug_font);
+            }
 
-        fontAtlasWidth += width;
-        if (fontAtlasHeight < height) {
-            fontAtlasHeight = height;
+            // Bound textures were stamped by the backend, residency runs once everything was drawn
+            RenderQueueSubmit(&render_queue, &d3d11_render_backend);
+            TextureResidencyUpdate(&texture_residency, &d3d11_residency_backend);
+            sprite_run_order = 0;
+            VertexRingEndFrame(&dynamic_vertex_ring);
+            VertexRingEndFrame(&sprite_instance_ring);
+            swapChain->Present(1, 0);
         }
 
-        stbtt_FreeBitmap(bitmap, nullptr);
+        g_window.frame_counter++;
+        g_window.frame_draw_calls = 0;
+        frame_culled_sprite_count = 0;
     }
 
-    result.font_atlas_width = fontAtlasWidth;
-    result.font_atlas_height = fontAtlasHeight;
-
-    int atlasX = 0;
-    unsigned char* font_atlas_buffer = (unsigned char*)calloc(fontAtlasHeight * fontAtlasWidth, sizeof(unsigned char));
-
-    for (int c = 32; c < 128; c++) {
-        int codepoint = c;
-        int width, height, xoffset, yoffset;
-        unsigned char *bitmap = stbtt_GetCodepointBitmap(&font, 0, scale, codepoint, &width, &height, &xoffset, &yoffset);
-
-        for (int row = 0; row < height; row++) {
-            int dest_index = (result.font_atlas_width * row) + atlasX;
-            unsigned char *dest = &font_atlas_buffer[dest_index];
-            int src_index = width * row;
-            unsigned char *src = &bitmap[src_index];
-            memcpy(dest, src, width);
+    FileWatcherDestroy(&g_file_watcher);
+    for (ShaderReload& reload : shader_reloads) {
+        if (reload.thread.joinable()) {
+            reload.thread.join();
         }
+    }
+
+    // Textures are released before the stream and residency state their release touches
+    ReleaseTextureAtlas(&sprite_atlas, sprite_atlas_pages);
+    ReleaseTexture(tile_atlas_01);
+    ReleaseTexture(dude_01);
+    AssetStreamDestroy(&g_asset_stream);
+    TextureResidencyDestroy(&texture_residency);
 
-        f32 uv_x0 = (f32)atlasX / (f32)result.font_atlas_width;
-        f32 uv_y0 = 0.0f;
-        f32 uv_x1 = uv_x0 + (f32)width / (f32)result.font_atlas_width;
-        f32 uv_y1 = (f32)height / (f32)result.font_atlas_height;
+    return window_message.wParam;
+}
 
-        int glyph_index = c - 32;
-        result.glyphs[glyph_index].uv_x0 = uv_x0;
-        result.glyphs[glyph_index].uv_y0 = uv_y0;
-        result.glyphs[glyph_index].uv_x1 = uv_x1;
-        result.glyphs[glyph_index].uv_y1 = uv_y1;
+FontAtlasInfo LoadFontAtlas(char* filepath, float pixel_height) {
+    size_t file_size;
+    unsigned char *fontBuffer = LoadFileToPtr(filepath, &file_size);
 
-        atlasX += width;
-        stbtt_FreeBitmap(bitmap, nullptr);
+    AssetFontBitmap bitmap = {};
+    if (!AssetBakeFont(fontBuffer, pixel_height, &bitmap)) {
+        ErrorMessageAndBreak((char*)"Failed to bake font atlas!");
     }
+    free(fontBuffer);
+
+    FontAtlasInfo result = CreateFontAtlas(&bitmap);
+    free(bitmap.pixels);
+    return result;
+}
 
-    result.glyphs[32].advance = result.glyphs['M' - 32].bitmap_width / 2.0f; // Spacebar
+FontAtlasInfo CreateFontAtlas(AssetFontBitmap* bitmap) {
+    FontAtlasInfo result = {};
+    result.font_size_px = bitmap->font_size_px;
+    result.font_atlas_width = bitmap->width;
+    result.font_atlas_height = bitmap->height;
+    result.font_ascent = bitmap->ascent;
+    result.font_descent = bitmap->descent;
+    result.font_linegap = bitmap->linegap;
+    memcpy(result.glyphs, bitmap->glyphs, sizeof(result.glyphs));
 
     D3D11_TEXTURE2D_DESC desc = {};
     desc.Width = result.font_atlas_width;
@@ -1414,7 +2573,7 @@ FontAtlasInfo LoadFontAtlas(char* filepath, float pixel_height) {
     desc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
     desc.CPUAccessFlags = 0;
     D3D11_SUBRESOURCE_DATA initData = {};
-    initData.pSysMem = font_atlas_buffer;
+    initData.pSysMem = bitmap->pixels;
     initData.SysMemPitch = result.font_atlas_width; // The distance in bytes between the start of each line of the texture
         
     ID3D11Texture2D* font_texture = nullptr;
@@ -1514,285 +2673,417 @@ f32 GetTextWidthPx(char* text, FontAtlasInfo* font_info) {
     return longest;
 }
 
+/**
+ * @brief Record glyph quads of 'text' into the render queue.
+ *
+ * Laid out quads are kept in the text run cache, so unchanged strings are copied instead of laid out again.
+ */
 Vec2f DrawTextToScreen(char* text, Vec2f screen_pos, FontAtlasInfo* font_info) {
-    Vec2f cursor = {
-        .x = screen_pos.x,
-        .y = screen_pos.y
-    };
+    if (TEXT_LAYOUT_MAX_QUADS < (i32)strlen(text)) {
+        ErrorMessageAndBreak((char*)"Text too long for text layout scratch buffer");
+    }
 
-    Vec2f cursor_original = {
-        .x = screen_pos.x,
-        .y = screen_pos.y
-    };
-    
-    for (char* p = (char*)text; *p != '\0'; p++) {
-        char c = *p;
+    u64 font_id = (u64)font_info;
+    TextRunView run = TextRunCacheLayout(&text_run_cache, text, screen_pos, font_id, font_info->glyphs, font_info->font_size_px, g_window.size_px, text_layout_scratch);
 
-        if (c == '\n') {
-            cursor.x = cursor_original.x;
-            cursor.y += font_info->font_size_px;
-            continue;
+    if (0 < run.quad_count) {
+        void* quads = RenderQueuePushQuads(&render_queue, render_layer, 0, RENDER_PIPELINE_TEXT, font_info->draw_id, sizeof(TextUiVertex), run.quad_count);
+        if (quads) {
+            memcpy(quads, run.vertices, sizeof(TextUiVertex) * QUAD_VERTEX_COUNT * run.quad_count);
         }
-
-        FontGlyphInfo glyph = font_info->glyphs[c - 32];
-
-        i32 px_x0 = cursor.x + glyph.x_offset;
-        i32 px_x1 = px_x0 + glyph.bitmap_width;
-        i32 px_y0 = cursor.y - glyph.y_offset;
-        i32 px_y1 = px_y0 + glyph.bitmap_height;
-
-        auto top_left = g_window.ScreenPxToNDC({px_x0, px_y0});
-        auto top_right = g_window.ScreenPxToNDC({px_x1, px_y0});
-        auto bot_left = g_window.ScreenPxToNDC({px_x0, px_y1});
-        auto bot_right = g_window.ScreenPxToNDC({px_x1, px_y1});
-
-        TextUiVertex vertices[] = {
-            { DirectX::XMFLOAT4(top_left.x, top_left.y, 1.0f, 1.0f), DirectX::XMFLOAT2(glyph.uv_x0, glyph.uv_y0) },  // Top-left
-            { DirectX::XMFLOAT4(top_right.x, top_right.y, 1.0f, 1.0f), DirectX::XMFLOAT2(glyph.uv_x1, glyph.uv_y0) },   // Top-right
-            { DirectX::XMFLOAT4(bot_left.x, bot_left.y, 1.0f, 1.0f), DirectX::XMFLOAT2(glyph.uv_x0, glyph.uv_y1) }, // Bottom-lef   
-            { DirectX::XMFLOAT4(bot_left.x, bot_left.y, 1.0f, 1.0f), DirectX::XMFLOAT2(glyph.uv_x0, glyph.uv_y1) }, // Bottom-left
-            { DirectX::XMFLOAT4(top_right.x, top_right.y, 1.0f, 1.0f), DirectX::XMFLOAT2(glyph.uv_x1, glyph.uv_y0) },   // Top-right
-            { DirectX::XMFLOAT4(bot_right.x, bot_right.y, 1.0f, 1.0f), DirectX::XMFLOAT2(glyph.uv_x1, glyph.uv_y1) }   // Bottom-right
-        };
-
-        D3D11_MAPPED_SUBRESOURCE mappedResource;
-        HRESULT hr = deviceContext->Map(text_ui_vertex_buffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource);
-        if (FAILED(hr)) {
-             ErrorMessageAndBreak((char*)"Map for text_ui dynamic vertex buffer failed!");
+        else {
+            DebugMessage((char*)"Render queue full, text dropped\n");
         }
+    }
 
-        memcpy(mappedResource.pData, vertices, sizeof(TextUiVertex) * 6);
-        deviceContext->Unmap(text_ui_vertex_buffer, 0);
+    if (run.end_cursor.x < 0) {
+        ErrorMessageAndBreak((char*)"Cursor x less than 0");
+    }
 
-        deviceContext->IASetInputLayout(text_ui_input_layout);
-        deviceContext->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+    if (run.end_cursor.y < 0) {
+        ErrorMessageAndBreak((char*)"Cursor y less than 0");
+    }
 
-        deviceContext->VSSetShader(text_ui_vertex_shader, nullptr, 0);
-        deviceContext->PSSetShader(text_ui_pixel_shader, nullptr, 0);
+    return run.end_cursor;
+}
 
-        deviceContext->PSSetShaderResources(0, 1, &font_info->texture);
-        deviceContext->PSSetSamplers(0, 1, &g_sampler);
+/**
+ * @brief Copy vertices into this frame's part of the dynamic vertex ring and bind them to input slot 0.
+ */
+void UploadDynamicVertices(void* vertices, u32 byte_size, UINT stride) {
+    VertexRingAllocation allocation = VertexRingAllocate(&dynamic_vertex_ring, byte_size, stride);
+    if (!allocation.data) {
+        ErrorMessageAndBreak((char*)"Dynamic vertex ring overflow!");
+    }
 
-        UINT stride = sizeof(TextUiVertex);
-        UINT offset = 0;
-        deviceContext->IASetVertexBuffers(0, 1, &text_ui_vertex_buffer, &stride, &offset);
-        deviceContext->Draw(6, 0);
-        g_window.frame_draw_calls++;
+    memcpy(allocation.data, vertices, byte_size);
+    VertexRingUnmap(&dynamic_vertex_ring);
 
-        cursor.x += glyph.advance;
-    }
+    UINT offset = allocation.offset;
+    deviceContext->IASetVertexBuffers(0, 1, &dynamic_vertex_buffer.buffer, &stride, &offset);
+}
 
-    if (cursor.x < 0) {
-        ErrorMessageAndBreak((char*)"Cursor x less than 0");
-    }
+void D3D11RenderBindPipeline(void* user_data, u32 pipeline) {
+    deviceContext->IASetIndexBuffer(quad_index_buffer, DXGI_FORMAT_R32_UINT, 0);
+    deviceContext->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+    deviceContext->PSSetSamplers(0, 1, &g_sampler);
 
-    if (cursor.y < 0) {
-        ErrorMessageAndBreak((char*)"Cursor y less than 0");
+    switch (pipeline) {
+        case RENDER_PIPELINE_QUAD_2D:
+            deviceContext->IASetInputLayout(rectangle_2d_input_layout);
+            deviceContext->VSSetShader(rectangle_2d_vertex_shader, nullptr, 0);
+            deviceContext->PSSetShader(rectangle_2d_pixel_shader, nullptr, 0);
+            break;
+        case RENDER_PIPELINE_SHAPES:
+            deviceContext->IASetInputLayout(rectangle_input_layout);
+            deviceContext->VSSetShader(rectangle_vertex_shader, nullptr, 0);
+            deviceContext->PSSetShader(rectangle_pixel_shader, nullptr, 0);
+            break;
+        case RENDER_PIPELINE_TEXT:
+            deviceContext->IASetInputLayout(text_ui_input_layout);
+            deviceContext->VSSetShader(text_ui_vertex_shader, nullptr, 0);
+            deviceContext->PSSetShader(text_ui_pixel_shader, nullptr, 0);
+            break;
+        case RENDER_PIPELINE_SPRITE_INSTANCED:
+            deviceContext->IASetInputLayout(nullptr);
+            deviceContext->VSSetShader(sprite_instanced_vertex_shader, nullptr, 0);
+            deviceContext->PSSetShader(sprite_instanced_pixel_shader, nullptr, 0);
+            deviceContext->VSSetConstantBuffers(BUFFER_SLOT_SPRITE_INSTANCE_DRAW, 1, &cbuffer_sprite_instance_draw);
+            break;
+        default:
+            ErrorMessageAndBreak((char*)"Unknown render pipeline");
     }
+}
 
-    return cursor;
+void D3D11RenderBindTexture(void* user_data, u32 texture) {
+    ID3D11ShaderResourceView* resource_view = texture < (u32)draw_texture_count ? draw_textures[texture] : nullptr;
+    deviceContext->PSSetShaderResources(0, 1, &resource_view);
+    TextureResidencyTouch(&texture_residency, texture);
 }
 
-BYTE* LoadWAWFile(wchar_t* filePath, WAVHeader* wavHeader) {
-    HANDLE hFile;
-    DWORD bytesRead;
+void D3D11RenderDrawQuads(void* user_data, void* vertices, u32 vertex_stride, u32 quad_count) {
+    UploadDynamicVertices(vertices, vertex_stride * QUAD_VERTEX_COUNT * quad_count, vertex_stride);
+    deviceContext->DrawIndexed(quad_count * QUAD_INDEX_COUNT, 0, 0);
+    g_window.frame_draw_calls++;
+}
 
-    hFile = CreateFileW(filePath, GENERIC_READ, 0, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
-    if (hFile == INVALID_HANDLE_VALUE) {
-        ErrorMessageAndBreak((char*)"Error opening file.");
-    }
+void D3D11RenderDrawStaticQuads(void* user_data, u32 static_buffer, u32 vertex_stride, u32 quad_count) {
+    UINT stride = vertex_stride;
+    UINT offset = 0;
+    deviceContext->IASetVertexBuffers(0, 1, &tilemap_chunk_vertex_buffers[static_buffer], &stride, &offset);
+    deviceContext->DrawIndexed(quad_count * QUAD_INDEX_COUNT, 0, 0);
+    g_window.frame_draw_calls++;
+}
 
-    if (!ReadFile(hFile, wavHeader, sizeof(WAVHeader), &bytesRead, NULL)) {
-        ErrorMessageAndBreak((char*)"Error reading file.\n");
+/**
+ * @brief Copy sprite instances into this frame's part of the instance ring and draw them from the shared quad indices.
+ */
+void D3D11RenderDrawInstances(void* user_data, void* instances, u32 instance_stride, u32 instance_count) {
+    u32 byte_size = instance_stride * instance_count;
+    VertexRingAllocation allocation = VertexRingAllocate(&sprite_instance_ring, byte_size, instance_stride);
+    if (!allocation.data) {
+        ErrorMessageAndBreak((char*)"Sprite instance ring overflow!");
     }
 
-    if (memcmp(wavHeader->riffHeader, "RIFF", 4) != 0 || memcmp(wavHeader->waveHeader, "WAVE", 4) != 0) {
-        ErrorMessageAndBreak((char*)"Invalid WAV file.");
+    memcpy(allocation.data, instances, byte_size);
+    VertexRingUnmap(&sprite_instance_ring);
+
+    D3D11_MAPPED_SUBRESOURCE mappedResource;
+    HRESULT hr = deviceContext->Map(cbuffer_sprite_instance_draw, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource);
+    if (FAILED(hr)) {
+        ErrorMessageAndBreak((char*)"deviceContext->Map() SpriteInstanceDrawBufferType failed!");
     }
+    SpriteInstanceDrawBufferType* draw_data = (SpriteInstanceDrawBufferType*)mappedResource.pData;
+    draw_data->first_instance = allocation.offset / instance_stride;
+    deviceContext->Unmap(cbuffer_sprite_instance_draw, 0);
 
-    BYTE* audioData = (BYTE*)GlobalAlloc(GMEM_FIXED, wavHeader->dataSize);
-    if (audioData == NULL) {
-        ErrorMessageAndBreak((char*)"Memory allocation failed.");
+    deviceContext->VSSetShaderResources(1, 1, &sprite_instance_view);
+    deviceContext->DrawIndexedInstanced(QUAD_INDEX_COUNT, instance_count, 0, 0, 0);
+    g_window.frame_draw_calls++;
+}
+
+void CreateD3D11RingBuffer(D3D11RingBuffer* ring_buffer, VertexRing* ring, D3D11_BUFFER_DESC* buffer_desc) {
+    HRESULT hr = id3d11_device->CreateBuffer(buffer_desc, nullptr, &ring_buffer->buffer);
+    if (FAILED(hr)) {
+        ErrorMessageAndBreak((char*)"CreateBuffer for ring buffer failed!");
     }
 
-    if (!ReadFile(hFile, audioData, wavHeader->dataSize, &bytesRead, NULL)) {
-        ErrorMessageAndBreak((char*)"Error reading audio data.");
+    D3D11_QUERY_DESC queryDesc = {};
+    queryDesc.Query = D3D11_QUERY_EVENT;
+
+    for (i32 i = 0; i < VERTEX_RING_MAX_FRAMES_IN_FLIGHT; i++) {
+        hr = id3d11_device->CreateQuery(&queryDesc, &ring_buffer->fences[i]);
+        if (FAILED(hr)) {
+            ErrorMessageAndBreak((char*)"CreateQuery for ring buffer fence failed!");
+        }
     }
 
-    CloseHandle(hFile);
-    return audioData;
+    VertexRingBackend backend = {
+        .user_data = ring_buffer,
+        .map = D3D11VertexRingMap,
+        .unmap = D3D11VertexRingUnmap,
+        .signal_fence = D3D11VertexRingSignalFence,
+        .is_fence_complete = D3D11VertexRingIsFenceComplete
+    };
+    VertexRingCreate(ring, backend, buffer_desc->ByteWidth);
 }
 
-Vec2f ScreenSpaceToTilemapCoords(Vec2f screen_coord) {
-    float x_tile = (screen_coord.x + 2.0f * screen_coord.y) / 2.0f;
-    float y_tile = (2.0f * screen_coord.y - screen_coord.x) / 2.0f;
-    Vec2f result = {x_tile, y_tile};
-    return result;
+byte* D3D11VertexRingMap(void* user_data, bool discard) {
+    D3D11RingBuffer* ring_buffer = (D3D11RingBuffer*)user_data;
+    D3D11_MAPPED_SUBRESOURCE mappedResource;
+    D3D11_MAP map_type = discard || !ring_buffer->can_map_no_overwrite ? D3D11_MAP_WRITE_DISCARD : D3D11_MAP_WRITE_NO_OVERWRITE;
+    HRESULT hr = deviceContext->Map(ring_buffer->buffer, 0, map_type, 0, &mappedResource);
+    if (FAILED(hr)) {
+        ErrorMessageAndBreak((char*)"Map for dynamic ring buffer failed!");
+    }
+    return (byte*)mappedResource.pData;
 }
 
-Vec2f TilemapCoordsToIsometricScreenSpace(Vec2f tilemap_coord) {
-    const float y_offset = 0.5f; // So that 0,0 coord is the bottom corner of tile
-    float x = (tilemap_coord.y * (-1.0f)) + (tilemap_coord.x * (1.0f));
-    float y = (tilemap_coord.y * (0.5f))  + (tilemap_coord.x * (0.5f)) + y_offset;
-    Vec2f result = {x, y};
-    return result;
+void D3D11VertexRingUnmap(void* user_data) {
+    D3D11RingBuffer* ring_buffer = (D3D11RingBuffer*)user_data;
+    deviceContext->Unmap(ring_buffer->buffer, 0);
 }
 
-void DrawBufferedRectangle2ds(ID3D11ShaderResourceView* texture) {
-    UINT stride = sizeof(TilemapTileVertex);
-    UINT offset = 0;
-    deviceContext->IASetVertexBuffers(0, 1, &rectangle_2d_vertex_buffer, &stride, &offset);
-    deviceContext->IASetInputLayout(rectangle_2d_input_layout);
-    deviceContext->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+void D3D11VertexRingSignalFence(void* user_data, i32 fence_slot) {
+    D3D11RingBuffer* ring_buffer = (D3D11RingBuffer*)user_data;
+    deviceContext->End(ring_buffer->fences[fence_slot]);
+}
 
-    deviceContext->VSSetShader(rectangle_2d_vertex_shader, nullptr, 0);
-    deviceContext->PSSetShader(rectangle_2d_pixel_shader, nullptr, 0);
+bool D3D11VertexRingIsFenceComplete(void* user_data, i32 fence_slot) {
+    D3D11RingBuffer* ring_buffer = (D3D11RingBuffer*)user_data;
+    HRESULT hr = deviceContext->GetData(ring_buffer->fences[fence_slot], nullptr, 0, D3D11_ASYNC_GETDATA_DONOTFLUSH);
+    return hr == S_OK;
+}
 
-    deviceContext->PSSetShaderResources(0, 1, &texture);
-    deviceContext->PSSetSamplers(0, 1, &g_sampler);
+void QueueSprite(Texture* texture, Vec2f center, Vec2f size, Vec4f uv_rect, u32 layer) {
+    f32 isometric_depth = center.y - size.y * 0.5f;
+    SpriteInstance instance = PackSpriteInstance(center, size, uv_rect, Vec4f{1.0f, 1.0f, 1.0f, 1.0f}, isometric_depth);
+    QueueSpriteInstance(texture->draw_id, &instance, layer);
+}
 
-    deviceContext->Draw(buffered_rectangle_2d_vertex_count, 0);
-    g_window.frame_draw_calls++;
-    buffered_rectangle_2d_vertex_count = 0;
-}
-
-void BufferRectangle2d(Vec2f offset) {
-    TilemapTileVertex vertices[] = {
-        // Top Right
-        { DirectX::XMFLOAT4( 0.5f + offset.x,  0.5f + offset.y, 0.0f, 1.0f), DirectX::XMFLOAT4(1.0f, 1.0f, 1.0f, 1.0f), DirectX::XMFLOAT2(1.0f, 0.0f) },
-        // Bottom Left
-        { DirectX::XMFLOAT4(-0.5f + offset.x, -0.5f + offset.y, 0.0f, 1.0f), DirectX::XMFLOAT4(1.0f, 1.0f, 1.0f, 1.0f), DirectX::XMFLOAT2(0.0f, 1.0f) },
-        // Top Left
-        { DirectX::XMFLOAT4(-0.5f + offset.x,  0.5f + offset.y, 0.0f, 1.0f), DirectX::XMFLOAT4(1.0f, 1.0f, 1.0f, 1.0f), DirectX::XMFLOAT2(0.0f, 0.0f) },
-
-        // Bottom Right
-        { DirectX::XMFLOAT4( 0.5f + offset.x, -0.5f + offset.y, 0.0f, 1.0f), DirectX::XMFLOAT4(1.0f, 1.0f, 1.0f, 1.0f), DirectX::XMFLOAT2(1.0f, 1.0f) },
-        // Bottom Left
-        { DirectX::XMFLOAT4(-0.5f + offset.x, -0.5f + offset.y, 0.0f, 1.0f), DirectX::XMFLOAT4(1.0f, 1.0f, 1.0f, 1.0f), DirectX::XMFLOAT2(0.0f, 1.0f) },
-        // Top Right
-        { DirectX::XMFLOAT4( 0.5f + offset.x,  0.5f + offset.y, 0.0f, 1.0f), DirectX::XMFLOAT4(1.0f, 1.0f, 1.0f, 1.0f), DirectX::XMFLOAT2(1.0f, 0.0f) }
+void QueueSpriteInstance(u32 texture_id, SpriteInstance* instance, u32 layer) {
+    if (!SpriteIsVisible(&sprite_cull_rect, instance->center, instance->size)) {
+        frame_culled_sprite_count++;
+        return;
+    }
+
+    QueuedQuad quad = {
+        .instance = *instance,
+        .texture_id = texture_id
     };
 
-    D3D11_MAPPED_SUBRESOURCE mappedResource;
-    HRESULT hr = deviceContext->Map(rectangle_2d_vertex_buffer, 0, D3D11_MAP_WRITE_NO_OVERWRITE, 0, &mappedResource);
-    if (FAILED(hr)) {
-        ErrorMessageAndBreak((char*)"Failed to map vertex buffer!");
+    if (!QuadDrawQueuePush(&sprite_draw_queue, layer, instance->depth, quad)) {
+        DebugMessage((char*)"Sprite draw queue full, sprite dropped\n");
     }
+}
 
-    size_t offsetInBytes = buffered_rectangle_2d_vertex_count * sizeof(TilemapTileVertex);
-    memcpy((byte*)mappedResource.pData + offsetInBytes, vertices, sizeof(vertices));
-
-    deviceContext->Unmap(rectangle_2d_vertex_buffer, 0);
-    buffered_rectangle_2d_vertex_count += 6;
+void QueueAtlasSprite(TextureAtlasRegion* region, Vec2f center, Vec2f size, u32 layer) {
+    Vec4f uv_rect = TextureAtlasRegionUVRect(&sprite_atlas, region);
+    f32 isometric_depth = center.y - size.y * 0.5f;
+    SpriteInstance instance = PackSpriteInstance(center, size, uv_rect, Vec4f{1.0f, 1.0f, 1.0f, 1.0f}, isometric_depth);
+    QueueSpriteInstance(ResolveTexture(sprite_atlas_pages[region->page])->draw_id, &instance, layer);
 }
 
-unsigned char* LoadFileToPtr(wchar_t* filename, size_t* get_file_size) {
-    HANDLE file = CreateFileW(filename, GENERIC_READ, 0, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
-    if (file == INVALID_HANDLE_VALUE) {
-        ErrorMessageAndBreak((char*)"CreateFileW failed!");
+void DrawQueuedSprites() {
+    QuadDrawQueueSort(&sprite_draw_queue);
+
+    i32 run_start = 0;
+    while (run_start < sprite_draw_queue.count) {
+        u32 texture_id = DrawSortKeyTextureId(sprite_draw_queue.keys[run_start]);
+        i32 run_end = run_start + 1;
+        while (run_end < sprite_draw_queue.count && DrawSortKeyTextureId(sprite_draw_queue.keys[run_end]) == texture_id) {
+            run_end++;
+        }
+
+        sprite_run_order++;
+        SpriteInstance* instances = (SpriteInstance*)RenderQueuePushInstances(&render_queue, render_layer, sprite_run_order, RENDER_PIPELINE_SPRITE_INSTANCED, texture_id, sizeof(SpriteInstance), run_end - run_start);
+        if (!instances) {
+            DebugMessage((char*)"Render queue full, sprites dropped\n");
+        }
+        else {
+            for (i32 i = run_start; i < run_end; i++) {
+                instances[i - run_start] = sprite_draw_queue.quads[sprite_draw_queue.indices[i]].instance;
+            }
+        }
+
+        run_start = run_end;
     }
 
-    DWORD fileSize = GetFileSize(file, NULL);
-    if (fileSize == INVALID_FILE_SIZE) {
-        ErrorMessageAndBreak((char*)"CreateFileW failed!");
+    QuadDrawQueueClear(&sprite_draw_queue);
+}
+
+void DrawTilemapChunk(TilemapChunk* chunk, u32 texture_id) {
+    i32 chunk_id = (i32)(chunk - g_tilemap.chunks);
+    ID3D11Buffer** vertex_buffer = &tilemap_chunk_vertex_buffers[chunk_id];
+
+    if (*vertex_buffer == nullptr) {
+        D3D11_BUFFER_DESC vertexBufferDesc = {};
+        vertexBufferDesc.Usage = D3D11_USAGE_DEFAULT;
+        vertexBufferDesc.ByteWidth = sizeof(TilemapTileVertex) * TILEMAP_CHUNK_MESH_MAX_VERTEX_COUNT;
+        vertexBufferDesc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
+        vertexBufferDesc.CPUAccessFlags = 0;
+
+        HRESULT hr = id3d11_device->CreateBuffer(&vertexBufferDesc, nullptr, vertex_buffer);
+        if (FAILED(hr)) {
+            ErrorMessageAndBreak((char*)"CreateBuffer for tilemap chunk vertex buffer failed!");
+        }
+        chunk->is_mesh_dirty = true;
     }
 
-    unsigned char* buffer = (unsigned char*)malloc(fileSize);
-    if (!buffer) {
-        ErrorMessageAndBreak((char*)"CreateFileW failed!");
+    if (chunk->is_mesh_dirty) {
+        i32 vertex_count = TilemapBuildChunkMesh(&g_tilemap, chunk, tile_atlas_01_layout, tilemap_chunk_mesh_scratch);
+
+        D3D11_BOX update_box = {};
+        update_box.left = 0;
+        update_box.right = sizeof(TilemapTileVertex) * vertex_count;
+        update_box.top = 0;
+        update_box.bottom = 1;
+        update_box.front = 0;
+        update_box.back = 1;
+
+        if (0 < vertex_count) {
+            deviceContext->UpdateSubresource(*vertex_buffer, 0, &update_box, tilemap_chunk_mesh_scratch, 0, 0);
+        }
+        tilemap_chunk_vertex_counts[chunk_id] = vertex_count;
+        chunk->is_mesh_dirty = false;
     }
 
-    DWORD bytesRead;
-    BOOL success = ReadFile(file, buffer, fileSize, &bytesRead, NULL);
-    if (!success || bytesRead != fileSize) {
-        ErrorMessageAndBreak((char*)"CreateFileW failed!");
+    i32 quad_count = tilemap_chunk_vertex_counts[chunk_id] / QUAD_VERTEX_COUNT;
+    if (0 < quad_count && !RenderQueuePushStatic(&render_queue, render_layer, 0, RENDER_PIPELINE_QUAD_2D, texture_id, (u32)chunk_id, sizeof(TilemapTileVertex), quad_count)) {
+        DebugMessage((char*)"Render queue full, tilemap chunk dropped\n");
     }
+}
 
-    CloseHandle(file);
+unsigned char* LoadFileToPtr(char* path, size_t* get_file_size) {
+    size_t file_size = 0;
+    unsigned char* buffer = VfsReadFile(&g_vfs, path, &file_size);
+    if (!buffer) {
+        auto message = temp_cstr.GetCStrBuffer();
+        snprintf(message, STR_BUFFER_COUNT, "Failed to load resource file: %s", path);
+        ErrorMessageAndBreak(message);
+    }
 
     if (get_file_size) {
-        *get_file_size = fileSize;
+        *get_file_size = file_size;
     }
 
     return buffer;
 }
 
-bool CursorOverTilemap() {
-    if (0 <= frame_input.mouse_tilemap_x && 0 <= frame_input.mouse_tilemap_y) {
-        if (frame_input.mouse_tilemap_x < g_tilemap.width && frame_input.mouse_tilemap_y < g_tilemap.height) {
-            return true;
-        }
+ID3DBlob* CompileShaderFromVfs(char* path, const char* entry_point, const char* target) {
+    char error[SHADER_ERROR_MAX];
+    ID3DBlob* blob = TryCompileShaderFromVfs(path, entry_point, target, error);
+    if (!blob) {
+        OutputDebugStringA(error);
+        ErrorMessageAndBreak(error);
     }
-    return false;
+    return blob;
 }
 
-void DrawRectangleToScreen(Vec2f top_left, Vec2f top_right, Vec2f bot_left, Vec2f bot_right, Vec3f color) {
-    RectangleVertex vertices[] = {
-        { DirectX::XMFLOAT4(top_left.x, top_left.y, 1.0f, 1.0f), DirectX::XMFLOAT4(color.x, color.y, color.z, 1.0f) },  // Top-left
-        { DirectX::XMFLOAT4(top_right.x, top_right.y, 1.0f, 1.0f), DirectX::XMFLOAT4(color.x, color.y, color.z, 1.0f) },   // Top-right
-        { DirectX::XMFLOAT4(bot_left.x, bot_left.y, 1.0f, 1.0f), DirectX::XMFLOAT4(color.x, color.y, color.z, 1.0f) }, // Bottom-left
-
-        { DirectX::XMFLOAT4(bot_left.x, bot_left.y, 1.0f, 1.0f), DirectX::XMFLOAT4(color.x, color.y, color.z, 1.0f) }, // Bottom-left
-        { DirectX::XMFLOAT4(top_right.x, top_right.y, 1.0f, 1.0f), DirectX::XMFLOAT4(color.x, color.y, color.z, 1.0f) },   // Top-right
-        { DirectX::XMFLOAT4(bot_right.x, bot_right.y, 1.0f, 1.0f), DirectX::XMFLOAT4(color.x, color.y, color.z, 1.0f) }   // Bottom-right
-    };
+ID3DBlob* TryCompileShaderFromVfs(const char* path, const char* entry_point, const char* target, char* error) {
+    return ShaderCompileCached(&g_shader_cache, &vfs_shader_reader, path, nullptr, entry_point, target, 0, error, SHADER_ERROR_MAX);
+}
 
-    D3D11_MAPPED_SUBRESOURCE mappedResource;
-    HRESULT hr = deviceContext->Map(rectangle_vertex_buffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource);
-    if (FAILED(hr)) {
-        ErrorMessageAndBreak((char*)"Map for rectangle dynamic vertex buffer failed!");
-    }
+byte* ReadShaderSource(void* user_data, const char* path, size_t* size) {
+    return VfsReadFile((Vfs*)user_data, path, size);
+}
 
-    memcpy(mappedResource.pData, vertices, sizeof(RectangleVertex) * 6);
-    deviceContext->Unmap(rectangle_vertex_buffer, 0);
-    deviceContext->IASetInputLayout(rectangle_input_layout);
-    deviceContext->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
-    deviceContext->VSSetShader(rectangle_vertex_shader, nullptr, 0);
-    deviceContext->PSSetShader(rectangle_pixel_shader, nullptr, 0);
+bool CreateShaderProgram(ShaderProgram* program, ID3DBlob* vertex_blob, ID3DBlob* pixel_blob) {
+    ID3D11VertexShader* vertex_shader = nullptr;
+    ID3D11PixelShader* pixel_shader = nullptr;
+    ID3D11InputLayout* input_layout = nullptr;
 
-    UINT stride = sizeof(RectangleVertex);
-    UINT offset = 0;
-    deviceContext->IASetVertexBuffers(0, 1, &rectangle_vertex_buffer, &stride, &offset);
-    deviceContext->Draw(6, 0);
-    g_window.frame_draw_calls++;
+    bool is_ok = SUCCEEDED(id3d11_device->CreateVertexShader(vertex_blob->GetBufferPointer(), vertex_blob->GetBufferSize(), nullptr, &vertex_shader))
+        && SUCCEEDED(id3d11_device->CreatePixelShader(pixel_blob->GetBufferPointer(), pixel_blob->GetBufferSize(), nullptr, &pixel_shader))
+        && SUCCEEDED(id3d11_device->CreateInputLayout(program->layout, program->layout_count, vertex_blob->GetBufferPointer(), vertex_blob->GetBufferSize(), &input_layout));
+
+    ID3D11VertexShader* old_vertex_shader = is_ok ? *program->vertex_shader : vertex_shader;
+    ID3D11PixelShader* old_pixel_shader = is_ok ? *program->pixel_shader : pixel_shader;
+    ID3D11InputLayout* old_input_layout = is_ok ? *program->input_layout : input_layout;
+    if (old_vertex_shader) {
+        old_vertex_shader->Release();
+    }
+    if (old_pixel_shader) {
+        old_pixel_shader->Release();
+    }
+    if (old_input_layout) {
+        old_input_layout->Release();
+    }
+
+    if (is_ok) {
+        *program->vertex_shader = vertex_shader;
+        *program->pixel_shader = pixel_shader;
+        *program->input_layout = input_layout;
+    }
+    return is_ok;
 }
 
-void DrawDotOnScreen(Vec2f ndc, f32 size_px, Vec3f color) {
-    f32 dot_w = g_window.GetPxInVW(size_px / 2);
-    f32 dot_h = g_window.GetPxInVH(size_px / 2);
-    DrawRectangleToScreen({-dot_w, dot_h}, {dot_w, dot_h}, {-dot_w, -dot_h}, {dot_w, -dot_h}, {color.x, color.y, color.z});
+bool CursorOverTilemap() {
+    return TilemapContains(&g_tilemap, frame_input.mouse_tilemap_x, frame_input.mouse_tilemap_y);
 }
 
-void DrawLineOnScreen(Vec2f ndc_start, Vec2f ndc_end, f32 size_px, Vec3f color) {
-    Vec2i start_px = g_window.NDCToScreenPx(ndc_start);
-    Vec2i end_px = g_window.NDCToScreenPx(ndc_end);
+void LoadTilemapChunk(void* user_data, Vec2i chunk_coord, Tile* tiles) {
+    if (TilemapChunkStoreGet((TilemapChunkStore*)user_data, chunk_coord, tiles)) {
+        return;
+    }
+
+    // Spilled edits are read back, the last spill of a chunk is its latest edit that left the store
+    u32 spill_slot = g_tilemap_spill_slots[chunk_coord.x + chunk_coord.y * WORLD_TILEMAP_CHUNKS_X];
+    if (spill_slot != 0) {
+        size_t chunk_bytes = sizeof(Tile) * TILEMAP_CHUNK_TILE_COUNT;
+        if (fseek(g_tilemap_spill_file, (long)((spill_slot - 1) * chunk_bytes), SEEK_SET) != 0
+            || fread(tiles, chunk_bytes, 1, g_tilemap_spill_file) != 1) {
+            ErrorMessageAndBreak((char*)"Failed to read a spilled tilemap chunk!");
+        }
+        return;
+    }
 
-    Vec2i line_vec = {start_px.x - end_px.x, start_px.y - end_px.y};
-    Vec2i perpendicular = {-line_vec.y, line_vec.x};
+    // Chunks that were never edited are generated, which for now means all tiles are type 0
+    memset(tiles, 0, sizeof(Tile) * TILEMAP_CHUNK_TILE_COUNT);
+}
 
-    DirectX::XMVECTOR perpVec = DirectX::XMVectorSet(perpendicular.x, perpendicular.y, 0.0f, 0.0f);
-    DirectX::XMVECTOR unit_perp_dx = DirectX::XMVector2Normalize(perpVec);
-    unit_perp_dx = DirectX::XMVectorScale(unit_perp_dx, size_px);
+void StoreTilemapChunk(void* user_data, Vec2i chunk_coord, Tile* tiles) {
+    if (!TilemapChunkStorePut((TilemapChunkStore*)user_data, chunk_coord, tiles)) {
+        ErrorMessageAndBreak((char*)"Tilemap chunk store is out of memory, edits would be lost!");
+    }
+}
 
-    Vec2i perp_vec = {(i32)DirectX::XMVectorGetX(unit_perp_dx), (i32)DirectX::XMVectorGetY(unit_perp_dx) };
+void SpillTilemapChunk(void* user_data, Vec2i chunk_coord, Tile* tiles) {
+    (void)user_data;
+    u32* spill_slot = &g_tilemap_spill_slots[chunk_coord.x + chunk_coord.y * WORLD_TILEMAP_CHUNKS_X];
+    if (*spill_slot == 0) {
+        *spill_slot = ++g_tilemap_spill_slot_count;
+    }
 
-    Vec2i line_start_1 = {start_px.x - perp_vec.x, start_px.y - perp_vec.y};
-    Vec2i line_start_2 = {start_px.x + perp_vec.x, start_px.y + perp_vec.y};
-    Vec2i line_end_1 = {end_px.x - perp_vec.x, end_px.y - perp_vec.y};
-    Vec2i line_end_2 = {end_px.x + perp_vec.x, end_px.y + perp_vec.y};
+    size_t chunk_bytes = sizeof(Tile) * TILEMAP_CHUNK_TILE_COUNT;
+    if (fseek(g_tilemap_spill_file, (long)((*spill_slot - 1) * chunk_bytes), SEEK_SET) != 0
+        || fwrite(tiles, chunk_bytes, 1, g_tilemap_spill_file) != 1) {
+        ErrorMessageAndBreak((char*)"Failed to write a spilled tilemap chunk, edits would be lost!");
+    }
+}
 
-    auto s1 = g_window.ScreenPxToNDC(line_start_1);
-    auto s2 = g_window.ScreenPxToNDC(line_start_2);
-    auto e1 = g_window.ScreenPxToNDC(line_end_1);
-    auto e2 = g_window.ScreenPxToNDC(line_end_2);
+/**
+ * @brief Record a solid color quad into the render queue.
+ */
+void DrawRectangleToScreen(Vec2f top_left, Vec2f top_right, Vec2f bot_left, Vec2f bot_right, Vec3f color) {
+    RectangleVertex* quad = (RectangleVertex*)RenderQueuePushQuads(&render_queue, render_layer, 0, RENDER_PIPELINE_SHAPES, RENDER_TEXTURE_NONE, sizeof(RectangleVertex), 1);
+    if (quad) {
+        BuildRectangleQuadVertices(quad, top_left, top_right, bot_left, bot_right, Vec4f{color.x, color.y, color.z, 1.0f});
+    }
+}
 
-    DrawRectangleToScreen(s1, s2, e1, e2, {color.x, color.y, color.z});
+void DrawDotOnScreen(Vec2f ndc, f32 size_px, Vec3f color) {
+    RectangleVertex* quad = (RectangleVertex*)RenderQueuePushQuads(&render_queue, render_layer, 0, RENDER_PIPELINE_SHAPES, RENDER_TEXTURE_NONE, sizeof(RectangleVertex), 1);
+    if (quad) {
+        BuildDotQuadVertices(quad, ndc, size_px, g_window.size_px, Vec4f{color.x, color.y, color.z, 1.0f});
+    }
 }
 
-Tile* GetCursorTilePtr() {
-    int index = frame_input.mouse_tilemap_x + (g_tilemap.width * frame_input.mouse_tilemap_y); 
-    Tile* tile = &tilemap_data[index];
-    return tile;
+void DrawLineOnScreen(Vec2f ndc_start, Vec2f ndc_end, f32 size_px, Vec3f color) {
+    RectangleVertex* quad = (RectangleVertex*)RenderQueuePushQuads(&render_queue, render_layer, 0, RENDER_PIPELINE_SHAPES, RENDER_TEXTURE_NONE, sizeof(RectangleVertex), 1);
+    if (quad) {
+        BuildLineQuadVertices(quad, ndc_start, ndc_end, size_px, g_window.size_px, Vec4f{color.x, color.y, color.z, 1.0f});
+    }
 }
 
 void SetDefaultViewportDimensions() {
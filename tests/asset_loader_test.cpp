@@ -0,0 +1,323 @@
+// Tests of the asset loader: converted .qoi and .fbct files are only used while they are at least as new as
+// their source, the worker pool gives the same results with any worker count, and errors keep the full path.
+
+// ----------
+// Includes
+
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <thread>
+#include <utime.h>
+
+#include "test.h"
+
+#define STB_IMAGE_IMPLEMENTATION
+#define STB_TRUETYPE_IMPLEMENTATION
+#include "../src/asset_loader.h"
+
+// ---------
+// Structs
+
+/**
+ * @brief Upload sink that checks every job arrives once, on the thread that created it.
+ */
+struct TestUploadSink {
+    std::thread::id thread_id;
+    i32 upload_counts[16];
+    i32 failed_count;
+    u64 content_hashes[16];
+};
+
+// ---------
+// Globals
+
+char test_directory[64] = "/tmp/asset_loader_test_XXXXXX";
+
+// --------------------------
+// Function implementations
+
+/**
+ * @brief Write 'size' bytes to 'name' in the test directory and set its modification time.
+ */
+void WriteTestFile(const char* name, const void* data, size_t size, i64 time) {
+    char path[ASSET_PATH_MAX];
+    snprintf(path, ASSET_PATH_MAX, "%s/%s", test_directory, name);
+    FILE* file = fopen(path, "wb");
+    if (!TEST_CHECK(file != nullptr)) {
+        return;
+    }
+    fwrite(data, 1, size, file);
+    fclose(file);
+
+    utimbuf times = { (time_t)time, (time_t)time };
+    TEST_CHECK(utime(path, &times) == 0);
+}
+
+void RemoveTestFile(const char* name) {
+    char path[ASSET_PATH_MAX];
+    snprintf(path, ASSET_PATH_MAX, "%s/%s", test_directory, name);
+    remove(path);
+}
+
+/**
+ * @brief 2x1 QOI image, one opaque red and one opaque blue pixel.
+ */
+size_t CreateTestQoi(byte* data) {
+    const byte file[] = {
+        'q', 'o', 'i', 'f', 0, 0, 0, 2, 0, 0, 0, 1, 4, 0,
+        QOI_OP_RGB, 255, 0, 0,
+        QOI_OP_RGB, 0, 0, 255,
+        0, 0, 0, 0, 0, 0, 0, 1
+    };
+    memcpy(data, file, sizeof(file));
+    return sizeof(file);
+}
+
+void TestDerivedFiles() {
+    byte qoi[64];
+    size_t qoi_size = CreateTestQoi(qoi);
+    const char not_a_png[] = "not an image";
+
+    Vfs vfs;
+    TEST_CHECK(VfsCreate(&vfs, 64));
+    TEST_CHECK(VfsMountDirectory(&vfs, "", test_directory, 0));
+
+    // A .qoi written after the source is used
+    WriteTestFile("sprite.png", not_a_png, sizeof(not_a_png), 1000);
+    WriteTestFile("sprite.qoi", qoi, qoi_size, 2000);
+    TEST_CHECK(AssetDerivedFileIsCurrent(&vfs, "sprite.qoi", "sprite.png"));
+
+    MipChain chain = {};
+    i32 channels = 0;
+    char error[ASSET_ERROR_MAX] = {};
+    TEST_CHECK(AssetDecodeImage(&vfs, "sprite.png", &chain, &channels, error));
+    TEST_CHECK(chain.widths[0] == 2 && chain.pixels[0] == 255 && chain.pixels[6] == 255);
+    MipChainDestroy(&chain);
+
+    // Once the source is saved again the stale .qoi is skipped, here the source then fails to decode
+    WriteTestFile("sprite.png", not_a_png, sizeof(not_a_png), 3000);
+    TEST_CHECK(!AssetDerivedFileIsCurrent(&vfs, "sprite.qoi", "sprite.png"));
+    TEST_CHECK(!AssetDecodeImage(&vfs, "sprite.png", &chain, &channels, error));
+    TEST_CHECK(strstr(error, "sprite.png") != nullptr);
+
+    // Equal times count as current, the converter usually runs within the same second
+    WriteTestFile("sprite.qoi", qoi, qoi_size, 3000);
+    TEST_CHECK(AssetDerivedFileIsCurrent(&vfs, "sprite.qoi", "sprite.png"));
+
+    // A converted file without a source is used, a missing converted file is not
+    WriteTestFile("page.fbct", qoi, qoi_size, 10);
+    TEST_CHECK(AssetDerivedFileIsCurrent(&vfs, "page.fbct", "page.png"));
+    TEST_CHECK(!AssetDerivedFileIsCurrent(&vfs, "missing.qoi", "sprite.png"));
+
+    // Without a Vfs the paths are native
+    char native_qoi[ASSET_PATH_MAX];
+    char native_png[ASSET_PATH_MAX];
+    snprintf(native_qoi, ASSET_PATH_MAX, "%s/sprite.qoi", test_directory);
+    snprintf(native_png, ASSET_PATH_MAX, "%s/sprite.png", test_directory);
+    TEST_CHECK(AssetDerivedFileIsCurrent(nullptr, native_qoi, native_png));
+    WriteTestFile("sprite.qoi", qoi, qoi_size, 2000);
+    TEST_CHECK(!AssetDerivedFileIsCurrent(nullptr, native_qoi, native_png));
+
+    // Packed and in-memory files have no times. Both packed is current, a loose source over them is an edit
+    VfsMemoryFile memory_files[] = {
+        { "packed/tile.png", (const byte*)not_a_png, sizeof(not_a_png) },
+        { "packed/tile.qoi", qoi, qoi_size },
+    };
+    TEST_CHECK(VfsMountMemory(&vfs, "", memory_files, 2, -1));
+    TEST_CHECK(AssetDerivedFileIsCurrent(&vfs, "packed/tile.qoi", "packed/tile.png"));
+
+    char packed_directory[ASSET_PATH_MAX];
+    snprintf(packed_directory, ASSET_PATH_MAX, "%s/packed", test_directory);
+    mkdir(packed_directory, 0755);
+    WriteTestFile("packed/tile.png", not_a_png, sizeof(not_a_png), 5000);
+    VfsInvalidate(&vfs);
+    TEST_CHECK(!AssetDerivedFileIsCurrent(&vfs, "packed/tile.qoi", "packed/tile.png"));
+
+    RemoveTestFile("packed/tile.png");
+    rmdir(packed_directory);
+    VfsDestroy(&vfs);
+}
+
+void TestUpload(void* user_data, AssetLoadJob* job) {
+    TestUploadSink* sink = (TestUploadSink*)user_data;
+    i32 target = (i32)(uintptr_t)job->target;
+    TEST_CHECK(std::this_thread::get_id() == sink->thread_id);
+    sink->upload_counts[target]++;
+    sink->failed_count += job->is_ok ? 0 : 1;
+
+    u64 hash = HASH_FNV1A_SEED;
+    if (job->is_ok && job->kind == ASSET_KIND_IMAGE) {
+        hash = HashFnv1a(job->image.pixels, job->image.byte_size, hash);
+    }
+    else if (job->is_ok && job->kind == ASSET_KIND_BLOCK_TEXTURE) {
+        hash = HashFnv1a(job->block_texture.data, job->block_texture.data_size, hash);
+    }
+    else if (job->is_ok && job->kind == ASSET_KIND_SOUND) {
+        hash = HashFnv1a(job->sound.data, job->sound.data_size, hash);
+    }
+    else {
+        hash = HashFnv1aString(job->error, hash);
+    }
+    sink->content_hashes[target] = hash;
+}
+
+/**
+ * @brief Mono 16 bit PCM WAV with a 44 byte header.
+ */
+void WriteTestWav(const char* name, u32 sample_count) {
+    u32 data_size = sample_count * 2;
+    byte* wav = (byte*)malloc(44 + data_size);
+    u32 riff_size = 36 + data_size;
+    u32 format_size = 16;
+    u16 format[] = { 1, 1 };
+    u32 rates[] = { 44100, 88200 };
+    u16 alignment[] = { 2, 16 };
+    memcpy(wav, "RIFF", 4);
+    memcpy(wav + 4, &riff_size, 4);
+    memcpy(wav + 8, "WAVEfmt ", 8);
+    memcpy(wav + 16, &format_size, 4);
+    memcpy(wav + 20, format, 4);
+    memcpy(wav + 24, rates, 8);
+    memcpy(wav + 32, alignment, 4);
+    memcpy(wav + 36, "data", 4);
+    memcpy(wav + 40, &data_size, 4);
+    for (u32 i = 0; i < sample_count; i++) {
+        u16 sample = (u16)(i * 37);
+        memcpy(wav + 44 + i * 2, &sample, 2);
+    }
+    WriteTestFile(name, wav, 44 + data_size, 1000);
+    free(wav);
+}
+
+/**
+ * @brief Uncompressed 32 bit TGA of 'width' x 'height' with a gradient, which stb_image reads.
+ */
+void WriteTestTga(const char* name, i32 width, i32 height) {
+    size_t size = 18 + (size_t)width * height * 4;
+    byte* tga = (byte*)calloc(size, 1);
+    tga[2] = 2;
+    tga[12] = (byte)width;
+    tga[13] = (byte)(width >> 8);
+    tga[14] = (byte)height;
+    tga[15] = (byte)(height >> 8);
+    tga[16] = 32;
+    tga[17] = 8;
+    for (i32 i = 0; i < width * height; i++) {
+        byte* pixel = tga + 18 + i * 4;
+        pixel[0] = (byte)i;
+        pixel[1] = (byte)(i / width);
+        pixel[2] = (byte)(i * 7);
+        pixel[3] = 255;
+    }
+    WriteTestFile(name, tga, size, 1000);
+    free(tga);
+}
+
+void TestWorkerPool() {
+    WriteTestTga("a.tga", 64, 48);
+    WriteTestTga("b.tga", 33, 17);
+    WriteTestTga("c.tga", 256, 256);
+    WriteTestWav("a.wav", 20000);
+    WriteTestWav("b.wav", 100);
+
+    byte block_texture[sizeof(BlockTextureHeader) + 16 * 4];
+    BlockTextureHeader header = { BLOCK_TEXTURE_MAGIC, BLOCK_TEXTURE_VERSION, BLOCK_TEXTURE_FORMAT_BC7, 8, 8, 1, 16 * 4, 0 };
+    memcpy(block_texture, &header, sizeof(header));
+    memset(block_texture + sizeof(header), 0x5a, 16 * 4);
+    WriteTestFile("a.fbct", block_texture, sizeof(block_texture), 1000);
+
+    Vfs vfs;
+    TEST_CHECK(VfsCreate(&vfs, 64));
+    TEST_CHECK(VfsMountDirectory(&vfs, "", test_directory, 0));
+
+    const AssetKind kinds[] = {
+        ASSET_KIND_IMAGE, ASSET_KIND_IMAGE, ASSET_KIND_IMAGE, ASSET_KIND_SOUND, ASSET_KIND_SOUND,
+        ASSET_KIND_BLOCK_TEXTURE, ASSET_KIND_IMAGE, ASSET_KIND_BLOCK_TEXTURE
+    };
+    const char* paths[] = { "a.tga", "b.tga", "c.tga", "a.wav", "b.wav", "a.fbct", "missing.png", "a.tga" };
+    const i32 job_count = 8;
+
+    u64 first_hashes[16] = {};
+    for (i32 worker_count = 1; worker_count <= 8; worker_count *= 2) {
+        AssetLoader loader;
+        TEST_CHECK(AssetLoaderCreate(&loader, job_count, &vfs));
+        for (i32 i = 0; i < job_count; i++) {
+            TEST_CHECK(AssetLoaderAdd(&loader, kinds[i], paths[i], (void*)(uintptr_t)i) != nullptr);
+        }
+        TEST_CHECK(AssetLoaderAdd(&loader, ASSET_KIND_SOUND, "a.wav", nullptr) == nullptr);
+
+        TestUploadSink sink = {};
+        sink.thread_id = std::this_thread::get_id();
+        AssetUploadSink upload_sink = { &sink, TestUpload };
+        AssetLoaderStart(&loader, worker_count);
+        AssetLoaderStats stats = AssetLoaderFinish(&loader, &upload_sink);
+        AssetLoaderDestroy(&loader);
+
+        TEST_CHECK(stats.job_count == job_count && stats.worker_count == worker_count);
+        i32 upload_mismatch_count = 0;
+        for (i32 i = 0; i < job_count; i++) {
+            upload_mismatch_count += sink.upload_counts[i] == 1 ? 0 : 1;
+        }
+        TEST_CHECK(upload_mismatch_count == 0);
+
+        // The missing image and the TGA read as a block texture fail, the rest decode the same on any worker count
+        TEST_CHECK(sink.failed_count == 2);
+        if (worker_count == 1) {
+            memcpy(first_hashes, sink.content_hashes, sizeof(first_hashes));
+        }
+        TEST_CHECK(memcmp(first_hashes, sink.content_hashes, sizeof(first_hashes)) == 0);
+    }
+
+    VfsDestroy(&vfs);
+    const char* names[] = { "a.tga", "b.tga", "c.tga", "a.wav", "b.wav", "a.fbct" };
+    for (const char* name : names) {
+        RemoveTestFile(name);
+    }
+}
+
+void TestErrors() {
+    // A path of the full length stays whole in the error
+    char long_path[ASSET_PATH_MAX];
+    memset(long_path, 'x', ASSET_PATH_MAX - 1);
+    long_path[ASSET_PATH_MAX - 1] = 0;
+    memcpy(long_path, "/tmp/", 5);
+
+    size_t file_size = 0;
+    TEST_CHECK(AssetReadFile(nullptr, long_path, &file_size) == nullptr);
+
+    AssetLoader loader;
+    TEST_CHECK(AssetLoaderCreate(&loader, 1, nullptr));
+    AssetLoadJob* job = AssetLoaderAdd(&loader, ASSET_KIND_FONT, long_path, nullptr);
+    if (TEST_CHECK(job != nullptr)) {
+        AssetRunJob(nullptr, job);
+        TEST_CHECK(!job->is_ok);
+        TEST_CHECK(strstr(job->error, long_path) != nullptr);
+    }
+    AssetLoaderDestroy(&loader);
+
+    byte wav_header[44] = {};
+    memcpy(wav_header, "RIFF", 4);
+    memcpy(wav_header + 8, "WAVE", 4);
+    u32 too_large = 100;
+    memcpy(wav_header + 40, &too_large, 4);
+    AssetSound sound;
+    TEST_CHECK(!AssetParseWav(wav_header, sizeof(wav_header), &sound));
+    TEST_CHECK(!AssetParseWav(wav_header, 43, &sound));
+}
+
+int main() {
+    if (!mkdtemp(test_directory)) {
+        printf("Failed to create a temporary directory\n");
+        return 1;
+    }
+
+    TestDerivedFiles();
+    TestWorkerPool();
+    TestErrors();
+
+    RemoveTestFile("sprite.png");
+    RemoveTestFile("sprite.qoi");
+    RemoveTestFile("page.fbct");
+    rmdir(test_directory);
+    return TestReport("asset_loader_test");
+}
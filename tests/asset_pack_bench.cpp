@@ -0,0 +1,96 @@
+// Benchmark of asset pack lookups: hashed slot table probes against a linear scan over the entry names,
+// for packs of increasing size. Every lookup is a hit, with mixed case and separators.
+
+// ----------
+// Includes
+
+#include <string>
+#include <vector>
+
+#include "test.h"
+#include "../src/asset_pack.h"
+
+// --------------------------
+// Function implementations
+
+/**
+ * @brief Pack table only, entries point at offset 0 with size 0, which is all the lookup needs.
+ */
+std::vector<byte> CreateBenchPack(const std::vector<std::string>& names) {
+    u32 entry_count = (u32)names.size();
+    u32 slot_count = 16;
+    while (slot_count < entry_count * 2) {
+        slot_count *= 2;
+    }
+    u32 string_bytes = 0;
+    for (const std::string& name : names) {
+        string_bytes += (u32)name.size() + 1;
+    }
+
+    size_t table_size = AssetPackTableSize(entry_count, slot_count, string_bytes);
+    std::vector<byte> pack(table_size, 0);
+    AssetPackHeader* header = (AssetPackHeader*)pack.data();
+    *header = { ASSET_PACK_MAGIC, ASSET_PACK_VERSION, entry_count, slot_count, string_bytes, 1, table_size };
+    AssetPackEntry* entries = (AssetPackEntry*)(header + 1);
+    u32* slots = (u32*)(entries + entry_count);
+    char* strings = (char*)(slots + slot_count);
+    memset(slots, 0xff, sizeof(u32) * slot_count);
+
+    u32 string_offset = 0;
+    for (u32 i = 0; i < entry_count; i++) {
+        entries[i] = { AssetPackHashPath(names[i].c_str()), table_size, 0, string_offset, 0 };
+        memcpy(strings + string_offset, names[i].c_str(), names[i].size() + 1);
+        string_offset += (u32)names[i].size() + 1;
+
+        u32 slot = (u32)entries[i].path_hash & (slot_count - 1);
+        while (slots[slot] != ASSET_PACK_SLOT_EMPTY) {
+            slot = (slot + 1) & (slot_count - 1);
+        }
+        slots[slot] = i;
+    }
+    return pack;
+}
+
+int main() {
+    printf("%8s %16s %16s\n", "entries", "hashed ns/find", "linear ns/find");
+    for (i32 entry_count = 16; entry_count <= 16384; entry_count *= 4) {
+        std::vector<std::string> names;
+        std::vector<std::string> queries;
+        for (i32 i = 0; i < entry_count; i++) {
+            names.push_back("images/tiles/tile_" + std::to_string(i) + ".png");
+            queries.push_back("Images\\Tiles\\Tile_" + std::to_string((i * 7919) % entry_count) + ".PNG");
+        }
+
+        std::vector<byte> data = CreateBenchPack(names);
+        AssetPack pack;
+        if (!AssetPackOpenMemory(&pack, data.data(), data.size())) {
+            return 1;
+        }
+
+        const i32 lookup_count = 1 << 20;
+        i32 found_count = 0;
+        f64 start_ms = TestNowMs();
+        for (i32 i = 0; i < lookup_count; i++) {
+            found_count += AssetPackFind(&pack, queries[i % entry_count].c_str()) ? 1 : 0;
+        }
+        f64 hashed_ns = (TestNowMs() - start_ms) * 1e6 / lookup_count;
+
+        // The scan gets fewer lookups, it is too slow for the full count on large packs
+        i32 scan_count = lookup_count / entry_count < 256 ? 256 : lookup_count / entry_count;
+        start_ms = TestNowMs();
+        for (i32 i = 0; i < scan_count; i++) {
+            const char* query = queries[i % entry_count].c_str();
+            for (u32 e = 0; e < pack.header->entry_count; e++) {
+                if (AssetPackPathEquals(AssetPackEntryName(&pack, &pack.entries[e]), query)) {
+                    found_count++;
+                    break;
+                }
+            }
+        }
+        f64 linear_ns = (TestNowMs() - start_ms) * 1e6 / scan_count;
+
+        printf("%8d %16.1f %16.1f%s\n", entry_count, hashed_ns, linear_ns, found_count == lookup_count + scan_count ? "" : "  (missing entries)");
+        AssetPackClose(&pack);
+    }
+    return 0;
+}
@@ -0,0 +1,199 @@
+// Tests of asset packs and the shared FNV-1a hash: lookups are case and separator insensitive and aligned,
+// misses end on tables that are nearly full, tables without an empty slot are rejected, and damaged packs
+// are either rejected or only ever return views inside the pack.
+
+// ----------
+// Includes
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "test.h"
+#include "../src/asset_pack.h"
+#include "../src/texture_atlas.h"
+
+// --------------------------
+// Function implementations
+
+u64 AlignUp(u64 value, u64 alignment) {
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+/**
+ * @brief Pack of 'names', each file holding its own name, laid out the way tools/asset_packer.cpp writes it.
+ */
+std::vector<byte> CreateTestPack(const std::vector<std::string>& names, u32 slot_count, u32 alignment) {
+    u32 entry_count = (u32)names.size();
+    u32 string_bytes = 0;
+    for (const std::string& name : names) {
+        string_bytes += (u32)name.size() + 1;
+    }
+
+    u64 data_offset = AlignUp(AssetPackTableSize(entry_count, slot_count, string_bytes), alignment);
+    u64 size = data_offset;
+    for (const std::string& name : names) {
+        size = AlignUp(size + name.size(), alignment);
+    }
+
+    // One extra alignment of room so the pack can start on an aligned address
+    std::vector<byte> pack((size_t)size + alignment, 0);
+    byte* data = pack.data() + (alignment - (uintptr_t)pack.data() % alignment) % alignment;
+    AssetPackHeader* header = (AssetPackHeader*)data;
+    *header = { ASSET_PACK_MAGIC, ASSET_PACK_VERSION, entry_count, slot_count, string_bytes, alignment, data_offset };
+
+    AssetPackEntry* entries = (AssetPackEntry*)(header + 1);
+    u32* slots = (u32*)(entries + entry_count);
+    char* strings = (char*)(slots + slot_count);
+    for (u32 i = 0; i < slot_count; i++) {
+        slots[i] = ASSET_PACK_SLOT_EMPTY;
+    }
+
+    u32 string_offset = 0;
+    u64 offset = data_offset;
+    for (u32 i = 0; i < entry_count; i++) {
+        const std::string& name = names[i];
+        entries[i] = { AssetPackHashPath(name.c_str()), offset, name.size(), string_offset, 0 };
+        memcpy(strings + string_offset, name.c_str(), name.size() + 1);
+        memcpy(data + offset, name.data(), name.size());
+        string_offset += (u32)name.size() + 1;
+        offset = AlignUp(offset + name.size(), alignment);
+
+        u32 slot = (u32)entries[i].path_hash & (slot_count - 1);
+        while (slots[slot] != ASSET_PACK_SLOT_EMPTY) {
+            slot = (slot + 1) & (slot_count - 1);
+        }
+        slots[slot] = i;
+    }
+
+    // Only the aligned part is the pack
+    std::vector<byte> result(data, data + size);
+    return result;
+}
+
+void TestHash() {
+    TEST_CHECK(HashFnv1a("", 0) == HASH_FNV1A_SEED);
+    TEST_CHECK(HashFnv1aString("a") == 0xaf63dc4c8601ec8cULL);
+    TEST_CHECK(HashFnv1aString("foobar") == 0x85944171f73967e8ULL);
+    TEST_CHECK(HashFnv1a("foobar", 6) == HashFnv1aString("foobar"));
+    TEST_CHECK(HashFnv1a("bar", 3, HashFnv1a("foo", 3)) == HashFnv1aString("foobar"));
+
+    // Stored hashes in packs and atlases are plain FNV-1a, of the normalized path for packs
+    TEST_CHECK(TextureAtlasHashName("Hero_Idle") == HashFnv1aString("Hero_Idle"));
+    TEST_CHECK(AssetPackHashPath("Images\\Tiles.PNG") == HashFnv1aString("images/tiles.png"));
+}
+
+void TestLookups() {
+    std::vector<std::string> names;
+    for (i32 i = 0; i < 200; i++) {
+        names.push_back("images/sprite_" + std::to_string(i) + ".png");
+    }
+    names.push_back("data/readme.txt");
+
+    // 201 entries in 256 slots leave long probe chains
+    std::vector<byte> file = CreateTestPack(names, 256, 64);
+    std::vector<byte> aligned_storage(file.size() + 64);
+    byte* data = aligned_storage.data() + (64 - (uintptr_t)aligned_storage.data() % 64) % 64;
+    memcpy(data, file.data(), file.size());
+
+    AssetPack pack;
+    if (!TEST_CHECK(AssetPackOpenMemory(&pack, data, file.size()))) {
+        return;
+    }
+
+    i32 mismatch_count = 0;
+    for (const std::string& name : names) {
+        size_t size = 0;
+        const byte* view = AssetPackView(&pack, name.c_str(), &size);
+        mismatch_count += view && size == name.size() && memcmp(view, name.data(), size) == 0 && (uintptr_t)view % 64 == 0 ? 0 : 1;
+    }
+    TEST_CHECK(mismatch_count == 0);
+
+    size_t size = 0;
+    TEST_CHECK(AssetPackView(&pack, "IMAGES\\Sprite_7.PNG", &size) == AssetPackView(&pack, "images/sprite_7.png", &size));
+    TEST_CHECK(AssetPackFind(&pack, "images/sprite_7.png") != nullptr);
+
+    i32 false_hit_count = 0;
+    for (i32 i = 0; i < 1000; i++) {
+        std::string missing = "images/missing_" + std::to_string(i) + ".png";
+        false_hit_count += AssetPackFind(&pack, missing.c_str()) ? 1 : 0;
+    }
+    TEST_CHECK(false_hit_count == 0);
+    AssetPackClose(&pack);
+}
+
+void TestInvalidPacks() {
+    std::vector<std::string> names = { "a.txt", "b.txt", "c.txt" };
+    std::vector<byte> file = CreateTestPack(names, 4, 8);
+    AssetPackHeader* header = (AssetPackHeader*)file.data();
+    u32* slots = (u32*)((AssetPackEntry*)(header + 1) + header->entry_count);
+    AssetPack pack;
+    TEST_CHECK(AssetPackOpenMemory(&pack, file.data(), file.size()));
+
+    // Every slot taken, a miss would probe forever
+    for (u32 i = 0; i < header->slot_count; i++) {
+        if (slots[i] == ASSET_PACK_SLOT_EMPTY) {
+            slots[i] = 0;
+        }
+    }
+    TEST_CHECK(!AssetPackOpenMemory(&pack, file.data(), file.size()));
+    TEST_CHECK(pack.header == nullptr && AssetPackFind(&pack, "a.txt") == nullptr);
+
+    file = CreateTestPack(names, 4, 8);
+    header = (AssetPackHeader*)file.data();
+    const u32 valid[] = { header->slot_count, header->alignment, header->entry_count };
+    for (i32 i = 0; i < 4; i++) {
+        std::vector<byte> corrupt = file;
+        AssetPackHeader* corrupt_header = (AssetPackHeader*)corrupt.data();
+        switch (i) {
+            case 0: corrupt_header->slot_count = valid[0] + 1; break;
+            case 1: corrupt_header->alignment = 12; break;
+            case 2: corrupt_header->entry_count = valid[0]; break;
+            case 3: corrupt_header->data_offset = corrupt.size() + 1; break;
+        }
+        TEST_CHECK(!AssetPackOpenMemory(&pack, corrupt.data(), corrupt.size()));
+    }
+    for (size_t cut = 0; cut < file.size(); cut++) {
+        if (AssetPackOpenMemory(&pack, file.data(), cut)) {
+            // A pack cut inside its data is only valid when no entry reaches past the cut
+            for (u32 i = 0; i < pack.header->entry_count; i++) {
+                TEST_CHECK(pack.entries[i].offset + pack.entries[i].size <= cut);
+            }
+        }
+    }
+
+    // Damaged table bytes: rejected, or every view stays inside the pack
+    std::vector<std::string> many_names;
+    for (i32 i = 0; i < 40; i++) {
+        many_names.push_back("data/blob_" + std::to_string(i) + ".bin");
+    }
+    file = CreateTestPack(many_names, 64, 16);
+    size_t table_size = (size_t)((AssetPackHeader*)file.data())->data_offset;
+    u32 random = 3;
+    i32 outside_count = 0;
+    for (i32 trial = 0; trial < 2000; trial++) {
+        std::vector<byte> damaged = file;
+        for (i32 i = 0; i < 3; i++) {
+            random = random * 1664525u + 1013904223u;
+            damaged[(random >> 8) % table_size] ^= (byte)(1 + (random >> 24) % 255);
+        }
+        if (!AssetPackOpenMemory(&pack, damaged.data(), damaged.size())) {
+            continue;
+        }
+        for (u32 i = 0; i < pack.header->entry_count; i++) {
+            size_t size = 0;
+            const byte* view = AssetPackView(&pack, AssetPackEntryName(&pack, &pack.entries[i]), &size);
+            bool is_inside = !view || (damaged.data() <= view && view + size <= damaged.data() + damaged.size());
+            outside_count += is_inside ? 0 : 1;
+        }
+        AssetPackFind(&pack, "data/not_there.bin");
+    }
+    TEST_CHECK(outside_count == 0);
+}
+
+int main() {
+    TestHash();
+    TestLookups();
+    TestInvalidPacks();
+    return TestReport("asset_pack_test");
+}
@@ -0,0 +1,82 @@
+// Benchmark of asset registry lookups: resolving generational ids against reading a plain pointer array, and
+// against finding the same assets by path, for a small and a large set of live assets in random order.
+
+// ----------
+// Includes
+
+#include <stdlib.h>
+
+#include "test.h"
+
+#define STB_IMAGE_IMPLEMENTATION
+#define STB_TRUETYPE_IMPLEMENTATION
+#include "../src/asset_registry.h"
+
+// ---------
+// Globals
+
+const i32 BENCH_ASSET_COUNT = 4096;
+
+i32 bench_resources[BENCH_ASSET_COUNT];
+void* bench_pointers[BENCH_ASSET_COUNT];
+char bench_paths[BENCH_ASSET_COUNT][64];
+
+// --------------------------
+// Function implementations
+
+int main() {
+    AssetRegistry registry = {};
+    if (!AssetRegistryCreate(&registry, BENCH_ASSET_COUNT)) {
+        return 1;
+    }
+
+    AssetId ids[BENCH_ASSET_COUNT];
+    bool is_new = false;
+    for (i32 i = 0; i < BENCH_ASSET_COUNT; i++) {
+        snprintf(bench_paths[i], sizeof(bench_paths[i]), "textures/texture_%d.png", i);
+        ids[i] = AssetRegistryAcquire(&registry, ASSET_KIND_IMAGE, bench_paths[i], &is_new);
+        AssetRegistrySetResource(&registry, ids[i], &bench_resources[i]);
+        bench_pointers[i] = &bench_resources[i];
+    }
+
+    const i32 lookup_count = 1 << 22;
+    u32* order = (u32*)malloc(sizeof(u32) * lookup_count);
+    srand(7);
+
+    printf("%8s %16s %16s %16s\n", "live", "resolve ns/id", "pointer ns/id", "find ns/path");
+    for (i32 live_count = 256; live_count <= BENCH_ASSET_COUNT; live_count *= 16) {
+        for (i32 i = 0; i < lookup_count; i++) {
+            order[i] = (u32)(rand() % live_count);
+        }
+
+        uintptr_t checksum = 0;
+        f64 start_ms = TestNowMs();
+        for (i32 i = 0; i < lookup_count; i++) {
+            checksum += (uintptr_t)AssetRegistryResolve(&registry, ids[order[i]]);
+        }
+        f64 resolve_ns = (TestNowMs() - start_ms) * 1e6 / lookup_count;
+
+        uintptr_t pointer_checksum = 0;
+        start_ms = TestNowMs();
+        for (i32 i = 0; i < lookup_count; i++) {
+            pointer_checksum += (uintptr_t)bench_pointers[order[i]];
+        }
+        f64 pointer_ns = (TestNowMs() - start_ms) * 1e6 / lookup_count;
+
+        // Path lookups hash and compare the whole path, fewer of them keep the run short
+        const i32 find_count = lookup_count / 8;
+        i32 found_count = 0;
+        start_ms = TestNowMs();
+        for (i32 i = 0; i < find_count; i++) {
+            found_count += AssetRegistryFind(&registry, ASSET_KIND_IMAGE, bench_paths[order[i]]).generation != 0 ? 1 : 0;
+        }
+        f64 find_ns = (TestNowMs() - start_ms) * 1e6 / find_count;
+
+        bool is_same = checksum == pointer_checksum && found_count == find_count;
+        printf("%8d %16.2f %16.2f %16.1f%s\n", live_count, resolve_ns, pointer_ns, find_ns, is_same ? "" : "  (mismatch)");
+    }
+
+    free(order);
+    AssetRegistryDestroy(&registry);
+    return 0;
+}
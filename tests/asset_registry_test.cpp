@@ -0,0 +1,144 @@
+// Tests of the asset registry: paths are deduplicated like the VFS matches them, the last release hands the
+// resource back and moves the generation on, over-long paths are refused, and random acquire and release
+// churn on a small table agrees with a reference count model.
+
+// ----------
+// Includes
+
+#include <stdlib.h>
+
+#include "test.h"
+
+#define STB_IMAGE_IMPLEMENTATION
+#define STB_TRUETYPE_IMPLEMENTATION
+#include "../src/asset_registry.h"
+
+// ---------
+// Structs
+
+struct TestModelEntry {
+    i32 ref_count;
+    AssetId id;
+};
+
+// --------------------------
+// Function implementations
+
+void TestReferences() {
+    AssetRegistry registry = {};
+    TEST_CHECK(AssetRegistryCreate(&registry, 16));
+    i32 resources[16];
+
+    bool is_new = false;
+    AssetId a = AssetRegistryAcquire(&registry, ASSET_KIND_IMAGE, "images/tiles_01.png", &is_new);
+    TEST_CHECK(is_new && a.generation != 0);
+    AssetRegistrySetResource(&registry, a, &resources[a.index]);
+
+    AssetId b = AssetRegistryAcquire(&registry, ASSET_KIND_IMAGE, "Images\\Tiles_01.PNG", &is_new);
+    TEST_CHECK(!is_new && b.index == a.index && b.generation == a.generation);
+    AssetId sound = AssetRegistryAcquire(&registry, ASSET_KIND_SOUND, "images/tiles_01.png", &is_new);
+    TEST_CHECK(is_new && sound.index != a.index);
+    TEST_CHECK(AssetRegistryResolve(&registry, b) == &resources[a.index]);
+    TEST_CHECK(strcmp(AssetRegistryPath(&registry, a), "images/tiles_01.png") == 0);
+
+    // The first release keeps the entry, the last one hands the resource back and the ids go stale
+    TEST_CHECK(AssetRegistryRelease(&registry, a) == nullptr);
+    TEST_CHECK(AssetRegistryResolve(&registry, a) == &resources[a.index]);
+    TEST_CHECK(AssetRegistryRelease(&registry, b) == &resources[a.index]);
+    TEST_CHECK(AssetRegistryResolve(&registry, a) == nullptr && !AssetRegistryIsValid(&registry, b));
+    TEST_CHECK(AssetRegistryRelease(&registry, b) == nullptr);
+    TEST_CHECK(AssetRegistryFind(&registry, ASSET_KIND_IMAGE, "images/tiles_01.png").generation == 0);
+
+    // The entry is reused with a new generation
+    AssetId again = AssetRegistryAcquire(&registry, ASSET_KIND_IMAGE, "images/tiles_01.png", &is_new);
+    TEST_CHECK(is_new && again.index == a.index && again.generation != a.generation);
+    TEST_CHECK(AssetRegistryResolve(&registry, a) == nullptr);
+
+    AssetRegistryRelease(&registry, sound);
+    AssetRegistryRelease(&registry, again);
+    TEST_CHECK(registry.stats.live_count == 0);
+    AssetRegistryDestroy(&registry);
+}
+
+void TestLongPaths() {
+    AssetRegistry registry = {};
+    TEST_CHECK(AssetRegistryCreate(&registry, 4));
+
+    char path[ASSET_PATH_MAX + 16];
+    memset(path, 'a', sizeof(path));
+    path[ASSET_PATH_MAX - 1] = '\0';
+
+    // The longest path that fits is stored whole and found again
+    bool is_new = false;
+    AssetId fits = AssetRegistryAcquire(&registry, ASSET_KIND_IMAGE, path, &is_new);
+    TEST_CHECK(is_new && fits.generation != 0);
+    TEST_CHECK(strcmp(AssetRegistryPath(&registry, fits), path) == 0);
+    TEST_CHECK(AssetRegistryFind(&registry, ASSET_KIND_IMAGE, path).index == fits.index);
+
+    // One more character is refused instead of being stored truncated under the hash of the full path
+    path[ASSET_PATH_MAX - 1] = 'a';
+    path[ASSET_PATH_MAX] = '\0';
+    AssetId too_long = AssetRegistryAcquire(&registry, ASSET_KIND_IMAGE, path, &is_new);
+    TEST_CHECK(!is_new && too_long.generation == 0);
+    path[sizeof(path) - 1] = '\0';
+    TEST_CHECK(AssetRegistryAcquire(&registry, ASSET_KIND_IMAGE, path, &is_new).generation == 0);
+    TEST_CHECK(registry.stats.live_count == 1 && registry.free_count == 3);
+
+    AssetRegistryDestroy(&registry);
+}
+
+void TestModel() {
+    const i32 path_count = 300;
+    AssetRegistry registry = {};
+    TEST_CHECK(AssetRegistryCreate(&registry, 256));
+    TestModelEntry model[path_count] = {};
+
+    srand(7);
+    char path[64];
+    bool is_new = false;
+    for (i32 step = 0; step < 200000; step++) {
+        i32 k = rand() % path_count;
+        snprintf(path, sizeof(path), "dir/file_%d.png", k);
+
+        bool is_acquire = (rand() % 2 == 0 && registry.stats.live_count < 256) || (0 < model[k].ref_count && rand() % 3 == 0);
+        if (is_acquire) {
+            AssetId id = AssetRegistryAcquire(&registry, ASSET_KIND_IMAGE, path, &is_new);
+            if (id.generation == 0) {
+                TEST_CHECK(registry.free_count == 0 && model[k].ref_count == 0);
+                continue;
+            }
+            TEST_CHECK(is_new == (model[k].ref_count == 0));
+            if (is_new) {
+                model[k].id = id;
+                AssetRegistrySetResource(&registry, id, &model[k]);
+            }
+            TEST_CHECK(id.index == model[k].id.index && id.generation == model[k].id.generation);
+            model[k].ref_count++;
+        }
+        else if (0 < model[k].ref_count) {
+            void* resource = AssetRegistryRelease(&registry, model[k].id);
+            model[k].ref_count--;
+            TEST_CHECK(resource == (model[k].ref_count == 0 ? &model[k] : nullptr));
+        }
+
+        // Every lookup still finds what is live after the backward shift deletes
+        if (step % 1000 == 0) {
+            for (i32 j = 0; j < path_count; j++) {
+                snprintf(path, sizeof(path), "DIR\\FILE_%d.png", j);
+                AssetId found = AssetRegistryFind(&registry, ASSET_KIND_IMAGE, path);
+                TEST_CHECK((found.generation != 0) == (0 < model[j].ref_count));
+                if (0 < model[j].ref_count) {
+                    TEST_CHECK(AssetRegistryResolve(&registry, model[j].id) == &model[j]);
+                }
+            }
+        }
+    }
+    AssetRegistryDestroy(&registry);
+}
+
+int main() {
+    TestReferences();
+    TestLongPaths();
+    TestModel();
+    return TestReport("asset_registry_test");
+}
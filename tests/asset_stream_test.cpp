@@ -0,0 +1,235 @@
+// Tests of the asset stream: files are read in request order and every request reaches the sink once, cancelled
+// requests never do, failed ones report why, slots are recycled with a new generation, and requesting or
+// polling never waits on a slow read.
+
+// ----------
+// Includes
+
+#include <stdlib.h>
+#include <atomic>
+#include <thread>
+
+#include "test.h"
+
+#define STB_IMAGE_IMPLEMENTATION
+#define STB_TRUETYPE_IMPLEMENTATION
+#include "../src/asset_stream.h"
+
+// ---------
+// Structs
+
+/**
+ * @brief Backend reading native files after 'delay_ms', recording the order of the reads.
+ */
+struct TestSlowBackend {
+    i32 delay_ms;
+    std::atomic<i32> read_count;
+    char read_paths[64][ASSET_PATH_MAX];
+};
+
+struct TestStreamSink {
+    i32 upload_count;
+    void* targets[64];
+};
+
+// ---------
+// Globals
+
+char test_directory[64] = "/tmp/asset_stream_test_XXXXXX";
+char test_paths[3][ASSET_PATH_MAX];
+
+// --------------------------
+// Function implementations
+
+bool TestSlowRead(void* user_data, AssetLoadJob* job) {
+    TestSlowBackend* backend = (TestSlowBackend*)user_data;
+    if (backend->delay_ms) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(backend->delay_ms));
+    }
+    i32 read_index = backend->read_count.load();
+    if (read_index < 64) {
+        snprintf(backend->read_paths[read_index], ASSET_PATH_MAX, "%s", job->path);
+    }
+    bool is_ok = AssetReadJob(nullptr, job);
+    backend->read_count.store(read_index + 1);
+    return is_ok;
+}
+
+void TestStreamUpload(void* user_data, AssetLoadJob* job) {
+    TestStreamSink* sink = (TestStreamSink*)user_data;
+    TEST_CHECK(job->is_ok);
+    if (sink->upload_count < 64) {
+        sink->targets[sink->upload_count] = job->target;
+    }
+    sink->upload_count++;
+}
+
+/**
+ * @brief Mono 16 bit PCM WAV of 'sample_count' samples.
+ */
+void WriteTestWav(const char* path, u32 sample_count) {
+    u32 data_size = sample_count * 2;
+    u32 riff_size = 36 + data_size;
+    u32 format_size = 16;
+    u16 format[] = { 1, 1 };
+    u32 rates[] = { 44100, 88200 };
+    u16 alignment[] = { 2, 16 };
+
+    FILE* file = fopen(path, "wb");
+    if (!TEST_CHECK(file != nullptr)) {
+        return;
+    }
+    fwrite("RIFF", 1, 4, file);
+    fwrite(&riff_size, 4, 1, file);
+    fwrite("WAVEfmt ", 1, 8, file);
+    fwrite(&format_size, 4, 1, file);
+    fwrite(format, 2, 2, file);
+    fwrite(rates, 4, 2, file);
+    fwrite(alignment, 2, 2, file);
+    fwrite("data", 1, 4, file);
+    fwrite(&data_size, 4, 1, file);
+    for (u32 i = 0; i < sample_count; i++) {
+        u16 sample = (u16)(i * 37);
+        fwrite(&sample, 2, 1, file);
+    }
+    fclose(file);
+}
+
+void TestOrder() {
+    TestSlowBackend backend = {};
+    AssetStream stream = {};
+    TEST_CHECK(AssetStreamCreate(&stream, 64, 3, { &backend, TestSlowRead }));
+
+    AssetHandle handles[40];
+    for (i32 i = 0; i < 40; i++) {
+        handles[i] = AssetStreamRequest(&stream, ASSET_KIND_SOUND, test_paths[i % 3], (void*)(uintptr_t)(i + 1));
+        TEST_CHECK(handles[i].generation != 0);
+        TEST_CHECK(AssetStreamGetState(&stream, handles[i]) == ASSET_STREAM_PENDING);
+    }
+
+    // A few uploads per poll, like a frame
+    TestStreamSink sink = {};
+    AssetUploadSink upload_sink = { &sink, TestStreamUpload };
+    while (0 < stream.stats.pending_count) {
+        AssetStreamPoll(&stream, &upload_sink, 4);
+        std::this_thread::sleep_for(std::chrono::microseconds(200));
+    }
+
+    TEST_CHECK(sink.upload_count == 40);
+    bool is_target_seen[41] = {};
+    for (i32 i = 0; i < 40; i++) {
+        TEST_CHECK(strcmp(backend.read_paths[i], test_paths[i % 3]) == 0);
+        uintptr_t target = (uintptr_t)sink.targets[i];
+        TEST_CHECK(0 < target && target <= 40 && !is_target_seen[target]);
+        is_target_seen[target] = true;
+
+        TEST_CHECK(AssetStreamGetState(&stream, handles[i]) == ASSET_STREAM_READY);
+        AssetStreamCancel(&stream, handles[i]);
+        TEST_CHECK(AssetStreamGetState(&stream, handles[i]) == ASSET_STREAM_NONE);
+    }
+    TEST_CHECK(stream.free_count == 64);
+    AssetStreamDestroy(&stream);
+}
+
+void TestCancelAndFailure() {
+    TestSlowBackend backend = {};
+    backend.delay_ms = 20;
+    AssetStream stream = {};
+    TEST_CHECK(AssetStreamCreate(&stream, 8, 2, { &backend, TestSlowRead }));
+
+    AssetHandle handles[8];
+    for (i32 i = 0; i < 8; i++) {
+        const char* path = i == 7 ? "/nonexistent/missing.wav" : test_paths[i % 3];
+        handles[i] = AssetStreamRequest(&stream, ASSET_KIND_SOUND, path, (void*)(uintptr_t)(i + 1));
+    }
+    TEST_CHECK(AssetStreamRequest(&stream, ASSET_KIND_SOUND, test_paths[0], nullptr).generation == 0);
+
+    // Request 0 is past its read when cancelled, request 5 is not read yet
+    while (backend.read_count.load() < 1) {
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+    }
+    AssetStreamCancel(&stream, handles[0]);
+    AssetStreamCancel(&stream, handles[5]);
+    TEST_CHECK(AssetStreamGetState(&stream, handles[0]) == ASSET_STREAM_NONE);
+    AssetStreamCancel(&stream, handles[0]);
+
+    TestStreamSink sink = {};
+    AssetUploadSink upload_sink = { &sink, TestStreamUpload };
+    while (0 < stream.stats.pending_count) {
+        AssetStreamPoll(&stream, &upload_sink, 0);
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    TEST_CHECK(sink.upload_count == 5);
+    for (i32 i = 0; i < sink.upload_count; i++) {
+        TEST_CHECK(sink.targets[i] != (void*)1 && sink.targets[i] != (void*)6);
+    }
+    TEST_CHECK(AssetStreamGetState(&stream, handles[7]) == ASSET_STREAM_FAILED);
+    TEST_CHECK(strstr(AssetStreamGetError(&stream, handles[7]), "missing.wav") != nullptr);
+    TEST_CHECK(backend.read_count.load() == 7);
+    TEST_CHECK(stream.stats.cancelled_count == 2);
+
+    // Released slots come back with a new generation, old handles stay invalid
+    for (i32 i = 0; i < 8; i++) {
+        AssetStreamCancel(&stream, handles[i]);
+    }
+    TEST_CHECK(stream.free_count == 8);
+    AssetHandle again = AssetStreamRequest(&stream, ASSET_KIND_SOUND, test_paths[0], nullptr);
+    TEST_CHECK(again.generation != 0 && again.generation != handles[again.index].generation);
+    TEST_CHECK(AssetStreamGetState(&stream, handles[again.index]) == ASSET_STREAM_NONE);
+
+    // Destroying with a request in flight drops it
+    AssetStreamDestroy(&stream);
+}
+
+void TestFrameThreadNeverWaits() {
+    TestSlowBackend backend = {};
+    backend.delay_ms = 30;
+    AssetStream stream = {};
+    TEST_CHECK(AssetStreamCreate(&stream, 64, 2, { &backend, TestSlowRead }));
+
+    TestStreamSink sink = {};
+    AssetUploadSink upload_sink = { &sink, TestStreamUpload };
+    f64 max_request_ms = 0.0;
+    f64 max_poll_ms = 0.0;
+    for (i32 frame = 0; frame < 200; frame++) {
+        if (frame % 10 == 0) {
+            f64 request_start = TestNowMs();
+            AssetStreamRequest(&stream, ASSET_KIND_SOUND, test_paths[frame % 3], (void*)1);
+            f64 request_ms = TestNowMs() - request_start;
+            max_request_ms = max_request_ms < request_ms ? request_ms : max_request_ms;
+        }
+        f64 poll_start = TestNowMs();
+        AssetStreamPoll(&stream, &upload_sink, 4);
+        f64 poll_ms = TestNowMs() - poll_start;
+        max_poll_ms = max_poll_ms < poll_ms ? poll_ms : max_poll_ms;
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+
+    // A read takes 30 ms, a request or a poll that waited on one would show it
+    TEST_CHECK(max_request_ms < 10.0);
+    TEST_CHECK(max_poll_ms < 10.0);
+    TEST_CHECK(0 < sink.upload_count);
+    AssetStreamDestroy(&stream);
+}
+
+int main() {
+    if (!mkdtemp(test_directory)) {
+        fprintf(stderr, "could not create %s\n", test_directory);
+        return 1;
+    }
+    for (i32 i = 0; i < 3; i++) {
+        snprintf(test_paths[i], ASSET_PATH_MAX, "%s/sound_%d.wav", test_directory, i);
+        WriteTestWav(test_paths[i], 256 + 64 * i);
+    }
+
+    TestOrder();
+    TestCancelAndFailure();
+    TestFrameThreadNeverWaits();
+
+    for (i32 i = 0; i < 3; i++) {
+        remove(test_paths[i]);
+    }
+    rmdir(test_directory);
+    return TestReport("asset_stream_test");
+}
@@ -0,0 +1,104 @@
+// Tests of the block compressed texture container loader: level offsets, sizes and row pitches for each format,
+// and rejection of truncated files and corrupt headers.
+
+// ----------
+// Includes
+
+#include "test.h"
+#include "../src/block_texture.h"
+
+// --------------------------
+// Function implementations
+
+/**
+ * @brief Container with 'level_count' levels whose bytes count up from zero, allocated with malloc.
+ */
+byte* CreateContainer(u32 format, u32 width, u32 height, u32 level_count, size_t* size) {
+    u32 data_bytes = 0;
+    for (u32 level = 0; level < level_count; level++) {
+        data_bytes += BlockTextureLevelSize(format, width >> level ? width >> level : 1, height >> level ? height >> level : 1);
+    }
+
+    *size = sizeof(BlockTextureHeader) + data_bytes;
+    byte* data = (byte*)malloc(*size);
+    BlockTextureHeader header = { BLOCK_TEXTURE_MAGIC, BLOCK_TEXTURE_VERSION, format, width, height, level_count, data_bytes, 0 };
+    memcpy(data, &header, sizeof(header));
+    for (u32 i = 0; i < data_bytes; i++) {
+        data[sizeof(header) + i] = (byte)i;
+    }
+    return data;
+}
+
+void TestLevels() {
+    const u32 formats[] = { BLOCK_TEXTURE_FORMAT_BC1, BLOCK_TEXTURE_FORMAT_BC3, BLOCK_TEXTURE_FORMAT_BC7 };
+    for (u32 format : formats) {
+        u32 block_bytes = BlockTextureBlockBytes(format);
+        size_t size = 0;
+        byte* data = CreateContainer(format, 12, 8, 4, &size);
+
+        BlockTexture texture;
+        if (!TEST_CHECK(BlockTextureLoadFromMemory(&texture, data, size))) {
+            free(data);
+            continue;
+        }
+
+        // 12x8, 6x4, 3x2 and 1x1 round up to 3x2, 2x1, 1x1 and 1x1 blocks
+        const u32 block_columns[] = { 3, 2, 1, 1 };
+        const u32 block_rows[] = { 2, 1, 1, 1 };
+        byte* expected_level = data + sizeof(BlockTextureHeader);
+        for (u32 level = 0; level < 4; level++) {
+            TEST_CHECK(texture.levels[level] == expected_level);
+            TEST_CHECK(texture.level_row_pitches[level] == block_columns[level] * block_bytes);
+            TEST_CHECK(texture.level_sizes[level] == block_columns[level] * block_rows[level] * block_bytes);
+            expected_level += texture.level_sizes[level];
+        }
+        TEST_CHECK(expected_level == data + size);
+        BlockTextureDestroy(&texture);
+        TEST_CHECK(texture.data == nullptr);
+    }
+
+    TEST_CHECK(BlockTextureBlockBytes(2) == 0);
+}
+
+void TestRejection() {
+    size_t size = 0;
+    byte* data = CreateContainer(BLOCK_TEXTURE_FORMAT_BC7, 64, 32, 7, &size);
+    BlockTextureHeader valid;
+    memcpy(&valid, data, sizeof(valid));
+    BlockTexture texture;
+
+    i32 accepted_truncation_count = 0;
+    for (size_t cut = 0; cut < size; cut++) {
+        accepted_truncation_count += BlockTextureLoadFromMemory(&texture, data, cut) ? 1 : 0;
+    }
+    TEST_CHECK(accepted_truncation_count == 0);
+    TEST_CHECK(texture.data == nullptr && texture.header == nullptr);
+
+    // One corruption at a time, each one on its own must fail the load
+    for (i32 corruption = 0; corruption < 9; corruption++) {
+        BlockTextureHeader* header = (BlockTextureHeader*)data;
+        *header = valid;
+        switch (corruption) {
+            case 0: header->magic++; break;
+            case 1: header->version = BLOCK_TEXTURE_VERSION + 1; break;
+            case 2: header->format = 2; break;
+            case 3: header->width = 62; break;
+            case 4: header->height = 0; break;
+            case 5: header->width = 16388; break;
+            case 6: header->level_count = 0; break;
+            case 7: header->level_count = 8; break;
+            case 8: header->data_bytes += 16; break;
+        }
+        TEST_CHECK(!BlockTextureLoadFromMemory(&texture, data, size));
+    }
+
+    memcpy(data, &valid, sizeof(valid));
+    TEST_CHECK(BlockTextureLoadFromMemory(&texture, data, size));
+    BlockTextureDestroy(&texture);
+}
+
+int main() {
+    TestLevels();
+    TestRejection();
+    return TestReport("block_texture_test");
+}
@@ -0,0 +1,57 @@
+// Benchmark of sorting 100k packed draw keys per frame with the radix sort, against std::sort.
+
+// ----------
+// Includes
+
+#include <algorithm>
+
+#include "test.h"
+#include "../src/draw_sort.h"
+
+// --------------------------
+// Function implementations
+
+int main() {
+    const i32 quad_count = 100000;
+    const i32 frame_count = 200;
+
+    QuadDrawQueue queue = {};
+    if (!QuadDrawQueueCreate(&queue, quad_count)) {
+        return 1;
+    }
+    u64* reference_keys = (u64*)malloc(sizeof(u64) * quad_count);
+
+    f64 radix_ms = 0.0;
+    f64 std_ms = 0.0;
+    srand(1);
+    for (i32 frame = 0; frame < frame_count; frame++) {
+        QuadDrawQueueClear(&queue);
+        for (i32 i = 0; i < quad_count; i++) {
+            QueuedQuad quad = {};
+            quad.texture_id = rand() % 8;
+            QuadDrawQueuePush(&queue, rand() % 4, (f32)(rand() % 20000 - 10000) / 7.0f, quad);
+        }
+        memcpy(reference_keys, queue.keys, sizeof(u64) * quad_count);
+
+        f64 start_ms = TestNowMs();
+        QuadDrawQueueSort(&queue);
+        radix_ms += TestNowMs() - start_ms;
+
+        start_ms = TestNowMs();
+        std::sort(reference_keys, reference_keys + quad_count);
+        std_ms += TestNowMs() - start_ms;
+
+        if (memcmp(reference_keys, queue.keys, sizeof(u64) * quad_count) != 0) {
+            printf("Sort mismatch\n");
+            return 1;
+        }
+    }
+
+    printf("%d keys per frame, %d frames\n", quad_count, frame_count);
+    printf("Radix sort: %.2f ns/quad, %.3f ms/frame\n", radix_ms * 1e6 / ((f64)quad_count * frame_count), radix_ms / frame_count);
+    printf("std::sort:  %.2f ns/quad, %.3f ms/frame\n", std_ms * 1e6 / ((f64)quad_count * frame_count), std_ms / frame_count);
+
+    free(reference_keys);
+    QuadDrawQueueDestroy(&queue);
+    return 0;
+}
@@ -0,0 +1,78 @@
+// Tests of the isometric draw sort: key packing order and the radix sort against std::stable_sort.
+
+// ----------
+// Includes
+
+#include <algorithm>
+#include <vector>
+
+#include "test.h"
+#include "../src/draw_sort.h"
+
+// --------------------------
+// Function implementations
+
+void TestKeyOrder() {
+    const f32 values[] = { -1e30f, -100.0f, -1.5f, -0.0f, 0.0f, 1e-20f, 0.5f, 2.0f, 1e30f };
+    for (i32 i = 1; i < (i32)(sizeof(values) / sizeof(values[0])); i++) {
+        TEST_CHECK(FloatToSortableU32(values[i - 1]) <= FloatToSortableU32(values[i]));
+    }
+
+    // Layer first, then further away (larger depth) first, then texture
+    TEST_CHECK(PackDrawSortKey(0, -50.0f, 9) < PackDrawSortKey(1, 50.0f, 0));
+    TEST_CHECK(PackDrawSortKey(0, 5.0f, 0) < PackDrawSortKey(0, 1.0f, 0));
+    TEST_CHECK(PackDrawSortKey(0, 1.0f, 0) < PackDrawSortKey(0, -1.0f, 0));
+    TEST_CHECK(PackDrawSortKey(2, 1.0f, 3) < PackDrawSortKey(2, 1.0f, 4));
+    TEST_CHECK(DrawSortKeyTextureId(PackDrawSortKey(3, 7.25f, 1234)) == 1234);
+}
+
+void TestRadixSort() {
+    const i32 count = 50000;
+    QuadDrawQueue queue = {};
+    TEST_CHECK(QuadDrawQueueCreate(&queue, count));
+
+    // Few distinct depths so that equal keys are common and stability is tested
+    srand(1);
+    for (i32 i = 0; i < count; i++) {
+        QueuedQuad quad = {};
+        quad.texture_id = rand() % 4;
+        TEST_CHECK(QuadDrawQueuePush(&queue, rand() % 3, (f32)(rand() % 200 - 100) * 0.25f, quad));
+    }
+    TEST_CHECK(!QuadDrawQueuePush(&queue, 0, 0.0f, QueuedQuad{}));
+
+    std::vector<std::pair<u64, u32>> expected;
+    for (i32 i = 0; i < count; i++) {
+        expected.push_back({ queue.keys[i], queue.indices[i] });
+    }
+    std::stable_sort(expected.begin(), expected.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+
+    QuadDrawQueueSort(&queue);
+    i32 mismatch_count = 0;
+    for (i32 i = 0; i < count; i++) {
+        mismatch_count += queue.keys[i] == expected[i].first && queue.indices[i] == expected[i].second ? 0 : 1;
+    }
+    TEST_CHECK(mismatch_count == 0);
+
+    // Keys that only differ in one byte take the pass skipping path
+    QuadDrawQueueClear(&queue);
+    for (i32 i = 0; i < 100; i++) {
+        QueuedQuad quad = {};
+        quad.texture_id = (u32)(99 - i);
+        QuadDrawQueuePush(&queue, 1, 2.0f, quad);
+    }
+    QuadDrawQueueSort(&queue);
+    for (i32 i = 0; i < 100; i++) {
+        TEST_CHECK(queue.quads[queue.indices[i]].texture_id == (u32)i);
+    }
+
+    QuadDrawQueueClear(&queue);
+    QuadDrawQueueSort(&queue);
+    TEST_CHECK(queue.count == 0);
+    QuadDrawQueueDestroy(&queue);
+}
+
+int main() {
+    TestKeyOrder();
+    TestRadixSort();
+    return TestReport("draw_sort_test");
+}
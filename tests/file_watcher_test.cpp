@@ -0,0 +1,180 @@
+// Tests of the file watcher on inotify: a burst of writes is reported once after it settles, created files and
+// saves that rename over the old file are structural, files in directories created later are seen, a page
+// .png and its .fbct are reported under their own paths, and nothing is reported while the tree is quiet.
+
+// ----------
+// Includes
+
+#include <stdlib.h>
+#include <sys/stat.h>
+
+#include "test.h"
+
+#define STB_IMAGE_IMPLEMENTATION
+#define STB_TRUETYPE_IMPLEMENTATION
+#include "../src/file_watcher.h"
+
+// ---------
+// Defines
+
+const f64 TEST_SETTLE_MS = 50.0;
+const f64 TEST_TIMEOUT_MS = 2000.0;
+
+// ---------
+// Globals
+
+char test_directory[64] = "/tmp/file_watcher_test_XXXXXX";
+
+// --------------------------
+// Function implementations
+
+void WriteTestFile(const char* name, const char* text) {
+    char path[ASSET_PATH_MAX];
+    snprintf(path, ASSET_PATH_MAX, "%s/%s", test_directory, name);
+    FILE* file = fopen(path, "wb");
+    if (!TEST_CHECK(file != nullptr)) {
+        return;
+    }
+    fputs(text, file);
+    fclose(file);
+}
+
+void CreateTestDirectory(const char* name) {
+    char path[ASSET_PATH_MAX];
+    snprintf(path, ASSET_PATH_MAX, "%s/%s", test_directory, name);
+    TEST_CHECK(mkdir(path, 0755) == 0);
+}
+
+/**
+ * @brief Poll until something is reported, then once more after the settle time to collect what came with it.
+ */
+i32 WaitForChanges(FileWatcher* watcher, FileWatcherChange* changes, i32 max_changes) {
+    f64 start_ms = TestNowMs();
+    while (TestNowMs() - start_ms < TEST_TIMEOUT_MS) {
+        i32 change_count = FileWatcherPoll(watcher, changes, max_changes);
+        if (0 < change_count) {
+            usleep((useconds_t)(TEST_SETTLE_MS * 2000.0));
+            return change_count + FileWatcherPoll(watcher, changes + change_count, max_changes - change_count);
+        }
+        usleep(1000);
+    }
+    return 0;
+}
+
+/**
+ * @brief Index of the change of 'path', -1 if there is none.
+ */
+i32 FindChange(FileWatcherChange* changes, i32 change_count, const char* path) {
+    for (i32 i = 0; i < change_count; i++) {
+        if (strcmp(changes[i].path, path) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+void TestWritesSettle(FileWatcher* watcher) {
+    FileWatcherChange changes[16];
+    for (i32 save = 0; save < 10; save++) {
+        for (i32 i = 0; i < 5; i++) {
+            WriteTestFile("images/a.png", "written");
+            usleep(2000);
+        }
+
+        i32 change_count = WaitForChanges(watcher, changes, 16);
+        TEST_CHECK(change_count == 1);
+        TEST_CHECK(strcmp(changes[0].path, "images/a.png") == 0 && !changes[0].is_structural);
+    }
+    TEST_CHECK(TEST_SETTLE_MS <= watcher->stats.max_latency_ms);
+}
+
+void TestStructuralChanges(FileWatcher* watcher) {
+    FileWatcherChange changes[16];
+
+    WriteTestFile("images/a.qoi", "converted");
+    i32 change_count = WaitForChanges(watcher, changes, 16);
+    TEST_CHECK(change_count == 1 && changes[0].is_structural && strcmp(changes[0].path, "images/a.qoi") == 0);
+
+    // Editors often save to a temporary file and rename it over the old one
+    char temporary_path[ASSET_PATH_MAX];
+    char path[ASSET_PATH_MAX];
+    WriteTestFile("images/a.png.tmp", "saved");
+    snprintf(temporary_path, ASSET_PATH_MAX, "%s/images/a.png.tmp", test_directory);
+    snprintf(path, ASSET_PATH_MAX, "%s/images/a.png", test_directory);
+    TEST_CHECK(rename(temporary_path, path) == 0);
+    change_count = WaitForChanges(watcher, changes, 16);
+    i32 index = FindChange(changes, change_count, "images/a.png");
+    TEST_CHECK(0 <= index && changes[index].is_structural);
+}
+
+void TestNewDirectories(FileWatcher* watcher) {
+    FileWatcherChange changes[16];
+    CreateTestDirectory("sounds");
+    WaitForChanges(watcher, changes, 16);
+
+    WriteTestFile("sounds/jump.wav", "sound");
+    i32 change_count = WaitForChanges(watcher, changes, 16);
+    TEST_CHECK(0 <= FindChange(changes, change_count, "sounds/jump.wav"));
+}
+
+void TestAtlasPageFiles(FileWatcher* watcher) {
+    FileWatcherChange changes[16];
+
+    // The game decides which of the two the page uses, the watcher reports each file under its own path
+    WriteTestFile("atlas/page_0.png", "page");
+    WriteTestFile("atlas/page_0.fbct", "compressed page");
+    i32 change_count = WaitForChanges(watcher, changes, 16);
+    TEST_CHECK(0 <= FindChange(changes, change_count, "atlas/page_0.png"));
+    TEST_CHECK(0 <= FindChange(changes, change_count, "atlas/page_0.fbct"));
+
+    WriteTestFile("atlas/page_0.png", "edited page");
+    change_count = WaitForChanges(watcher, changes, 16);
+    TEST_CHECK(change_count == 1 && strcmp(changes[0].path, "atlas/page_0.png") == 0);
+}
+
+void RemoveTestTree() {
+    const char* files[] = {
+        "images/a.png", "images/a.qoi", "sounds/jump.wav", "atlas/page_0.png", "atlas/page_0.fbct"
+    };
+    const char* directories[] = { "images", "sounds", "atlas" };
+    char path[ASSET_PATH_MAX];
+    for (const char* name : files) {
+        snprintf(path, ASSET_PATH_MAX, "%s/%s", test_directory, name);
+        remove(path);
+    }
+    for (const char* name : directories) {
+        snprintf(path, ASSET_PATH_MAX, "%s/%s", test_directory, name);
+        rmdir(path);
+    }
+    rmdir(test_directory);
+}
+
+int main() {
+    if (!mkdtemp(test_directory)) {
+        fprintf(stderr, "could not create %s\n", test_directory);
+        return 1;
+    }
+    CreateTestDirectory("images");
+    CreateTestDirectory("atlas");
+    WriteTestFile("images/a.png", "original");
+
+    FileWatcher watcher;
+    if (!TEST_CHECK(FileWatcherCreate(&watcher, test_directory, TEST_SETTLE_MS))) {
+        return TestReport("file_watcher_test");
+    }
+
+    TestWritesSettle(&watcher);
+    TestStructuralChanges(&watcher);
+    TestNewDirectories(&watcher);
+    TestAtlasPageFiles(&watcher);
+
+    // Nothing is reported while the tree is quiet
+    FileWatcherChange changes[16];
+    usleep(100000);
+    TEST_CHECK(FileWatcherPoll(&watcher, changes, 16) == 0);
+    TEST_CHECK(watcher.stats.dropped_count == 0);
+
+    FileWatcherDestroy(&watcher);
+    RemoveTestTree();
+    return TestReport("file_watcher_test");
+}
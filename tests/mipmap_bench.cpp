@@ -0,0 +1,74 @@
+// Benchmark of mip chain generation per kernel, whole chains of RGBA8 images and the 2x2 downsample alone.
+
+// ----------
+// Includes
+
+#include "test.h"
+#include "../src/mipmap.h"
+
+// ---------
+// Defines
+
+const MipmapKernel BENCH_KERNELS[] = { MIPMAP_KERNEL_SCALAR, MIPMAP_KERNEL_SSE2, MIPMAP_KERNEL_AVX2 };
+
+// --------------------------
+// Function implementations
+
+int main() {
+    printf("Resolved AVX2 kernel: %s\n", MipmapResolveKernel(MIPMAP_KERNEL_AVX2) == MIPMAP_KERNEL_AVX2 ? "AVX2" : "SSE2 fallback");
+
+    printf("%10s %14s %14s %14s\n", "size", "scalar MB/s", "SSE2 MB/s", "AVX2 MB/s");
+    for (i32 size = 256; size <= 2048; size *= 2) {
+        size_t image_bytes = (size_t)size * size * 4;
+        byte* rgba = (byte*)malloc(image_bytes);
+        for (size_t i = 0; i < image_bytes; i++) {
+            rgba[i] = (byte)(i * 2654435761u >> 24);
+        }
+
+        i32 repeat_count = size < 1024 ? 50 : 5;
+        f64 megabytes_per_second[3] = {};
+        for (i32 k = 0; k < 3; k++) {
+            MipChain chain;
+            MipChainBuild(&chain, rgba, size, size, BENCH_KERNELS[k]);
+            MipChainDestroy(&chain);
+
+            f64 start_ms = TestNowMs();
+            for (i32 i = 0; i < repeat_count; i++) {
+                MipChainBuild(&chain, rgba, size, size, BENCH_KERNELS[k]);
+                MipChainDestroy(&chain);
+            }
+            f64 elapsed_ms = (TestNowMs() - start_ms) / repeat_count;
+            megabytes_per_second[k] = (f64)image_bytes / 1e3 / elapsed_ms;
+        }
+        printf("%4dx%-5d %14.0f %14.0f %14.0f\n", size, size, megabytes_per_second[0], megabytes_per_second[1], megabytes_per_second[2]);
+        free(rgba);
+    }
+
+    // Downsample alone, from a float linear level 0 of 1024x1024
+    const i32 width = 1024;
+    const i32 height = 1024;
+    f32* src = (f32*)malloc(sizeof(f32) * 4 * width * height);
+    f32* dst = (f32*)malloc(sizeof(f32) * width * height);
+    for (size_t i = 0; i < (size_t)4 * width * height; i++) {
+        src[i] = (f32)(i % 97) / 97.0f;
+    }
+
+    typedef void Downsample(f32*, i32, i32, f32*, i32, i32);
+    Downsample* downsamples[3] = { MipDownsampleScalar, MipDownsampleSSE2, MipDownsampleAVX2 };
+    const char* names[3] = { "scalar", "SSE2", "AVX2" };
+    for (i32 k = 0; k < 3; k++) {
+        if (k == 2 && !MipmapCpuHasAVX2()) {
+            continue;
+        }
+        f64 start_ms = TestNowMs();
+        for (i32 i = 0; i < 50; i++) {
+            downsamples[k](src, width, height, dst, width / 2, height / 2);
+        }
+        f64 elapsed_ms = (TestNowMs() - start_ms) / 50;
+        printf("Downsample %-6s %8.0f MB/s of float source\n", names[k], sizeof(f32) * 4.0 * width * height / 1e3 / elapsed_ms);
+    }
+
+    free(src);
+    free(dst);
+    return 0;
+}
@@ -0,0 +1,99 @@
+// Tests of mip chain generation: level sizes for odd and thin images, identical bytes from the scalar, SSE2 and
+// AVX2 kernels, averaging in linear light and alpha weighted color.
+
+// ----------
+// Includes
+
+#include "test.h"
+#include "../src/mipmap.h"
+
+// ---------
+// Defines
+
+const MipmapKernel TEST_KERNELS[] = { MIPMAP_KERNEL_SCALAR, MIPMAP_KERNEL_SSE2, MIPMAP_KERNEL_AVX2 };
+
+// --------------------------
+// Function implementations
+
+/**
+ * @brief Random RGBA8 image where every seventh texel is fully transparent.
+ */
+byte* CreateNoiseImage(i32 width, i32 height) {
+    size_t pixel_count = (size_t)width * height;
+    byte* rgba = (byte*)malloc(pixel_count * 4);
+    u32 random = 12345;
+    for (size_t i = 0; i < pixel_count * 4; i++) {
+        random = random * 1664525u + 1013904223u;
+        rgba[i] = (byte)(random >> 24);
+    }
+    for (size_t i = 0; i < pixel_count; i += 7) {
+        rgba[i * 4 + 3] = 0;
+    }
+    return rgba;
+}
+
+void TestLevels() {
+    const i32 sizes[][2] = { {1, 1}, {1, 7}, {7, 1}, {3, 5}, {17, 33}, {256, 1}, {513, 257}, {1024, 1024} };
+    for (const i32* size : sizes) {
+        byte* rgba = CreateNoiseImage(size[0], size[1]);
+        MipChain chains[3];
+        for (i32 i = 0; i < 3; i++) {
+            TEST_CHECK(MipChainBuild(&chains[i], rgba, size[0], size[1], TEST_KERNELS[i]));
+        }
+
+        MipChain* chain = &chains[0];
+        i32 last = chain->level_count - 1;
+        TEST_CHECK(chain->level_count == MipLevelCount(size[0], size[1]));
+        TEST_CHECK(chain->widths[last] == 1 && chain->heights[last] == 1);
+        TEST_CHECK(memcmp(chain->pixels, rgba, (size_t)size[0] * size[1] * 4) == 0);
+        for (i32 level = 1; level < chain->level_count; level++) {
+            TEST_CHECK(chain->widths[level] == (1 < chain->widths[level - 1] ? chain->widths[level - 1] / 2 : 1));
+            TEST_CHECK(chain->heights[level] == (1 < chain->heights[level - 1] ? chain->heights[level - 1] / 2 : 1));
+        }
+        TEST_CHECK(chain->offsets[last] + 4 == chain->byte_size);
+
+        // Kernels not supported by the CPU fall back, the bytes are the same either way
+        for (i32 i = 1; i < 3; i++) {
+            TEST_CHECK(chains[i].byte_size == chain->byte_size);
+            TEST_CHECK(memcmp(chains[i].pixels, chain->pixels, chain->byte_size) == 0);
+        }
+
+        for (i32 i = 0; i < 3; i++) {
+            MipChainDestroy(&chains[i]);
+        }
+        free(rgba);
+    }
+}
+
+void TestFiltering() {
+    MipChain chain;
+
+    // Black and white average to half the light, which is sRGB 188 rather than 128
+    byte checker[16] = { 0, 0, 0, 255, 255, 255, 255, 255, 255, 255, 255, 255, 0, 0, 0, 255 };
+    TEST_CHECK(MipChainBuild(&chain, checker, 2, 2));
+    byte* level1 = chain.pixels + chain.offsets[1];
+    TEST_CHECK(level1[0] == 188 && level1[1] == 188 && level1[2] == 188 && level1[3] == 255);
+    MipChainDestroy(&chain);
+
+    // Color of fully transparent texels does not bleed into the average
+    byte cutout[16] = { 255, 0, 0, 255, 0, 255, 0, 0, 255, 0, 0, 255, 0, 255, 0, 0 };
+    TEST_CHECK(MipChainBuild(&chain, cutout, 2, 2));
+    level1 = chain.pixels + chain.offsets[1];
+    TEST_CHECK(level1[0] == 255 && level1[1] == 0 && level1[2] == 0 && level1[3] == 128);
+    MipChainDestroy(&chain);
+
+    // Every sRGB value survives decoding and encoding
+    MipmapInitTables();
+    i32 roundtrip_error_count = 0;
+    for (i32 i = 0; i < 256; i++) {
+        f32 linear = mipmap_tables.srgb_to_linear[i];
+        roundtrip_error_count += mipmap_tables.linear_to_srgb[(i32)(linear * (MIPMAP_SRGB_ENCODE_TABLE_SIZE - 1) + 0.5f)] == i ? 0 : 1;
+    }
+    TEST_CHECK(roundtrip_error_count == 0);
+}
+
+int main() {
+    TestLevels();
+    TestFiltering();
+    return TestReport("mipmap_test");
+}
@@ -0,0 +1,189 @@
+// Tests of the QOI decoder: random op streams decode to the same pixels as a straightforward reference decoder
+// written from the format description, and truncated or corrupted files fail cleanly instead of overrunning.
+
+// ----------
+// Includes
+
+#include <vector>
+
+#include "test.h"
+#include "../src/qoi_image.h"
+
+// ---------
+// Structs
+
+struct QoiStream {
+    std::vector<byte> bytes;
+    std::vector<u32> pixels;
+};
+
+// --------------------------
+// Function implementations
+
+u32 TestRandom(u32* state) {
+    *state = *state * 1664525u + 1013904223u;
+    return *state >> 8;
+}
+
+void PushU32BigEndian(std::vector<byte>* bytes, u32 value) {
+    bytes->push_back((byte)(value >> 24));
+    bytes->push_back((byte)(value >> 16));
+    bytes->push_back((byte)(value >> 8));
+    bytes->push_back((byte)value);
+}
+
+/**
+ * @brief Pixel after applying one op to 'pixel', as the format description states it.
+ */
+u32 ReferenceApplyDelta(u32 pixel, i32 dr, i32 dg, i32 db) {
+    u32 r = (u32)((i32)(pixel & 0xff) + dr) & 0xff;
+    u32 g = (u32)((i32)((pixel >> 8) & 0xff) + dg) & 0xff;
+    u32 b = (u32)((i32)((pixel >> 16) & 0xff) + db) & 0xff;
+    return (pixel & 0xff000000) | r | (g << 8) | (b << 16);
+}
+
+/**
+ * @brief Random valid stream of every op kind, with the pixels it decodes to tracked alongside.
+ *
+ * Index ops only refer to slots an encoder could have filled, and the image does not start with a run.
+ */
+QoiStream CreateRandomStream(u32 width, u32 height, byte channels, u32 seed) {
+    QoiStream stream;
+    PushU32BigEndian(&stream.bytes, QOI_MAGIC);
+    PushU32BigEndian(&stream.bytes, width);
+    PushU32BigEndian(&stream.bytes, height);
+    stream.bytes.push_back(channels);
+    stream.bytes.push_back(0);
+
+    u32 index[64] = {};
+    u32 pixel = 0xff000000;
+    size_t pixel_count = (size_t)width * height;
+
+    while (stream.pixels.size() < pixel_count) {
+        u32 op = TestRandom(&seed) % 6;
+        if (op == 0 && !stream.pixels.empty()) {
+            u32 run = 1 + TestRandom(&seed) % 62;
+            run = pixel_count - stream.pixels.size() < run ? (u32)(pixel_count - stream.pixels.size()) : run;
+            stream.bytes.push_back((byte)(QOI_OP_RUN | (run - 1)));
+            stream.pixels.insert(stream.pixels.end(), run, pixel);
+            continue;
+        }
+
+        if (op == 1) {
+            u32 slot = TestRandom(&seed) % 64;
+            if (QoiColorHash(index[slot]) != slot) {
+                continue;
+            }
+            stream.bytes.push_back((byte)(QOI_OP_INDEX | slot));
+            pixel = index[slot];
+        }
+        else if (op == 2) {
+            u32 bits = TestRandom(&seed) & 0x3f;
+            stream.bytes.push_back((byte)(QOI_OP_DIFF | bits));
+            pixel = ReferenceApplyDelta(pixel, (i32)((bits >> 4) & 3) - 2, (i32)((bits >> 2) & 3) - 2, (i32)(bits & 3) - 2);
+        }
+        else if (op == 3) {
+            i32 dg = (i32)(TestRandom(&seed) % 64) - 32;
+            u32 second = TestRandom(&seed) & 0xff;
+            stream.bytes.push_back((byte)(QOI_OP_LUMA | (dg + 32)));
+            stream.bytes.push_back((byte)second);
+            pixel = ReferenceApplyDelta(pixel, dg - 8 + (i32)(second >> 4), dg, dg - 8 + (i32)(second & 0x0f));
+        }
+        else if (op == 4) {
+            u32 rgb = TestRandom(&seed) & 0xffffff;
+            stream.bytes.push_back(QOI_OP_RGB);
+            stream.bytes.push_back((byte)rgb);
+            stream.bytes.push_back((byte)(rgb >> 8));
+            stream.bytes.push_back((byte)(rgb >> 16));
+            pixel = (pixel & 0xff000000) | rgb;
+        }
+        else {
+            u32 rgba = TestRandom(&seed) ^ (TestRandom(&seed) << 24);
+            stream.bytes.push_back(QOI_OP_RGBA);
+            for (i32 i = 0; i < 4; i++) {
+                stream.bytes.push_back((byte)(rgba >> (i * 8)));
+            }
+            pixel = rgba;
+        }
+
+        index[QoiColorHash(pixel)] = pixel;
+        stream.pixels.push_back(pixel);
+    }
+
+    for (i32 i = 0; i < QOI_END_MARKER_SIZE - 1; i++) {
+        stream.bytes.push_back(0);
+    }
+    stream.bytes.push_back(1);
+    return stream;
+}
+
+void TestRandomStreams() {
+    const u32 sizes[][2] = { {1, 1}, {1, 200}, {200, 1}, {3, 7}, {64, 64}, {333, 77} };
+    i32 mismatch_count = 0;
+    for (u32 seed = 1; seed <= 40; seed++) {
+        const u32* size = sizes[seed % 6];
+        QoiStream stream = CreateRandomStream(size[0], size[1], seed % 2 ? 4 : 3, seed);
+
+        QoiImageInfo info = {};
+        byte* image = QoiDecode(stream.bytes.data(), stream.bytes.size(), &info);
+        if (!TEST_CHECK(image != nullptr)) {
+            continue;
+        }
+        TEST_CHECK(info.width == size[0] && info.height == size[1] && info.channels == (seed % 2 ? 4 : 3));
+        mismatch_count += memcmp(image, stream.pixels.data(), stream.pixels.size() * 4) == 0 ? 0 : 1;
+        free(image);
+    }
+    TEST_CHECK(mismatch_count == 0);
+}
+
+void TestInvalidFiles() {
+    QoiStream stream = CreateRandomStream(48, 32, 4, 99);
+    std::vector<byte> file = stream.bytes;
+    QoiImageInfo info = {};
+
+    // Every cut, the end marker is never read as ops
+    i32 accepted_count = 0;
+    for (size_t cut = 0; cut + QOI_END_MARKER_SIZE < file.size(); cut++) {
+        std::vector<byte> truncated(file.begin(), file.begin() + cut);
+        byte* image = QoiDecode(truncated.data(), truncated.size(), &info);
+        accepted_count += image ? 1 : 0;
+        free(image);
+    }
+    TEST_CHECK(accepted_count == 0);
+
+    // Header fields out of range
+    const i32 header_offsets[] = { 0, 4, 8, 12, 12, 13 };
+    const byte header_values[] = { 'Q', 0, 0, 2, 5, 2 };
+    for (i32 i = 0; i < 6; i++) {
+        std::vector<byte> corrupt = file;
+        corrupt[header_offsets[i]] = header_values[i];
+        if (i == 1 || i == 2) {
+            memset(&corrupt[header_offsets[i]], 0, 4);
+        }
+        TEST_CHECK(QoiDecode(corrupt.data(), corrupt.size(), &info) == nullptr);
+    }
+
+    std::vector<byte> huge = file;
+    memset(&huge[4], 0xff, 8);
+    TEST_CHECK(QoiDecode(huge.data(), huge.size(), &info) == nullptr);
+
+    // Random byte damage either decodes to a full image or fails, build with -fsanitize=address to catch overruns
+    u32 seed = 7;
+    i32 decoded_count = 0;
+    for (i32 i = 0; i < 2000; i++) {
+        std::vector<byte> damaged = file;
+        for (i32 j = 0; j < 4; j++) {
+            damaged[QOI_HEADER_SIZE + TestRandom(&seed) % (damaged.size() - QOI_HEADER_SIZE)] = (byte)TestRandom(&seed);
+        }
+        byte* image = QoiDecode(damaged.data(), damaged.size(), &info);
+        decoded_count += image ? 1 : 0;
+        free(image);
+    }
+    TEST_CHECK(decoded_count < 2000);
+}
+
+int main() {
+    TestRandomStreams();
+    TestInvalidFiles();
+    return TestReport("qoi_image_test");
+}
@@ -0,0 +1,54 @@
+// Benchmark of quad vertex generation: four indexed vertices per quad against six unindexed vertices,
+// reported in quads per second and bytes written per quad.
+
+// ----------
+// Includes
+
+#include "test.h"
+#include "../src/quad_batch.h"
+
+// --------------------------
+// Function implementations
+
+int main() {
+    const i32 quad_count = 100000;
+    const i32 frame_count = 200;
+
+    TilemapTileVertex* vertices = (TilemapTileVertex*)malloc(sizeof(TilemapTileVertex) * 6 * quad_count);
+    if (!vertices) {
+        return 1;
+    }
+    Vec4f uv_rect = { 0.0f, 0.0f, 1.0f, 1.0f };
+    Vec4f color = { 1.0f, 1.0f, 1.0f, 1.0f };
+
+    f64 start_ms = TestNowMs();
+    for (i32 frame = 0; frame < frame_count; frame++) {
+        TilemapTileVertex* out = vertices;
+        for (i32 i = 0; i < quad_count; i++) {
+            out += BuildQuadVertices(out, Vec2f{(f32)(i % 512), (f32)(i / 512 + frame)}, Vec2f{2.0f, 1.0f}, uv_rect, color);
+        }
+    }
+    f64 indexed_ms = TestNowMs() - start_ms;
+
+    // The duplicated corners of the old unindexed quads: 2 copied vertices more per quad
+    start_ms = TestNowMs();
+    for (i32 frame = 0; frame < frame_count; frame++) {
+        TilemapTileVertex* out = vertices;
+        for (i32 i = 0; i < quad_count; i++) {
+            BuildQuadVertices(out, Vec2f{(f32)(i % 512), (f32)(i / 512 + frame)}, Vec2f{2.0f, 1.0f}, uv_rect, color);
+            out[5] = out[3];
+            out[4] = out[1];
+            out[3] = out[2];
+            out += 6;
+        }
+    }
+    f64 unindexed_ms = TestNowMs() - start_ms;
+
+    f64 total_quads = (f64)quad_count * frame_count;
+    printf("Indexed quads:   %6.1f M quads/s, %zu bytes/quad\n", total_quads / (indexed_ms * 1e3), 4 * sizeof(TilemapTileVertex));
+    printf("Unindexed quads: %6.1f M quads/s, %zu bytes/quad\n", total_quads / (unindexed_ms * 1e3), 6 * sizeof(TilemapTileVertex));
+
+    u32 checksum = vertices[quad_count].color;
+    free(vertices);
+    return checksum == 0xFFFFFFFF ? 0 : 1;
+}
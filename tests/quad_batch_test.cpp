@@ -0,0 +1,89 @@
+// Tests of the shared quad streams: the static quad index list, the four vertex quads written for
+// textured quads, solid rectangles and text glyphs, and the packed color and UV formats they use.
+
+// ----------
+// Includes
+
+#include "test.h"
+#include "../src/quad_batch.h"
+
+// --------------------------
+// Function implementations
+
+void TestQuadIndices() {
+    u32 indices[3 * QUAD_INDEX_COUNT];
+    FillQuadIndices(indices, 3);
+
+    const u32 expected[3 * QUAD_INDEX_COUNT] = { 0, 1, 2, 2, 1, 3, 4, 5, 6, 6, 5, 7, 8, 9, 10, 10, 9, 11 };
+    TEST_CHECK(memcmp(indices, expected, sizeof(expected)) == 0);
+}
+
+/**
+ * @brief Signed area of a triangle, negative when clockwise with y up.
+ */
+f32 TriangleArea(Vec2f a, Vec2f b, Vec2f c) {
+    return ((b.x - a.x) * (c.y - a.y) - (c.x - a.x) * (b.y - a.y)) * 0.5f;
+}
+
+void TestQuadVertices() {
+    TilemapTileVertex quad[QUAD_VERTEX_COUNT];
+    TEST_CHECK(BuildQuadVertices(quad, Vec2f{3.0f, -2.0f}, Vec2f{2.0f, 1.0f}, Vec4f{0.25f, 0.0f, 0.5f, 1.0f}, Vec4f{1.0f, 1.0f, 1.0f, 1.0f}) == QUAD_VERTEX_COUNT);
+
+    // Top-left, top-right, bottom-left, bottom-right
+    TEST_CHECK(quad[0].position.x == 2.0f && quad[0].position.y == -1.5f);
+    TEST_CHECK(quad[1].position.x == 4.0f && quad[1].position.y == -1.5f);
+    TEST_CHECK(quad[2].position.x == 2.0f && quad[2].position.y == -2.5f);
+    TEST_CHECK(quad[3].position.x == 4.0f && quad[3].position.y == -2.5f);
+    TEST_CHECK(quad[0].uv[0] == PackUnorm16(0.25f) && quad[0].uv[1] == 0);
+    TEST_CHECK(quad[3].uv[0] == PackUnorm16(0.5f) && quad[3].uv[1] == 0xFFFF);
+
+    // Both triangles of the index list wind clockwise, the rasterizer's front face
+    u32 indices[QUAD_INDEX_COUNT];
+    FillQuadIndices(indices, 1);
+    TEST_CHECK(TriangleArea(quad[indices[0]].position, quad[indices[1]].position, quad[indices[2]].position) < 0.0f);
+    TEST_CHECK(TriangleArea(quad[indices[3]].position, quad[indices[4]].position, quad[indices[5]].position) < 0.0f);
+
+    RectangleVertex rectangle[QUAD_VERTEX_COUNT];
+    BuildRectangleQuadVertices(rectangle, Vec2f{-1.0f, 1.0f}, Vec2f{1.0f, 1.0f}, Vec2f{-1.0f, -1.0f}, Vec2f{1.0f, -1.0f}, Vec4f{1.0f, 0.0f, 0.0f, 1.0f});
+    TEST_CHECK(rectangle[1].position.x == 1.0f && rectangle[2].position.y == -1.0f);
+    TEST_CHECK(rectangle[0].color == rectangle[3].color);
+
+    TextUiVertex glyph[QUAD_VERTEX_COUNT];
+    BuildTextUiQuadVertices(glyph, Vec2f{0.0f, 0.5f}, Vec2f{0.5f, 0.5f}, Vec2f{0.0f, 0.0f}, Vec2f{0.5f, 0.0f}, Vec4f{0.0f, 0.5f, 0.25f, 0.75f});
+    TEST_CHECK(glyph[0].uv[0] == 0 && glyph[0].uv[1] == PackUnorm16(0.5f));
+    TEST_CHECK(glyph[3].uv[0] == PackUnorm16(0.25f) && glyph[3].uv[1] == PackUnorm16(0.75f));
+}
+
+void TestPacking() {
+    TEST_CHECK(PackUnorm8(0.0f) == 0 && PackUnorm8(1.0f) == 255 && PackUnorm8(0.5f) == 128);
+    TEST_CHECK(PackUnorm8(-3.0f) == 0 && PackUnorm8(7.0f) == 255);
+    TEST_CHECK(PackUnorm16(0.0f) == 0 && PackUnorm16(1.0f) == 0xFFFF && PackUnorm16(2.0f) == 0xFFFF);
+
+    // Red in the lowest byte, as R8G8B8A8_UNORM reads it on little endian
+    TEST_CHECK(PackColorRGBA8(Vec4f{1.0f, 0.0f, 0.0f, 0.0f}) == 0x000000FF);
+    TEST_CHECK(PackColorRGBA8(Vec4f{0.0f, 0.0f, 0.0f, 1.0f}) == 0xFF000000);
+    TEST_CHECK(PackColorRGBA8(Vec4f{0.2f, 0.4f, 0.6f, 0.8f}) == (51u | 102u << 8 | 153u << 16 | 204u << 24));
+
+    // UNORM16 keeps every texel edge of a 4096 texel atlas distinct
+    i32 collision_count = 0;
+    for (i32 texel = 1; texel <= 4096; texel++) {
+        collision_count += PackUnorm16((f32)(texel - 1) / 4096.0f) == PackUnorm16((f32)texel / 4096.0f) ? 1 : 0;
+    }
+    TEST_CHECK(collision_count == 0);
+}
+
+void TestScreenConversion() {
+    Vec2i viewport = { 801, 601 };
+    Vec2f top_left = ScreenPxToNDC(Vec2i{0, 0}, viewport);
+    Vec2f bottom_right = ScreenPxToNDC(Vec2i{800, 600}, viewport);
+    TEST_CHECK(top_left.x == -1.0f && top_left.y == 1.0f);
+    TEST_CHECK(bottom_right.x == 1.0f && bottom_right.y == -1.0f);
+}
+
+int main() {
+    TestQuadIndices();
+    TestQuadVertices();
+    TestPacking();
+    TestScreenConversion();
+    return TestReport("quad_batch_test");
+}
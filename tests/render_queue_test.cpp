@@ -0,0 +1,200 @@
+// Tests of the render command queue: sorting and merging reduce binds and draws, merged vertices keep their
+// recording order, static draws stay separate, and run orders beyond 16 bits keep their sequence.
+
+// ----------
+// Includes
+
+#include <vector>
+
+#include "test.h"
+#include "../src/render_queue.h"
+
+// ---------
+// Defines
+
+const u32 PIPELINE_QUAD_2D = 0;
+const u32 PIPELINE_SHAPES = 1;
+const u32 PIPELINE_TEXT = 2;
+const u32 PIPELINE_SPRITES = 3;
+
+// ---------
+// Structs
+
+/**
+ * @brief Backend that records the first u32 of every drawn quad, static buffers as their id with the top bit set.
+ */
+struct SequenceBackend {
+    std::vector<u32> sequence;
+    std::vector<u32> bound_textures;
+};
+
+// --------------------------
+// Function implementations
+
+void SequenceBindPipeline(void*, u32) {
+}
+
+void SequenceBindTexture(void* user_data, u32 texture) {
+    ((SequenceBackend*)user_data)->bound_textures.push_back(texture);
+}
+
+void SequenceDrawQuads(void* user_data, void* vertices, u32 vertex_stride, u32 quad_count) {
+    SequenceBackend* backend = (SequenceBackend*)user_data;
+    for (u32 i = 0; i < quad_count; i++) {
+        u32 value;
+        memcpy(&value, (byte*)vertices + i * vertex_stride * QUAD_VERTEX_COUNT, sizeof(value));
+        backend->sequence.push_back(value);
+    }
+}
+
+void SequenceDrawStaticQuads(void* user_data, u32 static_buffer, u32, u32) {
+    ((SequenceBackend*)user_data)->sequence.push_back(0x80000000u | static_buffer);
+}
+
+void SequenceDrawInstances(void* user_data, void* instances, u32 instance_stride, u32 instance_count) {
+    SequenceBackend* backend = (SequenceBackend*)user_data;
+    for (u32 i = 0; i < instance_count; i++) {
+        u32 value;
+        memcpy(&value, (byte*)instances + i * instance_stride, sizeof(value));
+        backend->sequence.push_back(value);
+    }
+}
+
+RenderBackend SequenceBackendCreate(SequenceBackend* sequence) {
+    RenderBackend result = {
+        .user_data = sequence,
+        .bind_pipeline = SequenceBindPipeline,
+        .bind_texture = SequenceBindTexture,
+        .draw_quads = SequenceDrawQuads,
+        .draw_static_quads = SequenceDrawStaticQuads,
+        .draw_instances = SequenceDrawInstances
+    };
+    return result;
+}
+
+/**
+ * @brief Push one quad of 'vertex_stride' bytes per vertex whose first u32 is 'id'.
+ */
+void PushQuad(RenderQueue* queue, u32 layer, u32 order, u32 pipeline, u32 texture, u32 id) {
+    byte* quad = (byte*)RenderQueuePushQuads(queue, layer, order, pipeline, texture, 12, 1);
+    if (TEST_CHECK(quad != nullptr)) {
+        memset(quad, 0, 12 * QUAD_VERTEX_COUNT);
+        memcpy(quad, &id, sizeof(id));
+    }
+}
+
+void TestStateChanges() {
+    RenderQueue queue = {};
+    TEST_CHECK(RenderQueueCreate(&queue, 1024, 64, 0));
+    RenderNullBackendCounters counters = {};
+    RenderBackend backend = RenderNullBackendCreate(&counters);
+
+    // Debug overlay style interleaving: every line is a background rectangle and then its text
+    for (u32 i = 0; i < 50; i++) {
+        PushQuad(&queue, 3, 0, PIPELINE_SHAPES, RENDER_TEXTURE_NONE, i);
+        PushQuad(&queue, 3, 0, PIPELINE_TEXT, 7, i);
+    }
+    RenderQueueSubmit(&queue, &backend);
+
+    // Drawn immediately this would be 100 draws with 100 pipeline binds
+    TEST_CHECK(counters.draws == 2);
+    TEST_CHECK(counters.pipeline_binds == 2 && counters.texture_binds == 2);
+    TEST_CHECK(counters.quads == 100);
+    TEST_CHECK(queue.stats.commands == 100 && queue.stats.merged_commands == 98);
+    TEST_CHECK(queue.count == 0 && queue.vertex_bytes == 0);
+
+    RenderQueueDestroy(&queue);
+}
+
+void TestMergeOrder() {
+    RenderQueue queue = {};
+    TEST_CHECK(RenderQueueCreate(&queue, 1024, 64, 3));
+    SequenceBackend sequence = {};
+    RenderBackend backend = SequenceBackendCreate(&sequence);
+
+    PushQuad(&queue, 0, 0, PIPELINE_SHAPES, RENDER_TEXTURE_NONE, 1);
+    for (u32 chunk = 0; chunk < 3; chunk++) {
+        TEST_CHECK(RenderQueuePushStatic(&queue, 1, 0, PIPELINE_QUAD_2D, 5, 100 + chunk, 16, 10));
+    }
+    PushQuad(&queue, 1, 1, PIPELINE_SPRITES, 5, 2);
+    PushQuad(&queue, 1, 2, PIPELINE_SPRITES, 6, 3);
+    PushQuad(&queue, 1, 3, PIPELINE_SPRITES, 5, 4);
+    for (u32 i = 0; i < 4; i++) {
+        PushQuad(&queue, 3, 0, PIPELINE_SHAPES, RENDER_TEXTURE_NONE, 10 + i);
+        PushQuad(&queue, 3, 0, PIPELINE_TEXT, 7, 20 + i);
+    }
+    RenderQueueSubmit(&queue, &backend);
+
+    // Layers in order, static chunks one by one, sprite runs by order, and merged UI quads in recording order
+    const u32 expected[] = {
+        1,
+        0x80000000u | 100, 0x80000000u | 101, 0x80000000u | 102,
+        2, 3, 4,
+        10, 11, 12, 13,
+        20, 21, 22, 23
+    };
+    TEST_CHECK(sequence.sequence.size() == sizeof(expected) / sizeof(expected[0]));
+    TEST_CHECK(memcmp(sequence.sequence.data(), expected, sizeof(expected)) == 0);
+
+    // Four UI shapes with three quads per draw take two draws
+    TEST_CHECK(queue.stats.draws == 1 + 3 + 3 + 2 + 2);
+
+    RenderQueueDestroy(&queue);
+}
+
+void TestWideOrder() {
+    const u32 run_count = 70000;
+    RenderQueue queue = {};
+    TEST_CHECK(RenderQueueCreate(&queue, run_count, 1024, 0));
+    SequenceBackend sequence = {};
+    RenderBackend backend = SequenceBackendCreate(&sequence);
+
+    // Sprite runs alternating between two textures, more runs than a 16 bit order holds
+    for (u32 order = 1; order <= run_count; order++) {
+        u32* instance = (u32*)RenderQueuePushInstances(&queue, 1, order, PIPELINE_SPRITES, order % 2, sizeof(u32), 1);
+        if (!TEST_CHECK(instance != nullptr)) {
+            break;
+        }
+        *instance = order;
+    }
+    RenderQueueSubmit(&queue, &backend);
+
+    i32 out_of_order_count = 0;
+    for (size_t i = 0; i < sequence.sequence.size(); i++) {
+        out_of_order_count += sequence.sequence[i] == i + 1 ? 0 : 1;
+    }
+    TEST_CHECK(sequence.sequence.size() == run_count);
+    TEST_CHECK(out_of_order_count == 0);
+
+    // Orders past the field are refused, never wrapped
+    TEST_CHECK(RenderQueuePushQuads(&queue, 1, RENDER_ORDER_MAX, PIPELINE_SHAPES, 0, 12, 1) != nullptr);
+    TEST_CHECK(RenderQueuePushQuads(&queue, 1, RENDER_ORDER_MAX + 1, PIPELINE_SHAPES, 0, 12, 1) == nullptr);
+    TEST_CHECK(!RenderQueuePushStatic(&queue, 1, RENDER_ORDER_MAX + 1, PIPELINE_QUAD_2D, 0, 0, 16, 1));
+    TEST_CHECK(PackRenderSortKey(0, RENDER_ORDER_MAX, 0xFF, 0xFFFF) < PackRenderSortKey(1, 0, 0, 0));
+    TEST_CHECK(PackRenderSortKey(0, 0x10000, 0, 0) > PackRenderSortKey(0, 0xFFFF, 0xFF, 0xFFFF));
+
+    RenderQueueDestroy(&queue);
+}
+
+void TestFullQueue() {
+    RenderQueue queue = {};
+    TEST_CHECK(RenderQueueCreate(&queue, 2, 64, 0));
+
+    TEST_CHECK(RenderQueuePushQuads(&queue, 0, 0, PIPELINE_SHAPES, 0, 12, 1) != nullptr);
+    TEST_CHECK(RenderQueuePushQuads(&queue, 0, 0, PIPELINE_TEXT, 0, 12, 1) != nullptr);
+    TEST_CHECK(RenderQueuePushQuads(&queue, 0, 0, PIPELINE_SHAPES, 0, 12, 1) == nullptr);
+
+    // Quads extending the last command need no new command
+    TEST_CHECK(RenderQueuePushQuads(&queue, 0, 0, PIPELINE_TEXT, 0, 12, 1) != nullptr);
+    TEST_CHECK(queue.count == 2);
+
+    RenderQueueDestroy(&queue);
+}
+
+int main() {
+    TestStateChanges();
+    TestMergeOrder();
+    TestWideOrder();
+    TestFullQueue();
+    return TestReport("render_queue_test");
+}
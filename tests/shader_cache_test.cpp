@@ -0,0 +1,235 @@
+// Tests of the shader cache: keys separate every compile input, entries round trip and go stale with their
+// includes, damaged files are misses, paths that do not fit fail instead of naming another file, and pruning
+// removes superseded entries only.
+
+// ----------
+// Includes
+
+#include <stdlib.h>
+#include <vector>
+
+#include "test.h"
+#include "../src/shader_cache.h"
+
+// ---------
+// Globals
+
+char test_directory[64] = "/tmp/shader_cache_test_XXXXXX";
+char test_cache_directory[128];
+
+// --------------------------
+// Function implementations
+
+/**
+ * @brief ShaderCacheSourceReader callback reading paths relative to the test directory.
+ */
+byte* TestReadSource(void* user_data, const char* path, size_t* size) {
+    (void)user_data;
+    char native_path[SHADER_CACHE_PATH_MAX + 64];
+    snprintf(native_path, sizeof(native_path), "%s/%s", test_directory, path);
+    return ShaderCacheReadFile(native_path, size);
+}
+
+void WriteTestFile(const char* path, const void* data, size_t size) {
+    FILE* file = fopen(path, "wb");
+    if (!TEST_CHECK(file != nullptr)) {
+        return;
+    }
+    fwrite(data, 1, size, file);
+    fclose(file);
+}
+
+void WriteTestSource(const char* name, const char* text) {
+    char path[SHADER_CACHE_PATH_MAX + 64];
+    snprintf(path, sizeof(path), "%s/%s", test_directory, name);
+    WriteTestFile(path, text, strlen(text));
+}
+
+bool CacheFileExists(ShaderCache* cache, u64 key) {
+    char path[SHADER_CACHE_PATH_MAX];
+    if (!ShaderCacheFilePath(cache, key, path)) {
+        return false;
+    }
+    FILE* file = fopen(path, "rb");
+    if (file) {
+        fclose(file);
+    }
+    return file != nullptr;
+}
+
+void TestKeys() {
+    const char* source = "float4 VSMain() : SV_Position { return 0; }";
+    size_t size = strlen(source);
+    u64 key = ShaderCacheKeyOf((const byte*)source, size, "", "VSMain", "vs_5_0", 0, 47);
+    TEST_CHECK(key == ShaderCacheKeyOf((const byte*)source, size, "", "VSMain", "vs_5_0", 0, 47));
+    TEST_CHECK(key != ShaderCacheKeyOf((const byte*)source, size, "", "PSMain", "ps_5_0", 0, 47));
+    TEST_CHECK(key != ShaderCacheKeyOf((const byte*)source, size, "A=1;", "VSMain", "vs_5_0", 0, 47));
+    TEST_CHECK(key != ShaderCacheKeyOf((const byte*)source, size, "", "VSMain", "vs_5_0", 1, 47));
+    TEST_CHECK(key != ShaderCacheKeyOf((const byte*)source, size, "", "VSMain", "vs_5_0", 0, 43));
+    TEST_CHECK(key != ShaderCacheKeyOf((const byte*)source, size - 1, "", "VSMain", "vs_5_0", 0, 47));
+
+    // Fields are length prefixed, moving a character from one into the next is another key
+    TEST_CHECK(key != ShaderCacheKeyOf((const byte*)source, size, "", "VSMai", "nvs_5_0", 0, 47));
+}
+
+void TestRoundTrip(ShaderCache* cache) {
+    ShaderCacheSourceReader reader = { nullptr, TestReadSource };
+    u64 key = 0x0123456789abcdefull;
+    size_t size = 0;
+    TEST_CHECK(ShaderCacheLoad(cache, key, &reader, &size) == nullptr);
+    TEST_CHECK(cache->stats.misses == 1);
+
+    WriteTestSource("common.hlsli", "#define X 1");
+    size_t include_size = 0;
+    byte* include = TestReadSource(nullptr, "common.hlsli", &include_size);
+    ShaderCacheDependency dependency = {};
+    dependency.content_hash = HashFnv1a(include, include_size);
+    snprintf(dependency.path, SHADER_CACHE_PATH_MAX, "common.hlsli");
+    free(include);
+
+    std::vector<byte> bytecode(3000);
+    for (size_t i = 0; i < bytecode.size(); i++) {
+        bytecode[i] = (byte)(i * 31);
+    }
+    TEST_CHECK(ShaderCacheStore(cache, key, bytecode.data(), bytecode.size(), &dependency, 1));
+    byte* loaded = ShaderCacheLoad(cache, key, &reader, &size);
+    TEST_CHECK(loaded && size == bytecode.size() && memcmp(loaded, bytecode.data(), size) == 0);
+    free(loaded);
+
+    // A changed or removed include makes the entry stale, restoring it makes it current again
+    WriteTestSource("common.hlsli", "#define X 2");
+    TEST_CHECK(ShaderCacheLoad(cache, key, &reader, &size) == nullptr && cache->stats.stale == 1);
+    WriteTestSource("common.hlsli", "#define X 1");
+    loaded = ShaderCacheLoad(cache, key, &reader, &size);
+    TEST_CHECK(loaded != nullptr);
+    free(loaded);
+
+    // Damaged files are misses: truncated, with flipped bits and with trailing bytes
+    char path[SHADER_CACHE_PATH_MAX];
+    TEST_CHECK(ShaderCacheFilePath(cache, key, path));
+    size_t file_size = 0;
+    byte* file = ShaderCacheReadFile(path, &file_size);
+    if (!TEST_CHECK(file != nullptr)) {
+        return;
+    }
+    for (size_t length = 0; length < file_size; length += 97) {
+        WriteTestFile(path, file, length);
+        TEST_CHECK(ShaderCacheLoad(cache, key, &reader, &size) == nullptr);
+    }
+    size_t flips[] = { 0, 5, 9, 17, 25, 29, file_size - 1500, file_size - 1 };
+    for (size_t position : flips) {
+        file[position] ^= 0x10;
+        WriteTestFile(path, file, file_size);
+        TEST_CHECK(ShaderCacheLoad(cache, key, &reader, &size) == nullptr);
+        file[position] ^= 0x10;
+    }
+    std::vector<byte> longer(file, file + file_size);
+    longer.push_back(0);
+    WriteTestFile(path, longer.data(), longer.size());
+    TEST_CHECK(ShaderCacheLoad(cache, key, &reader, &size) == nullptr);
+    free(file);
+
+    TEST_CHECK(!ShaderCacheStore(cache, key, bytecode.data(), 0, nullptr, 0));
+}
+
+void TestLongPaths() {
+    // The directory fits, the entry names under it do not
+    char directory[SHADER_CACHE_PATH_MAX];
+    i32 length = snprintf(directory, sizeof(directory), "%s/", test_directory);
+    while (length < SHADER_CACHE_PATH_MAX - 8) {
+        directory[length++] = 'd';
+    }
+    directory[length] = '\0';
+
+    ShaderCache cache;
+    TEST_CHECK(ShaderCacheCreate(&cache, directory));
+    char path[SHADER_CACHE_PATH_MAX];
+    TEST_CHECK(!ShaderCacheFilePath(&cache, 1, path));
+
+    byte bytecode[16] = { 1, 2, 3 };
+    size_t size = 0;
+    ShaderCacheSourceReader reader = { nullptr, TestReadSource };
+    TEST_CHECK(!ShaderCacheStore(&cache, 1, bytecode, sizeof(bytecode), nullptr, 0));
+    TEST_CHECK(cache.stats.write_failures == 1 && cache.stats.writes == 0);
+    TEST_CHECK(ShaderCacheLoad(&cache, 1, &reader, &size) == nullptr && cache.stats.misses == 1);
+    rmdir(directory);
+
+    // A directory that does not fit at all is refused
+    char too_long[SHADER_CACHE_PATH_MAX + 16];
+    memset(too_long, 'd', sizeof(too_long));
+    too_long[sizeof(too_long) - 1] = '\0';
+    TEST_CHECK(!ShaderCacheCreate(&cache, too_long));
+}
+
+void TestPrune() {
+    ShaderCache cache;
+    char directory[128];
+    snprintf(directory, sizeof(directory), "%s/prune", test_directory);
+    TEST_CHECK(ShaderCacheCreate(&cache, directory));
+
+    // Enough entries for several removal batches
+    byte bytecode[64] = { 7 };
+    std::vector<u64> current_keys;
+    for (u64 key = 1; key <= 200; key++) {
+        TEST_CHECK(ShaderCacheStore(&cache, key * 0x9e3779b97f4a7c15ull, bytecode, sizeof(bytecode), nullptr, 0));
+        if (key % 10 == 0) {
+            current_keys.push_back(key * 0x9e3779b97f4a7c15ull);
+        }
+    }
+
+    // Files the cache did not write are left alone
+    char other_path[256];
+    snprintf(other_path, sizeof(other_path), "%s/notes.txt", directory);
+    WriteTestFile(other_path, "keep", 4);
+    char temp_path[256];
+    snprintf(temp_path, sizeof(temp_path), "%s/00000000000000ff.fsc.1-1.tmp", directory);
+    WriteTestFile(temp_path, "writer", 6);
+
+    TEST_CHECK(ShaderCachePrune(&cache, current_keys.data(), (i32)current_keys.size()) == 180);
+    for (u64 key = 1; key <= 200; key++) {
+        TEST_CHECK(CacheFileExists(&cache, key * 0x9e3779b97f4a7c15ull) == (key % 10 == 0));
+    }
+    FILE* file = fopen(other_path, "rb");
+    TEST_CHECK(file != nullptr);
+    if (file) {
+        fclose(file);
+    }
+    TEST_CHECK(ShaderCachePrune(&cache, current_keys.data(), (i32)current_keys.size()) == 0);
+
+    u64 key = 0;
+    TEST_CHECK(ShaderCacheKeyOfFileName("0123456789abcdef.fsc", &key) && key == 0x0123456789abcdefull);
+    TEST_CHECK(!ShaderCacheKeyOfFileName("0123456789ABCDEF.fsc", &key));
+    TEST_CHECK(!ShaderCacheKeyOfFileName("0123456789abcdef.fsc.1-1.tmp", &key));
+    TEST_CHECK(!ShaderCacheKeyOfFileName("0123.fsc", &key));
+
+    TEST_CHECK(ShaderCachePrune(&cache, nullptr, 0) == 20);
+    remove(other_path);
+    remove(temp_path);
+    rmdir(directory);
+}
+
+int main() {
+    if (!mkdtemp(test_directory)) {
+        fprintf(stderr, "could not create %s\n", test_directory);
+        return 1;
+    }
+    snprintf(test_cache_directory, sizeof(test_cache_directory), "%s/cache", test_directory);
+
+    ShaderCache cache;
+    TEST_CHECK(ShaderCacheCreate(&cache, test_cache_directory));
+    TEST_CHECK(ShaderCacheCreate(&cache, test_cache_directory));
+
+    TestKeys();
+    TestRoundTrip(&cache);
+    TestLongPaths();
+    TestPrune();
+
+    // Everything the round trip left behind is superseded now
+    ShaderCachePrune(&cache, nullptr, 0);
+    rmdir(test_cache_directory);
+    char include_path[128];
+    snprintf(include_path, sizeof(include_path), "%s/common.hlsli", test_directory);
+    remove(include_path);
+    rmdir(test_directory);
+    return TestReport("shader_cache_test");
+}
@@ -0,0 +1,53 @@
+// Benchmark of drawing 50k lines per frame through the render queue: building the line quads, sorting and
+// merging the commands and submitting them to the null backend.
+
+// ----------
+// Includes
+
+#include "test.h"
+#include "../src/shape_batch.h"
+#include "../src/render_queue.h"
+
+// --------------------------
+// Function implementations
+
+int main() {
+    const i32 line_count = 50000;
+    const i32 frame_count = 100;
+    const u32 pipeline_shapes = 1;
+
+    RenderQueue queue = {};
+    if (!RenderQueueCreate(&queue, 1024, 1024 * 1024, 0)) {
+        return 1;
+    }
+    RenderNullBackendCounters counters = {};
+    RenderBackend backend = RenderNullBackendCreate(&counters);
+
+    Vec2i viewport = { 1600, 900 };
+    Vec4f color = { 0.2f, 0.8f, 0.2f, 1.0f };
+    f64 build_ms = 0.0;
+    f64 submit_ms = 0.0;
+
+    for (i32 frame = 0; frame < frame_count; frame++) {
+        f64 start_ms = TestNowMs();
+        for (i32 i = 0; i < line_count; i++) {
+            f32 t = (f32)i / line_count * 2.0f - 1.0f;
+            RectangleVertex* quad = (RectangleVertex*)RenderQueuePushQuads(&queue, 0, 0, pipeline_shapes, RENDER_TEXTURE_NONE, sizeof(RectangleVertex), 1);
+            if (!quad) {
+                return 1;
+            }
+            BuildLineQuadVertices(quad, Vec2f{-1.0f, t}, Vec2f{1.0f, -t}, 1.0f, viewport, color);
+        }
+        f64 built_ms = TestNowMs();
+        RenderQueueSubmit(&queue, &backend);
+        submit_ms += TestNowMs() - built_ms;
+        build_ms += built_ms - start_ms;
+    }
+
+    printf("%d lines per frame: build %.3f ms, submit %.3f ms, %.1f ns/line, %d draws/frame\n",
+        line_count, build_ms / frame_count, submit_ms / frame_count,
+        (build_ms + submit_ms) * 1e6 / ((f64)line_count * frame_count), counters.draws / frame_count);
+
+    RenderQueueDestroy(&queue);
+    return 0;
+}
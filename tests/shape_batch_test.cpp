@@ -0,0 +1,81 @@
+// Tests of batched shapes: line and dot quads, and lines, dots and rectangles recorded in any order ending up
+// in one draw while staying ordered against the layers around them.
+
+// ----------
+// Includes
+
+#include <math.h>
+
+#include "test.h"
+#include "../src/shape_batch.h"
+#include "../src/render_queue.h"
+
+// --------------------------
+// Function implementations
+
+void TestShapeQuads() {
+    Vec2i viewport = { 801, 601 };
+    Vec4f color = { 0.0f, 1.0f, 0.0f, 1.0f };
+
+    // Horizontal line, 2 pixels to both sides
+    RectangleVertex line[QUAD_VERTEX_COUNT];
+    TEST_CHECK(BuildLineQuadVertices(line, Vec2f{-0.5f, 0.0f}, Vec2f{0.5f, 0.0f}, 2.0f, viewport, color) == QUAD_VERTEX_COUNT);
+    f32 pixel_height = 2.0f / (viewport.y - 1);
+    TEST_CHECK(fabsf(fabsf(line[0].position.y - line[1].position.y) - 4.0f * pixel_height) < 1e-4f);
+    TEST_CHECK(line[0].position.x == line[1].position.x && line[2].position.x == line[3].position.x);
+    TEST_CHECK(line[0].color == PackColorRGBA8(color));
+
+    // Zero length lines are degenerate but must not produce NaNs
+    TEST_CHECK(BuildLineQuadVertices(line, Vec2f{0.25f, 0.25f}, Vec2f{0.25f, 0.25f}, 2.0f, viewport, color) == QUAD_VERTEX_COUNT);
+    TEST_CHECK(!isnan(line[0].position.x) && !isnan(line[3].position.y));
+
+    RectangleVertex dot[QUAD_VERTEX_COUNT];
+    BuildDotQuadVertices(dot, Vec2f{0.0f, 0.0f}, 8.0f, Vec2i{800, 600}, color);
+    TEST_CHECK(dot[1].position.x - dot[0].position.x == 8.0f / 800.0f);
+    TEST_CHECK(dot[0].position.y - dot[2].position.y == 8.0f / 600.0f);
+}
+
+void TestOneDrawPerLayer() {
+    const u32 layer_world = 1;
+    const u32 layer_ui = 3;
+    const u32 pipeline_shapes = 1;
+    const u32 pipeline_text = 2;
+
+    RenderQueue queue = {};
+    TEST_CHECK(RenderQueueCreate(&queue, 1024, 1024, 0));
+    RenderNullBackendCounters counters = {};
+    RenderBackend backend = RenderNullBackendCreate(&counters);
+
+    // Shapes drawn between text on the UI layer, and more shapes under it on the world layer
+    Vec2i viewport = { 800, 600 };
+    Vec4f color = { 1.0f, 1.0f, 1.0f, 1.0f };
+    for (i32 i = 0; i < 1000; i++) {
+        u32 layer = i % 2 == 0 ? layer_ui : layer_world;
+        RectangleVertex* quad = (RectangleVertex*)RenderQueuePushQuads(&queue, layer, 0, pipeline_shapes, RENDER_TEXTURE_NONE, sizeof(RectangleVertex), 1);
+        TEST_CHECK(quad != nullptr);
+        if (i % 3 == 0) {
+            BuildDotQuadVertices(quad, Vec2f{0.0f, 0.0f}, 4.0f, viewport, color);
+        }
+        else {
+            BuildLineQuadVertices(quad, Vec2f{-1.0f, (f32)i / 1000.0f}, Vec2f{1.0f, (f32)i / 1000.0f}, 1.0f, viewport, color);
+        }
+        if (i % 100 == 0) {
+            RenderQueuePushQuads(&queue, layer_ui, 0, pipeline_text, 7, sizeof(TextUiVertex), 1);
+        }
+    }
+
+    RenderQueueSubmit(&queue, &backend);
+    TEST_CHECK(counters.quads == 1000 + 10);
+
+    // World shapes and UI shapes are neighbours after sorting and merge into one draw, UI text comes after them
+    TEST_CHECK(counters.draws == 2);
+    TEST_CHECK(queue.stats.pipeline_binds == 2);
+
+    RenderQueueDestroy(&queue);
+}
+
+int main() {
+    TestShapeQuads();
+    TestOneDrawPerLayer();
+    return TestReport("shape_batch_test");
+}
@@ -0,0 +1,60 @@
+// Stress benchmark of the frame sprite path: increasing sprite counts are queued, depth sorted, recorded as
+// instanced runs and submitted to the null backend, reporting CPU time per sprite.
+
+// ----------
+// Includes
+
+#include "test.h"
+#include "../src/render_queue.h"
+
+// --------------------------
+// Function implementations
+
+int main() {
+    const i32 sprite_budget = 131072;
+    const i32 frame_count = 20;
+
+    QuadDrawQueue sprites = {};
+    RenderQueue queue = {};
+    if (!QuadDrawQueueCreate(&sprites, sprite_budget) || !RenderQueueCreate(&queue, sprite_budget, 1024 * 1024, 16384)) {
+        return 1;
+    }
+    RenderNullBackendCounters counters = {};
+    RenderBackend backend = RenderNullBackendCreate(&counters);
+
+    printf("%8s %12s %12s %12s\n", "sprites", "ns/sprite", "ms/frame", "draws/frame");
+    u32 random = 1;
+    for (i32 sprite_count = 1024; sprite_count <= sprite_budget; sprite_count *= 2) {
+        counters = {};
+        f64 start_ms = TestNowMs();
+        for (i32 frame = 0; frame < frame_count; frame++) {
+            for (i32 i = 0; i < sprite_count; i++) {
+                random = random * 1664525u + 1013904223u;
+                Vec2f center = { (f32)((random >> 8) % 1000), (f32)((random >> 12) % 1000) * 0.5f };
+                QueuedQuad quad = {};
+                quad.instance = PackSpriteInstance(center, Vec2f{1.0f, 1.0f}, Vec4f{0.0f, 0.0f, 1.0f, 1.0f}, Vec4f{1.0f, 1.0f, 1.0f, 1.0f}, center.y - 0.5f);
+                quad.texture_id = 0;
+                QuadDrawQueuePush(&sprites, 2, quad.instance.depth, quad);
+            }
+
+            QuadDrawQueueSort(&sprites);
+            SpriteInstance* instances = (SpriteInstance*)RenderQueuePushInstances(&queue, 1, 1, 3, 0, sizeof(SpriteInstance), sprites.count);
+            if (!instances) {
+                return 1;
+            }
+            for (i32 i = 0; i < sprites.count; i++) {
+                instances[i] = sprites.quads[sprites.indices[i]].instance;
+            }
+            RenderQueueSubmit(&queue, &backend);
+            QuadDrawQueueClear(&sprites);
+        }
+        f64 elapsed_ms = TestNowMs() - start_ms;
+
+        printf("%8d %12.1f %12.3f %12d\n", sprite_count, elapsed_ms * 1e6 / ((f64)sprite_count * frame_count),
+            elapsed_ms / frame_count, (counters.draws + counters.instanced_draws) / frame_count);
+    }
+
+    QuadDrawQueueDestroy(&sprites);
+    RenderQueueDestroy(&queue);
+    return 0;
+}
@@ -0,0 +1,164 @@
+// Tests of the frame sprite path at its full budget: 131072 sprites sorted and recorded as instanced runs,
+// and 131072 plain quads split into draws of at most the index buffer size, all arriving intact and in order.
+
+// ----------
+// Includes
+
+#include <vector>
+
+#include "test.h"
+#include "../src/render_queue.h"
+
+// ---------
+// Defines
+
+const i32 SPRITE_BUDGET = 131072;
+const u32 MAX_QUADS_PER_DRAW = 16384;
+
+// ---------
+// Structs
+
+/**
+ * @brief Backend that keeps a copy of everything drawn, in draw order.
+ */
+struct RecordingBackend {
+    std::vector<SpriteInstance> instances;
+    std::vector<RectangleVertex> vertices;
+    u32 largest_draw = 0;
+    i32 draws = 0;
+};
+
+// --------------------------
+// Function implementations
+
+void RecordBindPipeline(void*, u32) {
+}
+
+void RecordBindTexture(void*, u32) {
+}
+
+void RecordDrawQuads(void* user_data, void* vertices, u32 vertex_stride, u32 quad_count) {
+    RecordingBackend* backend = (RecordingBackend*)user_data;
+    TEST_CHECK(vertex_stride == sizeof(RectangleVertex));
+    RectangleVertex* first = (RectangleVertex*)vertices;
+    backend->vertices.insert(backend->vertices.end(), first, first + quad_count * QUAD_VERTEX_COUNT);
+    backend->largest_draw = quad_count < backend->largest_draw ? backend->largest_draw : quad_count;
+    backend->draws++;
+}
+
+void RecordDrawStaticQuads(void*, u32, u32, u32) {
+}
+
+void RecordDrawInstances(void* user_data, void* instances, u32 instance_stride, u32 instance_count) {
+    RecordingBackend* backend = (RecordingBackend*)user_data;
+    TEST_CHECK(instance_stride == sizeof(SpriteInstance));
+    SpriteInstance* first = (SpriteInstance*)instances;
+    backend->instances.insert(backend->instances.end(), first, first + instance_count);
+    backend->draws++;
+}
+
+RenderBackend RecordingBackendCreate(RecordingBackend* recording) {
+    RenderBackend result = {
+        .user_data = recording,
+        .bind_pipeline = RecordBindPipeline,
+        .bind_texture = RecordBindTexture,
+        .draw_quads = RecordDrawQuads,
+        .draw_static_quads = RecordDrawStaticQuads,
+        .draw_instances = RecordDrawInstances
+    };
+    return result;
+}
+
+void TestInstancedSprites() {
+    QuadDrawQueue sprites = {};
+    RenderQueue queue = {};
+    TEST_CHECK(QuadDrawQueueCreate(&sprites, SPRITE_BUDGET));
+    TEST_CHECK(RenderQueueCreate(&queue, 1024, 1024, MAX_QUADS_PER_DRAW));
+
+    srand(7);
+    for (i32 i = 0; i < SPRITE_BUDGET; i++) {
+        f32 depth = (f32)(rand() % 4096) * 0.125f;
+        QueuedQuad quad = {};
+        quad.instance = PackSpriteInstance(Vec2f{(f32)i, depth + 0.5f}, Vec2f{1.0f, 1.0f}, Vec4f{0.0f, 0.0f, 1.0f, 1.0f}, Vec4f{1.0f, 1.0f, 1.0f, 1.0f}, depth);
+        quad.texture_id = 3;
+        TEST_CHECK(QuadDrawQueuePush(&sprites, 2, depth, quad));
+    }
+    TEST_CHECK(!QuadDrawQueuePush(&sprites, 2, 0.0f, QueuedQuad{}));
+
+    // What DrawQueuedSprites does, one run per texture change
+    QuadDrawQueueSort(&sprites);
+    u32 order = 0;
+    for (i32 run_start = 0; run_start < sprites.count;) {
+        u32 texture_id = DrawSortKeyTextureId(sprites.keys[run_start]);
+        i32 run_end = run_start + 1;
+        while (run_end < sprites.count && DrawSortKeyTextureId(sprites.keys[run_end]) == texture_id) {
+            run_end++;
+        }
+        SpriteInstance* instances = (SpriteInstance*)RenderQueuePushInstances(&queue, 1, ++order, 3, texture_id, sizeof(SpriteInstance), run_end - run_start);
+        if (TEST_CHECK(instances != nullptr)) {
+            for (i32 i = run_start; i < run_end; i++) {
+                instances[i - run_start] = sprites.quads[sprites.indices[i]].instance;
+            }
+        }
+        run_start = run_end;
+    }
+
+    RecordingBackend recording = {};
+    RenderBackend backend = RecordingBackendCreate(&recording);
+    RenderQueueSubmit(&queue, &backend);
+
+    // Every sprite exactly once, back to front
+    TEST_CHECK(recording.instances.size() == (size_t)SPRITE_BUDGET);
+    std::vector<bool> is_seen(SPRITE_BUDGET, false);
+    i32 order_errors = 0;
+    for (size_t i = 0; i < recording.instances.size(); i++) {
+        i32 id = (i32)recording.instances[i].center.x;
+        order_errors += is_seen[id] || (0 < i && recording.instances[i - 1].depth < recording.instances[i].depth) ? 1 : 0;
+        is_seen[id] = true;
+    }
+    TEST_CHECK(order_errors == 0);
+    TEST_CHECK(recording.draws == 1);
+
+    QuadDrawQueueDestroy(&sprites);
+    RenderQueueDestroy(&queue);
+}
+
+void TestSplitDraws() {
+    RenderQueue queue = {};
+    TEST_CHECK(RenderQueueCreate(&queue, 1024, 1024, MAX_QUADS_PER_DRAW));
+
+    // Pushed one quad at a time from a small vertex buffer that has to grow, like immediate mode shapes
+    for (i32 i = 0; i < SPRITE_BUDGET; i++) {
+        RectangleVertex* quad = (RectangleVertex*)RenderQueuePushQuads(&queue, 0, 0, 1, RENDER_TEXTURE_NONE, sizeof(RectangleVertex), 1);
+        if (!TEST_CHECK(quad != nullptr)) {
+            break;
+        }
+        for (i32 corner = 0; corner < QUAD_VERTEX_COUNT; corner++) {
+            quad[corner] = RectangleVertex{ Vec2f{(f32)i, (f32)corner}, (u32)i };
+        }
+    }
+    TEST_CHECK(queue.count == 1);
+
+    RecordingBackend recording = {};
+    RenderBackend backend = RecordingBackendCreate(&recording);
+    RenderQueueSubmit(&queue, &backend);
+
+    TEST_CHECK(recording.draws == SPRITE_BUDGET / (i32)MAX_QUADS_PER_DRAW);
+    TEST_CHECK(recording.largest_draw == MAX_QUADS_PER_DRAW);
+    TEST_CHECK(recording.vertices.size() == (size_t)SPRITE_BUDGET * QUAD_VERTEX_COUNT);
+
+    i32 mismatch_count = 0;
+    for (size_t i = 0; i < recording.vertices.size(); i++) {
+        RectangleVertex* vertex = &recording.vertices[i];
+        mismatch_count += vertex->color == i / QUAD_VERTEX_COUNT && vertex->position.y == (f32)(i % QUAD_VERTEX_COUNT) ? 0 : 1;
+    }
+    TEST_CHECK(mismatch_count == 0);
+
+    RenderQueueDestroy(&queue);
+}
+
+int main() {
+    TestInstancedSprites();
+    TestSplitDraws();
+    return TestReport("sprite_batch_test");
+}
@@ -0,0 +1,119 @@
+// Benchmark of the frame sprite step, queue, depth sort and record, with sprites recorded as four
+// TilemapTileVertex vertices each versus one packed 32 byte SpriteInstance each. All sprites share one atlas page.
+
+// ----------
+// Includes
+
+#include "test.h"
+#include "../src/render_queue.h"
+
+// ---------
+// Structs
+
+struct BenchSprite {
+    Vec2f center;
+    Vec2f size;
+    Vec4f uv_rect;
+    Vec4f color;
+    u32 texture_id;
+};
+
+// ---------
+// Globals
+
+QuadDrawQueue sprite_queue = {};
+RenderQueue render_queue = {};
+
+// --------------------------
+// Function implementations
+
+void QueueSprites(BenchSprite* sprites, i32 count) {
+    for (i32 i = 0; i < count; i++) {
+        BenchSprite* sprite = &sprites[i];
+        QueuedQuad quad = {};
+        quad.instance = PackSpriteInstance(sprite->center, sprite->size, sprite->uv_rect, sprite->color, sprite->center.y - sprite->size.y * 0.5f);
+        quad.texture_id = sprite->texture_id;
+        QuadDrawQueuePush(&sprite_queue, 2, quad.instance.depth, quad);
+    }
+    QuadDrawQueueSort(&sprite_queue);
+}
+
+/**
+ * @brief Record sorted runs with 'build_vertices' true for the vertex path and false for instances.
+ */
+void RecordSprites(bool build_vertices) {
+    u32 order = 0;
+    for (i32 run_start = 0; run_start < sprite_queue.count;) {
+        u32 texture_id = DrawSortKeyTextureId(sprite_queue.keys[run_start]);
+        i32 run_end = run_start + 1;
+        while (run_end < sprite_queue.count && DrawSortKeyTextureId(sprite_queue.keys[run_end]) == texture_id) {
+            run_end++;
+        }
+
+        order++;
+        if (build_vertices) {
+            TilemapTileVertex* vertices = (TilemapTileVertex*)RenderQueuePushQuads(&render_queue, 1, order, 0, texture_id, sizeof(TilemapTileVertex), run_end - run_start);
+            for (i32 i = run_start; vertices && i < run_end; i++) {
+                SpriteInstance* instance = &sprite_queue.quads[sprite_queue.indices[i]].instance;
+                Vec4f uv_rect = {
+                    (f32)(instance->uv[0] & 0xFFFF) / 65535.0f, (f32)(instance->uv[0] >> 16) / 65535.0f,
+                    (f32)(instance->uv[1] & 0xFFFF) / 65535.0f, (f32)(instance->uv[1] >> 16) / 65535.0f
+                };
+                BuildQuadVertices(&vertices[(i - run_start) * QUAD_VERTEX_COUNT], instance->center, instance->size, uv_rect, Vec4f{1.0f, 1.0f, 1.0f, 1.0f});
+            }
+        }
+        else {
+            SpriteInstance* instances = (SpriteInstance*)RenderQueuePushInstances(&render_queue, 1, order, 3, texture_id, sizeof(SpriteInstance), run_end - run_start);
+            for (i32 i = run_start; instances && i < run_end; i++) {
+                instances[i - run_start] = sprite_queue.quads[sprite_queue.indices[i]].instance;
+            }
+        }
+        run_start = run_end;
+    }
+}
+
+int main() {
+    const i32 sprite_budget = 131072;
+    const i32 frame_count = 20;
+
+    BenchSprite* sprites = (BenchSprite*)malloc(sizeof(BenchSprite) * sprite_budget);
+    if (!sprites || !QuadDrawQueueCreate(&sprite_queue, sprite_budget) || !RenderQueueCreate(&render_queue, 65536, sizeof(TilemapTileVertex) * QUAD_VERTEX_COUNT * sprite_budget, 16384)) {
+        return 1;
+    }
+    RenderNullBackendCounters counters = {};
+    RenderBackend backend = RenderNullBackendCreate(&counters);
+
+    srand(5);
+    for (i32 i = 0; i < sprite_budget; i++) {
+        sprites[i] = BenchSprite{
+            .center = { (f32)(rand() % 1000), (f32)(rand() % 1000) },
+            .size = { 1.0f, 1.0f },
+            .uv_rect = { 0.0f, 0.0f, 1.0f, 1.0f },
+            .color = { 1.0f, 1.0f, 1.0f, 1.0f },
+            .texture_id = 0
+        };
+    }
+
+    printf("%8s %18s %18s %8s\n", "sprites", "vertices ns/sprite", "instances ns/sprite", "speedup");
+    for (i32 sprite_count = 1024; sprite_count <= sprite_budget; sprite_count *= 2) {
+        f64 elapsed_ms[2] = {};
+        for (i32 path = 0; path < 2; path++) {
+            f64 start_ms = TestNowMs();
+            for (i32 frame = 0; frame < frame_count; frame++) {
+                QueueSprites(sprites, sprite_count);
+                RecordSprites(path == 0);
+                RenderQueueSubmit(&render_queue, &backend);
+                QuadDrawQueueClear(&sprite_queue);
+            }
+            elapsed_ms[path] = TestNowMs() - start_ms;
+        }
+
+        f64 sprite_total = (f64)sprite_count * frame_count;
+        printf("%8d %18.1f %18.1f %7.2fx\n", sprite_count, elapsed_ms[0] * 1e6 / sprite_total, elapsed_ms[1] * 1e6 / sprite_total, elapsed_ms[0] / elapsed_ms[1]);
+    }
+
+    free(sprites);
+    QuadDrawQueueDestroy(&sprite_queue);
+    RenderQueueDestroy(&render_queue);
+    return 0;
+}
@@ -0,0 +1,82 @@
+// Tests of instanced sprites: the vertex shader expansion of a packed SpriteInstance, emulated here, gives the
+// same corners, uvs and color as BuildQuadVertices, and the view cull test keeps sprites touching the view.
+
+// ----------
+// Includes
+
+#include <math.h>
+
+#include "test.h"
+#include "../src/quad_batch.h"
+#include "../src/sprite_instance.h"
+
+// --------------------------
+// Function implementations
+
+/**
+ * @brief Corner 'vertex_id' of 'instance' as the VSMain of the instanced sprite shader computes it.
+ */
+TilemapTileVertex ExpandSpriteInstance(SpriteInstance* instance, u32 vertex_id) {
+    f32 corner_x = (f32)(vertex_id & 1);
+    f32 corner_y = (f32)(vertex_id >> 1);
+    u16 u0 = (u16)(instance->uv[0] & 0xFFFF);
+    u16 v0 = (u16)(instance->uv[0] >> 16);
+    u16 u1 = (u16)(instance->uv[1] & 0xFFFF);
+    u16 v1 = (u16)(instance->uv[1] >> 16);
+
+    TilemapTileVertex result = {
+        .position = {
+            instance->center.x + (corner_x - 0.5f) * instance->size.x,
+            instance->center.y + (0.5f - corner_y) * instance->size.y
+        },
+        .color = instance->color,
+        .uv = { corner_x == 0.0f ? u0 : u1, corner_y == 0.0f ? v0 : v1 }
+    };
+    return result;
+}
+
+void TestExpansion() {
+    srand(5);
+    i32 mismatch_count = 0;
+    for (i32 i = 0; i < 1000; i++) {
+        Vec2f center = { (f32)(rand() % 1000) * 0.1f, (f32)(rand() % 1000) * 0.1f };
+        Vec2f size = { 1.0f + (f32)(rand() % 10), 1.0f + (f32)(rand() % 10) };
+        Vec4f uv_rect = { (f32)(rand() % 100) / 100.0f, (f32)(rand() % 100) / 100.0f, (f32)(rand() % 100) / 100.0f, (f32)(rand() % 100) / 100.0f };
+        Vec4f color = { 0.5f, 0.25f, 1.0f, (f32)(rand() % 256) / 255.0f };
+
+        TilemapTileVertex vertices[QUAD_VERTEX_COUNT];
+        BuildQuadVertices(vertices, center, size, uv_rect, color);
+        SpriteInstance instance = PackSpriteInstance(center, size, uv_rect, color, center.y);
+
+        for (u32 corner = 0; corner < QUAD_VERTEX_COUNT; corner++) {
+            TilemapTileVertex expanded = ExpandSpriteInstance(&instance, corner);
+            bool is_match = fabsf(expanded.position.x - vertices[corner].position.x) < 1e-4f
+                && fabsf(expanded.position.y - vertices[corner].position.y) < 1e-4f
+                && expanded.uv[0] == vertices[corner].uv[0]
+                && expanded.uv[1] == vertices[corner].uv[1]
+                && expanded.color == vertices[corner].color;
+            mismatch_count += is_match ? 0 : 1;
+        }
+    }
+    TEST_CHECK(mismatch_count == 0);
+}
+
+void TestCulling() {
+    SpriteCullRect view = SpriteCullRectFromView(Vec2f{0.0f, 0.0f}, Vec2f{20.0f, 10.0f});
+    TEST_CHECK(view.min.x == -10.0f && view.max.x == 10.0f && view.min.y == -5.0f && view.max.y == 5.0f);
+
+    TEST_CHECK(SpriteIsVisible(&view, Vec2f{0.0f, 0.0f}, Vec2f{1.0f, 1.0f}));
+    TEST_CHECK(SpriteIsVisible(&view, Vec2f{10.4f, 0.0f}, Vec2f{1.0f, 1.0f}));
+    TEST_CHECK(SpriteIsVisible(&view, Vec2f{10.5f, 0.0f}, Vec2f{1.0f, 1.0f}));
+    TEST_CHECK(!SpriteIsVisible(&view, Vec2f{10.6f, 0.0f}, Vec2f{1.0f, 1.0f}));
+    TEST_CHECK(!SpriteIsVisible(&view, Vec2f{0.0f, -5.6f}, Vec2f{1.0f, 1.0f}));
+
+    // Larger than the view and centered outside of it
+    TEST_CHECK(SpriteIsVisible(&view, Vec2f{0.0f, 20.0f}, Vec2f{100.0f, 40.0f}));
+}
+
+int main() {
+    TestExpansion();
+    TestCulling();
+    return TestReport("sprite_instance_test");
+}
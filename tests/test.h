@@ -0,0 +1,56 @@
+#pragma once
+
+// ----------
+// Includes
+
+#include <stdio.h>
+#include <chrono>
+
+#include "../src/types.h"
+
+// Minimal check and timing helpers shared by the headless tests and benchmarks, see tests/Makefile.
+
+// ---------
+// Defines
+
+#define TEST_CHECK(condition) TestCheck((condition), #condition, __FILE__, __LINE__)
+
+// ---------
+// Globals
+
+i32 test_check_count = 0;
+i32 test_failure_count = 0;
+
+// --------------------------
+// Function implementations
+
+/**
+ * @brief Record one check, printing it if it failed. Returns 'condition' so callers can stop early.
+ */
+bool TestCheck(bool condition, const char* expression, const char* file, i32 line) {
+    test_check_count++;
+    if (!condition) {
+        test_failure_count++;
+        fprintf(stderr, "%s:%d: check failed: %s\n", file, line, expression);
+    }
+    return condition;
+}
+
+/**
+ * @brief Print the result of a test program and return its exit code.
+ */
+int TestReport(const char* name) {
+    if (test_failure_count == 0) {
+        printf("%s: %d checks passed\n", name, test_check_count);
+        return 0;
+    }
+    printf("%s: %d of %d checks failed\n", name, test_failure_count, test_check_count);
+    return 1;
+}
+
+/**
+ * @brief Milliseconds since an arbitrary point, for benchmarks.
+ */
+f64 TestNowMs() {
+    return std::chrono::duration<f64, std::milli>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
@@ -0,0 +1,130 @@
+// Tests of batched text layout against the per glyph quads DrawTextToScreen drew before batching: the same
+// six corners per glyph once expanded through the quad index list, and the same end cursor.
+
+// ----------
+// Includes
+
+#include <math.h>
+
+#include "test.h"
+#include "../src/text_layout.h"
+
+// ---------
+// Structs
+
+/**
+ * @brief Corner of a glyph triangle as the old per glyph path wrote it, before UVs were packed.
+ */
+struct ReferenceTextVertex {
+    Vec2f position;
+    f32 u;
+    f32 v;
+};
+
+// --------------------------
+// Function implementations
+
+/**
+ * @brief Old DrawTextToScreen loop: two triangles, six vertices, for every glyph. Returns glyph count.
+ */
+i32 ReferenceLayout(const char* text, Vec2f screen_pos, FontGlyphInfo* glyphs, i32 font_size_px, Vec2i viewport, ReferenceTextVertex* out, Vec2f* end_cursor) {
+    Vec2f cursor = screen_pos;
+    i32 glyph_count = 0;
+
+    for (const char* p = text; *p != '\0'; p++) {
+        if (*p == '\n') {
+            cursor.x = screen_pos.x;
+            cursor.y += font_size_px;
+            continue;
+        }
+
+        FontGlyphInfo glyph = glyphs[*p - 32];
+        i32 px_x0 = cursor.x + glyph.x_offset;
+        i32 px_x1 = px_x0 + glyph.bitmap_width;
+        i32 px_y0 = cursor.y - glyph.y_offset;
+        i32 px_y1 = px_y0 + glyph.bitmap_height;
+        cursor.x += glyph.advance;
+
+        // Zero sized glyphs, like space, were degenerate triangles that drew nothing
+        if (glyph.bitmap_width == 0 || glyph.bitmap_height == 0) {
+            continue;
+        }
+
+        Vec2f top_left = ScreenPxToNDC({px_x0, px_y0}, viewport);
+        Vec2f top_right = ScreenPxToNDC({px_x1, px_y0}, viewport);
+        Vec2f bot_left = ScreenPxToNDC({px_x0, px_y1}, viewport);
+        Vec2f bot_right = ScreenPxToNDC({px_x1, px_y1}, viewport);
+
+        ReferenceTextVertex* vertices = &out[glyph_count * 6];
+        vertices[0] = { top_left, glyph.uv_x0, glyph.uv_y0 };
+        vertices[1] = { top_right, glyph.uv_x1, glyph.uv_y0 };
+        vertices[2] = { bot_left, glyph.uv_x0, glyph.uv_y1 };
+        vertices[3] = { bot_left, glyph.uv_x0, glyph.uv_y1 };
+        vertices[4] = { top_right, glyph.uv_x1, glyph.uv_y0 };
+        vertices[5] = { bot_right, glyph.uv_x1, glyph.uv_y1 };
+        glyph_count++;
+    }
+
+    *end_cursor = cursor;
+    return glyph_count;
+}
+
+int main() {
+    FontGlyphInfo glyphs[FONT_GLYPH_COUNT];
+    for (i32 i = 0; i < FONT_GLYPH_COUNT; i++) {
+        bool is_space = i == 0;
+        glyphs[i] = FontGlyphInfo{
+            .bitmap_width = is_space ? 0 : 3 + i % 7,
+            .bitmap_height = is_space ? 0 : 4 + i % 5,
+            .x_offset = i % 3,
+            .y_offset = i % 4,
+            .advance = 0.5f + (f32)(i % 9),
+            .uv_x0 = (f32)i / FONT_GLYPH_COUNT,
+            .uv_y0 = 0.1f,
+            .uv_x1 = (f32)(i + 1) / FONT_GLYPH_COUNT,
+            .uv_y1 = 0.2f,
+            .character = (char)(i + FONT_FIRST_GLYPH)
+        };
+    }
+
+    const char* text = "Camera x: 12.5, Camera y: -3.0\nDraw calls: 42\n\n~Frame time {ms}: 16.6";
+    Vec2i viewport = { 1600, 1200 };
+    Vec2f screen_pos = { 5.0f, 18.0f };
+    i32 length = (i32)strlen(text);
+
+    TextUiVertex* vertices = (TextUiVertex*)malloc(sizeof(TextUiVertex) * QUAD_VERTEX_COUNT * length);
+    ReferenceTextVertex* reference = (ReferenceTextVertex*)malloc(sizeof(ReferenceTextVertex) * 6 * length);
+
+    Vec2f end_cursor = {};
+    Vec2f reference_end_cursor = {};
+    i32 quad_count = TextLayoutString((char*)text, screen_pos, glyphs, 16, viewport, vertices, &end_cursor);
+    i32 reference_count = ReferenceLayout(text, screen_pos, glyphs, 16, viewport, reference, &reference_end_cursor);
+
+    TEST_CHECK(quad_count == reference_count);
+    TEST_CHECK(end_cursor.x == reference_end_cursor.x && end_cursor.y == reference_end_cursor.y);
+
+    u32 indices[QUAD_INDEX_COUNT];
+    FillQuadIndices(indices, 1);
+    i32 mismatch_count = 0;
+    for (i32 quad = 0; quad < quad_count && quad < reference_count; quad++) {
+        for (i32 corner = 0; corner < QUAD_INDEX_COUNT; corner++) {
+            TextUiVertex* vertex = &vertices[quad * QUAD_VERTEX_COUNT + indices[corner]];
+            ReferenceTextVertex* expected = &reference[quad * 6 + corner];
+            bool is_same = vertex->position.x == expected->position.x
+                && vertex->position.y == expected->position.y
+                && fabsf(vertex->uv[0] / 65535.0f - expected->u) <= 0.5f / 65535.0f
+                && fabsf(vertex->uv[1] / 65535.0f - expected->v) <= 0.5f / 65535.0f;
+            mismatch_count += is_same ? 0 : 1;
+        }
+    }
+    TEST_CHECK(mismatch_count == 0);
+
+    // Characters outside the font produce nothing and do not move the cursor
+    TextLayoutCursor cursor = TextLayoutBegin(screen_pos);
+    TEST_CHECK(!TextLayoutGlyph(&cursor, (char)200, glyphs, 16, viewport, vertices));
+    TEST_CHECK(cursor.position.x == screen_pos.x);
+
+    free(vertices);
+    free(reference);
+    return TestReport("text_layout_test");
+}
@@ -0,0 +1,272 @@
+// Tests of the text run cache: a repeated string is a hit with the quads of a fresh layout, least recently used
+// runs go first under the byte budget and the run cap, a key whose text differs is rejected, NaN and negative
+// zero positions find their own runs, and a run larger than the whole budget is laid out but not stored.
+
+// ----------
+// Includes
+
+#include <math.h>
+#include <stdlib.h>
+
+#include "test.h"
+#include "../src/text_run_cache.h"
+
+// ---------
+// Defines
+
+const i32 TEST_FONT_SIZE_PX = 16;
+const Vec2i TEST_VIEWPORT = { 1600, 1200 };
+
+// ---------
+// Globals
+
+FontGlyphInfo test_glyphs[FONT_GLYPH_COUNT];
+TextUiVertex test_scratch[256 * QUAD_VERTEX_COUNT];
+
+// --------------------------
+// Function implementations
+
+void InitTestGlyphs() {
+    for (i32 i = 0; i < FONT_GLYPH_COUNT; i++) {
+        bool is_space = i == 0;
+        test_glyphs[i] = FontGlyphInfo{
+            .bitmap_width = is_space ? 0 : 3 + i % 7,
+            .bitmap_height = is_space ? 0 : 4 + i % 5,
+            .x_offset = i % 3,
+            .y_offset = i % 4,
+            .advance = 0.5f + (f32)(i % 9),
+            .uv_x0 = (f32)i / FONT_GLYPH_COUNT,
+            .uv_y0 = 0.1f,
+            .uv_x1 = (f32)(i + 1) / FONT_GLYPH_COUNT,
+            .uv_y1 = 0.2f,
+            .character = (char)(i + FONT_FIRST_GLYPH)
+        };
+    }
+}
+
+TextRunView TestLayout(TextRunCache* cache, const char* text, Vec2f position) {
+    return TextRunCacheLayout(cache, (char*)text, position, 1, test_glyphs, TEST_FONT_SIZE_PX, TEST_VIEWPORT, test_scratch);
+}
+
+/**
+ * @brief True if a lookup of 'text' would hit, without touching the run or the hit counters.
+ */
+bool IsCached(TextRunCache* cache, const char* text, Vec2f position) {
+    TextRunKey key = TextRunMakeKey((char*)text, 1, position, TEST_VIEWPORT);
+    return cache->run_index[TextRunCacheFindIndexSlot(cache, &key, (char*)text)] != TEXT_RUN_SLOT_EMPTY;
+}
+
+/**
+ * @brief Every index slot points at a used run, and every used run is in the index once.
+ */
+bool IsIndexConsistent(TextRunCache* cache) {
+    i32 indexed_count = 0;
+    for (u32 slot = 0; slot <= cache->run_index_mask; slot++) {
+        i32 run_id = cache->run_index[slot];
+        if (run_id == TEXT_RUN_SLOT_EMPTY) {
+            continue;
+        }
+        if (!cache->runs[run_id].is_used) {
+            return false;
+        }
+        indexed_count++;
+    }
+
+    size_t bytes_used = 0;
+    i32 used_count = 0;
+    for (i32 i = 0; i < cache->run_capacity; i++) {
+        if (cache->runs[i].is_used) {
+            bytes_used += cache->runs[i].byte_size;
+            used_count++;
+        }
+    }
+    return indexed_count == cache->run_count && used_count == cache->run_count && bytes_used == cache->bytes_used;
+}
+
+size_t RunByteSize(const char* text) {
+    size_t quad_count = 0;
+    for (const char* p = text; *p != '\0'; p++) {
+        quad_count += *p != ' ' && *p != '\n' ? 1 : 0;
+    }
+    return sizeof(TextUiVertex) * QUAD_VERTEX_COUNT * quad_count + strlen(text);
+}
+
+void TestHitAndMiss() {
+    TextRunCache cache;
+    TEST_CHECK(TextRunCacheCreate(&cache, 16, 64 * 1024));
+
+    const char* text = "Draw calls: 42\nFrames: 1000";
+    Vec2f position = { 5.0f, 18.0f };
+    TextUiVertex expected[64 * QUAD_VERTEX_COUNT];
+    Vec2f expected_end = {};
+    i32 expected_count = TextLayoutString((char*)text, position, test_glyphs, TEST_FONT_SIZE_PX, TEST_VIEWPORT, expected, &expected_end);
+
+    TextRunView miss = TestLayout(&cache, text, position);
+    TEST_CHECK(miss.vertices == test_scratch && cache.misses == 1 && cache.run_count == 1);
+    memset(test_scratch, 0, sizeof(test_scratch));
+
+    // The hit hands back the stored copy, not the scratch memory a later layout overwrites
+    TextRunView hit = TestLayout(&cache, text, position);
+    TEST_CHECK(hit.vertices != test_scratch && cache.hits == 1);
+    TEST_CHECK(hit.quad_count == expected_count && hit.end_cursor.x == expected_end.x && hit.end_cursor.y == expected_end.y);
+    TEST_CHECK(memcmp(hit.vertices, expected, sizeof(TextUiVertex) * QUAD_VERTEX_COUNT * expected_count) == 0);
+    TEST_CHECK(TextRunCacheHitRate(&cache) == 0.5f);
+
+    // Every part of the key tells runs apart
+    TestLayout(&cache, text, { 6.0f, 18.0f });
+    TextRunCacheLayout(&cache, (char*)text, position, 2, test_glyphs, TEST_FONT_SIZE_PX, TEST_VIEWPORT, test_scratch);
+    TextRunCacheLayout(&cache, (char*)text, position, 1, test_glyphs, TEST_FONT_SIZE_PX, { 800, 600 }, test_scratch);
+    TestLayout(&cache, "Draw calls: 43\nFrames: 1000", position);
+    TEST_CHECK(cache.misses == 5 && cache.run_count == 5);
+
+    // An empty string is a run without quads
+    TestLayout(&cache, "", position);
+    TEST_CHECK(TestLayout(&cache, "", position).quad_count == 0 && cache.hits == 2);
+    TEST_CHECK(IsIndexConsistent(&cache));
+
+    TextRunCacheResetStats(&cache);
+    TEST_CHECK(cache.hits == 0 && cache.misses == 0 && TextRunCacheHitRate(&cache) == 0.0f);
+    TextRunCacheDestroy(&cache);
+}
+
+void TestByteBudget() {
+    // Room for three runs of the same size
+    const char* texts[] = { "Frames: 1001", "Frames: 1002", "Frames: 1003", "Frames: 1004" };
+    size_t run_bytes = RunByteSize(texts[0]);
+    TextRunCache cache;
+    TEST_CHECK(TextRunCacheCreate(&cache, 16, run_bytes * 3));
+    Vec2f position = { 5.0f, 18.0f };
+
+    TestLayout(&cache, texts[0], position);
+    TestLayout(&cache, texts[1], position);
+    TestLayout(&cache, texts[2], position);
+    TEST_CHECK(cache.bytes_used == run_bytes * 3);
+
+    // Using the first run again makes the second the least recently used
+    TestLayout(&cache, texts[0], position);
+    TestLayout(&cache, texts[3], position);
+    TEST_CHECK(IsCached(&cache, texts[0], position) && !IsCached(&cache, texts[1], position));
+    TEST_CHECK(IsCached(&cache, texts[2], position) && IsCached(&cache, texts[3], position));
+    TEST_CHECK(cache.bytes_used <= cache.byte_budget && IsIndexConsistent(&cache));
+
+    // A longer run takes the room of several short ones
+    const char* longer = "Frames: 1005, Frames: 1006";
+    TEST_CHECK(RunByteSize(longer) <= cache.byte_budget);
+    TestLayout(&cache, longer, position);
+    TEST_CHECK(IsCached(&cache, longer, position) && cache.bytes_used <= cache.byte_budget);
+    TEST_CHECK(!IsCached(&cache, texts[2], position) && IsIndexConsistent(&cache));
+    TextRunCacheDestroy(&cache);
+}
+
+void TestRunCap() {
+    // The game caps runs at TEXT_RUN_CACHE_MAX_RUNS through 'run_capacity', the budget never binds here
+    const i32 run_capacity = 8;
+    TextRunCache cache;
+    TEST_CHECK(TextRunCacheCreate(&cache, run_capacity, 1024 * 1024));
+
+    char text[32];
+    for (i32 i = 0; i < 1000; i++) {
+        snprintf(text, sizeof(text), "Mouse x: %d", i);
+        TestLayout(&cache, text, { 5.0f, 18.0f });
+
+        // Runs used every frame stay while one-off strings churn through the rest
+        TestLayout(&cache, "Frames: 60", { 5.0f, 18.0f });
+        TestLayout(&cache, "Draw calls: 3", { 5.0f, 34.0f });
+        TEST_CHECK(cache.run_count <= run_capacity);
+    }
+    TEST_CHECK(cache.run_count == run_capacity && IsIndexConsistent(&cache));
+    TEST_CHECK(IsCached(&cache, "Frames: 60", { 5.0f, 18.0f }) && IsCached(&cache, "Draw calls: 3", { 5.0f, 34.0f }));
+    TEST_CHECK(IsCached(&cache, "Mouse x: 999", { 5.0f, 18.0f }) && !IsCached(&cache, "Mouse x: 0", { 5.0f, 18.0f }));
+    TEST_CHECK(cache.hits == 2 * 1000 - 2);
+    TextRunCacheDestroy(&cache);
+}
+
+void TestCollision() {
+    TextRunCache cache;
+    TEST_CHECK(TextRunCacheCreate(&cache, 16, 64 * 1024));
+    Vec2f position = { 5.0f, 18.0f };
+    TestLayout(&cache, "Camera x: 1.0", position);
+
+    // Same hash, length, font and position as the stored run, only the text differs
+    TextRunKey key = TextRunMakeKey((char*)"Camera x: 1.0", 1, position, TEST_VIEWPORT);
+    TEST_CHECK(TextRunCacheFind(&cache, &key, (char*)"Camera x: 2.0") == nullptr);
+    TEST_CHECK(TextRunCacheFind(&cache, &key, (char*)"Camera x: 1.0") != nullptr);
+
+    // The colliding text is stored next to the original instead of replacing it
+    TEST_CHECK(TextRunCacheInsert(&cache, &key, (char*)"Camera x: 2.0", test_scratch, 0, position) != nullptr);
+    TextRun* original = TextRunCacheFind(&cache, &key, (char*)"Camera x: 1.0");
+    TextRun* colliding = TextRunCacheFind(&cache, &key, (char*)"Camera x: 2.0");
+    TEST_CHECK(original && colliding && original != colliding && colliding->quad_count == 0);
+    TEST_CHECK(cache.run_count == 2 && IsIndexConsistent(&cache));
+    TextRunCacheDestroy(&cache);
+}
+
+void TestPositionBits() {
+    TextRunCache cache;
+    TEST_CHECK(TextRunCacheCreate(&cache, 4, 64 * 1024));
+
+    // Negative zero is the same position as zero and shares its run
+    TestLayout(&cache, "Frames: 1", { 0.0f, 18.0f });
+    TestLayout(&cache, "Frames: 1", { -0.0f, 18.0f });
+    TEST_CHECK(cache.run_count == 1 && cache.hits == 1);
+
+    // A NaN position finds its own run again, and evicting it removes its index entry
+    Vec2f nan_position = { nanf(""), 18.0f };
+    TestLayout(&cache, "Frames: 2", nan_position);
+    TestLayout(&cache, "Frames: 2", nan_position);
+    TEST_CHECK(cache.run_count == 2 && cache.hits == 2);
+    char text[32];
+    for (i32 i = 0; i < 16; i++) {
+        snprintf(text, sizeof(text), "Frames: %d", 100 + i);
+        TestLayout(&cache, text, { 5.0f, 18.0f });
+        TEST_CHECK(IsIndexConsistent(&cache));
+    }
+    TEST_CHECK(!IsCached(&cache, "Frames: 2", nan_position));
+
+    TestLayout(&cache, "Frames: 2", nan_position);
+    TextRunCacheClear(&cache);
+    TEST_CHECK(cache.run_count == 0 && cache.bytes_used == 0 && IsIndexConsistent(&cache));
+    TextRunCacheDestroy(&cache);
+}
+
+void TestClearAndOverBudget() {
+    const char* text = "Window width: 1600, Window height: 1200";
+    Vec2f position = { 5.0f, 18.0f };
+    TextRunCache cache;
+    TEST_CHECK(TextRunCacheCreate(&cache, 16, RunByteSize(text) - 1));
+
+    // A run larger than the whole budget is laid out every time and never stored
+    TextUiVertex expected[64 * QUAD_VERTEX_COUNT];
+    Vec2f expected_end = {};
+    i32 expected_count = TextLayoutString((char*)text, position, test_glyphs, TEST_FONT_SIZE_PX, TEST_VIEWPORT, expected, &expected_end);
+    TextRunKey key = TextRunMakeKey((char*)text, 1, position, TEST_VIEWPORT);
+    TEST_CHECK(TextRunCacheInsert(&cache, &key, (char*)text, expected, expected_count, expected_end) == nullptr);
+    TextRunView view = TestLayout(&cache, text, position);
+    TEST_CHECK(view.vertices == test_scratch && view.quad_count == expected_count);
+    TEST_CHECK(memcmp(view.vertices, expected, sizeof(TextUiVertex) * QUAD_VERTEX_COUNT * expected_count) == 0);
+    TestLayout(&cache, text, position);
+    TEST_CHECK(cache.run_count == 0 && cache.bytes_used == 0 && cache.misses == 2);
+
+    // Clearing drops every run and the cache fills again afterwards
+    TestLayout(&cache, "Frames: 1", position);
+    TestLayout(&cache, "Frames: 2", position);
+    TEST_CHECK(cache.run_count == 2);
+    TextRunCacheClear(&cache);
+    TEST_CHECK(cache.run_count == 0 && cache.bytes_used == 0 && IsIndexConsistent(&cache));
+    TEST_CHECK(!IsCached(&cache, "Frames: 1", position));
+    TestLayout(&cache, "Frames: 1", position);
+    TEST_CHECK(IsCached(&cache, "Frames: 1", position) && IsIndexConsistent(&cache));
+    TextRunCacheDestroy(&cache);
+    TEST_CHECK(cache.runs == nullptr && cache.run_index == nullptr);
+}
+
+int main() {
+    InitTestGlyphs();
+    TestHitAndMiss();
+    TestByteBudget();
+    TestRunCap();
+    TestCollision();
+    TestPositionBits();
+    TestClearAndOverBudget();
+    return TestReport("text_run_cache_test");
+}
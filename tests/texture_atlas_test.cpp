@@ -0,0 +1,208 @@
+// Tests of atlas manifests: every region resolves by name to its rectangle and UVs, missing names miss on a
+// nearly full slot table, and manifests without an empty slot, with zero sized pages or with out of range
+// fields are rejected.
+
+// ----------
+// Includes
+
+#include <stdlib.h>
+#include <string>
+#include <vector>
+
+#include "test.h"
+#include "../src/texture_atlas.h"
+
+// ---------
+// Structs
+
+struct TestRegion {
+    std::string name;
+    u16 page;
+    u16 x;
+    u16 y;
+    u16 width;
+    u16 height;
+};
+
+// --------------------------
+// Function implementations
+
+/**
+ * @brief Manifest of 'regions' on 'page_count' pages of 256 x 128 pixels, laid out the way tools/atlas_packer.cpp writes it.
+ */
+std::vector<byte> CreateTestAtlas(const std::vector<TestRegion>& regions, u32 page_count, u32 slot_count) {
+    u32 region_count = (u32)regions.size();
+    std::vector<std::string> page_names;
+    u32 string_bytes = 0;
+    for (u32 i = 0; i < page_count; i++) {
+        page_names.push_back("sprites_" + std::to_string(i) + ".png");
+        string_bytes += (u32)page_names[i].size() + 1;
+    }
+    for (const TestRegion& region : regions) {
+        string_bytes += (u32)region.name.size() + 1;
+    }
+    string_bytes = (string_bytes + 3) & ~3u;
+
+    std::vector<byte> file(TextureAtlasManifestSize(page_count, region_count, slot_count, string_bytes), 0);
+    TextureAtlasHeader* header = (TextureAtlasHeader*)file.data();
+    *header = { TEXTURE_ATLAS_MAGIC, TEXTURE_ATLAS_VERSION, page_count, region_count, slot_count, string_bytes, {} };
+    TextureAtlasPage* pages = (TextureAtlasPage*)(header + 1);
+    TextureAtlasRegion* out_regions = (TextureAtlasRegion*)(pages + page_count);
+    u32* slots = (u32*)(out_regions + region_count);
+    char* strings = (char*)(slots + slot_count);
+    for (u32 i = 0; i < slot_count; i++) {
+        slots[i] = TEXTURE_ATLAS_SLOT_EMPTY;
+    }
+
+    u32 string_offset = 0;
+    for (u32 i = 0; i < page_count; i++) {
+        pages[i] = { string_offset, 256, 128 };
+        memcpy(strings + string_offset, page_names[i].c_str(), page_names[i].size() + 1);
+        string_offset += (u32)page_names[i].size() + 1;
+    }
+    for (u32 i = 0; i < region_count; i++) {
+        const TestRegion& region = regions[i];
+        u64 hash = TextureAtlasHashName(region.name.c_str());
+        out_regions[i] = { hash, string_offset, region.page, 0, region.x, region.y, region.width, region.height };
+        memcpy(strings + string_offset, region.name.c_str(), region.name.size() + 1);
+        string_offset += (u32)region.name.size() + 1;
+
+        u32 slot = (u32)hash & (slot_count - 1);
+        while (slots[slot] != TEXTURE_ATLAS_SLOT_EMPTY) {
+            slot = (slot + 1) & (slot_count - 1);
+        }
+        slots[slot] = i;
+    }
+    return file;
+}
+
+/**
+ * @brief Load a malloc copy of 'file' like the game does. The copy is freed if the manifest is rejected.
+ */
+bool LoadTestAtlas(TextureAtlas* atlas, const std::vector<byte>& file) {
+    byte* data = (byte*)malloc(file.size());
+    memcpy(data, file.data(), file.size());
+    if (!TextureAtlasLoadFromMemory(atlas, data, file.size())) {
+        free(data);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief True if the manifest is rejected. One that loads is destroyed again.
+ */
+bool IsRejected(const std::vector<byte>& file) {
+    TextureAtlas atlas;
+    if (LoadTestAtlas(&atlas, file)) {
+        TextureAtlasDestroy(&atlas);
+        return false;
+    }
+    return atlas.header == nullptr;
+}
+
+std::vector<TestRegion> CreateTestRegions(i32 count) {
+    std::vector<TestRegion> regions;
+    for (i32 i = 0; i < count; i++) {
+        regions.push_back({ "hero_" + std::to_string(i), (u16)(i % 2), (u16)(i % 16 * 16), (u16)(i / 16 % 8 * 16), 16, (u16)(8 + i % 9) });
+    }
+    return regions;
+}
+
+void TestLookups() {
+    // 60 regions in 64 slots leave long probe chains
+    std::vector<TestRegion> regions = CreateTestRegions(60);
+    TextureAtlas atlas;
+    if (!TEST_CHECK(LoadTestAtlas(&atlas, CreateTestAtlas(regions, 2, 64)))) {
+        return;
+    }
+
+    i32 mismatch_count = 0;
+    for (const TestRegion& expected : regions) {
+        TextureAtlasRegion* region = TextureAtlasFind(&atlas, expected.name.c_str());
+        bool is_same = region && region->page == expected.page && region->x == expected.x && region->y == expected.y
+            && region->width == expected.width && region->height == expected.height
+            && strcmp(TextureAtlasRegionName(&atlas, region), expected.name.c_str()) == 0;
+        mismatch_count += is_same ? 0 : 1;
+    }
+    TEST_CHECK(mismatch_count == 0);
+    TEST_CHECK(strcmp(TextureAtlasPageName(&atlas, 1), "sprites_1.png") == 0);
+
+    // hero_17 is 16 x 16 at (16, 16) of a 256 x 128 page
+    TextureAtlasRegion* region = TextureAtlasFind(&atlas, "hero_17");
+    if (TEST_CHECK(region != nullptr)) {
+        Vec4f uv = TextureAtlasRegionUVRect(&atlas, region);
+        TEST_CHECK(region->page == 1 && uv.x == 16.0f / 256.0f && uv.y == 16.0f / 128.0f);
+        TEST_CHECK(uv.z == 32.0f / 256.0f && uv.w == 32.0f / 128.0f);
+    }
+
+    // Names are matched exactly, a miss ends at an empty slot
+    i32 false_hit_count = 0;
+    for (i32 i = 0; i < 1000; i++) {
+        std::string missing = "villain_" + std::to_string(i);
+        false_hit_count += TextureAtlasFind(&atlas, missing.c_str()) ? 1 : 0;
+    }
+    TEST_CHECK(false_hit_count == 0);
+    TEST_CHECK(TextureAtlasFind(&atlas, "Hero_17") == nullptr && TextureAtlasFind(&atlas, "hero_") == nullptr);
+    TEST_CHECK(TextureAtlasFind(&atlas, "") == nullptr);
+
+    TextureAtlasDestroy(&atlas);
+    TEST_CHECK(atlas.header == nullptr && TextureAtlasFind(&atlas, "hero_17") == nullptr);
+}
+
+void TestInvalidManifests() {
+    // Regions are on the first two pages, the third has none
+    std::vector<byte> file = CreateTestAtlas(CreateTestRegions(3), 3, 4);
+    TextureAtlas atlas;
+    TEST_CHECK(LoadTestAtlas(&atlas, file));
+    TextureAtlasDestroy(&atlas);
+
+    // Every slot taken, a miss would probe forever. The header still claims fewer regions than slots
+    std::vector<byte> full = file;
+    TextureAtlasHeader* header = (TextureAtlasHeader*)full.data();
+    u32* slots = (u32*)((byte*)full.data() + TextureAtlasManifestSize(header->page_count, header->region_count, 0, 0));
+    for (u32 i = 0; i < header->slot_count; i++) {
+        if (slots[i] == TEXTURE_ATLAS_SLOT_EMPTY) {
+            slots[i] = 0;
+        }
+    }
+    TEST_CHECK(IsRejected(full));
+
+    // Zero sized pages would divide by zero in the UVs, even one that no region bounds check reaches
+    for (i32 i = 0; i < 2; i++) {
+        std::vector<byte> corrupt = file;
+        TextureAtlasPage* page = (TextureAtlasPage*)(corrupt.data() + sizeof(TextureAtlasHeader)) + 2;
+        if (i == 0) {
+            page->width = 0;
+        }
+        else {
+            page->height = 0;
+        }
+        TEST_CHECK(IsRejected(corrupt));
+    }
+
+    for (i32 i = 0; i < 7; i++) {
+        std::vector<byte> corrupt = file;
+        TextureAtlasHeader* corrupt_header = (TextureAtlasHeader*)corrupt.data();
+        TextureAtlasRegion* regions = (TextureAtlasRegion*)(corrupt.data() + sizeof(TextureAtlasHeader) + sizeof(TextureAtlasPage) * 3);
+        switch (i) {
+            case 0: corrupt_header->magic = 0; break;
+            case 1: corrupt_header->slot_count = 3; break;
+            case 2: corrupt_header->region_count = 4; break;
+            case 3: corrupt_header->string_bytes += 4; break;
+            case 4: regions[1].page = 3; break;
+            case 5: regions[2].x = 250; break;
+            case 6: regions[0].name_offset = corrupt_header->string_bytes; break;
+        }
+        TEST_CHECK(IsRejected(corrupt));
+    }
+    for (size_t cut = 0; cut < file.size(); cut++) {
+        TEST_CHECK(IsRejected(std::vector<byte>(file.begin(), file.begin() + cut)));
+    }
+}
+
+int main() {
+    TestLookups();
+    TestInvalidManifests();
+    return TestReport("texture_atlas_test");
+}
@@ -0,0 +1,269 @@
+// Tests of texture residency against a simulated backend: tails load before larger levels, a texture that fits
+// reaches level 0 with one load, loads past the per-update limit keep room for their next level, the budget
+// holds while the working set moves, and eviction takes the least recently used textures first.
+
+// ----------
+// Includes
+
+#include <stdlib.h>
+
+#include "test.h"
+#include "../src/texture_residency.h"
+
+// ---------
+// Structs
+
+/**
+ * @brief Backend that finishes loads after 'latency' updates and logs what it was asked to do.
+ */
+struct TestResidencyBackend {
+    TextureResidency* residency;
+    i32 latency;
+    i32 resident_levels[256];
+    i32 pending_levels[256];
+    i32 pending_updates[256];
+    u64 used_frames[256];
+    i32 load_textures[1024];
+    i32 load_levels[1024];
+    i32 load_count;
+    i32 evicted_textures[1024];
+    i32 eviction_count;
+};
+
+// --------------------------
+// Function implementations
+
+void TestBackendLoad(void* user_data, u32 texture, i32 top_level) {
+    TestResidencyBackend* backend = (TestResidencyBackend*)user_data;
+    TEST_CHECK(backend->pending_updates[texture] == 0);
+    TEST_CHECK(top_level < backend->resident_levels[texture]);
+    if (backend->load_count < 1024) {
+        backend->load_textures[backend->load_count] = (i32)texture;
+        backend->load_levels[backend->load_count] = top_level;
+    }
+    backend->load_count++;
+
+    if (backend->latency == 0) {
+        backend->resident_levels[texture] = top_level;
+        TextureResidencyLoaded(backend->residency, texture, top_level);
+        return;
+    }
+    backend->pending_levels[texture] = top_level;
+    backend->pending_updates[texture] = backend->latency;
+}
+
+bool TestBackendEvict(void* user_data, u32 texture, i32 top_level) {
+    TestResidencyBackend* backend = (TestResidencyBackend*)user_data;
+    TEST_CHECK(backend->used_frames[texture] != backend->residency->frame);
+    TEST_CHECK(backend->resident_levels[texture] < top_level);
+    backend->resident_levels[texture] = top_level;
+    if (backend->eviction_count < 1024) {
+        backend->evicted_textures[backend->eviction_count] = (i32)texture;
+    }
+    backend->eviction_count++;
+    return true;
+}
+
+/**
+ * @brief Finish the loads whose latency ran out, call once per update.
+ */
+void TestBackendTick(TestResidencyBackend* backend) {
+    for (u32 texture = 0; texture < 256; texture++) {
+        if (backend->pending_updates[texture] != 0 && --backend->pending_updates[texture] == 0) {
+            backend->resident_levels[texture] = backend->pending_levels[texture];
+            TextureResidencyLoaded(backend->residency, texture, backend->pending_levels[texture]);
+        }
+    }
+}
+
+void TestBackendTouch(TestResidencyBackend* backend, u32 texture) {
+    TextureResidencyTouch(backend->residency, texture);
+    backend->used_frames[texture] = backend->residency->frame;
+}
+
+/**
+ * @brief Level sizes of a square RGBA texture. Returns the level count.
+ */
+i32 TestRgbaLevels(u64* level_bytes, i32 size) {
+    i32 level_count = 0;
+    for (;;) {
+        level_bytes[level_count++] = (u64)size * size * 4;
+        if (size == 1) {
+            return level_count;
+        }
+        size /= 2;
+    }
+}
+
+/**
+ * @brief Track 'count' untouched square textures with only 'resident_level' and below resident, -1 for nothing.
+ */
+void TestTrackTextures(TestResidencyBackend* backend, i32 count, i32 size, i32 resident_level) {
+    u64 level_bytes[MIPMAP_MAX_LEVELS];
+    i32 level_count = TestRgbaLevels(level_bytes, size);
+    for (i32 texture = 0; texture < count; texture++) {
+        i32 level = resident_level < 0 ? level_count : resident_level;
+        TextureResidencyTrack(backend->residency, texture, level_bytes, level_count, level);
+        backend->resident_levels[texture] = level;
+    }
+}
+
+void TestOneLoadWhenItFits() {
+    TextureResidency residency;
+    TEST_CHECK(TextureResidencyCreate(&residency, 256, 64ull << 20, 2));
+    TestResidencyBackend* backend = (TestResidencyBackend*)calloc(1, sizeof(TestResidencyBackend));
+    backend->residency = &residency;
+    TextureResidencyBackend callbacks = { backend, TestBackendLoad, TestBackendEvict };
+
+    // Two 1024 x 1024 textures fit the budget many times over, each is read once straight to level 0
+    TestTrackTextures(backend, 2, 1024, -1);
+    TEST_CHECK(residency.entries[0].tail_level == 4);
+    for (i32 update = 0; update < 8; update++) {
+        TestBackendTouch(backend, 0);
+        TestBackendTouch(backend, 1);
+        TextureResidencyUpdate(&residency, &callbacks);
+    }
+    TEST_CHECK(backend->load_count == 2);
+    TEST_CHECK(backend->load_levels[0] == 0 && backend->load_levels[1] == 0);
+    TEST_CHECK(residency.entries[0].resident_level == 0 && residency.entries[1].resident_level == 0);
+
+    free(backend);
+    TextureResidencyDestroy(&residency);
+}
+
+void TestTailsFirst() {
+    u64 level_bytes[MIPMAP_MAX_LEVELS];
+    i32 level_count = TestRgbaLevels(level_bytes, 1024);
+    u64 full_bytes = 0;
+    for (i32 level = 0; level < level_count; level++) {
+        full_bytes += level_bytes[level];
+    }
+
+    // Room for one full texture and the tails of the rest, with at most two loads per update
+    TextureResidency residency;
+    TEST_CHECK(TextureResidencyCreate(&residency, 256, full_bytes + 4 * TEXTURE_RESIDENCY_TAIL_BYTES, 2));
+    TestResidencyBackend* backend = (TestResidencyBackend*)calloc(1, sizeof(TestResidencyBackend));
+    backend->residency = &residency;
+    TextureResidencyBackend callbacks = { backend, TestBackendLoad, TestBackendEvict };
+
+    TestTrackTextures(backend, 4, 1024, -1);
+    i32 tail_level = residency.entries[0].tail_level;
+    for (i32 update = 0; update < 60; update++) {
+        for (u32 texture = 0; texture < 4; texture++) {
+            TestBackendTouch(backend, texture);
+        }
+        TextureResidencyUpdate(&residency, &callbacks);
+        TEST_CHECK(residency.stats.committed_bytes <= residency.budget_bytes);
+    }
+
+    // The first two loads may not take the room the two textures past the load limit need for their tails
+    TEST_CHECK(backend->load_levels[0] < tail_level && backend->load_levels[1] < tail_level);
+    TEST_CHECK(backend->load_levels[2] == tail_level && backend->load_levels[3] == tail_level);
+    for (u32 texture = 0; texture < 4; texture++) {
+        TEST_CHECK(residency.entries[texture].resident_level <= tail_level);
+    }
+    TEST_CHECK(residency.stats.evictions == 0);
+
+    free(backend);
+    TextureResidencyDestroy(&residency);
+}
+
+void TestMovingWorkingSet(i32 latency) {
+    const u64 budget_bytes = 48ull << 20;
+    TextureResidency residency;
+    TEST_CHECK(TextureResidencyCreate(&residency, 256, budget_bytes, 4));
+    TestResidencyBackend* backend = (TestResidencyBackend*)calloc(1, sizeof(TestResidencyBackend));
+    backend->residency = &residency;
+    backend->latency = latency;
+    TextureResidencyBackend callbacks = { backend, TestBackendLoad, TestBackendEvict };
+
+    // 200 fully resident textures of 64 to 1024 pixels, far more than the budget
+    srand(42);
+    u64 level_bytes[MIPMAP_MAX_LEVELS];
+    for (u32 texture = 0; texture < 200; texture++) {
+        i32 level_count = TestRgbaLevels(level_bytes, 64 << (rand() % 5));
+        TextureResidencyTrack(&residency, texture, level_bytes, level_count, 0);
+    }
+
+    // A working set of 13 textures moves along every 30 updates
+    for (i32 update = 0; update < 3000; update++) {
+        i32 center = (update / 30) % 200;
+        for (i32 k = -6; k <= 6; k++) {
+            TestBackendTouch(backend, (u32)((center + k + 200) % 200));
+        }
+        TextureResidencyUpdate(&residency, &callbacks);
+        TestBackendTick(backend);
+
+        // The first update evicts down to the budget
+        TEST_CHECK(update == 0 || residency.stats.resident_bytes <= budget_bytes);
+        for (u32 texture = 0; texture < 200; texture++) {
+            TEST_CHECK(backend->resident_levels[texture] == residency.entries[texture].resident_level);
+        }
+    }
+
+    i32 center = (2999 / 30) % 200;
+    for (i32 k = -6; k <= 6; k++) {
+        TEST_CHECK(residency.entries[(center + k + 200) % 200].resident_level == 0);
+    }
+
+    free(backend);
+    TextureResidencyDestroy(&residency);
+}
+
+void TestLeastRecentlyUsedFirst() {
+    u64 level_bytes[MIPMAP_MAX_LEVELS];
+    i32 level_count = TestRgbaLevels(level_bytes, 512);
+    u64 full_bytes = 0;
+    for (i32 level = 0; level < level_count; level++) {
+        full_bytes += level_bytes[level];
+    }
+
+    // Three full textures used in the order 1, 0, 2, then a fourth needs the room of one of them
+    TextureResidency residency;
+    TEST_CHECK(TextureResidencyCreate(&residency, 8, full_bytes * 3 + full_bytes / 2, 8));
+    TestResidencyBackend* backend = (TestResidencyBackend*)calloc(1, sizeof(TestResidencyBackend));
+    backend->residency = &residency;
+    TextureResidencyBackend callbacks = { backend, TestBackendLoad, TestBackendEvict };
+
+    TestTrackTextures(backend, 3, 512, 0);
+    TextureResidencyTrack(&residency, 3, level_bytes, level_count, level_count);
+    i32 tail_level = residency.entries[3].tail_level;
+    residency.entries[3].resident_level = tail_level;
+    residency.entries[3].loading_level = tail_level;
+    backend->resident_levels[3] = tail_level;
+
+    TextureResidencyTouch(&residency, 1);
+    TextureResidencyUpdate(&residency, &callbacks);
+    TextureResidencyTouch(&residency, 0);
+    TextureResidencyUpdate(&residency, &callbacks);
+    TextureResidencyTouch(&residency, 2);
+    TextureResidencyUpdate(&residency, &callbacks);
+    for (i32 update = 0; update < 10; update++) {
+        TestBackendTouch(backend, 3);
+        TextureResidencyUpdate(&residency, &callbacks);
+    }
+    TEST_CHECK(backend->eviction_count == 1 && backend->evicted_textures[0] == 1);
+    TEST_CHECK(residency.entries[3].resident_level == 0);
+
+    // A lowered budget evicts without anything loading
+    u64 tail_bytes = TextureResidencyBytesFrom(&residency.entries[0], tail_level);
+    residency.budget_bytes = full_bytes + 3 * tail_bytes;
+    TestBackendTouch(backend, 3);
+    TextureResidencyUpdate(&residency, &callbacks);
+    TEST_CHECK(residency.stats.committed_bytes <= residency.budget_bytes);
+    for (u32 texture = 0; texture < 3; texture++) {
+        TEST_CHECK(residency.entries[texture].resident_level == tail_level);
+    }
+
+    free(backend);
+    TextureResidencyDestroy(&residency);
+}
+
+int main() {
+    TestOneLoadWhenItFits();
+    TestTailsFirst();
+    TestMovingWorkingSet(0);
+    TestMovingWorkingSet(3);
+    TestLeastRecentlyUsedFirst();
+    return TestReport("texture_residency_test");
+}
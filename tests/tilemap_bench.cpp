@@ -0,0 +1,61 @@
+// Benchmark of chunked tilemap access: tile lookups inside the resident set, lookups that miss and evict,
+// and streaming around a moving camera, on a 4096x4096 world with the game's 256 chunk budget.
+
+// ----------
+// Includes
+
+#include "test.h"
+#include "../src/tilemap.h"
+
+// --------------------------
+// Function implementations
+
+int main() {
+    const i32 world_size = 4096;
+    const i32 chunk_budget = 256;
+    const i32 lookup_count = 10000000;
+
+    Tilemap tilemap = {};
+    if (!TilemapCreate(&tilemap, world_size, world_size, chunk_budget)) {
+        return 1;
+    }
+    printf("World %dx%d tiles, %d resident chunks, %.1f MB resident\n",
+        world_size, world_size, chunk_budget, (f64)chunk_budget * sizeof(TilemapChunk) / (1024.0 * 1024.0));
+
+    // Resident: random tiles inside the streamed square around the camera
+    TilemapStreamAround(&tilemap, Vec2f{2048.0f, 2048.0f}, 7);
+    u32 random = 12345;
+    i64 type_sum = 0;
+    f64 start_ms = TestNowMs();
+    for (i32 i = 0; i < lookup_count; i++) {
+        random = random * 1664525u + 1013904223u;
+        i32 x = 2048 - 7 * TILEMAP_CHUNK_SIZE + (i32)(random >> 8) % (15 * TILEMAP_CHUNK_SIZE);
+        i32 y = 2048 - 7 * TILEMAP_CHUNK_SIZE + (i32)(random >> 4) % (15 * TILEMAP_CHUNK_SIZE);
+        type_sum += TilemapGetTile(&tilemap, x, y)->type;
+    }
+    f64 resident_ms = TestNowMs() - start_ms;
+    printf("Resident lookup: %.1f ns/tile\n", resident_ms * 1e6 / lookup_count);
+
+    // Missing: random tiles anywhere, nearly every lookup loads a chunk and evicts one
+    const i32 miss_count = 200000;
+    start_ms = TestNowMs();
+    for (i32 i = 0; i < miss_count; i++) {
+        random = random * 1664525u + 1013904223u;
+        type_sum += TilemapGetTile(&tilemap, (i32)(random >> 8) % world_size, (i32)(random >> 3) % world_size)->type;
+        tilemap.frame++;
+    }
+    f64 miss_ms = TestNowMs() - start_ms;
+    printf("Evicting lookup: %.1f ns/tile\n", miss_ms * 1e6 / miss_count);
+
+    // Streaming: camera walking diagonally across the world one tile per frame
+    const i32 frame_count = 4000;
+    start_ms = TestNowMs();
+    for (i32 frame = 0; frame < frame_count; frame++) {
+        TilemapStreamAround(&tilemap, Vec2f{(f32)frame, (f32)frame}, 7);
+    }
+    f64 stream_ms = TestNowMs() - start_ms;
+    printf("Streaming frame: %.2f us/frame\n", stream_ms * 1e3 / frame_count);
+
+    TilemapDestroy(&tilemap);
+    return type_sum == 0 ? 0 : 1;
+}
@@ -0,0 +1,108 @@
+// Tests of static tile chunk meshes: vertices compared with the expected quad of every tile, back to front
+// order, dirty tracking on edits, and the frame guard that keeps drawn chunks from being evicted.
+
+// ----------
+// Includes
+
+#include "test.h"
+#include "../src/tilemap_mesh.h"
+
+// ---------
+// Globals
+
+TilemapTileVertex mesh[TILEMAP_CHUNK_MESH_MAX_VERTEX_COUNT];
+
+// --------------------------
+// Function implementations
+
+/**
+ * @brief Check that 'quad' is the quad of tile 'x', 'y' of 'type' for a three tile atlas.
+ */
+bool IsTileQuad(TilemapTileVertex* quad, i32 x, i32 y, i32 type) {
+    Vec2f center = TilemapCoordsToIsometricScreenSpace(Vec2f{(f32)x, (f32)y});
+    u16 u0 = PackUnorm16((f32)type / 3.0f);
+    u16 u1 = PackUnorm16((f32)(type + 1) / 3.0f);
+
+    return quad[0].position.x == center.x - 1.0f && quad[0].position.y == center.y + 0.5f
+        && quad[1].position.x == center.x + 1.0f && quad[1].position.y == center.y + 0.5f
+        && quad[2].position.x == center.x - 1.0f && quad[2].position.y == center.y - 0.5f
+        && quad[3].position.x == center.x + 1.0f && quad[3].position.y == center.y - 0.5f
+        && quad[0].uv[0] == u0 && quad[1].uv[0] == u1 && quad[2].uv[0] == u0 && quad[3].uv[0] == u1
+        && quad[0].uv[1] == 0 && quad[2].uv[1] == 0xFFFF
+        && quad[0].color == 0xFFFFFFFF;
+}
+
+void TestChunkMesh() {
+    const TileAtlasLayout atlas = { .columns = 3, .rows = 1 };
+    Tilemap tilemap = {};
+    TEST_CHECK(TilemapCreate(&tilemap, 40, 40, 4));
+
+    // Full chunk, every tile in back to front order
+    TilemapChunk* chunk = TilemapLoadChunk(&tilemap, Vec2i{0, 0});
+    TEST_CHECK(chunk->is_mesh_dirty);
+    i32 vertex_count = TilemapBuildChunkMesh(&tilemap, chunk, atlas, mesh);
+    TEST_CHECK(vertex_count == TILEMAP_CHUNK_MESH_MAX_VERTEX_COUNT);
+
+    i32 previous_depth = 2 * TILEMAP_CHUNK_SIZE;
+    i32 mismatch_count = 0;
+    for (i32 quad = 0; quad < vertex_count / QUAD_VERTEX_COUNT; quad++) {
+        // Back from the top-left corner to the quad center, then undo the projection and its half tile offset
+        Vec2f top_left = mesh[quad * QUAD_VERTEX_COUNT].position;
+        Vec2f tile = ScreenSpaceToTilemapCoords(Vec2f{top_left.x + 1.0f, top_left.y - 0.5f - 0.5f});
+        i32 x = (i32)roundf(tile.x);
+        i32 y = (i32)roundf(tile.y);
+        mismatch_count += IsTileQuad(&mesh[quad * QUAD_VERTEX_COUNT], x, y, 0) ? 0 : 1;
+        TEST_CHECK(x + y <= previous_depth);
+        previous_depth = x + y;
+    }
+    TEST_CHECK(mismatch_count == 0);
+    TEST_CHECK(IsTileQuad(&mesh[0], 31, 31, 0));
+    TEST_CHECK(IsTileQuad(&mesh[vertex_count - QUAD_VERTEX_COUNT], 0, 0, 0));
+
+    // Partial chunk at the map edge only has the tiles inside the map, 8x8 here
+    chunk = TilemapLoadChunk(&tilemap, Vec2i{1, 1});
+    vertex_count = TilemapBuildChunkMesh(&tilemap, chunk, atlas, mesh);
+    TEST_CHECK(vertex_count == 8 * 8 * QUAD_VERTEX_COUNT);
+    TEST_CHECK(IsTileQuad(&mesh[0], 39, 39, 0));
+
+    // Editing a tile dirties its chunk only, and the rebuilt mesh has the new type at the same place
+    chunk->is_mesh_dirty = false;
+    TilemapChunk* other = TilemapFindChunk(&tilemap, Vec2i{0, 0});
+    other->is_mesh_dirty = false;
+    TilemapSetTile(&tilemap, 39, 39, 2);
+    TEST_CHECK(chunk->is_mesh_dirty && !other->is_mesh_dirty);
+    TEST_CHECK(TilemapBuildChunkMesh(&tilemap, chunk, atlas, mesh) == 8 * 8 * QUAD_VERTEX_COUNT);
+    TEST_CHECK(IsTileQuad(&mesh[0], 39, 39, 2));
+    TEST_CHECK(IsTileQuad(&mesh[QUAD_VERTEX_COUNT], 38, 39, 0) || IsTileQuad(&mesh[QUAD_VERTEX_COUNT], 39, 38, 0));
+
+    TilemapDestroy(&tilemap);
+}
+
+void TestFrameGuard() {
+    Tilemap tilemap = {};
+    TEST_CHECK(TilemapCreate(&tilemap, 1024, 1024, 4));
+    tilemap.frame = 1;
+
+    for (i32 i = 0; i < 4; i++) {
+        TEST_CHECK(TilemapCanLoadChunk(&tilemap));
+        TilemapLoadChunk(&tilemap, Vec2i{i, 0});
+    }
+
+    // Every resident chunk was used this frame
+    TEST_CHECK(!TilemapCanLoadChunk(&tilemap));
+
+    // Next frame one of them is reused and the others can go
+    tilemap.frame++;
+    TilemapLoadChunk(&tilemap, Vec2i{2, 0});
+    TEST_CHECK(TilemapCanLoadChunk(&tilemap));
+    TilemapLoadChunk(&tilemap, Vec2i{9, 9});
+    TEST_CHECK(TilemapFindChunk(&tilemap, Vec2i{2, 0}) != nullptr);
+
+    TilemapDestroy(&tilemap);
+}
+
+int main() {
+    TestChunkMesh();
+    TestFrameGuard();
+    return TestReport("tilemap_mesh_test");
+}
@@ -0,0 +1,225 @@
+// Tests of the chunked tilemap: tile access, chunk residency under the budget, LRU eviction and the
+// chunk store that keeps edited chunks across eviction under its own budget, spilling or refusing past it.
+
+// ----------
+// Includes
+
+#include "test.h"
+#include "../src/tilemap.h"
+
+// --------------------------
+// Function implementations
+
+void LoadStoredChunk(void* user_data, Vec2i chunk_coord, Tile* tiles) {
+    if (!TilemapChunkStoreGet((TilemapChunkStore*)user_data, chunk_coord, tiles)) {
+        memset(tiles, 0, sizeof(Tile) * TILEMAP_CHUNK_TILE_COUNT);
+    }
+}
+
+void StoreChunk(void* user_data, Vec2i chunk_coord, Tile* tiles) {
+    TEST_CHECK(TilemapChunkStorePut((TilemapChunkStore*)user_data, chunk_coord, tiles));
+}
+
+/**
+ * @brief Every occupied index slot must point at a loaded chunk that is found again by its coordinate.
+ */
+bool IsIndexConsistent(Tilemap* tilemap) {
+    i32 indexed_count = 0;
+    for (u32 i = 0; i <= tilemap->chunk_index_mask; i++) {
+        i32 chunk_id = tilemap->chunk_index[i];
+        if (chunk_id == TILEMAP_CHUNK_SLOT_EMPTY) {
+            continue;
+        }
+        TilemapChunk* chunk = &tilemap->chunks[chunk_id];
+        if (!chunk->is_loaded || TilemapFindChunk(tilemap, chunk->coord) != chunk) {
+            return false;
+        }
+        indexed_count++;
+    }
+    return indexed_count == tilemap->loaded_chunk_count;
+}
+
+void TestTileAccess() {
+    Tilemap tilemap = {};
+    TEST_CHECK(!TilemapCreate(&tilemap, 0, 10, 4));
+    TEST_CHECK(TilemapCreate(&tilemap, 100, 70, 4));
+
+    Vec2i chunk_count = TilemapChunkCount(&tilemap);
+    TEST_CHECK(chunk_count.x == 4 && chunk_count.y == 3);
+
+    TEST_CHECK(TilemapGetTile(&tilemap, -1, 0) == nullptr);
+    TEST_CHECK(TilemapGetTile(&tilemap, 0, 70) == nullptr);
+    TEST_CHECK(TilemapGetTile(&tilemap, 99, 69) != nullptr);
+    TEST_CHECK(TilemapGetTile(&tilemap, 5, 5)->type == 0);
+
+    TilemapSetTile(&tilemap, 40, 33, 2);
+    TEST_CHECK(TilemapGetTile(&tilemap, 40, 33)->type == 2);
+    TilemapChunk* chunk = TilemapFindChunk(&tilemap, Vec2i{1, 1});
+    TEST_CHECK(chunk && chunk->is_modified && chunk->is_mesh_dirty);
+
+    // Setting the same type again is not a modification
+    chunk->is_modified = false;
+    TilemapSetTile(&tilemap, 40, 33, 2);
+    TEST_CHECK(!chunk->is_modified);
+
+    TilemapDestroy(&tilemap);
+}
+
+void TestEviction() {
+    Tilemap tilemap = {};
+    TEST_CHECK(TilemapCreate(&tilemap, 4096, 4096, 16));
+
+    for (i32 frame = 0; frame < 500; frame++) {
+        TilemapStreamAround(&tilemap, Vec2f{(f32)(frame * 37 % 4000), (f32)(frame * 91 % 4000)}, 1);
+        TEST_CHECK(tilemap.loaded_chunk_count <= tilemap.chunk_capacity);
+    }
+    TEST_CHECK(IsIndexConsistent(&tilemap));
+
+    // The chunks just streamed in are the most recently used ones and survive the next load
+    TilemapStreamAround(&tilemap, Vec2f{2048.0f, 2048.0f}, 1);
+    TilemapLoadChunk(&tilemap, Vec2i{0, 0});
+    for (i32 y = 63; y <= 65; y++) {
+        for (i32 x = 63; x <= 65; x++) {
+            TEST_CHECK(TilemapFindChunk(&tilemap, Vec2i{x, y}) != nullptr);
+        }
+    }
+
+    // Radius is clamped to what fits in the budget: a 3x3 square for 16 chunks
+    TilemapStreamAround(&tilemap, Vec2f{1000.0f, 1000.0f}, 10);
+    TEST_CHECK(TilemapFindChunk(&tilemap, Vec2i{31 - 1, 31 - 1}) != nullptr);
+    TEST_CHECK(TilemapFindChunk(&tilemap, Vec2i{31 - 2, 31}) == nullptr);
+
+    for (i32 i = 0; i < 2000; i++) {
+        TEST_CHECK(TilemapGetTile(&tilemap, rand() % 4096, rand() % 4096) != nullptr);
+    }
+    TEST_CHECK(IsIndexConsistent(&tilemap));
+
+    TilemapDestroy(&tilemap);
+}
+
+void TestEditsSurviveEviction() {
+    TilemapChunkStore store = {};
+    TEST_CHECK(TilemapChunkStoreCreate(&store, 128));
+
+    Tilemap tilemap = {};
+    TEST_CHECK(TilemapCreate(&tilemap, 4096, 4096, 4));
+    tilemap.load_chunk = LoadStoredChunk;
+    tilemap.store_chunk = StoreChunk;
+    tilemap.user_data = &store;
+
+    // One edit in each of 100 chunks, far more than stay resident
+    for (i32 i = 0; i < 100; i++) {
+        TilemapSetTile(&tilemap, i * 40 + 1, i * 40 + 2, 1 + i % 3);
+        tilemap.frame++;
+    }
+    TEST_CHECK(tilemap.loaded_chunk_count == 4);
+    TEST_CHECK(store.count == 96);
+
+    for (i32 i = 0; i < 100; i++) {
+        tilemap.frame++;
+        TEST_CHECK(TilemapGetTile(&tilemap, i * 40 + 1, i * 40 + 2)->type == 1 + i % 3);
+        TEST_CHECK(TilemapGetTile(&tilemap, i * 40, i * 40 + 2)->type == 0);
+    }
+
+    // Editing a stored chunk again replaces its copy instead of adding one
+    u32 stored_count = store.count;
+    TilemapSetTile(&tilemap, 1, 2, 3);
+    for (i32 i = 50; i < 60; i++) {
+        tilemap.frame++;
+        TilemapGetTile(&tilemap, i * 40, i * 40);
+    }
+    TEST_CHECK(store.count == stored_count);
+    TEST_CHECK(TilemapGetTile(&tilemap, 1, 2)->type == 3);
+    TEST_CHECK(IsIndexConsistent(&tilemap));
+
+    Tile tiles[TILEMAP_CHUNK_TILE_COUNT];
+    TEST_CHECK(!TilemapChunkStoreGet(&store, Vec2i{63, 0}, tiles));
+
+    TilemapDestroy(&tilemap);
+    TilemapChunkStoreDestroy(&store);
+}
+
+/**
+ * @brief Spill callback keeping spilled chunks in a second, larger store that stands in for a file.
+ */
+void SpillChunk(void* user_data, Vec2i chunk_coord, Tile* tiles) {
+    TEST_CHECK(TilemapChunkStorePut((TilemapChunkStore*)user_data, chunk_coord, tiles));
+}
+
+void LoadStoredOrSpilledChunk(void* user_data, Vec2i chunk_coord, Tile* tiles) {
+    TilemapChunkStore* store = (TilemapChunkStore*)user_data;
+    if (!TilemapChunkStoreGet(store, chunk_coord, tiles) && !TilemapChunkStoreGet((TilemapChunkStore*)store->user_data, chunk_coord, tiles)) {
+        memset(tiles, 0, sizeof(Tile) * TILEMAP_CHUNK_TILE_COUNT);
+    }
+}
+
+void TestStoreBudget() {
+    // Without a spill callback a full store refuses new chunks, chunks it holds can still be replaced
+    TilemapChunkStore store = {};
+    TEST_CHECK(!TilemapChunkStoreCreate(&store, 0));
+    TEST_CHECK(TilemapChunkStoreCreate(&store, 8));
+    Tile tiles[TILEMAP_CHUNK_TILE_COUNT] = {};
+    for (i32 i = 0; i < 8; i++) {
+        tiles[0].type = i;
+        TEST_CHECK(TilemapChunkStorePut(&store, Vec2i{i, 0}, tiles));
+    }
+    TEST_CHECK(!TilemapChunkStorePut(&store, Vec2i{8, 0}, tiles));
+    tiles[0].type = 42;
+    TEST_CHECK(TilemapChunkStorePut(&store, Vec2i{3, 0}, tiles));
+    TEST_CHECK(store.count == 8 && store.spilled_count == 0);
+    TEST_CHECK(TilemapChunkStoreGet(&store, Vec2i{3, 0}, tiles) && tiles[0].type == 42);
+    TEST_CHECK(!TilemapChunkStoreGet(&store, Vec2i{8, 0}, tiles));
+    TilemapChunkStoreDestroy(&store);
+
+    // With one, edits of 300 chunks go through a store of 8 and the oldest spill
+    TilemapChunkStore spilled = {};
+    TEST_CHECK(TilemapChunkStoreCreate(&spilled, 512));
+    TEST_CHECK(TilemapChunkStoreCreate(&store, 8));
+    store.spill_chunk = SpillChunk;
+    store.user_data = &spilled;
+
+    Tilemap tilemap = {};
+    TEST_CHECK(TilemapCreate(&tilemap, 4096, 4096, 4));
+    tilemap.load_chunk = LoadStoredOrSpilledChunk;
+    tilemap.store_chunk = StoreChunk;
+    tilemap.user_data = &store;
+    for (i32 round = 0; round < 2; round++) {
+        for (i32 i = 0; i < 300; i++) {
+            TilemapSetTile(&tilemap, i % 100 * 40 + 1, i / 100 * 40 + 2, 1 + (i + round) % 3);
+            tilemap.frame++;
+            TEST_CHECK(store.count <= 8);
+        }
+    }
+    // Every chunk not resident or held went to the spill, which also keeps stale copies of chunks edited again
+    TEST_CHECK(store.count == 8 && 300 - 8 - 4 <= store.spilled_count && 300 - 8 - 4 <= spilled.count);
+
+    // The chunk used last stays in memory, the least recently used one is the next to spill
+    i32 mismatch_count = 0;
+    for (i32 i = 0; i < 300; i++) {
+        tilemap.frame++;
+        mismatch_count += TilemapGetTile(&tilemap, i % 100 * 40 + 1, i / 100 * 40 + 2)->type == 1 + (i + 1) % 3 ? 0 : 1;
+    }
+    TEST_CHECK(mismatch_count == 0 && store.count == 8);
+
+    // Removing spilled slots keeps every held chunk reachable
+    i32 held_count = 0;
+    for (u32 slot = 0; slot < store.capacity; slot++) {
+        if (store.tiles[slot]) {
+            held_count++;
+            TEST_CHECK(TilemapChunkStoreFindSlot(&store, store.coords[slot]) == slot);
+        }
+    }
+    TEST_CHECK(held_count == 8);
+
+    TilemapDestroy(&tilemap);
+    TilemapChunkStoreDestroy(&store);
+    TilemapChunkStoreDestroy(&spilled);
+}
+
+int main() {
+    TestTileAccess();
+    TestEviction();
+    TestEditsSurviveEviction();
+    TestStoreBudget();
+    return TestReport("tilemap_test");
+}
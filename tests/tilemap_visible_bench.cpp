@@ -0,0 +1,76 @@
+// Benchmark of per frame tile iteration: scanning every tile of the map against walking only the culled
+// visible spans, for map sizes from 40x40 to 4096x4096 at the default zoom and a 16:9 window.
+
+// ----------
+// Includes
+
+#include "test.h"
+#include "../src/tilemap.h"
+
+// --------------------------
+// Function implementations
+
+int main() {
+    const i32 map_sizes[] = { 40, 256, 1024, 4096 };
+    const f32 view_width = 2.0f * 10.0f;
+    const f32 view_height = view_width * 9.0f / 16.0f;
+
+    printf("%10s %14s %14s %12s %12s\n", "map", "scanned tiles", "culled tiles", "scan us", "culled us");
+    for (i32 size : map_sizes) {
+        Tilemap tilemap = {};
+        if (!TilemapCreate(&tilemap, size, size, 16)) {
+            return 1;
+        }
+
+        // Camera in the middle of the map
+        Vec2f center = TilemapCoordsToIsometricScreenSpace(Vec2f{size * 0.5f, size * 0.5f});
+        Vec2f corners[4] = {
+            { center.x - view_width * 0.5f, center.y - view_height * 0.5f },
+            { center.x + view_width * 0.5f, center.y - view_height * 0.5f },
+            { center.x + view_width * 0.5f, center.y + view_height * 0.5f },
+            { center.x - view_width * 0.5f, center.y + view_height * 0.5f },
+        };
+
+        // Full scan does what the old draw loop did per tile: project it and test it against the screen
+        i32 scan_frame_count = size <= 256 ? 1000 : 10;
+        i64 scanned_count = 0;
+        i64 on_screen_count = 0;
+        f64 start_ms = TestNowMs();
+        for (i32 frame = 0; frame < scan_frame_count; frame++) {
+            for (i32 y = 0; y < size; y++) {
+                for (i32 x = 0; x < size; x++) {
+                    Vec2f screen = TilemapCoordsToIsometricScreenSpace(Vec2f{(f32)x, (f32)y});
+                    on_screen_count += corners[0].x <= screen.x && screen.x <= corners[2].x && corners[0].y <= screen.y && screen.y <= corners[2].y;
+                    scanned_count++;
+                }
+            }
+        }
+        f64 scan_us = (TestNowMs() - start_ms) * 1e3 / scan_frame_count;
+
+        const i32 frame_count = 10000;
+        i64 culled_count = 0;
+        start_ms = TestNowMs();
+        for (i32 frame = 0; frame < frame_count; frame++) {
+            TilemapVisibleRange range = TilemapComputeVisibleRange(&tilemap, corners);
+            for (i32 y = range.min_y; y <= range.max_y; y++) {
+                i32 x_start, x_end;
+                if (TilemapVisibleRowSpan(&range, y, &x_start, &x_end)) {
+                    for (i32 x = x_start; x <= x_end; x++) {
+                        Vec2f screen = TilemapCoordsToIsometricScreenSpace(Vec2f{(f32)x, (f32)y});
+                        on_screen_count += corners[0].x <= screen.x && screen.x <= corners[2].x;
+                        culled_count++;
+                    }
+                }
+            }
+        }
+        f64 culled_us = (TestNowMs() - start_ms) * 1e3 / frame_count;
+
+        printf("%4dx%-5d %14lld %14lld %12.2f %12.2f\n", size, size,
+            scanned_count / scan_frame_count, culled_count / frame_count, scan_us, culled_us);
+        if (on_screen_count == 0) {
+            return 1;
+        }
+        TilemapDestroy(&tilemap);
+    }
+    return 0;
+}
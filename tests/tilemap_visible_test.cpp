@@ -0,0 +1,81 @@
+// Tests of isometric view culling: every tile on screen is inside the culled row spans and chunk spans,
+// and the spans stay close to the number of tiles actually visible.
+
+// ----------
+// Includes
+
+#include "test.h"
+#include "../src/tilemap.h"
+
+// --------------------------
+// Function implementations
+
+/**
+ * @brief Check culling of the screen rectangle 'min' - 'max' given in world (screen space) coordinates.
+ */
+void CheckVisibleRange(Tilemap* tilemap, Vec2f min, Vec2f max) {
+    Vec2f corners[4] = { {min.x, min.y}, {max.x, min.y}, {max.x, max.y}, {min.x, max.y} };
+    TilemapVisibleRange range = TilemapComputeVisibleRange(tilemap, corners);
+
+    i64 culled_count = 0;
+    for (i32 y = range.min_y; y <= range.max_y; y++) {
+        i32 x_start, x_end;
+        if (TilemapVisibleRowSpan(&range, y, &x_start, &x_end)) {
+            TEST_CHECK(0 <= x_start && x_end < tilemap->width);
+            culled_count += x_end - x_start + 1;
+        }
+    }
+
+    // Brute force over the whole map: a tile is visible if any of its corners or its center is on screen
+    i64 visible_count = 0;
+    i32 missing_count = 0;
+    const Vec2f tile_points[5] = { {0.0f, 0.0f}, {1.0f, 0.0f}, {0.0f, 1.0f}, {1.0f, 1.0f}, {0.5f, 0.5f} };
+    for (i32 y = 0; y < tilemap->height; y++) {
+        for (i32 x = 0; x < tilemap->width; x++) {
+            bool is_visible = false;
+            for (const Vec2f& point : tile_points) {
+                Vec2f screen = TilemapCoordsToIsometricScreenSpace(Vec2f{x + point.x, y + point.y});
+                is_visible = is_visible || (min.x <= screen.x && screen.x <= max.x && min.y <= screen.y && screen.y <= max.y);
+            }
+            if (!is_visible) {
+                continue;
+            }
+            visible_count++;
+
+            i32 x_start, x_end, chunk_x_start, chunk_x_end;
+            bool is_in_row = TilemapVisibleRowSpan(&range, y, &x_start, &x_end) && x_start <= x && x <= x_end;
+            bool is_in_chunk = TilemapVisibleChunkSpan(&range, y / TILEMAP_CHUNK_SIZE, &chunk_x_start, &chunk_x_end)
+                && chunk_x_start <= x / TILEMAP_CHUNK_SIZE && x / TILEMAP_CHUNK_SIZE <= chunk_x_end;
+            missing_count += is_in_row && is_in_chunk ? 0 : 1;
+        }
+    }
+
+    TEST_CHECK(missing_count == 0);
+    TEST_CHECK(culled_count <= 2 * visible_count + 400);
+}
+
+int main() {
+    Tilemap tilemap = {};
+    TEST_CHECK(TilemapCreate(&tilemap, 300, 300, 16));
+
+    // Default zoom at several camera positions, including the map edges and corners
+    CheckVisibleRange(&tilemap, Vec2f{-10.0f, -5.0f}, Vec2f{10.0f, 6.25f});
+    CheckVisibleRange(&tilemap, Vec2f{80.0f, 60.0f}, Vec2f{100.0f, 71.25f});
+    CheckVisibleRange(&tilemap, Vec2f{-160.0f, 70.0f}, Vec2f{-140.0f, 81.25f});
+    CheckVisibleRange(&tilemap, Vec2f{140.0f, 70.0f}, Vec2f{160.0f, 81.25f});
+    CheckVisibleRange(&tilemap, Vec2f{-10.0f, 290.0f}, Vec2f{10.0f, 301.25f});
+
+    // Zoomed out past the whole map, and a camera off the map
+    CheckVisibleRange(&tilemap, Vec2f{-400.0f, -100.0f}, Vec2f{400.0f, 400.0f});
+    Vec2f off_map[4] = { {1000.0f, 0.0f}, {1020.0f, 0.0f}, {1020.0f, 11.25f}, {1000.0f, 11.25f} };
+    TilemapVisibleRange range = TilemapComputeVisibleRange(&tilemap, off_map);
+    bool is_any_visible = false;
+    for (i32 y = range.min_y; y <= range.max_y; y++) {
+        i32 x_start, x_end;
+        is_any_visible = is_any_visible || TilemapVisibleRowSpan(&range, y, &x_start, &x_end);
+    }
+    TEST_CHECK(!is_any_visible);
+
+    TilemapDestroy(&tilemap);
+    return TestReport("tilemap_visible_test");
+}
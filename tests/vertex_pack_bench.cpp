@@ -0,0 +1,74 @@
+// Microbenchmark of vertex fill cost: the packed 16 byte TilemapTileVertex against the 40 byte layout it
+// replaced, float4 position, float4 color and float2 UV.
+
+// ----------
+// Includes
+
+#include "test.h"
+#include "../src/quad_batch.h"
+
+// ---------
+// Structs
+
+struct UnpackedTileVertex {
+    f32 position[4];
+    f32 color[4];
+    f32 uv[2];
+};
+
+// --------------------------
+// Function implementations
+
+i32 BuildUnpackedQuadVertices(UnpackedTileVertex* out, Vec2f center, Vec2f size, Vec4f uv_rect, Vec4f color) {
+    f32 x0 = center.x - size.x * 0.5f;
+    f32 x1 = center.x + size.x * 0.5f;
+    f32 y0 = center.y - size.y * 0.5f;
+    f32 y1 = center.y + size.y * 0.5f;
+
+    out[0] = { {x0, y1, 0.0f, 1.0f}, {color.x, color.y, color.z, color.w}, {uv_rect.x, uv_rect.y} };
+    out[1] = { {x1, y1, 0.0f, 1.0f}, {color.x, color.y, color.z, color.w}, {uv_rect.z, uv_rect.y} };
+    out[2] = { {x0, y0, 0.0f, 1.0f}, {color.x, color.y, color.z, color.w}, {uv_rect.x, uv_rect.w} };
+    out[3] = { {x1, y0, 0.0f, 1.0f}, {color.x, color.y, color.z, color.w}, {uv_rect.z, uv_rect.w} };
+    return QUAD_VERTEX_COUNT;
+}
+
+int main() {
+    const i32 quad_count = 100000;
+    const i32 frame_count = 200;
+
+    TilemapTileVertex* packed = (TilemapTileVertex*)malloc(sizeof(TilemapTileVertex) * QUAD_VERTEX_COUNT * quad_count);
+    UnpackedTileVertex* unpacked = (UnpackedTileVertex*)malloc(sizeof(UnpackedTileVertex) * QUAD_VERTEX_COUNT * quad_count);
+    if (!packed || !unpacked) {
+        return 1;
+    }
+
+    // Per quad colors and UVs so the packing is not hoisted out of the loop
+    f64 start_ms = TestNowMs();
+    for (i32 frame = 0; frame < frame_count; frame++) {
+        for (i32 i = 0; i < quad_count; i++) {
+            f32 t = (f32)(i & 255) / 255.0f;
+            BuildQuadVertices(&packed[i * QUAD_VERTEX_COUNT], Vec2f{(f32)(i % 512), (f32)frame}, Vec2f{2.0f, 1.0f}, Vec4f{t, 0.0f, t, 1.0f}, Vec4f{t, 1.0f - t, 1.0f, 1.0f});
+        }
+    }
+    f64 packed_ms = TestNowMs() - start_ms;
+
+    start_ms = TestNowMs();
+    for (i32 frame = 0; frame < frame_count; frame++) {
+        for (i32 i = 0; i < quad_count; i++) {
+            f32 t = (f32)(i & 255) / 255.0f;
+            BuildUnpackedQuadVertices(&unpacked[i * QUAD_VERTEX_COUNT], Vec2f{(f32)(i % 512), (f32)frame}, Vec2f{2.0f, 1.0f}, Vec4f{t, 0.0f, t, 1.0f}, Vec4f{t, 1.0f - t, 1.0f, 1.0f});
+        }
+    }
+    f64 unpacked_ms = TestNowMs() - start_ms;
+
+    f64 total_quads = (f64)quad_count * frame_count;
+    printf("Packed vertices:   %2zu bytes, %6.2f ns/quad, %6.2f MB/frame\n", sizeof(TilemapTileVertex), packed_ms * 1e6 / total_quads,
+        (f64)sizeof(TilemapTileVertex) * QUAD_VERTEX_COUNT * quad_count / (1024.0 * 1024.0));
+    printf("Unpacked vertices: %2zu bytes, %6.2f ns/quad, %6.2f MB/frame\n", sizeof(UnpackedTileVertex), unpacked_ms * 1e6 / total_quads,
+        (f64)sizeof(UnpackedTileVertex) * QUAD_VERTEX_COUNT * quad_count / (1024.0 * 1024.0));
+
+    bool is_written = packed[4].color != 0 && unpacked[4].color[3] == 1.0f;
+    free(packed);
+    free(unpacked);
+    return is_written ? 0 : 1;
+}
@@ -0,0 +1,154 @@
+// Tests of the frame vertex ring against a fake GPU whose fences complete a few frames late: allocations are
+// aligned and in bounds, never overlap bytes of frames still in flight, wrap when the tail is free and discard
+// instead of waiting when it is not.
+
+// ----------
+// Includes
+
+#include <vector>
+
+#include "test.h"
+#include "../src/vertex_ring.h"
+
+// ---------
+// Structs
+
+struct FakeRange {
+    i32 frame;
+    u32 begin;
+    u32 end;
+};
+
+/**
+ * @brief Fake GPU: a fence signaled in frame N completes in frame N + 'latency'. Discards rename the buffer.
+ */
+struct FakeGpu {
+    std::vector<byte> memory;
+    std::vector<FakeRange> in_flight;
+    i32 frame = 0;
+    i32 latency = 2;
+    i32 signaled_frames[VERTEX_RING_MAX_FRAMES_IN_FLIGHT] = {};
+    i32 maps = 0;
+    i32 unmaps = 0;
+    i32 discards = 0;
+};
+
+// --------------------------
+// Function implementations
+
+byte* FakeMap(void* user_data, bool discard) {
+    FakeGpu* gpu = (FakeGpu*)user_data;
+    gpu->maps++;
+    if (discard) {
+        gpu->discards++;
+        gpu->in_flight.clear();
+    }
+    return gpu->memory.data();
+}
+
+void FakeUnmap(void* user_data) {
+    ((FakeGpu*)user_data)->unmaps++;
+}
+
+void FakeSignalFence(void* user_data, i32 fence_slot) {
+    FakeGpu* gpu = (FakeGpu*)user_data;
+    gpu->signaled_frames[fence_slot] = gpu->frame;
+}
+
+bool FakeIsFenceComplete(void* user_data, i32 fence_slot) {
+    FakeGpu* gpu = (FakeGpu*)user_data;
+    return gpu->latency <= gpu->frame - gpu->signaled_frames[fence_slot];
+}
+
+/**
+ * @brief Run 'frame_count' frames of random allocations and check every allocation against the bytes in flight.
+ */
+void RunFrames(FakeGpu* gpu, VertexRing* ring, i32 frame_count, u32 max_allocation, u32 seed) {
+    i32 overlap_count = 0;
+    i32 misplaced_count = 0;
+
+    for (i32 frame = 0; frame < frame_count; frame++) {
+        gpu->frame++;
+        VertexRingBeginFrame(ring);
+        std::erase_if(gpu->in_flight, [&](FakeRange& range) { return gpu->latency <= gpu->frame - range.frame; });
+
+        seed = seed * 1664525u + 1013904223u;
+        i32 allocation_count = (seed >> 16) % 20;
+        for (i32 i = 0; i < allocation_count; i++) {
+            seed = seed * 1664525u + 1013904223u;
+            u32 size = 1 + (seed >> 8) % max_allocation;
+            VertexRingAllocation allocation = VertexRingAllocate(ring, size, 16);
+            if (!TEST_CHECK(allocation.data != nullptr)) {
+                continue;
+            }
+
+            misplaced_count += allocation.offset % 16 != 0 || ring->capacity < allocation.offset + size
+                || allocation.data != gpu->memory.data() + allocation.offset ? 1 : 0;
+            for (FakeRange& range : gpu->in_flight) {
+                bool is_overlapping = allocation.offset < range.end && range.begin < allocation.offset + size;
+                overlap_count += range.frame < gpu->frame && is_overlapping ? 1 : 0;
+            }
+            gpu->in_flight.push_back(FakeRange{gpu->frame, allocation.offset, allocation.offset + size});
+        }
+        VertexRingEndFrame(ring);
+    }
+
+    TEST_CHECK(overlap_count == 0);
+    TEST_CHECK(misplaced_count == 0);
+}
+
+void TestSteadyState() {
+    FakeGpu gpu = {};
+    gpu.memory.resize(1 << 16);
+    VertexRing ring = {};
+    VertexRingCreate(&ring, VertexRingBackend{&gpu, FakeMap, FakeUnmap, FakeSignalFence, FakeIsFenceComplete}, 1 << 16);
+
+    // Frames use well under a third of the ring, so after the first discard it only wraps
+    RunFrames(&gpu, &ring, 2000, 1000, 1);
+    TEST_CHECK(gpu.discards == 1);
+    TEST_CHECK(gpu.maps == gpu.unmaps);
+
+    // Frames larger than what the fences free up fall back to discarding, never to waiting
+    RunFrames(&gpu, &ring, 2000, 6000, 2);
+    TEST_CHECK(1 < gpu.discards);
+}
+
+void TestStalledGpu() {
+    FakeGpu gpu = {};
+    gpu.memory.resize(4096);
+    gpu.latency = 1000000;
+    VertexRing ring = {};
+    VertexRingCreate(&ring, VertexRingBackend{&gpu, FakeMap, FakeUnmap, FakeSignalFence, FakeIsFenceComplete}, 4096);
+
+    // No fence ever completes: more frames than can be tracked must still all allocate
+    RunFrames(&gpu, &ring, 50, 512, 3);
+    TEST_CHECK(VERTEX_RING_MAX_FRAMES_IN_FLIGHT < gpu.discards);
+}
+
+void TestWrapAndOverflow() {
+    FakeGpu gpu = {};
+    gpu.memory.resize(1000);
+    gpu.latency = 1;
+    VertexRing ring = {};
+    VertexRingCreate(&ring, VertexRingBackend{&gpu, FakeMap, FakeUnmap, FakeSignalFence, FakeIsFenceComplete}, 1000);
+
+    gpu.frame++;
+    VertexRingBeginFrame(&ring);
+    TEST_CHECK(VertexRingAllocate(&ring, 600, 16).offset == 0);
+    VertexRingEndFrame(&ring);
+
+    // The first frame has retired, 600 more bytes do not fit at the end and wrap to offset 0
+    gpu.frame++;
+    VertexRingBeginFrame(&ring);
+    VertexRingAllocation wrapped = VertexRingAllocate(&ring, 600, 16);
+    TEST_CHECK(wrapped.offset == 0 && ring.stat_wraps == 1 && ring.stat_discards == 0);
+    TEST_CHECK(VertexRingAllocate(&ring, 1001, 16).data == nullptr && ring.stat_overflows == 1);
+    VertexRingEndFrame(&ring);
+}
+
+int main() {
+    TestSteadyState();
+    TestStalledGpu();
+    TestWrapAndOverflow();
+    return TestReport("vertex_ring_test");
+}
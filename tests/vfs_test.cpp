@@ -0,0 +1,186 @@
+// Tests of the virtual file system: mount priority, case and separator insensitive paths, remembered misses
+// until VfsInvalidate, the bound on remembered misses, and the last path separator of mixed paths.
+
+// ----------
+// Includes
+
+#include <stdlib.h>
+#include <sys/stat.h>
+
+#include "test.h"
+
+#define STB_IMAGE_IMPLEMENTATION
+#define STB_TRUETYPE_IMPLEMENTATION
+#include "../src/asset_loader.h"
+
+// ---------
+// Globals
+
+char test_directory[64] = "/tmp/vfs_test_XXXXXX";
+
+// --------------------------
+// Function implementations
+
+void WriteTestFile(const char* name, const char* text) {
+    char path[ASSET_PATH_MAX];
+    snprintf(path, ASSET_PATH_MAX, "%s/%s", test_directory, name);
+    FILE* file = fopen(path, "wb");
+    if (!TEST_CHECK(file != nullptr)) {
+        return;
+    }
+    fwrite(text, 1, strlen(text), file);
+    fclose(file);
+}
+
+void RemoveTestFile(const char* name) {
+    char path[ASSET_PATH_MAX];
+    snprintf(path, ASSET_PATH_MAX, "%s/%s", test_directory, name);
+    remove(path);
+}
+
+/**
+ * @brief True if 'path' reads as exactly 'text'. A null 'text' expects the file to be missing.
+ */
+bool ReadsAs(Vfs* vfs, const char* path, const char* text) {
+    size_t size = 0;
+    byte* data = VfsReadFile(vfs, path, &size);
+    if (!data) {
+        return text == nullptr;
+    }
+    bool result = text != nullptr && size == strlen(text) && memcmp(data, text, size) == 0;
+    free(data);
+    return result;
+}
+
+void TestMounts() {
+    char low_directory[ASSET_PATH_MAX];
+    char high_directory[ASSET_PATH_MAX];
+    snprintf(low_directory, ASSET_PATH_MAX, "%s/low", test_directory);
+    snprintf(high_directory, ASSET_PATH_MAX, "%s/high", test_directory);
+    mkdir(low_directory, 0700);
+    mkdir(high_directory, 0700);
+    WriteTestFile("low/a.txt", "low a");
+    WriteTestFile("low/b.txt", "low b");
+    WriteTestFile("high/a.txt", "high a");
+
+    const VfsMemoryFile memory_files[] = {
+        { "Images/D.TXT", (const byte*)"memory d", 8 },
+        { "images/b.txt", (const byte*)"memory b", 8 }
+    };
+
+    Vfs vfs;
+    TEST_CHECK(VfsCreate(&vfs, 64));
+    TEST_CHECK(VfsMountDirectory(&vfs, "", low_directory, 0));
+    TEST_CHECK(VfsMountDirectory(&vfs, "", high_directory, 2));
+    TEST_CHECK(VfsMountMemory(&vfs, "", memory_files, 2, -1));
+    TEST_CHECK(VfsMountDirectory(&vfs, "images", low_directory, 1));
+
+    TEST_CHECK(ReadsAs(&vfs, "a.txt", "high a"));
+    TEST_CHECK(ReadsAs(&vfs, "b.txt", "low b"));
+    TEST_CHECK(ReadsAs(&vfs, "IMAGES\\d.txt", "memory d"));
+    TEST_CHECK(ReadsAs(&vfs, "images/b.txt", "low b"));
+    TEST_CHECK(ReadsAs(&vfs, "images_old/b.txt", nullptr));
+    TEST_CHECK(ReadsAs(&vfs, "c.txt", nullptr));
+
+    VfsFile file;
+    TEST_CHECK(VfsResolve(&vfs, "A.TXT", &file) && file.kind == VFS_MOUNT_DIRECTORY);
+    TEST_CHECK(VfsResolve(&vfs, "images/d.txt", &file) && file.kind == VFS_MOUNT_MEMORY && file.size == 8);
+
+    // The second lookup of each path is answered from the table
+    i64 hits_before = vfs.stats.cache_hits;
+    TEST_CHECK(ReadsAs(&vfs, "a.txt", "high a"));
+    TEST_CHECK(ReadsAs(&vfs, "c.txt", nullptr));
+    TEST_CHECK(vfs.stats.cache_hits == hits_before + 2);
+
+    VfsDestroy(&vfs);
+    RemoveTestFile("low/a.txt");
+    RemoveTestFile("low/b.txt");
+    RemoveTestFile("high/a.txt");
+    rmdir(low_directory);
+    rmdir(high_directory);
+}
+
+void TestRememberedMisses() {
+    Vfs vfs;
+    TEST_CHECK(VfsCreate(&vfs, 64));
+    TEST_CHECK(VfsMountDirectory(&vfs, "", test_directory, 0));
+
+    // A miss hides a file created later until the table is invalidated
+    TEST_CHECK(!VfsExists(&vfs, "new.txt"));
+    WriteTestFile("new.txt", "new");
+    TEST_CHECK(!VfsExists(&vfs, "new.txt"));
+    VfsInvalidate(&vfs);
+    TEST_CHECK(ReadsAs(&vfs, "new.txt", "new"));
+
+    // Removing a file needs the same
+    RemoveTestFile("new.txt");
+    TEST_CHECK(VfsExists(&vfs, "new.txt"));
+    VfsInvalidate(&vfs);
+    TEST_CHECK(!VfsExists(&vfs, "new.txt"));
+
+    VfsDestroy(&vfs);
+}
+
+void TestMissBound() {
+    Vfs vfs;
+    TEST_CHECK(VfsCreate(&vfs, 64));
+    TEST_CHECK(VfsMountDirectory(&vfs, "", test_directory, 0));
+    u32 slot_count = vfs.cache_mask + 1;
+
+    WriteTestFile("present.txt", "present");
+    TEST_CHECK(VfsExists(&vfs, "present.txt"));
+
+    char path[64];
+    for (u32 i = 0; i < slot_count * 4; i++) {
+        snprintf(path, sizeof(path), "missing_%u.txt", i);
+        TEST_CHECK(!VfsExists(&vfs, path));
+    }
+    TEST_CHECK(vfs.cache_miss_count == slot_count / VFS_CACHE_MISS_SHARE);
+    TEST_CHECK(vfs.stats.uncached_misses == slot_count * 4 - slot_count / VFS_CACHE_MISS_SHARE);
+
+    // Misses never filled the table, so the file that exists is still remembered
+    i64 hits_before = vfs.stats.cache_hits;
+    TEST_CHECK(VfsExists(&vfs, "present.txt"));
+    TEST_CHECK(vfs.stats.cache_hits == hits_before + 1);
+
+    // Misses past the bound are resolved again and see new files without an invalidate
+    snprintf(path, sizeof(path), "missing_%u.txt", slot_count * 4 - 1);
+    WriteTestFile(path, "late");
+    TEST_CHECK(ReadsAs(&vfs, path, "late"));
+    RemoveTestFile(path);
+
+    VfsInvalidate(&vfs);
+    TEST_CHECK(vfs.cache_miss_count == 0);
+
+    VfsDestroy(&vfs);
+    RemoveTestFile("present.txt");
+}
+
+void TestPathSeparators() {
+    const char* forward_after_back = "assets\\atlas/sprites.fatl";
+    const char* back_after_forward = "assets/atlas\\sprites.fatl";
+    TEST_CHECK(PathLastSeparator(forward_after_back) == forward_after_back + 12);
+    TEST_CHECK(PathLastSeparator(back_after_forward) == back_after_forward + 12);
+    TEST_CHECK(PathLastSeparator("sprites.fatl") == nullptr);
+
+    char result[ASSET_PATH_MAX];
+    PathWithExtension(result, ASSET_PATH_MAX, "a.b\\c", ".qoi");
+    TEST_CHECK(strcmp(result, "a.b\\c.qoi") == 0);
+    PathWithExtension(result, ASSET_PATH_MAX, "a\\b.c/d.png", ".qoi");
+    TEST_CHECK(strcmp(result, "a\\b.c/d.qoi") == 0);
+}
+
+int main() {
+    if (!mkdtemp(test_directory)) {
+        fprintf(stderr, "could not create %s\n", test_directory);
+        return 1;
+    }
+
+    TestMounts();
+    TestRememberedMisses();
+    TestMissBound();
+    TestPathSeparators();
+
+    rmdir(test_directory);
+    return TestReport("vfs_test");
+}
@@ -0,0 +1,384 @@
+// Offline asset packer. Packs every file under a directory into a single asset pack (see src/asset_pack.h),
+// with entry paths relative to that directory.
+//
+// Build: g++ -O2 -std=c++20 tools/asset_packer.cpp -o asset_packer
+// Usage: asset_packer [--alignment N] [--bench N] -o <output.fpak> <directory>
+//
+// The written pack is mapped again and every entry compared with its source file. With --bench, every file
+// is loaded N times both as a loose file (open, read into a malloc'ed buffer, close) and as a view into the
+// mapped pack, and lookup and load times are printed. On Linux the first, cold round drops the source files
+// and the pack from the page cache first.
+
+// ----------
+// Includes
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "../src/types.h"
+#include "../src/asset_pack.h"
+
+// ---------
+// Defines
+
+const u32 PACK_MAX_ALIGNMENT = 65536;
+const size_t PACK_PAGE_SIZE = 4096;
+
+// ---------
+// Structs
+
+struct SourceFile {
+    std::string path;
+    std::string name;
+    u64 size;
+    u64 offset;
+};
+
+// --------------------------
+// Function implementations
+
+u64 AlignUp(u64 value, u64 alignment) {
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+byte* ReadWholeFile(const char* path, size_t* size) {
+    FILE* file = fopen(path, "rb");
+    if (!file) {
+        return nullptr;
+    }
+    fseek(file, 0, SEEK_END);
+    *size = (size_t)ftell(file);
+    fseek(file, 0, SEEK_SET);
+
+    byte* data = (byte*)malloc(*size ? *size : 1);
+    if (!data || fread(data, 1, *size, file) != *size) {
+        free(data);
+        data = nullptr;
+    }
+    fclose(file);
+    return data;
+}
+
+f64 ElapsedMs(std::chrono::steady_clock::time_point start_time) {
+    return std::chrono::duration<f64, std::milli>(std::chrono::steady_clock::now() - start_time).count();
+}
+
+/**
+ * @brief Evict a file from the OS page cache so that the next read goes to the disk. Only does something on Linux.
+ */
+void DropFileCache(const char* path) {
+#ifdef __linux__
+    int file = open(path, O_RDONLY);
+    if (0 <= file) {
+        fdatasync(file);
+        posix_fadvise(file, 0, 0, POSIX_FADV_DONTNEED);
+        close(file);
+    }
+#else
+    (void)path;
+#endif
+}
+
+bool WritePack(const char* path, std::vector<SourceFile>& files, u32 alignment) {
+    u32 entry_count = (u32)files.size();
+    u32 slot_count = 16;
+    while (slot_count < entry_count * 2) {
+        slot_count *= 2;
+    }
+
+    u32 string_bytes = 0;
+    for (SourceFile& source : files) {
+        string_bytes += (u32)source.name.size() + 1;
+    }
+
+    size_t table_size = AssetPackTableSize(entry_count, slot_count, string_bytes);
+    u64 data_offset = AlignUp(table_size, alignment);
+    u64 offset = data_offset;
+    for (SourceFile& source : files) {
+        source.offset = offset;
+        offset = AlignUp(offset + source.size, alignment);
+    }
+
+    byte* table = (byte*)calloc(1, (size_t)data_offset);
+    if (!table) {
+        return false;
+    }
+
+    AssetPackHeader* header = (AssetPackHeader*)table;
+    header->magic = ASSET_PACK_MAGIC;
+    header->version = ASSET_PACK_VERSION;
+    header->entry_count = entry_count;
+    header->slot_count = slot_count;
+    header->string_bytes = string_bytes;
+    header->alignment = alignment;
+    header->data_offset = data_offset;
+
+    AssetPackEntry* entries = (AssetPackEntry*)(table + sizeof(AssetPackHeader));
+    u32* slots = (u32*)(entries + entry_count);
+    char* strings = (char*)(slots + slot_count);
+    u32 string_offset = 0;
+
+    for (u32 i = 0; i < slot_count; i++) {
+        slots[i] = ASSET_PACK_SLOT_EMPTY;
+    }
+
+    for (u32 i = 0; i < entry_count; i++) {
+        SourceFile* source = &files[i];
+        AssetPackEntry* entry = &entries[i];
+        entry->path_hash = AssetPackHashPath(source->name.c_str());
+        entry->offset = source->offset;
+        entry->size = source->size;
+        entry->name_offset = string_offset;
+        memcpy(strings + string_offset, source->name.c_str(), source->name.size() + 1);
+        string_offset += (u32)source->name.size() + 1;
+
+        u32 slot = (u32)entry->path_hash & (slot_count - 1);
+        while (slots[slot] != ASSET_PACK_SLOT_EMPTY) {
+            slot = (slot + 1) & (slot_count - 1);
+        }
+        slots[slot] = i;
+    }
+
+    FILE* file = fopen(path, "wb");
+    if (!file) {
+        free(table);
+        return false;
+    }
+
+    bool is_ok = fwrite(table, 1, (size_t)data_offset, file) == (size_t)data_offset;
+    free(table);
+
+    static const byte padding[PACK_MAX_ALIGNMENT] = {};
+    u64 written = data_offset;
+    for (SourceFile& source : files) {
+        if (!is_ok) {
+            break;
+        }
+
+        size_t size = 0;
+        byte* data = ReadWholeFile(source.path.c_str(), &size);
+        if (!data || size != source.size) {
+            fprintf(stderr, "Failed to read %s\n", source.path.c_str());
+            free(data);
+            is_ok = false;
+            break;
+        }
+
+        is_ok = fwrite(data, 1, size, file) == size;
+        free(data);
+        written += size;
+
+        size_t padding_size = (size_t)(AlignUp(written, alignment) - written);
+        is_ok = is_ok && fwrite(padding, 1, padding_size, file) == padding_size;
+        written += padding_size;
+    }
+
+    is_ok = fclose(file) == 0 && is_ok;
+    return is_ok;
+}
+
+bool VerifyPack(const char* path, std::vector<SourceFile>& files) {
+    AssetPack pack = {};
+    if (!AssetPackOpenFile(&pack, path)) {
+        fprintf(stderr, "Failed to open the written pack %s\n", path);
+        return false;
+    }
+
+    bool is_ok = true;
+    for (SourceFile& source : files) {
+        size_t view_size = 0;
+        const byte* view = AssetPackView(&pack, source.name.c_str(), &view_size);
+
+        size_t size = 0;
+        byte* data = ReadWholeFile(source.path.c_str(), &size);
+        if (!view || !data || view_size != size || memcmp(view, data, size) != 0) {
+            fprintf(stderr, "%s: packed contents do not match the source\n", source.name.c_str());
+            is_ok = false;
+        }
+        free(data);
+    }
+
+    AssetPackClose(&pack);
+    return is_ok;
+}
+
+/**
+ * @brief Read one byte of every page, so that a pack view costs what a decoder reading it would pay for paging it in.
+ */
+u32 TouchPages(const byte* data, size_t size) {
+    u32 sum = 0;
+    for (size_t i = 0; i < size; i += PACK_PAGE_SIZE) {
+        sum += data[i];
+    }
+    return sum;
+}
+
+void RunBenchmark(const char* pack_path, std::vector<SourceFile>& files, i32 iterations) {
+    u64 total_bytes = 0;
+    for (SourceFile& source : files) {
+        total_bytes += source.size;
+    }
+    f64 total_mb = (f64)total_bytes / (1024.0 * 1024.0);
+    volatile u32 sink = 0;
+
+    for (i32 round = 0; round < 2; round++) {
+        bool is_cold = round == 0;
+        i32 round_iterations = is_cold ? 1 : iterations;
+
+        if (is_cold) {
+            for (SourceFile& source : files) {
+                DropFileCache(source.path.c_str());
+            }
+            DropFileCache(pack_path);
+        }
+
+        // Loose files, the way LoadFileToPtr loads them
+        auto start_time = std::chrono::steady_clock::now();
+        for (i32 i = 0; i < round_iterations; i++) {
+            for (SourceFile& source : files) {
+                size_t size = 0;
+                byte* data = ReadWholeFile(source.path.c_str(), &size);
+                sink = sink + (data ? data[0] : 0);
+                free(data);
+            }
+        }
+        f64 loose_ms = ElapsedMs(start_time) / round_iterations;
+
+        // Views into the pack, opening the mapping included
+        start_time = std::chrono::steady_clock::now();
+        for (i32 i = 0; i < round_iterations; i++) {
+            AssetPack pack = {};
+            AssetPackOpenFile(&pack, pack_path);
+            for (SourceFile& source : files) {
+                size_t size = 0;
+                const byte* view = AssetPackView(&pack, source.name.c_str(), &size);
+                sink = sink + (view ? TouchPages(view, size) : 0);
+            }
+            AssetPackClose(&pack);
+        }
+        f64 pack_ms = ElapsedMs(start_time) / round_iterations;
+
+        printf("%s load of %zu files (%.1f MB): loose %.3f ms (%.1f us/file), pack %.3f ms (%.1f us/file), %.1fx\n",
+            is_cold ? "Cold" : "Warm", files.size(), total_mb,
+            loose_ms, 1000.0 * loose_ms / files.size(), pack_ms, 1000.0 * pack_ms / files.size(), loose_ms / pack_ms);
+    }
+
+    // Lookup alone: resolving a path to its data without touching the data
+    AssetPack pack = {};
+    AssetPackOpenFile(&pack, pack_path);
+    i32 lookup_iterations = iterations * 100;
+
+    auto start_time = std::chrono::steady_clock::now();
+    for (i32 i = 0; i < lookup_iterations; i++) {
+        for (SourceFile& source : files) {
+            const AssetPackEntry* entry = AssetPackFind(&pack, source.name.c_str());
+            sink = sink + (entry ? (u32)entry->size : 0);
+        }
+    }
+    f64 pack_lookup_ns = 1000000.0 * ElapsedMs(start_time) / ((f64)lookup_iterations * files.size());
+    AssetPackClose(&pack);
+
+    start_time = std::chrono::steady_clock::now();
+    for (i32 i = 0; i < iterations; i++) {
+        for (SourceFile& source : files) {
+            FILE* file = fopen(source.path.c_str(), "rb");
+            if (file) {
+                fclose(file);
+            }
+        }
+    }
+    f64 loose_lookup_ns = 1000000.0 * ElapsedMs(start_time) / ((f64)iterations * files.size());
+
+    printf("Lookup: pack %.0f ns/file, loose fopen + fclose %.0f ns/file\n", pack_lookup_ns, loose_lookup_ns);
+}
+
+int main(int argc, char** argv) {
+    u32 alignment = ASSET_PACK_DEFAULT_ALIGNMENT;
+    i32 bench_iterations = 0;
+    char* output_path = nullptr;
+    char* directory = nullptr;
+
+    for (i32 i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--alignment") == 0 && i + 1 < argc) {
+            alignment = (u32)atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--bench") == 0 && i + 1 < argc) {
+            bench_iterations = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+            output_path = argv[++i];
+        }
+        else {
+            directory = argv[i];
+        }
+    }
+
+    bool is_alignment_valid = alignment != 0 && (alignment & (alignment - 1)) == 0 && alignment <= PACK_MAX_ALIGNMENT;
+    if (!output_path || !directory || !is_alignment_valid || bench_iterations < 0) {
+        fprintf(stderr, "Usage: asset_packer [--alignment N] [--bench N] -o <output.fpak> <directory>\n");
+        return 1;
+    }
+
+    auto start_time = std::chrono::steady_clock::now();
+
+    // ------------
+    // List files
+    std::vector<SourceFile> files;
+    std::error_code error;
+    std::filesystem::path output_absolute = std::filesystem::absolute(output_path, error);
+
+    for (auto it = std::filesystem::recursive_directory_iterator(directory, error); !error && it != std::filesystem::recursive_directory_iterator(); it.increment(error)) {
+        if (!it->is_regular_file() || std::filesystem::absolute(it->path(), error) == output_absolute) {
+            continue;
+        }
+
+        SourceFile source = {};
+        source.path = it->path().string();
+        source.size = (u64)it->file_size();
+        for (char c : std::filesystem::relative(it->path(), directory).generic_string()) {
+            source.name += AssetPackNormalizeChar(c);
+        }
+        files.push_back(source);
+    }
+
+    if (error) {
+        fprintf(stderr, "Failed to list %s: %s\n", directory, error.message().c_str());
+        return 1;
+    }
+
+    // Sorted by path, so that packing the same directory twice gives the same file
+    std::sort(files.begin(), files.end(), [](const SourceFile& a, const SourceFile& b) { return a.name < b.name; });
+    for (size_t i = 1; i < files.size(); i++) {
+        if (files[i - 1].name == files[i].name) {
+            fprintf(stderr, "Duplicate pack path '%s' (%s and %s)\n", files[i].name.c_str(), files[i - 1].path.c_str(), files[i].path.c_str());
+            return 1;
+        }
+    }
+
+    // ----------------
+    // Write and check
+    if (!WritePack(output_path, files, alignment)) {
+        fprintf(stderr, "Failed to write %s\n", output_path);
+        return 1;
+    }
+    if (!VerifyPack(output_path, files)) {
+        return 1;
+    }
+
+    u64 source_bytes = 0;
+    for (SourceFile& source : files) {
+        source_bytes += source.size;
+    }
+    printf("%s: %zu files, %llu bytes of data, %llu bytes packed, %.0f ms\n", output_path, files.size(),
+        (unsigned long long)source_bytes, (unsigned long long)std::filesystem::file_size(output_path, error), ElapsedMs(start_time));
+
+    if (0 < bench_iterations && !files.empty()) {
+        RunBenchmark(output_path, files, bench_iterations);
+    }
+    return 0;
+}
@@ -0,0 +1,537 @@
+// Offline texture atlas packer. Packs source images into atlas pages with MaxRects (best short side fit)
+// and writes the pages as 32-bit TGA images plus a binary manifest, see src/texture_atlas.h.
+//
+// Build: g++ -O2 -std=c++20 tools/atlas_packer.cpp -o atlas_packer
+// Usage: atlas_packer [--page-size N] [--padding N] -o <output_prefix> <image> [image...]
+//
+// Region names are the source file names without directory and extension.
+
+// ----------
+// Includes
+
+#include <stdio.h>
+#include <chrono>
+
+#include "../src/types.h"
+#include "../src/texture_atlas.h"
+
+#define STB_IMAGE_IMPLEMENTATION
+#include "../src/stb_image.h"
+
+// ---------
+// Defines
+
+const i32 ATLAS_DEFAULT_PAGE_SIZE = 2048;
+const i32 ATLAS_DEFAULT_PADDING = 2;
+const i32 ATLAS_MAX_PAGE_SIZE = 16384;
+const i32 ATLAS_MAX_NAME_LENGTH = 256;
+
+// ---------
+// Structs
+
+struct PackRect {
+    i32 x;
+    i32 y;
+    i32 width;
+    i32 height;
+};
+
+struct SourceImage {
+    char name[ATLAS_MAX_NAME_LENGTH];
+    char* path;
+    byte* pixels;
+    i32 width;
+    i32 height;
+    i32 page;
+    PackRect rect;
+};
+
+/**
+ * @brief MaxRects bin: the list of maximal free rectangles left on one page.
+ */
+struct MaxRectsBin {
+    i32 width;
+    i32 height;
+    PackRect* free_rects;
+    i32 free_count;
+    i32 free_capacity;
+    i32 used_width;
+    i32 used_height;
+};
+
+// --------------------------
+// Function implementations
+
+bool PackRectContains(PackRect* outer, PackRect* inner) {
+    return outer->x <= inner->x && outer->y <= inner->y
+        && inner->x + inner->width <= outer->x + outer->width
+        && inner->y + inner->height <= outer->y + outer->height;
+}
+
+bool PackRectsOverlap(PackRect* a, PackRect* b) {
+    return a->x < b->x + b->width && b->x < a->x + a->width
+        && a->y < b->y + b->height && b->y < a->y + a->height;
+}
+
+void MaxRectsAddFree(MaxRectsBin* bin, PackRect rect) {
+    if (bin->free_capacity <= bin->free_count) {
+        bin->free_capacity = bin->free_capacity < 64 ? 64 : bin->free_capacity * 2;
+        bin->free_rects = (PackRect*)realloc(bin->free_rects, sizeof(PackRect) * bin->free_capacity);
+        if (!bin->free_rects) {
+            fprintf(stderr, "Out of memory\n");
+            exit(1);
+        }
+    }
+    bin->free_rects[bin->free_count++] = rect;
+}
+
+void MaxRectsInit(MaxRectsBin* bin, i32 width, i32 height) {
+    *bin = {};
+    bin->width = width;
+    bin->height = height;
+    MaxRectsAddFree(bin, PackRect{0, 0, width, height});
+}
+
+/**
+ * @brief Find the free rectangle position that leaves the smallest leftover on its shorter side.
+ */
+bool MaxRectsFindPosition(MaxRectsBin* bin, i32 width, i32 height, PackRect* result) {
+    i32 best_short = INT_MAX;
+    i32 best_long = INT_MAX;
+
+    for (i32 i = 0; i < bin->free_count; i++) {
+        PackRect* free_rect = &bin->free_rects[i];
+        if (free_rect->width < width || free_rect->height < height) {
+            continue;
+        }
+
+        i32 leftover_x = free_rect->width - width;
+        i32 leftover_y = free_rect->height - height;
+        i32 short_side = leftover_x < leftover_y ? leftover_x : leftover_y;
+        i32 long_side = leftover_x < leftover_y ? leftover_y : leftover_x;
+
+        if (short_side < best_short || (short_side == best_short && long_side < best_long)) {
+            best_short = short_side;
+            best_long = long_side;
+            *result = PackRect{free_rect->x, free_rect->y, width, height};
+        }
+    }
+    return best_short != INT_MAX;
+}
+
+/**
+ * @brief Cut 'used' out of every free rectangle it overlaps, then drop free rectangles contained in others.
+ */
+void MaxRectsPlace(MaxRectsBin* bin, PackRect used) {
+    i32 count = bin->free_count;
+    for (i32 i = 0; i < count; i++) {
+        PackRect free_rect = bin->free_rects[i];
+        if (!PackRectsOverlap(&free_rect, &used)) {
+            continue;
+        }
+
+        if (free_rect.x < used.x) {
+            MaxRectsAddFree(bin, PackRect{free_rect.x, free_rect.y, used.x - free_rect.x, free_rect.height});
+        }
+        if (used.x + used.width < free_rect.x + free_rect.width) {
+            MaxRectsAddFree(bin, PackRect{used.x + used.width, free_rect.y, free_rect.x + free_rect.width - (used.x + used.width), free_rect.height});
+        }
+        if (free_rect.y < used.y) {
+            MaxRectsAddFree(bin, PackRect{free_rect.x, free_rect.y, free_rect.width, used.y - free_rect.y});
+        }
+        if (used.y + used.height < free_rect.y + free_rect.height) {
+            MaxRectsAddFree(bin, PackRect{free_rect.x, used.y + used.height, free_rect.width, free_rect.y + free_rect.height - (used.y + used.height)});
+        }
+
+        // Mark the split rectangle for removal
+        bin->free_rects[i].width = 0;
+    }
+
+    // A rectangle removed here is inside one that stays, so later checks can skip it
+    for (i32 i = 0; i < bin->free_count; i++) {
+        PackRect* rect = &bin->free_rects[i];
+        for (i32 j = 0; j < bin->free_count && rect->width != 0; j++) {
+            PackRect* other = &bin->free_rects[j];
+            if (i != j && other->width != 0 && other->height != 0 && PackRectContains(other, rect)) {
+                rect->width = 0;
+            }
+        }
+    }
+
+    i32 kept = 0;
+    for (i32 i = 0; i < bin->free_count; i++) {
+        if (bin->free_rects[i].width != 0 && bin->free_rects[i].height != 0) {
+            bin->free_rects[kept++] = bin->free_rects[i];
+        }
+    }
+    bin->free_count = kept;
+
+    if (bin->used_width < used.x + used.width) {
+        bin->used_width = used.x + used.width;
+    }
+    if (bin->used_height < used.y + used.height) {
+        bin->used_height = used.y + used.height;
+    }
+}
+
+i32 RoundUpToPowerOfTwo(i32 value) {
+    i32 result = 1;
+    while (result < value) {
+        result *= 2;
+    }
+    return result;
+}
+
+/**
+ * @brief Pack every unplaced image that fits on a 'width' x 'height' page, writing positions to 'rects'.
+ *
+ * Images are tried in 'order'. Returns the number of placed images, 'placed[i]' tells which.
+ */
+i32 PackPage(SourceImage** order, i32 image_count, i32 width, i32 height, i32 padding, PackRect* rects, bool* placed, Vec2i* used_size) {
+    MaxRectsBin bin;
+    MaxRectsInit(&bin, width, height);
+    i32 placed_count = 0;
+
+    for (i32 i = 0; i < image_count; i++) {
+        SourceImage* image = order[i];
+        placed[i] = image->page < 0 && MaxRectsFindPosition(&bin, image->width + padding, image->height + padding, &rects[i]);
+        if (placed[i]) {
+            MaxRectsPlace(&bin, rects[i]);
+            placed_count++;
+        }
+    }
+
+    *used_size = Vec2i{bin.used_width, bin.used_height};
+    free(bin.free_rects);
+    return placed_count;
+}
+
+/**
+ * @brief Sort order for packing: larger maximum side first, then larger area.
+ */
+int CompareSourceImages(const void* a, const void* b) {
+    SourceImage* image_a = *(SourceImage**)a;
+    SourceImage* image_b = *(SourceImage**)b;
+    i32 side_a = image_a->width < image_a->height ? image_a->height : image_a->width;
+    i32 side_b = image_b->width < image_b->height ? image_b->height : image_b->width;
+    if (side_a != side_b) {
+        return side_b - side_a;
+    }
+    i64 area_a = (i64)image_a->width * image_a->height;
+    i64 area_b = (i64)image_b->width * image_b->height;
+    return area_a < area_b ? 1 : (area_b < area_a ? -1 : 0);
+}
+
+void ImageNameFromPath(char* path, char* name) {
+    char* base = path;
+    for (char* p = path; *p != '\0'; p++) {
+        if (*p == '/' || *p == '\\') {
+            base = p + 1;
+        }
+    }
+
+    size_t length = strlen(base);
+    char* dot = strrchr(base, '.');
+    if (dot) {
+        length = (size_t)(dot - base);
+    }
+    if (ATLAS_MAX_NAME_LENGTH <= length) {
+        length = ATLAS_MAX_NAME_LENGTH - 1;
+    }
+    memcpy(name, base, length);
+    name[length] = '\0';
+}
+
+/**
+ * @brief Write RGBA pixels as an uncompressed top-left origin 32-bit TGA.
+ */
+bool WriteTGA(char* path, byte* pixels, i32 width, i32 height) {
+    FILE* file = fopen(path, "wb");
+    if (!file) {
+        return false;
+    }
+
+    byte header[18] = {};
+    header[2] = 2; // Uncompressed true color
+    header[12] = (byte)(width & 0xFF);
+    header[13] = (byte)(width >> 8);
+    header[14] = (byte)(height & 0xFF);
+    header[15] = (byte)(height >> 8);
+    header[16] = 32;
+    header[17] = 0x28; // 8 alpha bits, top-left origin
+    fwrite(header, 1, sizeof(header), file);
+
+    size_t row_bytes = (size_t)width * 4;
+    byte* row = (byte*)malloc(row_bytes);
+    for (i32 y = 0; y < height; y++) {
+        byte* src = pixels + row_bytes * y;
+        for (i32 x = 0; x < width; x++) {
+            row[x * 4 + 0] = src[x * 4 + 2];
+            row[x * 4 + 1] = src[x * 4 + 1];
+            row[x * 4 + 2] = src[x * 4 + 0];
+            row[x * 4 + 3] = src[x * 4 + 3];
+        }
+        fwrite(row, 1, row_bytes, file);
+    }
+    free(row);
+
+    bool is_ok = ferror(file) == 0;
+    return fclose(file) == 0 && is_ok;
+}
+
+/**
+ * @brief Build and write the manifest. Page files are named '<prefix base name>_<page>.tga'.
+ */
+bool WriteManifest(char* path, char* page_base_name, SourceImage* images, i32 image_count, i32* page_widths, i32* page_heights, i32 page_count) {
+    u32 slot_count = 16;
+    while (slot_count < (u32)image_count * 2) {
+        slot_count *= 2;
+    }
+
+    u32 string_bytes = 0;
+    for (i32 i = 0; i < page_count; i++) {
+        string_bytes += (u32)snprintf(nullptr, 0, "%s_%d.tga", page_base_name, i) + 1;
+    }
+    for (i32 i = 0; i < image_count; i++) {
+        string_bytes += (u32)strlen(images[i].name) + 1;
+    }
+
+    size_t manifest_size = TextureAtlasManifestSize((u32)page_count, (u32)image_count, slot_count, string_bytes);
+    byte* data = (byte*)calloc(1, manifest_size);
+    if (!data) {
+        return false;
+    }
+
+    TextureAtlasHeader* header = (TextureAtlasHeader*)data;
+    header->magic = TEXTURE_ATLAS_MAGIC;
+    header->version = TEXTURE_ATLAS_VERSION;
+    header->page_count = (u32)page_count;
+    header->region_count = (u32)image_count;
+    header->slot_count = slot_count;
+    header->string_bytes = string_bytes;
+
+    TextureAtlasPage* pages = (TextureAtlasPage*)(data + sizeof(TextureAtlasHeader));
+    TextureAtlasRegion* regions = (TextureAtlasRegion*)(pages + page_count);
+    u32* slots = (u32*)(regions + image_count);
+    char* strings = (char*)(slots + slot_count);
+    u32 string_offset = 0;
+
+    for (i32 i = 0; i < page_count; i++) {
+        pages[i].name_offset = string_offset;
+        pages[i].width = (u16)page_widths[i];
+        pages[i].height = (u16)page_heights[i];
+        string_offset += (u32)sprintf(strings + string_offset, "%s_%d.tga", page_base_name, i) + 1;
+    }
+
+    for (u32 i = 0; i < slot_count; i++) {
+        slots[i] = TEXTURE_ATLAS_SLOT_EMPTY;
+    }
+
+    for (i32 i = 0; i < image_count; i++) {
+        SourceImage* image = &images[i];
+        TextureAtlasRegion* region = &regions[i];
+        region->name_hash = TextureAtlasHashName(image->name);
+        region->name_offset = string_offset;
+        region->page = (u16)image->page;
+        region->x = (u16)image->rect.x;
+        region->y = (u16)image->rect.y;
+        region->width = (u16)image->width;
+        region->height = (u16)image->height;
+        string_offset += (u32)sprintf(strings + string_offset, "%s", image->name) + 1;
+
+        u32 slot = (u32)region->name_hash & (slot_count - 1);
+        while (slots[slot] != TEXTURE_ATLAS_SLOT_EMPTY) {
+            slot = (slot + 1) & (slot_count - 1);
+        }
+        slots[slot] = (u32)i;
+    }
+
+    FILE* file = fopen(path, "wb");
+    if (!file) {
+        free(data);
+        return false;
+    }
+    bool is_ok = fwrite(data, 1, manifest_size, file) == manifest_size;
+    is_ok = fclose(file) == 0 && is_ok;
+    free(data);
+    return is_ok;
+}
+
+int main(int argc, char** argv) {
+    i32 page_size = ATLAS_DEFAULT_PAGE_SIZE;
+    i32 padding = ATLAS_DEFAULT_PADDING;
+    char* output_prefix = nullptr;
+
+    SourceImage* images = (SourceImage*)calloc(argc, sizeof(SourceImage));
+    i32 image_count = 0;
+
+    for (i32 i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--page-size") == 0 && i + 1 < argc) {
+            page_size = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--padding") == 0 && i + 1 < argc) {
+            padding = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+            output_prefix = argv[++i];
+        }
+        else {
+            images[image_count++].path = argv[i];
+        }
+    }
+
+    if (!output_prefix || image_count == 0 || page_size <= 0 || ATLAS_MAX_PAGE_SIZE < page_size || padding < 0) {
+        fprintf(stderr, "Usage: atlas_packer [--page-size N] [--padding N] -o <output_prefix> <image> [image...]\n");
+        return 1;
+    }
+
+    auto start_time = std::chrono::steady_clock::now();
+
+    // -------------
+    // Load images
+    for (i32 i = 0; i < image_count; i++) {
+        SourceImage* image = &images[i];
+        int channels = 0;
+        image->pixels = stbi_load(image->path, &image->width, &image->height, &channels, 4);
+        if (!image->pixels) {
+            fprintf(stderr, "Failed to load %s: %s\n", image->path, stbi_failure_reason());
+            return 1;
+        }
+        if (page_size < image->width + padding || page_size < image->height + padding) {
+            fprintf(stderr, "%s (%dx%d) does not fit on a %d page\n", image->path, image->width, image->height, page_size);
+            return 1;
+        }
+
+        ImageNameFromPath(image->path, image->name);
+        for (i32 j = 0; j < i; j++) {
+            if (strcmp(images[j].name, image->name) == 0) {
+                fprintf(stderr, "Duplicate sprite name '%s' (%s and %s)\n", image->name, images[j].path, image->path);
+                return 1;
+            }
+        }
+    }
+
+    // ------
+    // Pack
+    SourceImage** order = (SourceImage**)malloc(sizeof(SourceImage*) * image_count);
+    for (i32 i = 0; i < image_count; i++) {
+        order[i] = &images[i];
+        order[i]->page = -1;
+    }
+    qsort(order, image_count, sizeof(SourceImage*), CompareSourceImages);
+
+    i32* page_widths = (i32*)malloc(sizeof(i32) * image_count);
+    i32* page_heights = (i32*)malloc(sizeof(i32) * image_count);
+    PackRect* rects = (PackRect*)malloc(sizeof(PackRect) * image_count);
+    bool* placed = (bool*)malloc(sizeof(bool) * image_count);
+    i32 page_count = 0;
+    i32 packed_count = 0;
+
+    while (packed_count < image_count) {
+        i64 remaining_area = 0;
+        for (i32 i = 0; i < image_count; i++) {
+            if (order[i]->page < 0) {
+                remaining_area += (i64)(order[i]->width + padding) * (order[i]->height + padding);
+            }
+        }
+
+        // When the rest could fit on a smaller page, try power of two sizes from the smallest area up
+        // and take the first one that holds everything. Otherwise fill a full size page.
+        Vec2i used_size = {};
+        i32 placed_count = 0;
+        for (i32 area_shift = 0; placed_count < image_count - packed_count && (i64)1 << area_shift <= (i64)page_size * page_size; area_shift++) {
+            if (((i64)1 << area_shift) < remaining_area) {
+                continue;
+            }
+            for (i32 width = page_size; width * width >= ((i64)1 << area_shift) / 2 && 0 < width; width /= 2) {
+                i64 height = ((i64)1 << area_shift) / width;
+                if (height < 1 || page_size < height) {
+                    continue;
+                }
+                placed_count = PackPage(order, image_count, width, (i32)height, padding, rects, placed, &used_size);
+                if (placed_count == image_count - packed_count) {
+                    break;
+                }
+            }
+        }
+        if (placed_count < image_count - packed_count) {
+            placed_count = PackPage(order, image_count, page_size, page_size, padding, rects, placed, &used_size);
+        }
+
+        for (i32 i = 0; i < image_count; i++) {
+            if (placed[i]) {
+                order[i]->page = page_count;
+                order[i]->rect = rects[i];
+            }
+        }
+        packed_count += placed_count;
+
+        // Trim the page to the packed area, rounded up to a power of two for mipmapping
+        page_widths[page_count] = RoundUpToPowerOfTwo(used_size.x);
+        page_heights[page_count] = RoundUpToPowerOfTwo(used_size.y);
+        page_count++;
+    }
+    free(rects);
+    free(placed);
+
+    // -------------------------
+    // Write pages and manifest
+    char* page_base_name = output_prefix;
+    for (char* p = output_prefix; *p != '\0'; p++) {
+        if (*p == '/' || *p == '\\') {
+            page_base_name = p + 1;
+        }
+    }
+
+    char path[1024];
+    i64 total_image_area = 0;
+    i64 total_page_area = 0;
+
+    for (i32 page = 0; page < page_count; page++) {
+        i32 width = page_widths[page];
+        i32 height = page_heights[page];
+        byte* pixels = (byte*)calloc((size_t)width * height, 4);
+        i64 image_area = 0;
+
+        for (i32 i = 0; i < image_count; i++) {
+            SourceImage* image = &images[i];
+            if (image->page != page) {
+                continue;
+            }
+            for (i32 y = 0; y < image->height; y++) {
+                memcpy(pixels + ((size_t)(image->rect.y + y) * width + image->rect.x) * 4, image->pixels + (size_t)y * image->width * 4, (size_t)image->width * 4);
+            }
+            image_area += (i64)image->width * image->height;
+        }
+
+        snprintf(path, sizeof(path), "%s_%d.tga", output_prefix, page);
+        if (!WriteTGA(path, pixels, width, height)) {
+            fprintf(stderr, "Failed to write %s\n", path);
+            return 1;
+        }
+        free(pixels);
+
+        i64 page_area = (i64)width * height;
+        printf("Page %d: %dx%d, efficiency %.1f%%\n", page, width, height, 100.0 * (f64)image_area / (f64)page_area);
+        total_image_area += image_area;
+        total_page_area += page_area;
+    }
+
+    snprintf(path, sizeof(path), "%s.fatl", output_prefix);
+    if (!WriteManifest(path, page_base_name, images, image_count, page_widths, page_heights, page_count)) {
+        fprintf(stderr, "Failed to write %s\n", path);
+        return 1;
+    }
+
+    f64 elapsed_ms = std::chrono::duration<f64, std::milli>(std::chrono::steady_clock::now() - start_time).count();
+    printf("Packed %d images into %d page(s), efficiency %.1f%%, %.1f ms\n", image_count, page_count, 100.0 * (f64)total_image_area / (f64)total_page_area, elapsed_ms);
+
+    for (i32 i = 0; i < image_count; i++) {
+        stbi_image_free(images[i].pixels);
+    }
+    free(images);
+    free(order);
+    free(page_widths);
+    free(page_heights);
+    return 0;
+}
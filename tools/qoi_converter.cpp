@@ -0,0 +1,244 @@
+// Offline QOI converter. Encodes source images to QOI (see src/qoi_image.h) next to the source, so that
+// LoadTextureFromFilepath picks the .qoi up instead of decoding the PNG. Once the PNG is edited again it is
+// newer than the .qoi and is decoded until the converter runs again.
+//
+// Build: g++ -O2 -std=c++20 tools/qoi_converter.cpp -o qoi_converter
+// Usage: qoi_converter [--bench N] <image> [image...]
+//
+// Every converted file is decoded again and compared with the source pixels. With --bench, both the source
+// file through stbi_load and the QOI file are decoded N times and the decode throughput is printed.
+
+// ----------
+// Includes
+
+#include <stdio.h>
+#include <chrono>
+
+#include "../src/types.h"
+#include "../src/qoi_image.h"
+
+#define STB_IMAGE_IMPLEMENTATION
+#include "../src/stb_image.h"
+
+// --------------------------
+// Function implementations
+
+void QoiWriteU32(byte* p, u32 value) {
+    p[0] = (byte)(value >> 24);
+    p[1] = (byte)(value >> 16);
+    p[2] = (byte)(value >> 8);
+    p[3] = (byte)value;
+}
+
+/**
+ * @brief Encode RGBA8 pixels. Returns a malloc'ed file image and its size in 'out_size'.
+ */
+byte* QoiEncode(byte* rgba, u32 width, u32 height, byte channels, size_t* out_size) {
+    size_t pixel_count = (size_t)width * height;
+    size_t max_size = QOI_HEADER_SIZE + pixel_count * (channels + 1) + QOI_END_MARKER_SIZE;
+    byte* data = (byte*)malloc(max_size);
+    if (!data) {
+        fprintf(stderr, "Out of memory\n");
+        exit(1);
+    }
+
+    QoiWriteU32(data, QOI_MAGIC);
+    QoiWriteU32(data + 4, width);
+    QoiWriteU32(data + 8, height);
+    data[12] = channels;
+    data[13] = 0;
+    byte* p = data + QOI_HEADER_SIZE;
+
+    u32 index[64] = {};
+    u32 previous = 0xff000000;
+    i32 run = 0;
+
+    for (size_t i = 0; i < pixel_count; i++) {
+        u32 pixel;
+        memcpy(&pixel, rgba + i * 4, 4);
+
+        if (pixel == previous) {
+            run++;
+            if (run == 62 || i == pixel_count - 1) {
+                *p++ = (byte)(QOI_OP_RUN | (run - 1));
+                run = 0;
+            }
+            continue;
+        }
+
+        if (0 < run) {
+            *p++ = (byte)(QOI_OP_RUN | (run - 1));
+            run = 0;
+        }
+
+        u32 slot = QoiColorHash(pixel);
+        if (index[slot] == pixel) {
+            *p++ = (byte)(QOI_OP_INDEX | slot);
+        }
+        else {
+            index[slot] = pixel;
+
+            if ((pixel >> 24) == (previous >> 24)) {
+                i32 dr = (signed char)((pixel & 0xff) - (previous & 0xff));
+                i32 dg = (signed char)(((pixel >> 8) & 0xff) - ((previous >> 8) & 0xff));
+                i32 db = (signed char)(((pixel >> 16) & 0xff) - ((previous >> 16) & 0xff));
+                i32 dr_dg = (signed char)(dr - dg);
+                i32 db_dg = (signed char)(db - dg);
+
+                if (-3 < dr && dr < 2 && -3 < dg && dg < 2 && -3 < db && db < 2) {
+                    *p++ = (byte)(QOI_OP_DIFF | ((dr + 2) << 4) | ((dg + 2) << 2) | (db + 2));
+                }
+                else if (-33 < dg && dg < 32 && -9 < dr_dg && dr_dg < 8 && -9 < db_dg && db_dg < 8) {
+                    *p++ = (byte)(QOI_OP_LUMA | (dg + 32));
+                    *p++ = (byte)(((dr_dg + 8) << 4) | (db_dg + 8));
+                }
+                else {
+                    *p++ = QOI_OP_RGB;
+                    *p++ = (byte)pixel;
+                    *p++ = (byte)(pixel >> 8);
+                    *p++ = (byte)(pixel >> 16);
+                }
+            }
+            else {
+                *p++ = QOI_OP_RGBA;
+                memcpy(p, &pixel, 4);
+                p += 4;
+            }
+        }
+        previous = pixel;
+    }
+
+    memset(p, 0, QOI_END_MARKER_SIZE - 1);
+    p[QOI_END_MARKER_SIZE - 1] = 1;
+    p += QOI_END_MARKER_SIZE;
+
+    *out_size = (size_t)(p - data);
+    return data;
+}
+
+byte* ReadWholeFile(char* path, size_t* size) {
+    FILE* file = fopen(path, "rb");
+    if (!file) {
+        return nullptr;
+    }
+    fseek(file, 0, SEEK_END);
+    *size = (size_t)ftell(file);
+    fseek(file, 0, SEEK_SET);
+
+    byte* data = (byte*)malloc(*size);
+    if (!data || fread(data, 1, *size, file) != *size) {
+        free(data);
+        data = nullptr;
+    }
+    fclose(file);
+    return data;
+}
+
+f64 ElapsedMs(std::chrono::steady_clock::time_point start_time) {
+    return std::chrono::duration<f64, std::milli>(std::chrono::steady_clock::now() - start_time).count();
+}
+
+bool ConvertImage(char* path, i32 bench_iterations) {
+    size_t source_size = 0;
+    byte* source = ReadWholeFile(path, &source_size);
+    if (!source) {
+        fprintf(stderr, "Failed to read %s\n", path);
+        return false;
+    }
+
+    i32 width = 0;
+    i32 height = 0;
+    i32 channels = 0;
+    byte* image = stbi_load_from_memory(source, (int)source_size, &width, &height, &channels, 4);
+    if (!image) {
+        fprintf(stderr, "Failed to load %s: %s\n", path, stbi_failure_reason());
+        free(source);
+        return false;
+    }
+
+    size_t qoi_size = 0;
+    byte* qoi = QoiEncode(image, (u32)width, (u32)height, channels == 4 || channels == 2 ? 4 : 3, &qoi_size);
+
+    QoiImageInfo info = {};
+    byte* decoded = QoiDecode(qoi, qoi_size, &info);
+    bool is_ok = decoded && memcmp(decoded, image, (size_t)width * height * 4) == 0;
+    free(decoded);
+    if (!is_ok) {
+        fprintf(stderr, "%s: QOI round trip does not match the source\n", path);
+    }
+
+    char output_path[1024];
+    const char* extension = strrchr(path, '.');
+    const char* last_separator = nullptr;
+    for (const char* p = path; *p != 0; p++) {
+        if (*p == '/' || *p == '\\') {
+            last_separator = p;
+        }
+    }
+    i32 stem_length = extension && (!last_separator || last_separator < extension) ? (i32)(extension - path) : (i32)strlen(path);
+    snprintf(output_path, sizeof(output_path), "%.*s.qoi", stem_length, path);
+
+    FILE* file = is_ok ? fopen(output_path, "wb") : nullptr;
+    if (is_ok) {
+        is_ok = file && fwrite(qoi, 1, qoi_size, file) == qoi_size;
+        is_ok = file && fclose(file) == 0 && is_ok;
+        if (!is_ok) {
+            fprintf(stderr, "Failed to write %s\n", output_path);
+        }
+    }
+
+    if (is_ok) {
+        printf("%s: %dx%d, source %zu bytes, QOI %zu bytes (%.0f%%)", output_path, width, height, source_size, qoi_size, 100.0 * (f64)qoi_size / (f64)source_size);
+
+        if (0 < bench_iterations) {
+            f64 image_mb = (f64)width * height * 4 / (1024.0 * 1024.0);
+
+            auto start_time = std::chrono::steady_clock::now();
+            for (i32 i = 0; i < bench_iterations; i++) {
+                stbi_image_free(stbi_load_from_memory(source, (int)source_size, &width, &height, &channels, 4));
+            }
+            f64 stbi_ms = ElapsedMs(start_time) / bench_iterations;
+
+            start_time = std::chrono::steady_clock::now();
+            for (i32 i = 0; i < bench_iterations; i++) {
+                free(QoiDecode(qoi, qoi_size, &info));
+            }
+            f64 qoi_ms = ElapsedMs(start_time) / bench_iterations;
+
+            printf(", decode stbi_load %.2f ms (%.0f MB/s), QOI %.2f ms (%.0f MB/s), %.1fx",
+                stbi_ms, image_mb / (stbi_ms / 1000.0), qoi_ms, image_mb / (qoi_ms / 1000.0), stbi_ms / qoi_ms);
+        }
+        printf("\n");
+    }
+
+    stbi_image_free(image);
+    free(source);
+    free(qoi);
+    return is_ok;
+}
+
+int main(int argc, char** argv) {
+    i32 bench_iterations = 0;
+    i32 first_image = argc;
+
+    for (i32 i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--bench") == 0 && i + 1 < argc) {
+            bench_iterations = atoi(argv[++i]);
+        }
+        else {
+            first_image = i;
+            break;
+        }
+    }
+
+    if (first_image == argc || bench_iterations < 0) {
+        fprintf(stderr, "Usage: qoi_converter [--bench N] <image> [image...]\n");
+        return 1;
+    }
+
+    bool is_ok = true;
+    for (i32 i = first_image; i < argc; i++) {
+        is_ok = ConvertImage(argv[i], bench_iterations) && is_ok;
+    }
+    return is_ok ? 0 : 1;
+}
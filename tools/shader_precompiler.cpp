@@ -0,0 +1,161 @@
+// Offline shader precompiler. Compiles every .hlsl file under a resources directory into a shader cache
+// (see src/shader_cache.h), so a release build starts without running the HLSL compiler.
+//
+// Build: cl /std:c++20 /O2 /EHsc tools/shader_precompiler.cpp /link D3DCompiler.lib
+// Usage: shader_precompiler [--clean] -o <cache directory> <resources directory>
+//
+// Each file is compiled for VSMain with vs_5_0 and PSMain with ps_5_0, the entry points and profiles the game
+// uses, and is read by its path relative to the resources directory like the game reads it through the VFS.
+// The keys therefore match what the game looks up. The game reads 'shader_cache' in the directory of its
+// executable, or the directory FINITE_ENGINE_SHADER_CACHE points at; build_release.bat fills
+// release\shader_cache. After a run where everything compiled, entries of sources that have changed or no
+// longer exist are pruned. --clean removes all cache files first and compiles everything again.
+
+// ----------
+// Includes
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "../src/types.h"
+#include "../src/shader_cache.h"
+#include "../src/shader_compiler.h"
+
+// ---------
+// Structs
+
+struct ShaderEntryPoint {
+    const char* name;
+    const char* profile;
+};
+
+// ---------
+// Defines
+
+const ShaderEntryPoint SHADER_ENTRY_POINTS[] = {
+    { "VSMain", "vs_5_0" },
+    { "PSMain", "ps_5_0" },
+};
+const i32 SHADER_PRECOMPILER_ERROR_MAX = 4096;
+
+// --------------------------
+// Function implementations
+
+/**
+ * @brief ShaderCacheSourceReader callback, 'user_data' is the resources directory.
+ */
+byte* ReadSourceFile(void* user_data, const char* path, size_t* size) {
+    std::filesystem::path native_path = std::filesystem::path((const char*)user_data) / path;
+    return ShaderCacheReadFile(native_path.string().c_str(), size);
+}
+
+void PrintUsage() {
+    fprintf(stderr, "Usage: shader_precompiler [--clean] -o <cache directory> <resources directory>\n");
+}
+
+int main(int argc, char** argv) {
+    const char* output_directory = nullptr;
+    const char* resources_directory = nullptr;
+    bool is_clean = false;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--clean") == 0) {
+            is_clean = true;
+        }
+        else if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+            output_directory = argv[++i];
+        }
+        else if (!resources_directory) {
+            resources_directory = argv[i];
+        }
+        else {
+            PrintUsage();
+            return 1;
+        }
+    }
+    if (!output_directory || !resources_directory) {
+        PrintUsage();
+        return 1;
+    }
+
+    std::error_code error_code;
+    if (!std::filesystem::is_directory(resources_directory, error_code)) {
+        fprintf(stderr, "Not a directory: %s\n", resources_directory);
+        return 1;
+    }
+
+    ShaderCache cache;
+    if (!ShaderCacheCreate(&cache, output_directory)) {
+        fprintf(stderr, "Failed to create the cache directory: %s\n", output_directory);
+        return 1;
+    }
+
+    if (is_clean) {
+        i32 removed_count = 0;
+        for (const auto& entry : std::filesystem::directory_iterator(output_directory, error_code)) {
+            std::string extension = entry.path().extension().string();
+            if (entry.is_regular_file() && (extension == SHADER_CACHE_EXTENSION || extension == ".tmp")) {
+                removed_count += std::filesystem::remove(entry.path(), error_code) ? 1 : 0;
+            }
+        }
+        printf("Removed %d cache files\n", removed_count);
+    }
+
+    // Sorted for stable output
+    std::vector<std::string> paths;
+    for (const auto& entry : std::filesystem::recursive_directory_iterator(resources_directory, error_code)) {
+        if (entry.is_regular_file() && entry.path().extension() == ".hlsl") {
+            paths.push_back(std::filesystem::relative(entry.path(), resources_directory).generic_string());
+        }
+    }
+    std::sort(paths.begin(), paths.end());
+
+    ShaderCacheSourceReader reader = { (void*)resources_directory, ReadSourceFile };
+    char error[SHADER_PRECOMPILER_ERROR_MAX];
+    i32 failed_count = 0;
+    std::vector<u64> current_keys;
+    auto start_time = std::chrono::steady_clock::now();
+
+    for (const std::string& path : paths) {
+        for (const ShaderEntryPoint& entry_point : SHADER_ENTRY_POINTS) {
+            i32 hits_before = cache.stats.hits;
+            ID3DBlob* blob = ShaderCompileCached(&cache, &reader, path.c_str(), nullptr, entry_point.name, entry_point.profile, 0, error, SHADER_PRECOMPILER_ERROR_MAX);
+            if (!blob) {
+                fprintf(stderr, "%s %s: %s\n", path.c_str(), entry_point.name, error);
+                failed_count++;
+                continue;
+            }
+
+            const char* result = hits_before < cache.stats.hits ? "up to date" : "compiled";
+            printf("%-40s %-8s %6zu bytes  %s\n", path.c_str(), entry_point.name, (size_t)blob->GetBufferSize(), result);
+            blob->Release();
+
+            // The same key ShaderCompileCached looked up, read again rather than threaded out of it
+            size_t source_size = 0;
+            byte* source = ReadSourceFile((void*)resources_directory, path.c_str(), &source_size);
+            u64 key = 0;
+            if (source && ShaderCompileKey(source, source_size, nullptr, entry_point.name, entry_point.profile, 0, &key)) {
+                current_keys.push_back(key);
+            }
+            free(source);
+        }
+    }
+
+    // Nothing is pruned after a failed compile, the entry of the last version that compiled stays
+    i32 pruned_count = 0;
+    if (failed_count == 0) {
+        pruned_count = ShaderCachePrune(&cache, current_keys.data(), (i32)current_keys.size());
+    }
+
+    f64 elapsed_ms = std::chrono::duration<f64, std::milli>(std::chrono::steady_clock::now() - start_time).count();
+    printf("%zu files, %d up to date, %d written, %d pruned, %d failed to write, %d failed to compile in %.1f ms\n",
+        paths.size(), cache.stats.hits.load(), cache.stats.writes.load(), pruned_count, cache.stats.write_failures.load(), failed_count, elapsed_ms);
+
+    return failed_count == 0 && cache.stats.write_failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,930 @@
+// Offline block texture compressor. Builds the mip chain of each source image with src/mipmap.h, encodes
+// every level to BC1, BC3 or BC7 on all cores and writes a block texture container, see src/block_texture.h.
+//
+// Build: g++ -O2 -std=c++20 -pthread tools/texture_compressor.cpp -o texture_compressor
+// Usage: texture_compressor [--format auto|bc1|bc3|bc7] [--threads N] [--no-mips] <image> [image...]
+//
+// Each image is written next to its source with the extension replaced by .fbct, which the game uses while
+// it is not older than the source. 'auto' picks BC1 for fully opaque images and BC7 otherwise. BC1 output
+// is always opaque. Level 0 sides must be multiples of 4.
+//
+// Encoders:
+//   BC1  principal axis endpoints, two least squares refinement passes, always 4 color mode
+//   BC3  BC1 color block fitted to the visible texels plus an alpha block that also tries the 0/255 mode
+//   BC7  mode 6 only (one subset, RGBA 7777 endpoints with p-bits, 4-bit indices), principal axis endpoints,
+//        all four p-bit pairs and two least squares refinement passes
+
+// ----------
+// Includes
+
+#include <stdio.h>
+#include <math.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include "../src/types.h"
+#include "../src/mipmap.h"
+#include "../src/block_texture.h"
+
+#define STB_IMAGE_IMPLEMENTATION
+#include "../src/stb_image.h"
+
+// ---------
+// Defines
+
+const i32 COMPRESSOR_MAX_THREADS = 64;
+const i32 COMPRESSOR_REFINE_PASSES = 2;
+
+const i32 BC7_WEIGHTS_4[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+// ---------
+// Structs
+
+/**
+ * @brief 4x4 source texels, row-major, RGBA.
+ */
+struct ColorBlock {
+    f32 pixels[16][4];
+};
+
+/**
+ * @brief One block row of one mip level, the unit of work handed to the encoder threads.
+ */
+struct EncodeJob {
+    i32 level;
+    i32 block_y;
+};
+
+struct EncodeContext {
+    MipChain* chain;
+    u32 format;
+    byte* output;
+    size_t level_offsets[MIPMAP_MAX_LEVELS];
+    EncodeJob* jobs;
+    i32 job_count;
+    std::atomic<i32> next_job;
+};
+
+struct BitWriter {
+    u64 bits[2];
+    i32 position;
+};
+
+struct BitReader {
+    const byte* data;
+    i32 position;
+};
+
+// --------------------------
+// Function implementations
+
+i32 ClampInt(i32 value, i32 min, i32 max) {
+    return value < min ? min : (max < value ? max : value);
+}
+
+f32 ClampFloat(f32 value, f32 min, f32 max) {
+    return value < min ? min : (max < value ? max : value);
+}
+
+/**
+ * @brief Fetch a 4x4 block, repeating the last row and column for levels smaller than a block.
+ */
+void FetchColorBlock(byte* pixels, i32 width, i32 height, i32 block_x, i32 block_y, ColorBlock* block) {
+    for (i32 y = 0; y < 4; y++) {
+        i32 source_y = ClampInt(block_y * 4 + y, 0, height - 1);
+        for (i32 x = 0; x < 4; x++) {
+            i32 source_x = ClampInt(block_x * 4 + x, 0, width - 1);
+            byte* p = pixels + ((size_t)source_y * width + source_x) * 4;
+            for (i32 c = 0; c < 4; c++) {
+                block->pixels[y * 4 + x][c] = (f32)p[c];
+            }
+        }
+    }
+}
+
+/**
+ * @brief Principal axis of the weighted texels over the first 'channels' channels by power iteration.
+ *
+ * Returns false when the texels are all the same color. 'mean' and 'axis' always get 'channels' values.
+ */
+bool PrincipalAxis(ColorBlock* block, f32* weights, i32 channels, f32* mean, f32* axis) {
+    f32 weight_sum = 0.0f;
+    for (i32 c = 0; c < channels; c++) {
+        mean[c] = 0.0f;
+    }
+    for (i32 i = 0; i < 16; i++) {
+        weight_sum += weights[i];
+        for (i32 c = 0; c < channels; c++) {
+            mean[c] += block->pixels[i][c] * weights[i];
+        }
+    }
+    for (i32 c = 0; c < channels; c++) {
+        mean[c] /= weight_sum;
+    }
+
+    f32 covariance[4][4] = {};
+    for (i32 i = 0; i < 16; i++) {
+        for (i32 a = 0; a < channels; a++) {
+            for (i32 b = 0; b < channels; b++) {
+                covariance[a][b] += (block->pixels[i][a] - mean[a]) * (block->pixels[i][b] - mean[b]) * weights[i];
+            }
+        }
+    }
+
+    f32 vector[4] = { 1.0f, 0.7f, 0.5f, 0.3f };
+    f32 length = 0.0f;
+    for (i32 iteration = 0; iteration < 8; iteration++) {
+        f32 next[4] = {};
+        for (i32 a = 0; a < channels; a++) {
+            for (i32 b = 0; b < channels; b++) {
+                next[a] += covariance[a][b] * vector[b];
+            }
+        }
+
+        length = 0.0f;
+        for (i32 c = 0; c < channels; c++) {
+            length += next[c] * next[c];
+        }
+        length = sqrtf(length);
+        if (length < 1e-6f) {
+            break;
+        }
+        for (i32 c = 0; c < channels; c++) {
+            vector[c] = next[c] / length;
+        }
+    }
+
+    for (i32 c = 0; c < channels; c++) {
+        axis[c] = vector[c];
+    }
+    return 1e-6f <= length;
+}
+
+/**
+ * @brief Endpoints at the extreme projections of the weighted texels on the principal axis.
+ */
+void AxisEndpoints(ColorBlock* block, f32* weights, i32 channels, f32* endpoint_low, f32* endpoint_high) {
+    f32 mean[4];
+    f32 axis[4];
+    if (!PrincipalAxis(block, weights, channels, mean, axis)) {
+        for (i32 c = 0; c < channels; c++) {
+            endpoint_low[c] = mean[c];
+            endpoint_high[c] = mean[c];
+        }
+        return;
+    }
+
+    f32 min_t = 1e30f;
+    f32 max_t = -1e30f;
+    for (i32 i = 0; i < 16; i++) {
+        if (weights[i] <= 0.0f) {
+            continue;
+        }
+        f32 t = 0.0f;
+        for (i32 c = 0; c < channels; c++) {
+            t += (block->pixels[i][c] - mean[c]) * axis[c];
+        }
+        min_t = t < min_t ? t : min_t;
+        max_t = max_t < t ? t : max_t;
+    }
+
+    for (i32 c = 0; c < channels; c++) {
+        endpoint_low[c] = ClampFloat(mean[c] + axis[c] * min_t, 0.0f, 255.0f);
+        endpoint_high[c] = ClampFloat(mean[c] + axis[c] * max_t, 0.0f, 255.0f);
+    }
+}
+
+/**
+ * @brief Least squares endpoints for fixed per texel interpolation factors. Returns false if the system is singular.
+ *
+ * Each texel is modelled as (1 - t) * low + t * high with t = factors[i].
+ */
+bool LeastSquaresEndpoints(ColorBlock* block, f32* weights, f32* factors, i32 channels, f32* endpoint_low, f32* endpoint_high) {
+    f32 aa = 0.0f;
+    f32 ab = 0.0f;
+    f32 bb = 0.0f;
+    f32 ax[4] = {};
+    f32 bx[4] = {};
+
+    for (i32 i = 0; i < 16; i++) {
+        f32 b = factors[i];
+        f32 a = 1.0f - b;
+        aa += a * a * weights[i];
+        ab += a * b * weights[i];
+        bb += b * b * weights[i];
+        for (i32 c = 0; c < channels; c++) {
+            ax[c] += a * block->pixels[i][c] * weights[i];
+            bx[c] += b * block->pixels[i][c] * weights[i];
+        }
+    }
+
+    f32 determinant = aa * bb - ab * ab;
+    if (fabsf(determinant) < 1e-6f) {
+        return false;
+    }
+
+    for (i32 c = 0; c < channels; c++) {
+        endpoint_low[c] = ClampFloat((ax[c] * bb - bx[c] * ab) / determinant, 0.0f, 255.0f);
+        endpoint_high[c] = ClampFloat((bx[c] * aa - ax[c] * ab) / determinant, 0.0f, 255.0f);
+    }
+    return true;
+}
+
+// -----
+// BC1
+
+u16 PackRGB565(f32* color) {
+    i32 r = ClampInt((i32)(color[0] * 31.0f / 255.0f + 0.5f), 0, 31);
+    i32 g = ClampInt((i32)(color[1] * 63.0f / 255.0f + 0.5f), 0, 63);
+    i32 b = ClampInt((i32)(color[2] * 31.0f / 255.0f + 0.5f), 0, 31);
+    return (u16)((r << 11) | (g << 5) | b);
+}
+
+void UnpackRGB565(u16 packed, i32* color) {
+    i32 r = (packed >> 11) & 31;
+    i32 g = (packed >> 5) & 63;
+    i32 b = packed & 31;
+    color[0] = (r << 3) | (r >> 2);
+    color[1] = (g << 2) | (g >> 4);
+    color[2] = (b << 3) | (b >> 2);
+}
+
+/**
+ * @brief Four color BC1 palette. Index 0 is color0, index 1 color1, 2 and 3 are the thirds in between.
+ */
+void BC1Palette(u16 color0, u16 color1, i32 palette[4][3]) {
+    UnpackRGB565(color0, palette[0]);
+    UnpackRGB565(color1, palette[1]);
+    for (i32 c = 0; c < 3; c++) {
+        palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+        palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+    }
+}
+
+/**
+ * @brief Pick the nearest palette entry for every texel. Returns the weighted squared error.
+ */
+f32 BC1SelectIndices(ColorBlock* block, f32* weights, u16 color0, u16 color1, u32* indices) {
+    i32 palette[4][3];
+    BC1Palette(color0, color1, palette);
+
+    f32 total_error = 0.0f;
+    *indices = 0;
+    for (i32 i = 0; i < 16; i++) {
+        f32 best_error = 1e30f;
+        u32 best_index = 0;
+        for (u32 index = 0; index < 4; index++) {
+            f32 error = 0.0f;
+            for (i32 c = 0; c < 3; c++) {
+                f32 d = block->pixels[i][c] - (f32)palette[index][c];
+                error += d * d;
+            }
+            if (error < best_error) {
+                best_error = error;
+                best_index = index;
+            }
+        }
+        *indices |= best_index << (i * 2);
+        total_error += best_error * weights[i];
+    }
+    return total_error;
+}
+
+/**
+ * @brief Encode the color part of a BC1 or BC3 block in 4 color mode. Texels with zero weight do not affect the fit.
+ */
+void EncodeBC1Color(ColorBlock* block, f32* weights, byte* out) {
+    const f32 index_factors[4] = { 0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f };
+
+    f32 low[4];
+    f32 high[4];
+    AxisEndpoints(block, weights, 3, low, high);
+
+    u16 best_color0 = PackRGB565(high);
+    u16 best_color1 = PackRGB565(low);
+    u32 best_indices = 0;
+    f32 best_error = BC1SelectIndices(block, weights, best_color0, best_color1, &best_indices);
+
+    for (i32 pass = 0; pass < COMPRESSOR_REFINE_PASSES && 0.0f < best_error; pass++) {
+        // color0 is the 'high' endpoint, so the factor of each index is measured from color1
+        f32 factors[16];
+        for (i32 i = 0; i < 16; i++) {
+            factors[i] = 1.0f - index_factors[(best_indices >> (i * 2)) & 3];
+        }
+        if (!LeastSquaresEndpoints(block, weights, factors, 3, low, high)) {
+            break;
+        }
+
+        u16 color0 = PackRGB565(high);
+        u16 color1 = PackRGB565(low);
+        u32 indices = 0;
+        f32 error = BC1SelectIndices(block, weights, color0, color1, &indices);
+        if (best_error <= error) {
+            break;
+        }
+        best_color0 = color0;
+        best_color1 = color1;
+        best_indices = indices;
+        best_error = error;
+    }
+
+    // Decoders treat color0 <= color1 as the 3 color mode, swap so the 4 color mode is used
+    if (best_color0 < best_color1) {
+        u16 swap = best_color0;
+        best_color0 = best_color1;
+        best_color1 = swap;
+        best_indices ^= 0x55555555;
+    }
+    else if (best_color0 == best_color1) {
+        best_indices = 0;
+    }
+
+    out[0] = (byte)best_color0;
+    out[1] = (byte)(best_color0 >> 8);
+    out[2] = (byte)best_color1;
+    out[3] = (byte)(best_color1 >> 8);
+    memcpy(out + 4, &best_indices, 4);
+}
+
+void DecodeBC1Color(const byte* block, byte* out, i32 out_stride) {
+    u16 color0 = (u16)(block[0] | (block[1] << 8));
+    u16 color1 = (u16)(block[2] | (block[3] << 8));
+    u32 indices;
+    memcpy(&indices, block + 4, 4);
+
+    i32 palette[4][3];
+    BC1Palette(color0, color1, palette);
+    for (i32 i = 0; i < 16; i++) {
+        i32* color = palette[(indices >> (i * 2)) & 3];
+        byte* p = out + (i / 4) * out_stride + (i % 4) * 4;
+        p[0] = (byte)color[0];
+        p[1] = (byte)color[1];
+        p[2] = (byte)color[2];
+    }
+}
+
+// -----
+// BC3
+
+void BC3AlphaPalette(i32 alpha0, i32 alpha1, i32* palette) {
+    palette[0] = alpha0;
+    palette[1] = alpha1;
+    if (alpha1 < alpha0) {
+        for (i32 i = 1; i < 7; i++) {
+            palette[i + 1] = ((7 - i) * alpha0 + i * alpha1) / 7;
+        }
+    }
+    else {
+        for (i32 i = 1; i < 5; i++) {
+            palette[i + 1] = ((5 - i) * alpha0 + i * alpha1) / 5;
+        }
+        palette[6] = 0;
+        palette[7] = 255;
+    }
+}
+
+f32 BC3SelectAlphaIndices(ColorBlock* block, i32 alpha0, i32 alpha1, u64* indices) {
+    i32 palette[8];
+    BC3AlphaPalette(alpha0, alpha1, palette);
+
+    f32 total_error = 0.0f;
+    *indices = 0;
+    for (i32 i = 0; i < 16; i++) {
+        f32 best_error = 1e30f;
+        u64 best_index = 0;
+        for (u64 index = 0; index < 8; index++) {
+            f32 d = block->pixels[i][3] - (f32)palette[index];
+            if (d * d < best_error) {
+                best_error = d * d;
+                best_index = index;
+            }
+        }
+        *indices |= best_index << (i * 3);
+        total_error += best_error;
+    }
+    return total_error;
+}
+
+/**
+ * @brief Alpha half of a BC3 block. Tries the 8 value mode over the full range and the 6 value mode over the
+ * texels strictly between 0 and 255, which keeps cutout edges exact.
+ */
+void EncodeBC3Alpha(ColorBlock* block, byte* out) {
+    i32 min_alpha = 255;
+    i32 max_alpha = 0;
+    i32 inner_min = 255;
+    i32 inner_max = 0;
+    for (i32 i = 0; i < 16; i++) {
+        i32 alpha = (i32)block->pixels[i][3];
+        min_alpha = alpha < min_alpha ? alpha : min_alpha;
+        max_alpha = max_alpha < alpha ? alpha : max_alpha;
+        if (0 < alpha && alpha < 255) {
+            inner_min = alpha < inner_min ? alpha : inner_min;
+            inner_max = inner_max < alpha ? alpha : inner_max;
+        }
+    }
+
+    i32 alpha0 = max_alpha;
+    i32 alpha1 = min_alpha;
+    u64 indices = 0;
+    f32 error = BC3SelectAlphaIndices(block, alpha0, alpha1, &indices);
+
+    if (0.0f < error) {
+        if (inner_max < inner_min) {
+            inner_min = inner_max = 0;
+        }
+        u64 inner_indices = 0;
+        f32 inner_error = BC3SelectAlphaIndices(block, inner_min, inner_max, &inner_indices);
+        if (inner_error < error) {
+            alpha0 = inner_min;
+            alpha1 = inner_max;
+            indices = inner_indices;
+        }
+    }
+
+    out[0] = (byte)alpha0;
+    out[1] = (byte)alpha1;
+    for (i32 i = 0; i < 6; i++) {
+        out[2 + i] = (byte)(indices >> (i * 8));
+    }
+}
+
+void DecodeBC3Alpha(const byte* block, byte* out, i32 out_stride) {
+    i32 palette[8];
+    BC3AlphaPalette(block[0], block[1], palette);
+
+    u64 indices = 0;
+    for (i32 i = 0; i < 6; i++) {
+        indices |= (u64)block[2 + i] << (i * 8);
+    }
+    for (i32 i = 0; i < 16; i++) {
+        out[(i / 4) * out_stride + (i % 4) * 4 + 3] = (byte)palette[(indices >> (i * 3)) & 7];
+    }
+}
+
+// -----
+// BC7
+
+void BitWrite(BitWriter* writer, u32 value, i32 count) {
+    for (i32 i = 0; i < count; i++, writer->position++) {
+        writer->bits[writer->position / 64] |= (u64)((value >> i) & 1) << (writer->position % 64);
+    }
+}
+
+u32 BitRead(BitReader* reader, i32 count) {
+    u32 value = 0;
+    for (i32 i = 0; i < count; i++, reader->position++) {
+        value |= (u32)((reader->data[reader->position / 8] >> (reader->position % 8)) & 1) << i;
+    }
+    return value;
+}
+
+/**
+ * @brief Quantize an endpoint to 7 bits per channel plus a shared p-bit. 'quantized' gets the 7-bit values.
+ */
+void BC7QuantizeEndpoint(f32* endpoint, u32 p_bit, i32* quantized, i32* expanded) {
+    for (i32 c = 0; c < 4; c++) {
+        quantized[c] = ClampInt((i32)((endpoint[c] - (f32)p_bit) * 0.5f + 0.5f), 0, 127);
+        expanded[c] = (quantized[c] << 1) | (i32)p_bit;
+    }
+}
+
+f32 BC7SelectIndices(ColorBlock* block, i32* expanded0, i32* expanded1, byte* indices) {
+    i32 palette[16][4];
+    for (i32 index = 0; index < 16; index++) {
+        i32 weight = BC7_WEIGHTS_4[index];
+        for (i32 c = 0; c < 4; c++) {
+            palette[index][c] = ((64 - weight) * expanded0[c] + weight * expanded1[c] + 32) >> 6;
+        }
+    }
+
+    f32 total_error = 0.0f;
+    for (i32 i = 0; i < 16; i++) {
+        f32 best_error = 1e30f;
+        for (i32 index = 0; index < 16; index++) {
+            f32 error = 0.0f;
+            for (i32 c = 0; c < 4; c++) {
+                f32 d = block->pixels[i][c] - (f32)palette[index][c];
+                error += d * d;
+            }
+            if (error < best_error) {
+                best_error = error;
+                indices[i] = (byte)index;
+            }
+        }
+        total_error += best_error;
+    }
+    return total_error;
+}
+
+struct BC7Mode6Candidate {
+    i32 quantized[2][4];
+    u32 p_bits[2];
+    byte indices[16];
+    f32 error;
+};
+
+/**
+ * @brief Try all four p-bit pairs for a pair of float endpoints and keep the best one in 'best'.
+ */
+void BC7TryEndpoints(ColorBlock* block, f32* endpoint0, f32* endpoint1, BC7Mode6Candidate* best) {
+    for (u32 p_pair = 0; p_pair < 4; p_pair++) {
+        BC7Mode6Candidate candidate;
+        i32 expanded[2][4];
+        candidate.p_bits[0] = p_pair & 1;
+        candidate.p_bits[1] = p_pair >> 1;
+        BC7QuantizeEndpoint(endpoint0, candidate.p_bits[0], candidate.quantized[0], expanded[0]);
+        BC7QuantizeEndpoint(endpoint1, candidate.p_bits[1], candidate.quantized[1], expanded[1]);
+        candidate.error = BC7SelectIndices(block, expanded[0], expanded[1], candidate.indices);
+        if (candidate.error < best->error) {
+            *best = candidate;
+        }
+    }
+}
+
+void EncodeBC7(ColorBlock* block, byte* out) {
+    f32 weights[16];
+    for (i32 i = 0; i < 16; i++) {
+        weights[i] = 1.0f;
+    }
+
+    f32 low[4];
+    f32 high[4];
+    AxisEndpoints(block, weights, 4, low, high);
+
+    BC7Mode6Candidate best = {};
+    best.error = 1e30f;
+    BC7TryEndpoints(block, low, high, &best);
+
+    for (i32 pass = 0; pass < COMPRESSOR_REFINE_PASSES && 0.0f < best.error; pass++) {
+        f32 factors[16];
+        for (i32 i = 0; i < 16; i++) {
+            factors[i] = (f32)BC7_WEIGHTS_4[best.indices[i]] / 64.0f;
+        }
+        if (!LeastSquaresEndpoints(block, weights, factors, 4, low, high)) {
+            break;
+        }
+        f32 previous_error = best.error;
+        BC7TryEndpoints(block, low, high, &best);
+        if (previous_error <= best.error) {
+            break;
+        }
+    }
+
+    // The anchor index of texel 0 is stored without its top bit, so it has to be below 8
+    if (8 <= best.indices[0]) {
+        for (i32 c = 0; c < 4; c++) {
+            i32 swap = best.quantized[0][c];
+            best.quantized[0][c] = best.quantized[1][c];
+            best.quantized[1][c] = swap;
+        }
+        u32 swap = best.p_bits[0];
+        best.p_bits[0] = best.p_bits[1];
+        best.p_bits[1] = swap;
+        for (i32 i = 0; i < 16; i++) {
+            best.indices[i] = (byte)(15 - best.indices[i]);
+        }
+    }
+
+    BitWriter writer = {};
+    BitWrite(&writer, 1 << 6, 7);
+    for (i32 c = 0; c < 4; c++) {
+        BitWrite(&writer, (u32)best.quantized[0][c], 7);
+        BitWrite(&writer, (u32)best.quantized[1][c], 7);
+    }
+    BitWrite(&writer, best.p_bits[0], 1);
+    BitWrite(&writer, best.p_bits[1], 1);
+    BitWrite(&writer, best.indices[0], 3);
+    for (i32 i = 1; i < 16; i++) {
+        BitWrite(&writer, best.indices[i], 4);
+    }
+    memcpy(out, writer.bits, 16);
+}
+
+/**
+ * @brief Decode a BC7 mode 6 block, the only mode the encoder writes. Other modes decode to magenta.
+ */
+void DecodeBC7(const byte* block, byte* out, i32 out_stride) {
+    if ((block[0] & 0x7F) != 1 << 6) {
+        for (i32 i = 0; i < 16; i++) {
+            byte* p = out + (i / 4) * out_stride + (i % 4) * 4;
+            p[0] = 255;
+            p[1] = 0;
+            p[2] = 255;
+            p[3] = 255;
+        }
+        return;
+    }
+
+    BitReader reader = { block, 7 };
+    i32 endpoints[2][4];
+    for (i32 c = 0; c < 4; c++) {
+        endpoints[0][c] = (i32)BitRead(&reader, 7);
+        endpoints[1][c] = (i32)BitRead(&reader, 7);
+    }
+    for (i32 e = 0; e < 2; e++) {
+        u32 p_bit = BitRead(&reader, 1);
+        for (i32 c = 0; c < 4; c++) {
+            endpoints[e][c] = (endpoints[e][c] << 1) | (i32)p_bit;
+        }
+    }
+
+    for (i32 i = 0; i < 16; i++) {
+        i32 weight = BC7_WEIGHTS_4[BitRead(&reader, i == 0 ? 3 : 4)];
+        byte* p = out + (i / 4) * out_stride + (i % 4) * 4;
+        for (i32 c = 0; c < 4; c++) {
+            p[c] = (byte)(((64 - weight) * endpoints[0][c] + weight * endpoints[1][c] + 32) >> 6);
+        }
+    }
+}
+
+// ---------
+// Driver
+
+void EncodeBlock(ColorBlock* block, u32 format, byte* out) {
+    switch (format) {
+        case BLOCK_TEXTURE_FORMAT_BC1: {
+            f32 weights[16];
+            for (i32 i = 0; i < 16; i++) {
+                weights[i] = 1.0f;
+            }
+            EncodeBC1Color(block, weights, out);
+            break;
+        }
+        case BLOCK_TEXTURE_FORMAT_BC3: {
+            // Fit the color to the visible texels, unless there are none
+            f32 weights[16];
+            f32 weight_sum = 0.0f;
+            for (i32 i = 0; i < 16; i++) {
+                weights[i] = 0.0f < block->pixels[i][3] ? 1.0f : 0.0f;
+                weight_sum += weights[i];
+            }
+            if (weight_sum == 0.0f) {
+                for (i32 i = 0; i < 16; i++) {
+                    weights[i] = 1.0f;
+                }
+            }
+            EncodeBC3Alpha(block, out);
+            EncodeBC1Color(block, weights, out + 8);
+            break;
+        }
+        case BLOCK_TEXTURE_FORMAT_BC7:
+            EncodeBC7(block, out);
+            break;
+    }
+}
+
+void DecodeBlock(const byte* block, u32 format, byte* out, i32 out_stride) {
+    switch (format) {
+        case BLOCK_TEXTURE_FORMAT_BC1:
+            DecodeBC1Color(block, out, out_stride);
+            for (i32 i = 0; i < 16; i++) {
+                out[(i / 4) * out_stride + (i % 4) * 4 + 3] = 255;
+            }
+            break;
+        case BLOCK_TEXTURE_FORMAT_BC3:
+            DecodeBC3Alpha(block, out, out_stride);
+            DecodeBC1Color(block + 8, out, out_stride);
+            break;
+        case BLOCK_TEXTURE_FORMAT_BC7:
+            DecodeBC7(block, out, out_stride);
+            break;
+    }
+}
+
+void EncodeWorker(EncodeContext* context) {
+    u32 block_bytes = BlockTextureBlockBytes(context->format);
+    for (;;) {
+        i32 job_index = context->next_job.fetch_add(1);
+        if (context->job_count <= job_index) {
+            return;
+        }
+
+        EncodeJob* job = &context->jobs[job_index];
+        MipChain* chain = context->chain;
+        i32 width = chain->widths[job->level];
+        i32 height = chain->heights[job->level];
+        byte* pixels = chain->pixels + chain->offsets[job->level];
+        i32 blocks_wide = (width + 3) / 4;
+        byte* out = context->output + context->level_offsets[job->level] + (size_t)job->block_y * blocks_wide * block_bytes;
+
+        for (i32 block_x = 0; block_x < blocks_wide; block_x++) {
+            ColorBlock block;
+            FetchColorBlock(pixels, width, height, block_x, job->block_y, &block);
+            EncodeBlock(&block, context->format, out + (size_t)block_x * block_bytes);
+        }
+    }
+}
+
+/**
+ * @brief PSNR in dB of the decoded level 0 against the source. RGB only counts texels that are not fully transparent.
+ */
+void MeasurePSNR(byte* source, byte* blocks, u32 format, i32 width, i32 height, f64* psnr_rgb, f64* psnr_alpha) {
+    u32 block_bytes = BlockTextureBlockBytes(format);
+    i32 blocks_wide = width / 4;
+    byte decoded[4 * 4 * 4];
+    f64 error_rgb = 0.0;
+    f64 error_alpha = 0.0;
+    f64 visible_count = 0.0;
+
+    for (i32 block_y = 0; block_y < height / 4; block_y++) {
+        for (i32 block_x = 0; block_x < blocks_wide; block_x++) {
+            DecodeBlock(blocks + ((size_t)block_y * blocks_wide + block_x) * block_bytes, format, decoded, 16);
+            for (i32 i = 0; i < 16; i++) {
+                byte* s = source + ((size_t)(block_y * 4 + i / 4) * width + block_x * 4 + i % 4) * 4;
+                byte* d = decoded + i * 4;
+                if (s[3] != 0) {
+                    for (i32 c = 0; c < 3; c++) {
+                        error_rgb += (f64)(s[c] - d[c]) * (s[c] - d[c]);
+                    }
+                    visible_count += 1.0;
+                }
+                error_alpha += (f64)(s[3] - d[3]) * (s[3] - d[3]);
+            }
+        }
+    }
+
+    f64 mse_rgb = visible_count == 0.0 ? 0.0 : error_rgb / (visible_count * 3.0);
+    f64 mse_alpha = error_alpha / ((f64)width * height);
+    *psnr_rgb = mse_rgb == 0.0 ? INFINITY : 10.0 * log10(255.0 * 255.0 / mse_rgb);
+    *psnr_alpha = mse_alpha == 0.0 ? INFINITY : 10.0 * log10(255.0 * 255.0 / mse_alpha);
+}
+
+bool WriteBlockTexture(char* path, BlockTextureHeader* header, byte* data) {
+    FILE* file = fopen(path, "wb");
+    if (!file) {
+        return false;
+    }
+    bool is_ok = fwrite(header, 1, sizeof(BlockTextureHeader), file) == sizeof(BlockTextureHeader);
+    is_ok = fwrite(data, 1, header->data_bytes, file) == header->data_bytes && is_ok;
+    is_ok = fclose(file) == 0 && is_ok;
+    return is_ok;
+}
+
+const char* FormatName(u32 format) {
+    switch (format) {
+        case BLOCK_TEXTURE_FORMAT_BC1: return "BC1";
+        case BLOCK_TEXTURE_FORMAT_BC3: return "BC3";
+        case BLOCK_TEXTURE_FORMAT_BC7: return "BC7";
+        default: return "?";
+    }
+}
+
+bool CompressImage(char* path, u32 requested_format, i32 thread_count, bool generate_mips) {
+    i32 width = 0;
+    i32 height = 0;
+    i32 channels = 0;
+    byte* image = stbi_load(path, &width, &height, &channels, 4);
+    if (!image) {
+        fprintf(stderr, "Failed to load %s: %s\n", path, stbi_failure_reason());
+        return false;
+    }
+    if (width % 4 != 0 || height % 4 != 0) {
+        fprintf(stderr, "%s (%dx%d): width and height must be multiples of 4\n", path, width, height);
+        stbi_image_free(image);
+        return false;
+    }
+
+    u32 format = requested_format;
+    if (format == 0) {
+        bool is_opaque = true;
+        for (size_t i = 0; i < (size_t)width * height && is_opaque; i++) {
+            is_opaque = image[i * 4 + 3] == 255;
+        }
+        format = is_opaque ? BLOCK_TEXTURE_FORMAT_BC1 : BLOCK_TEXTURE_FORMAT_BC7;
+    }
+
+    MipChain chain = {};
+    if (!MipChainBuild(&chain, image, width, height)) {
+        fprintf(stderr, "Out of memory\n");
+        exit(1);
+    }
+    stbi_image_free(image);
+    if (!generate_mips) {
+        chain.level_count = 1;
+    }
+
+    EncodeContext context = {};
+    context.chain = &chain;
+    context.format = format;
+
+    size_t data_bytes = 0;
+    i32 job_count = 0;
+    for (i32 level = 0; level < chain.level_count; level++) {
+        context.level_offsets[level] = data_bytes;
+        data_bytes += BlockTextureLevelSize(format, chain.widths[level], chain.heights[level]);
+        job_count += (chain.heights[level] + 3) / 4;
+    }
+
+    context.output = (byte*)malloc(data_bytes);
+    context.jobs = (EncodeJob*)malloc(sizeof(EncodeJob) * job_count);
+    if (!context.output || !context.jobs) {
+        fprintf(stderr, "Out of memory\n");
+        exit(1);
+    }
+    for (i32 level = 0; level < chain.level_count; level++) {
+        for (i32 block_y = 0; block_y < (chain.heights[level] + 3) / 4; block_y++) {
+            context.jobs[context.job_count++] = EncodeJob{ level, block_y };
+        }
+    }
+
+    auto start_time = std::chrono::steady_clock::now();
+
+    std::thread threads[COMPRESSOR_MAX_THREADS];
+    for (i32 i = 1; i < thread_count; i++) {
+        threads[i] = std::thread(EncodeWorker, &context);
+    }
+    EncodeWorker(&context);
+    for (i32 i = 1; i < thread_count; i++) {
+        threads[i].join();
+    }
+
+    f64 elapsed_ms = std::chrono::duration<f64, std::milli>(std::chrono::steady_clock::now() - start_time).count();
+
+    f64 psnr_rgb = 0.0;
+    f64 psnr_alpha = 0.0;
+    MeasurePSNR(chain.pixels, context.output, format, width, height, &psnr_rgb, &psnr_alpha);
+
+    BlockTextureHeader header = {
+        .magic = BLOCK_TEXTURE_MAGIC,
+        .version = BLOCK_TEXTURE_VERSION,
+        .format = format,
+        .width = (u32)width,
+        .height = (u32)height,
+        .level_count = (u32)chain.level_count,
+        .data_bytes = (u32)data_bytes,
+        .reserved = 0
+    };
+
+    char output_path[1024];
+    const char* extension = strrchr(path, '.');
+    const char* last_separator = nullptr;
+    for (const char* p = path; *p != 0; p++) {
+        if (*p == '/' || *p == '\\') {
+            last_separator = p;
+        }
+    }
+    i32 stem_length = extension && (!last_separator || last_separator < extension) ? (i32)(extension - path) : (i32)strlen(path);
+    snprintf(output_path, sizeof(output_path), "%.*s.fbct", stem_length, path);
+
+    bool is_ok = WriteBlockTexture(output_path, &header, context.output);
+    if (is_ok) {
+        size_t texel_count = 0;
+        for (i32 level = 0; level < chain.level_count; level++) {
+            texel_count += (size_t)chain.widths[level] * chain.heights[level];
+        }
+        printf("%s: %dx%d %s, %d level(s), %zu bytes, PSNR RGB %.2f dB alpha %.2f dB, %.1f ms, %.2f Mtexel/s\n",
+            output_path, width, height, FormatName(format), chain.level_count, data_bytes, psnr_rgb, psnr_alpha,
+            elapsed_ms, (f64)texel_count / (elapsed_ms * 1000.0));
+    }
+    else {
+        fprintf(stderr, "Failed to write %s\n", output_path);
+    }
+
+    free(context.output);
+    free(context.jobs);
+    MipChainDestroy(&chain);
+    return is_ok;
+}
+
+int main(int argc, char** argv) {
+    u32 format = 0;
+    i32 thread_count = (i32)std::thread::hardware_concurrency();
+    bool generate_mips = true;
+    bool is_usage_valid = true;
+    i32 first_image = argc;
+
+    for (i32 i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--format") == 0 && i + 1 < argc) {
+            char* name = argv[++i];
+            if (strcmp(name, "auto") == 0) format = 0;
+            else if (strcmp(name, "bc1") == 0) format = BLOCK_TEXTURE_FORMAT_BC1;
+            else if (strcmp(name, "bc3") == 0) format = BLOCK_TEXTURE_FORMAT_BC3;
+            else if (strcmp(name, "bc7") == 0) format = BLOCK_TEXTURE_FORMAT_BC7;
+            else is_usage_valid = false;
+        }
+        else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            thread_count = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--no-mips") == 0) {
+            generate_mips = false;
+        }
+        else {
+            first_image = i;
+            break;
+        }
+    }
+
+    if (!is_usage_valid || first_image == argc || thread_count < 0) {
+        fprintf(stderr, "Usage: texture_compressor [--format auto|bc1|bc3|bc7] [--threads N] [--no-mips] <image> [image...]\n");
+        return 1;
+    }
+    thread_count = ClampInt(thread_count, 1, COMPRESSOR_MAX_THREADS);
+
+    bool is_ok = true;
+    for (i32 i = first_image; i < argc; i++) {
+        is_ok = CompressImage(argv[i], format, thread_count, generate_mips) && is_ok;
+    }
+    return is_ok ? 0 : 1;
+}